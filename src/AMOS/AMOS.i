@@ -23,8 +23,32 @@
 %include "datatypes_AMOS.hh"
 %include "databanks_AMOS.hh"
 %include "IDMap_AMOS.hh"
+// Bank internals, protected nested classes older SWIG warns about
+%ignore AMOS::Bank_t::BankPartition_t;
+%ignore AMOS::Bank_t::MappedBuffer_t;
+%ignore AMOS::Bank_t::StoreSums_t;
 %include "Bank_AMOS.hh"
 %include "BankStream_AMOS.hh"
+#ifdef SWIGPYTHON
+// A fill or clear would pull the arrays out from under the views handed out
+// by the last fill, see BatchView below
+%define BATCH_UNEXPORTED(method)
+%exception method {
+  if ( BatchExported (arg1) )
+    {
+      PyErr_SetString (PyExc_BufferError,
+        "batch arrays are still in use, delete them before refilling the batch");
+      SWIG_fail;
+    }
+  $action
+}
+%enddef
+BATCH_UNEXPORTED(AMOS::ReadBatch_t::fill)
+BATCH_UNEXPORTED(AMOS::ReadBatch_t::clear)
+BATCH_UNEXPORTED(AMOS::TileBatch_t::fill)
+BATCH_UNEXPORTED(AMOS::TileBatch_t::clear)
+#endif
+%include "BankBatch_AMOS.hh"
 %include "Universal_AMOS.hh"
 %include "Sequence_AMOS.hh"
 %include "Read_AMOS.hh"
@@ -67,10 +91,177 @@ typedef AMOS::IDMap_t::HashTriple_t HashTriple_t;
 %}
 
 
+#ifdef SWIGPYTHON
+// Zero copy views of the batch arrays, e.g. for numpy.frombuffer. Each view
+// exports a BatchBuffer, which holds a reference to the Python batch so the
+// arrays outlive the batch variable. The live BatchBuffers of each batch are
+// counted, and the batch refuses to be refilled or cleared while it has any.
+%{
+#include <map>
+
+static std::map<const void *, Py_ssize_t> BatchExports;
+
+static bool BatchExported (const void * batch)
+{
+  return BatchExports . find (batch) != BatchExports . end( );
+}
+
+struct BatchBuffer_t
+{
+  PyObject_HEAD
+  PyObject * owner;         // the batch the data belongs to
+  const void * batch;       // the C++ batch, the key of its export count
+  void * data;
+  Py_ssize_t n;             // item count, the shape of the view
+  Py_ssize_t itemsize;
+  const char * format;      // struct module format of an item
+};
+
+static int BatchBuffer_getbuffer (PyObject * self, Py_buffer * view, int flags)
+{
+  BatchBuffer_t * b = (BatchBuffer_t *) self;
+
+  if ( (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE )
+    {
+      PyErr_SetString (PyExc_BufferError, "batch arrays are read-only");
+      return -1;
+    }
+
+  view->obj = self;
+  Py_INCREF (self);
+  view->buf = b->data;
+  view->len = b->n * b->itemsize;
+  view->readonly = 1;
+  view->itemsize = b->itemsize;
+  view->format = (flags & PyBUF_FORMAT) ? (char *) b->format : NULL;
+  view->ndim = 1;
+  view->shape = (flags & PyBUF_ND) ? &b->n : NULL;
+  view->strides =
+    ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? &b->itemsize : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+  return 0;
+}
+
+static void BatchBuffer_dealloc (PyObject * self)
+{
+  BatchBuffer_t * b = (BatchBuffer_t *) self;
+
+  if ( -- BatchExports [b->batch] == 0 )
+    BatchExports . erase (b->batch);
+  Py_XDECREF (b->owner);
+  PyObject_Del (self);
+}
+
+static PyBufferProcs BatchBuffer_as_buffer;
+static PyTypeObject BatchBuffer_Type = { PyVarObject_HEAD_INIT (NULL, 0) };
+
+static PyObject * BatchView (PyObject * owner, const void * batch,
+                             const void * data, Py_ssize_t n,
+                             Py_ssize_t itemsize, const char * format)
+{
+  static char empty = 0;
+  if ( data == NULL )
+    data = &empty;
+
+  if ( BatchBuffer_Type.tp_name == NULL )
+    {
+      BatchBuffer_as_buffer.bf_getbuffer = BatchBuffer_getbuffer;
+      BatchBuffer_Type.tp_name = "AMOS.BatchBuffer";
+      BatchBuffer_Type.tp_basicsize = sizeof (BatchBuffer_t);
+      BatchBuffer_Type.tp_dealloc = BatchBuffer_dealloc;
+      BatchBuffer_Type.tp_as_buffer = &BatchBuffer_as_buffer;
+#if PY_MAJOR_VERSION < 3
+      BatchBuffer_Type.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER;
+#else
+      BatchBuffer_Type.tp_flags = Py_TPFLAGS_DEFAULT;
+#endif
+      BatchBuffer_Type.tp_doc = "Array of a read or tile batch";
+      if ( PyType_Ready (&BatchBuffer_Type) < 0 )
+        {
+          BatchBuffer_Type.tp_name = NULL;
+          return NULL;
+        }
+    }
+
+  BatchBuffer_t * b = PyObject_New (BatchBuffer_t, &BatchBuffer_Type);
+  if ( b == NULL )
+    return NULL;
+  Py_INCREF (owner);
+  b->owner = owner;
+  b->batch = batch;
+  BatchExports [batch] ++;
+  b->data = (void *) data;
+  b->n = n;
+  b->itemsize = itemsize;
+  b->format = format;
+
+  PyObject * view = PyMemoryView_FromObject ((PyObject *) b);
+  Py_DECREF (b);
+  return view;
+}
+%}
+
+// The array methods take the Python batch as their owner, the proxy methods
+// below pass it in
+%extend AMOS::ReadBatch_t {
+  PyObject * iids_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getIIDs( ), $self->getSize( ), sizeof (AMOS::ID_t), "I"); }
+  PyObject * lengths_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getLengths( ), $self->getSize( ), sizeof (AMOS::Size_t), "i"); }
+  PyObject * clear_begins_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getClearBegins( ), $self->getSize( ), sizeof (AMOS::Pos_t), "i"); }
+  PyObject * clear_ends_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getClearEnds( ), $self->getSize( ), sizeof (AMOS::Pos_t), "i"); }
+  PyObject * seq_offsets_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getSeqOffsets( ), $self->getSize( ) + 1, sizeof (uint64_t), "Q"); }
+  PyObject * seqs_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getSeqs( ), $self->getSeqsSize( ), 1, "B"); }
+  PyObject * quals_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getQuals( ), $self->getQualsSize( ), 1, "B"); }
+
+%pythoncode %{
+    def iids (self): return self.iids_view (self)
+    def lengths (self): return self.lengths_view (self)
+    def clear_begins (self): return self.clear_begins_view (self)
+    def clear_ends (self): return self.clear_ends_view (self)
+    def seq_offsets (self): return self.seq_offsets_view (self)
+    def seqs (self): return self.seqs_view (self)
+    def quals (self): return self.quals_view (self)
+%}
+}
+
+%extend AMOS::TileBatch_t {
+  PyObject * contigs_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getContigs( ), $self->getSize( ), sizeof (AMOS::ID_t), "I"); }
+  PyObject * sources_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getSources( ), $self->getSize( ), sizeof (AMOS::ID_t), "I"); }
+  PyObject * offsets_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getOffsets( ), $self->getSize( ), sizeof (AMOS::Pos_t), "i"); }
+  PyObject * range_begins_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getRangeBegins( ), $self->getSize( ), sizeof (AMOS::Pos_t), "i"); }
+  PyObject * range_ends_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getRangeEnds( ), $self->getSize( ), sizeof (AMOS::Pos_t), "i"); }
+  PyObject * gapped_lengths_view (PyObject * owner)
+  { return BatchView (owner, $self, $self->getGappedLengths( ), $self->getSize( ), sizeof (AMOS::Size_t), "i"); }
+
+%pythoncode %{
+    def contigs (self): return self.contigs_view (self)
+    def sources (self): return self.sources_view (self)
+    def offsets (self): return self.offsets_view (self)
+    def range_begins (self): return self.range_begins_view (self)
+    def range_ends (self): return self.range_ends_view (self)
+    def gapped_lengths (self): return self.gapped_lengths_view (self)
+%}
+}
+#endif
+
+
 // make clean; make CXXFLAGS=-fPIC
 // /fs/szdevel/treangen/bin/swig -Wall -python -c++ AMOS.i
 //  g++ -shared  -fPIC -c AMOS_wrap.cxx -I/fs/sz-user-supported/Linux-x86_64/include/python2.6
 //  g++ -shared -fPIC  AMOS_wrap.o -L. -lAMOS -o _AMOS.so
+//  python batchtest.py <bank>
 
 //ignore BankStream_AMOS::triples_m
 //ignore Bank_AMOS::getIDMap()
@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Source for ReadBatch_t and TileBatch_t
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#include "BankBatch_AMOS.hh"
+#include "Read_AMOS.hh"
+#include "Contig_AMOS.hh"
+using namespace AMOS;
+using namespace std;
+
+
+
+
+//================================================ ReadBatch_t =================
+//----------------------------------------------------- clear ------------------
+void ReadBatch_t::clear ( )
+{
+  iids_m . clear( );
+  lengths_m . clear( );
+  clrbegs_m . clear( );
+  clrends_m . clear( );
+  seqoffs_m . clear( );
+  seqoffs_m . push_back (0);
+  seqs_m . clear( );
+  quals_m . clear( );
+}
+
+
+//----------------------------------------------------- fill -------------------
+Size_t ReadBatch_t::fill (BankStream_t & bank, Size_t max)
+{
+  Read_t red;
+
+  clear( );
+
+  while ( getSize( ) < max  &&  ! bank . eof( )  &&  bank >> red )
+    {
+      Range_t clr = red . getClearRange( );
+
+      iids_m . push_back (red . getIID( ));
+      lengths_m . push_back (red . getLength( ));
+      clrbegs_m . push_back (clr . begin);
+      clrends_m . push_back (clr . end);
+
+      seqs_m += red . getSeqString( );
+      if ( withquals_m )
+        quals_m += red . getQualString( );
+      seqoffs_m . push_back (seqs_m . size( ));
+    }
+
+  return getSize( );
+}
+
+
+
+
+//================================================ TileBatch_t =================
+//----------------------------------------------------- clear ------------------
+void TileBatch_t::clear ( )
+{
+  contigs_m . clear( );
+  sources_m . clear( );
+  offsets_m . clear( );
+  rngbegs_m . clear( );
+  rngends_m . clear( );
+  gaplens_m . clear( );
+}
+
+
+//----------------------------------------------------- fill -------------------
+Size_t TileBatch_t::fill (BankStream_t & bank, Size_t max)
+{
+  Contig_t ctg;
+  Size_t n = 0;
+
+  clear( );
+
+  while ( n < max  &&  ! bank . eof( )  &&  bank >> ctg )
+    {
+      const vector<Tile_t> & tiles = ctg . getReadTiling( );
+
+      for ( vector<Tile_t>::const_iterator
+              ti = tiles . begin( ); ti != tiles . end( ); ++ ti )
+        {
+          contigs_m . push_back (ctg . getIID( ));
+          sources_m . push_back (ti -> source);
+          offsets_m . push_back (ti -> offset);
+          rngbegs_m . push_back (ti -> range . begin);
+          rngends_m . push_back (ti -> range . end);
+          gaplens_m . push_back (ti -> getGappedLength( ));
+        }
+
+      n ++;
+    }
+
+  return n;
+}
@@ -0,0 +1,258 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Header for ReadBatch_t and TileBatch_t
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BankBatch_AMOS_HH
+#define __BankBatch_AMOS_HH 1
+
+#include "BankStream_AMOS.hh"
+#include <string>
+#include <vector>
+
+
+
+
+namespace AMOS {
+
+//================================================ ReadBatch_t =================
+//! \brief Columns of the reads of a bank, filled a batch at a time
+//!
+//! Streams reads from a bank into contiguous arrays, one element per read,
+//! plus the sequences (and optionally the qualities) of all the reads
+//! concatenated into one buffer. Read i's sequence is the bytes
+//! [getSeqOffsets( )[i], getSeqOffsets( )[i+1]) of getSeqs( ), the qualities
+//! use the same offsets. Meant for scripting languages, which can wrap the
+//! arrays without building an object per read.
+//!
+//! The arrays are reused by the next fill, so pointers to them are valid
+//! until the batch is filled again or destroyed.
+//!
+//==============================================================================
+class ReadBatch_t
+{
+
+public:
+
+  //--------------------------------------------------- ReadBatch_t ------------
+  //! \brief Constructs an empty batch
+  //!
+  //! \param quals Also collect the qualities
+  //!
+  ReadBatch_t (bool quals = false)
+    : withquals_m (quals)
+  {
+    seqoffs_m . push_back (0);
+  }
+
+
+  //--------------------------------------------------- fill -------------------
+  //! \brief Reads the next batch of reads from a bank stream
+  //!
+  //! Replaces the contents of the batch by the next max reads of the stream,
+  //! or as many as are left.
+  //!
+  //! \param bank An open read bank stream
+  //! \param max The maximum number of reads
+  //! \throws IOException_t
+  //! \return The number of reads in the batch, 0 at the end of the stream
+  //!
+  Size_t fill (BankStream_t & bank, Size_t max);
+
+
+  //--------------------------------------------------- clear ------------------
+  //! \brief Empties the batch
+  //!
+  void clear ( );
+
+
+  //--------------------------------------------------- getSize ----------------
+  Size_t getSize ( ) const
+  {
+    return iids_m . size( );
+  }
+
+
+  //--------------------------------------------------- getIIDs ----------------
+  const ID_t * getIIDs ( ) const
+  {
+    return iids_m . empty( ) ? NULL : &iids_m[0];
+  }
+
+
+  //--------------------------------------------------- getLengths -------------
+  const Size_t * getLengths ( ) const
+  {
+    return lengths_m . empty( ) ? NULL : &lengths_m[0];
+  }
+
+
+  //--------------------------------------------------- getClearBegins ---------
+  const Pos_t * getClearBegins ( ) const
+  {
+    return clrbegs_m . empty( ) ? NULL : &clrbegs_m[0];
+  }
+
+
+  //--------------------------------------------------- getClearEnds -----------
+  const Pos_t * getClearEnds ( ) const
+  {
+    return clrends_m . empty( ) ? NULL : &clrends_m[0];
+  }
+
+
+  //--------------------------------------------------- getSeqOffsets ----------
+  //! \brief Returns the getSize( ) + 1 offsets of the reads in getSeqs( )
+  //!
+  const uint64_t * getSeqOffsets ( ) const
+  {
+    return &seqoffs_m[0];
+  }
+
+
+  //--------------------------------------------------- getSeqs ----------------
+  const char * getSeqs ( ) const
+  {
+    return seqs_m . data( );
+  }
+
+
+  //--------------------------------------------------- getSeqsSize ------------
+  uint64_t getSeqsSize ( ) const
+  {
+    return seqs_m . size( );
+  }
+
+
+  //--------------------------------------------------- getQuals ---------------
+  //! \brief Returns the qualities, empty unless collected
+  //!
+  const char * getQuals ( ) const
+  {
+    return quals_m . data( );
+  }
+
+
+  //--------------------------------------------------- getQualsSize -----------
+  uint64_t getQualsSize ( ) const
+  {
+    return quals_m . size( );
+  }
+
+
+private:
+
+  bool withquals_m;                 //!< collect the qualities
+  std::vector<ID_t> iids_m;         //!< read IIDs
+  std::vector<Size_t> lengths_m;    //!< read lengths
+  std::vector<Pos_t> clrbegs_m;     //!< clear range begins
+  std::vector<Pos_t> clrends_m;     //!< clear range ends
+  std::vector<uint64_t> seqoffs_m;  //!< sequence offsets, one more than reads
+  std::string seqs_m;               //!< concatenated sequences
+  std::string quals_m;              //!< concatenated qualities
+};
+
+
+
+
+//================================================ TileBatch_t =================
+//! \brief Columns of the read tiles of a contig bank, a batch at a time
+//!
+//! Streams contigs from a bank and lays out their read tiles as contiguous
+//! arrays, one element per tile, tagged with the IID of the contig. The
+//! tiles of a contig are never split between batches.
+//!
+//! The arrays are reused by the next fill, so pointers to them are valid
+//! until the batch is filled again or destroyed.
+//!
+//==============================================================================
+class TileBatch_t
+{
+
+public:
+
+  //--------------------------------------------------- fill -------------------
+  //! \brief Reads the next batch of contigs from a bank stream
+  //!
+  //! Replaces the contents of the batch by the tiles of the next max contigs
+  //! of the stream, or as many as are left.
+  //!
+  //! \param bank An open contig bank stream
+  //! \param max The maximum number of contigs
+  //! \throws IOException_t
+  //! \return The number of contigs read, 0 at the end of the stream
+  //!
+  Size_t fill (BankStream_t & bank, Size_t max);
+
+
+  //--------------------------------------------------- clear ------------------
+  //! \brief Empties the batch
+  //!
+  void clear ( );
+
+
+  //--------------------------------------------------- getSize ----------------
+  //! \brief Returns the number of tiles in the batch
+  //!
+  Size_t getSize ( ) const
+  {
+    return sources_m . size( );
+  }
+
+
+  //--------------------------------------------------- getContigs -------------
+  const ID_t * getContigs ( ) const
+  {
+    return contigs_m . empty( ) ? NULL : &contigs_m[0];
+  }
+
+
+  //--------------------------------------------------- getSources -------------
+  const ID_t * getSources ( ) const
+  {
+    return sources_m . empty( ) ? NULL : &sources_m[0];
+  }
+
+
+  //--------------------------------------------------- getOffsets -------------
+  const Pos_t * getOffsets ( ) const
+  {
+    return offsets_m . empty( ) ? NULL : &offsets_m[0];
+  }
+
+
+  //--------------------------------------------------- getRangeBegins ---------
+  const Pos_t * getRangeBegins ( ) const
+  {
+    return rngbegs_m . empty( ) ? NULL : &rngbegs_m[0];
+  }
+
+
+  //--------------------------------------------------- getRangeEnds -----------
+  const Pos_t * getRangeEnds ( ) const
+  {
+    return rngends_m . empty( ) ? NULL : &rngends_m[0];
+  }
+
+
+  //--------------------------------------------------- getGappedLengths -------
+  const Size_t * getGappedLengths ( ) const
+  {
+    return gaplens_m . empty( ) ? NULL : &gaplens_m[0];
+  }
+
+
+private:
+
+  std::vector<ID_t> contigs_m;      //!< contig IIDs
+  std::vector<ID_t> sources_m;      //!< read IIDs
+  std::vector<Pos_t> offsets_m;     //!< tile offsets
+  std::vector<Pos_t> rngbegs_m;     //!< tile range begins
+  std::vector<Pos_t> rngends_m;     //!< tile range ends
+  std::vector<Size_t> gaplens_m;    //!< gapped tile lengths
+};
+
+} // namespace AMOS
+
+#endif // #ifndef __BankBatch_AMOS_HH
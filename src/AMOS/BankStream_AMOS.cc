@@ -8,12 +8,314 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "BankStream_AMOS.hh"
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
 using namespace AMOS;
 using namespace std;
 
 
 
 
+//================================================ ReadAhead_t =================
+//! \brief The state shared by a BankStream_t and its read-ahead thread
+//!
+//! The thread reads the raw fixed records of a run of BIDs, and the variable
+//! records they point to, into a chunk. Chunks never span partitions. The
+//! thread only sees what is copied in here at start, and reads the stores
+//! through its own descriptors, so the stream keeps using its own.
+//!
+//==============================================================================
+struct BankStream_t::ReadAhead_t
+{
+  struct Chunk_t
+  {
+    ID_t first_bid;                 //!< first BID of the chunk
+    ID_t next_bid;                  //!< one past the last BID of the chunk
+    std::string fix;                //!< fixed records of every BID
+    std::string var;                //!< variable records of the live BIDs
+    std::vector<Size_t> varoff;     //!< offset of each BID in var
+    std::vector<Size_t> varlen;     //!< length of each BID in var
+  };
+
+  std::vector<std::string> fix_names;
+  std::vector<std::string> var_names;
+  Size_t partition_size;
+  Size_t fix_size;
+  ID_t last_bid;
+  bool withvar;                     //!< also load the variable records
+  Size_t max_records;
+  Size_t max_bytes;
+  Size_t chunk_records;
+
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t ready;             //!< a chunk was queued or the thread ended
+  pthread_cond_t space;             //!< a chunk was taken or stop was asked
+
+  ID_t next_bid;                    //!< next BID for the thread to load
+  std::deque<Chunk_t *> chunks;     //!< loaded, not yet taken
+  Size_t queued_records;
+  Size_t queued_bytes;
+  bool stopping;
+  bool done;
+  std::string error;
+
+  Chunk_t * current;                //!< chunk being decoded by operator>>
+
+
+  ReadAhead_t ( )
+    : queued_records (0), queued_bytes (0),
+      stopping (false), done (false), current (NULL)
+  {
+    pthread_mutex_init (&lock, NULL);
+    pthread_cond_init (&ready, NULL);
+    pthread_cond_init (&space, NULL);
+  }
+
+  ~ReadAhead_t ( )
+  {
+    delete current;
+    for ( Size_t i = 0; i < (Size_t) chunks . size( ); ++ i )
+      delete chunks [i];
+    pthread_cond_destroy (&space);
+    pthread_cond_destroy (&ready);
+    pthread_mutex_destroy (&lock);
+  }
+
+  static void * threadMain (void * ra);
+  void run ( );
+  void load (Chunk_t * chunk, int fixfd, int varfd);
+  Chunk_t * take ( );
+};
+
+
+//-- Read exactly size bytes at off, false on a short read
+static bool ReadFully (int fd, char * buf, size_t size, off_t off)
+{
+  while ( size > 0 )
+    {
+      ssize_t n = pread (fd, buf, size, off);
+      if ( n < 0  &&  errno == EINTR )
+        continue;
+      if ( n <= 0 )
+        return false;
+      buf += n;
+      size -= n;
+      off += n;
+    }
+  return true;
+}
+
+
+//-- Hint the kernel about how a store will be read
+static void AdviseStore (int fd, off_t off, off_t len, bool sequential)
+{
+#ifdef HAVE_POSIX_FADVISE
+  posix_fadvise (fd, off, len,
+                 sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_WILLNEED);
+#endif
+}
+
+
+//----------------------------------------------------- threadMain -------------
+void * BankStream_t::ReadAhead_t::threadMain (void * ra)
+{
+  ((ReadAhead_t *) ra) -> run( );
+  return NULL;
+}
+
+
+//----------------------------------------------------- run --------------------
+void BankStream_t::ReadAhead_t::run ( )
+{
+  int fixfd = -1;
+  int varfd = -1;
+  ID_t pid = -1;
+  string err;
+
+  pthread_mutex_lock (&lock);
+  ID_t bid = next_bid;
+
+  while ( ! stopping  &&  bid <= last_bid )
+    {
+      //-- Wait for room, there is always room for one chunk
+      while ( ! stopping  &&  ! chunks . empty( )  &&
+              ( queued_records + chunk_records > max_records  ||
+                ( max_bytes > 0  &&  queued_bytes >= max_bytes ) ) )
+        pthread_cond_wait (&space, &lock);
+      if ( stopping )
+        break;
+      pthread_mutex_unlock (&lock);
+
+      ID_t lid = bid - 1;
+      ID_t cpid = lid / partition_size;
+      lid -= cpid * partition_size;
+
+      if ( cpid != pid )
+        {
+          if ( fixfd != -1 ) ::close (fixfd);
+          if ( varfd != -1 ) ::close (varfd);
+          fixfd = varfd = -1;
+          pid = cpid;
+
+          fixfd = ::open (fix_names [pid] . c_str( ), O_RDONLY);
+          if ( withvar )
+            varfd = ::open (var_names [pid] . c_str( ), O_RDONLY);
+          if ( fixfd == -1  ||  (withvar  &&  varfd == -1) )
+            err = "Could not open bank partition in read-ahead";
+          else
+            {
+              AdviseStore (fixfd, 0, 0, true);
+              if ( withvar )
+                AdviseStore (varfd, 0, 0, true);
+            }
+        }
+
+      Chunk_t * chunk = NULL;
+      if ( err . empty( ) )
+        {
+          ID_t n = chunk_records;
+          if ( n > partition_size - lid )
+            n = partition_size - lid;
+          if ( n > last_bid - bid + 1 )
+            n = last_bid - bid + 1;
+
+          chunk = new Chunk_t;
+          chunk -> first_bid = bid;
+          chunk -> next_bid = bid + n;
+          try {
+            load (chunk, fixfd, varfd);
+          }
+          catch (Exception_t & e) {
+            err = e . what( );
+          }
+
+          //-- Ask for the next chunk while this one is consumed
+          if ( err . empty( ) )
+            AdviseStore (fixfd, (off_t) (lid + n) * fix_size,
+                         (off_t) n * fix_size, false);
+        }
+
+      pthread_mutex_lock (&lock);
+      if ( ! err . empty( ) )
+        {
+          delete chunk;
+          error = err;
+          break;
+        }
+
+      chunks . push_back (chunk);
+      queued_records += chunk -> next_bid - chunk -> first_bid;
+      queued_bytes += chunk -> fix . size( ) + chunk -> var . size( );
+      bid = chunk -> next_bid;
+      pthread_cond_signal (&ready);
+    }
+
+  done = true;
+  pthread_cond_signal (&ready);
+  pthread_mutex_unlock (&lock);
+
+  if ( fixfd != -1 ) ::close (fixfd);
+  if ( varfd != -1 ) ::close (varfd);
+}
+
+
+//----------------------------------------------------- load -------------------
+void BankStream_t::ReadAhead_t::load (Chunk_t * chunk, int fixfd, int varfd)
+{
+  ID_t n = chunk -> next_bid - chunk -> first_bid;
+  ID_t lid = (chunk -> first_bid - 1) % partition_size;
+
+  size_t size = (size_t) n * fix_size;
+  chunk -> fix . resize (size);
+  if ( ! ReadFully (fixfd, &(chunk -> fix [0]), size, (off_t) lid * fix_size) )
+    AMOS_THROW_IO ("Unknown file read error in read-ahead, bank corrupted");
+
+  if ( ! withvar )
+    return;
+
+  //-- Load the variable records, merging the runs that are adjacent on disk
+  chunk -> varoff . resize (n, 0);
+  chunk -> varlen . resize (n, 0);
+
+  bankstreamoff vpos;
+  BankFlags_t flags;
+  Size_t vsize;
+  bankstreamoff run = 0;
+  Size_t runlen = 0;
+
+  for ( ID_t i = 0; i <= n; ++ i )
+    {
+      if ( i < n )
+        {
+          const char * rec = chunk -> fix . data( ) + i * fix_size;
+          MappedBuffer_t head (rec, rec + fix_size);
+          MappedBuffer_t tail (rec + fix_size - sizeof (Size_t), rec + fix_size);
+          istream hin (&head);
+          istream tin (&tail);
+          readLE (hin, &vpos);
+          readLE (hin, &flags);
+          readLE (tin, &vsize);
+
+          if ( flags . is_removed )
+            continue;
+          if ( vpos < 0 )
+            AMOS_THROW_IO ("Unknown file read error in read-ahead, bank corrupted");
+
+          if ( runlen > 0  &&  vpos == run + (bankstreamoff) runlen )
+            {
+              chunk -> varoff [i] = chunk -> var . size( ) + runlen;
+              chunk -> varlen [i] = vsize;
+              runlen += vsize;
+              continue;
+            }
+        }
+
+      if ( runlen > 0 )
+        {
+          Size_t at = chunk -> var . size( );
+          chunk -> var . resize (at + runlen);
+          if ( ! ReadFully (varfd, &(chunk -> var [at]), runlen, run) )
+            AMOS_THROW_IO ("Unknown file read error in read-ahead, bank corrupted");
+        }
+
+      if ( i < n )
+        {
+          run = vpos;
+          runlen = vsize;
+          chunk -> varoff [i] = chunk -> var . size( );
+          chunk -> varlen [i] = vsize;
+        }
+    }
+}
+
+
+//----------------------------------------------------- take -------------------
+BankStream_t::ReadAhead_t::Chunk_t * BankStream_t::ReadAhead_t::take ( )
+{
+  pthread_mutex_lock (&lock);
+  while ( chunks . empty( )  &&  ! done )
+    pthread_cond_wait (&ready, &lock);
+
+  Chunk_t * chunk = NULL;
+  if ( ! chunks . empty( ) )
+    {
+      chunk = chunks . front( );
+      chunks . pop_front( );
+      queued_records -= chunk -> next_bid - chunk -> first_bid;
+      queued_bytes -= chunk -> fix . size( ) + chunk -> var . size( );
+      pthread_cond_signal (&space);
+    }
+  pthread_mutex_unlock (&lock);
+
+  return chunk;
+}
+
+
+
+
 //================================================ BankStream_t ================
 const Size_t BankStream_t::DEFAULT_BUFFER_SIZE = 1024;
 const Size_t BankStream_t::MAX_OPEN_PARTITIONS = 2;
@@ -85,6 +387,91 @@ void BankStream_t::concat (BankStream_t & s)
 }
 
 
+//----------------------------------------------------- getBuffered ------------
+void BankStream_t::getBuffered (IBankable_t & obj)
+{
+  bool withvar = ( fields_m == P_ALL  &&  ! fixed_store_only_m );
+  ReadAhead_t::Chunk_t * chunk = NULL;
+  BankFlags_t flags;
+  bankstreamoff vpos = 0;
+  const char * rec = NULL;
+
+  //-- Find the next live record, restarting the thread after a seek
+  flags.is_removed = true;
+  while ( flags.is_removed )
+    {
+      if ( !inrange() )
+        {
+          eof_m = true;
+          return;
+        }
+
+      if ( readahead_m == NULL  ||  (withvar  &&  ! readahead_m -> withvar) )
+        startReadAhead( );
+
+      chunk = readahead_m -> current;
+      if ( chunk != NULL  &&  curr_bid_m >= chunk -> next_bid )
+        {
+          delete chunk;
+          chunk = readahead_m -> current = readahead_m -> take( );
+          if ( chunk == NULL  &&  ! readahead_m -> error . empty( ) )
+            {
+              string err (readahead_m -> error);
+              stopReadAhead( );
+              AMOS_THROW_IO (err);
+            }
+        }
+
+      if ( chunk == NULL  ||  curr_bid_m < chunk -> first_bid  ||
+           curr_bid_m >= chunk -> next_bid )
+        {
+          startReadAhead( );
+          if ( readahead_m -> current == NULL )
+            AMOS_THROW_IO ("Unknown file read error in read-ahead, bank corrupted");
+          continue;
+        }
+
+      rec = chunk -> fix . data( ) +
+        (curr_bid_m - chunk -> first_bid) * fix_size_m;
+      MappedBuffer_t head (rec, rec + sizeof (bankstreamoff) + sizeof (BankFlags_t));
+      istream hin (&head);
+      readLE (hin, &vpos);
+      readLE (hin, &flags);
+
+      ++ curr_bid_m;
+    }
+
+  setStreamIDs (obj, flags, vpos);
+
+  MappedBuffer_t fixbuf (rec + sizeof (bankstreamoff) + sizeof (BankFlags_t),
+                         rec + fix_size_m);
+  istream fix (&fixbuf);
+
+  if (fields_m != P_ALL)
+  {
+    obj.readRecordFields (fix, fields_m);
+  }
+  else if (fixed_store_only_m)
+  {
+    obj.readRecordFix (fix);
+  }
+  else
+  {
+    ID_t i = curr_bid_m - 1 - chunk -> first_bid;
+    const char * beg = chunk -> var . data( ) + chunk -> varoff [i];
+    MappedBuffer_t varbuf (beg, beg + chunk -> varlen [i]);
+    istream var (&varbuf);
+    obj.readRecord (fix, var);
+
+    if ( var.fail() )
+      AMOS_THROW_IO ("Unknown file read error in variable stream fetch, bank corrupted");
+  }
+
+  if ( fix.fail() )
+    AMOS_THROW_IO ("Unknown file read error in fixed stream fetch, bank corrupted");
+}
+
+
 //----------------------------------------------------- ignore -----------------
 BankStream_t & BankStream_t::ignore (bankstreamoff n)
 {
@@ -146,6 +533,12 @@ BankStream_t & BankStream_t::operator>> (IBankable_t & obj)
   if ( eof() )
     AMOS_THROW_ARGUMENT ("Cannot stream fetch: beyond end of stream");
 
+  if ( ra_records_m > 0  &&  ! (mode_m & (B_WRITE | B_VERIFY)) )
+    {
+      getBuffered (obj);
+      return *this;
+    }
+
   ID_t lid;
   BankFlags_t flags;
   bankstreamoff off;
@@ -181,22 +574,16 @@ BankStream_t & BankStream_t::operator>> (IBankable_t & obj)
       ++ curr_bid_m;
     }
 
+  if ( (mode_m & B_VERIFY) )
+    verifyRecord (partition, lid, fields_m == P_ALL  &&  ! fixed_store_only_m);
 
-  const IDMap_t::HashTriple_t * trip = triples_m [curr_bid_m - 1];
-  if ( trip == NULL )
-    {
-      obj.iid_m = NULL_ID;
-      obj.eid_m.erase();
-    }
-  else
-    {
-      obj.iid_m = trip->iid;
-      obj.eid_m.assign (trip->eid);
-    }
-
-  obj.flags_m = flags;
+  setStreamIDs (obj, flags, vpos);
 
-  if (fixed_store_only_m)
+  if (fields_m != P_ALL)
+  {
+    obj.readRecordFields (partition->fix, fields_m);
+  }
+  else if (fixed_store_only_m)
   {
     obj.readRecordFix (partition->fix);
   }
@@ -250,23 +637,17 @@ BankStream_t & BankStream_t::operator<< (IBankable_t & obj)
         ate_m = true;
       }
 
-    //-- data is written in the following order to the FIX and VAR streams
-    //   FIX = [VAR streampos] [BankableFlags] [OBJECT FIX] [VAR size]
-    //   VAR = [OBJECT VAR]
     bankstreamoff fpos = (std::streamoff)partition->fix.tellp();
     bankstreamoff vpos = (std::streamoff)partition->var.tellp();
-    writeLE (partition->fix, &vpos);
-    writeLE (partition->fix, &(obj.flags_m));
-    obj.writeRecord (partition->fix, partition->var);
-    Size_t vsize = (std::streamoff)partition->var.tellp() - vpos;
-    writeLE (partition->fix, &vsize);
+    bool written = appendRecord (partition, obj, fpos, vpos);
 
     //-- If fix_size is not yet known, calculate it
     Size_t fsize = (std::streamoff)partition->fix.tellp() - fpos;
     if ( fix_size_m == 0 )
       fix_size_m = fsize;
 
-    if ( fix_size_m != fsize  ||
+    if ( ! written  ||
+	 fix_size_m != fsize  ||
 	 partition->fix.fail()  ||
 	 partition->var.fail() )
       AMOS_THROW_IO
@@ -377,3 +758,80 @@ void BankStream_t::replaceByBID(ID_t bid, IBankable_t & obj)
   }
 }
 
+
+//----------------------------------------------------- setStreamIDs -----------
+void BankStream_t::setStreamIDs (IBankable_t & obj,
+                                 BankFlags_t flags, bankstreamoff vpos)
+{
+  const IDMap_t::HashTriple_t * trip = triples_m [curr_bid_m - 1];
+  if ( trip == NULL )
+    {
+      obj.iid_m = NULL_ID;
+      obj.eid_m.erase();
+    }
+  else
+    {
+      obj.iid_m = trip->iid;
+      if ( fields_m & P_EID )
+        obj.eid_m.assign (trip->eid);
+      else
+        obj.eid_m.erase();
+    }
+
+  obj.flags_m = flags;
+  last_vpos_m = vpos;
+}
+
+
+//----------------------------------------------------- startReadAhead ---------
+void BankStream_t::startReadAhead ( )
+{
+  stopReadAhead( );
+
+  ReadAhead_t * ra = new ReadAhead_t;
+  for ( Size_t i = 0; i < npartitions_m; ++ i )
+    {
+      ra -> fix_names . push_back ((*partitions_m [i]) [version_m] -> fix_name);
+      ra -> var_names . push_back ((*partitions_m [i]) [version_m] -> var_name);
+    }
+  ra -> partition_size = partition_size_m;
+  ra -> fix_size = fix_size_m;
+  ra -> last_bid = last_bid_m [version_m];
+  ra -> withvar = ( fields_m == P_ALL  &&  ! fixed_store_only_m );
+  ra -> max_records = ra_records_m;
+  ra -> max_bytes = ra_bytes_m;
+  ra -> chunk_records = ra_records_m / 4 > 0 ? ra_records_m / 4 : 1;
+  ra -> next_bid = curr_bid_m;
+
+  if ( pthread_create (&(ra -> thread), NULL, ReadAhead_t::threadMain, ra) != 0 )
+    {
+      delete ra;
+      AMOS_THROW_IO ("Could not start the read-ahead thread");
+    }
+
+  readahead_m = ra;
+  readahead_m -> current = readahead_m -> take( );
+  if ( readahead_m -> current == NULL  &&  ! readahead_m -> error . empty( ) )
+    {
+      string err (readahead_m -> error);
+      stopReadAhead( );
+      AMOS_THROW_IO (err);
+    }
+}
+
+
+//----------------------------------------------------- stopReadAhead ----------
+void BankStream_t::stopReadAhead ( )
+{
+  if ( readahead_m == NULL )
+    return;
+
+  pthread_mutex_lock (&(readahead_m -> lock));
+  readahead_m -> stopping = true;
+  pthread_cond_signal (&(readahead_m -> space));
+  pthread_mutex_unlock (&(readahead_m -> lock));
+
+  pthread_join (readahead_m -> thread, NULL);
+  delete readahead_m;
+  readahead_m = NULL;
+}
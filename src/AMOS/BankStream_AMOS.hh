@@ -43,13 +43,19 @@ protected:
   //!< Allowable simultaneously open partitions (one for >>, one for <<)
 
 
+  struct ReadAhead_t;
+
+
   //--------------------------------------------------- init -------------------
   //! \brief Initializes the stream variables
   //!
   void init()
   {
+    stopReadAhead();
     oldPartition_m = NULL;
     fixed_store_only_m = false;
+    fields_m = P_ALL;
+    last_vpos_m = -1;
     eof_m = false;
     curr_bid_m = 1;
     ate_m = false;
@@ -62,9 +68,35 @@ protected:
   {
     return ( curr_bid_m > 0  &&  curr_bid_m <= last_bid_m [version_m] );
   }
+
+
+  //--------------------------------------------------- getBuffered ------------
+  //! \brief operator>> from the records loaded by the read-ahead thread
+  //!
+  void getBuffered (IBankable_t & obj);
+
+
+  //--------------------------------------------------- setStreamIDs -----------
+  //! \brief Sets the IDs and flags of a streamed object
+  //!
+  void setStreamIDs (IBankable_t & obj, BankFlags_t flags, bankstreamoff vpos);
+
+
+  //--------------------------------------------------- startReadAhead ---------
+  //! \brief Starts the read-ahead thread at the current get pointer
+  //!
+  void startReadAhead ( );
+
+
+  //--------------------------------------------------- stopReadAhead ----------
+  //! \brief Stops the read-ahead thread and drops its records
+  //!
+  void stopReadAhead ( );
   
 
   bool fixed_store_only_m;            //!< Just fetch from fixed store
+  BankFields_t fields_m;              //!< fixed store projection, or P_ALL
+  bankstreamoff last_vpos_m;          //!< var store offset of the last get
   bool eof_m;                         //!< eof error flag
   ID_t curr_bid_m;                    //!< BID to be returned on next get
   bool ate_m;                         //!< put pointers at end of bank
@@ -72,6 +104,10 @@ protected:
 
   BankPartition_t * oldPartition_m;
 
+  Size_t ra_records_m;                //!< read-ahead record limit, 0 if off
+  Size_t ra_bytes_m;                  //!< read-ahead byte limit, 0 if none
+  ReadAhead_t * readahead_m;          //!< running read-ahead, or NULL
+
 public:
 
   enum bankseekdir
@@ -99,7 +135,8 @@ public:
   //! \param type The type of Bank to construct
   //!
   BankStream_t (NCode_t type )
-    : Bank_t (type)
+    : Bank_t (type),
+      ra_records_m (0), ra_bytes_m (0), readahead_m (NULL)
   {
     init();
     triples_m [NULL_ID] = NULL;
@@ -110,7 +147,8 @@ public:
 
   //--------------------------------------------------- BankStream_t -----------
   BankStream_t (const std::string & type)
-    : Bank_t (type)
+    : Bank_t (type),
+      ra_records_m (0), ra_bytes_m (0), readahead_m (NULL)
   {
     init();
     triples_m [NULL_ID] = NULL;
@@ -124,6 +162,7 @@ public:
   {
     if ( is_open_m )
       close();
+    stopReadAhead();
   }
 
 
@@ -336,6 +375,46 @@ public:
   }
 
 
+  //--------------------------------------------------- setReadAhead -----------
+  //! \brief Loads records ahead of operator>> in a background thread
+  //!
+  //! While the bank is open read only, a background thread reads the records
+  //! following the get pointer from the fixed and variable stores into
+  //! memory, and operator>> decodes them from there. Scans that spend most of
+  //! their time computing on each object then overlap the disk reads with
+  //! that work. The thread hints the kernel to read the stores sequentially
+  //! and ahead of time. Seeking simply restarts the thread at the new
+  //! position. Has no effect on banks open for writing or with B_VERIFY.
+  //!
+  //! \param records Most records loaded ahead, 0 turns read-ahead off
+  //! \param bytes Most bytes loaded ahead, 0 for no limit
+  //!
+  void setReadAhead (Size_t records, Size_t bytes = 0)
+  {
+    stopReadAhead();
+    ra_records_m = records;
+    ra_bytes_m = bytes;
+  }
+
+
+  //--------------------------------------------------- setProjection ----------
+  //! \brief Restricts operator>> to a subset of the fixed store fields
+  //!
+  //! Scans that only need a few fixed length members, e.g. read lengths or
+  //! fragment links, can declare them here so operator>> decodes just those
+  //! fields from the fixed store and never touches the variable store. The
+  //! IID and bank flags are always set, the EID only if P_EID is requested,
+  //! and all other members are left empty. Overrides setFixedStoreOnly until
+  //! reset with setProjection(P_ALL).
+  //!
+  //! \param fields Bitwise OR of the P_ field flags, or P_ALL for full records
+  //!
+  void setProjection(BankFields_t fields)
+  {
+    fields_m = fields;
+  }
+
+
   //--------------------------------------------------- seekg ------------------
   //! \brief Seeks to a different position in the BankStream
   //!
@@ -415,6 +494,22 @@ public:
   }
 
 
+  //--------------------------------------------------- tellv ------------------
+  //! \brief Return the variable store offset of the last object fetched
+  //!
+  //! Every replace appends a new variable record, so the offset of an object
+  //! changes whenever it is replaced and can be remembered to detect edits
+  //! without fetching the variable data. Offsets are only comparable between
+  //! objects of the same BID.
+  //!
+  //! \return The offset of the last streamed object, or -1 if none
+  //!
+  bankstreamoff tellv() const
+  {
+    return last_vpos_m;
+  }
+
+
   //--------------------------------------------------- tellp ------------------
   //! \brief Return the current position of the put pointer
   //!
@@ -465,7 +560,8 @@ public:
   //! When called after setFixedStoreOnly(true), then only read the fixed
   //! store information. For example, reads store clear ranges, lengths, and
   //! other meta data in the fixed store, and sequences and quality values
-  //! in the variable store.
+  //! in the variable store. When called after setProjection, only the
+  //! requested fixed store fields are read.
   //!
   //! \pre The bank is open for reading
   //! \pre obj is compatible with the banktype
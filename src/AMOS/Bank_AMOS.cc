@@ -12,7 +12,9 @@
 #include <sstream>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
+#include <dirent.h>
 #include <unistd.h>
 #include <cstdlib>
 #include <cstdio>
@@ -35,6 +37,8 @@ using namespace std;
 #define DIR_MODE  00755
 #define FILE_MODE 00644
 
+#define MAX_REPORT_LINES 10
+
 
 
 
@@ -51,6 +55,9 @@ const string Bank_t::LCK_STORE_SUFFIX = ".lck";
 const string Bank_t::VAR_STORE_SUFFIX = ".var";
 const string Bank_t::MAP_STORE_SUFFIX = ".map";
 const string Bank_t::TMP_STORE_SUFFIX = ".tmp";
+const string Bank_t::SUM_STORE_SUFFIX = ".crc";
+
+const Size_t Bank_t::CHECKSUM_BLOCK_SIZE = 65536;
 
 const char Bank_t::WRITE_LOCK_CHAR    = 'w';
 const char Bank_t::READ_LOCK_CHAR     = 'r';
@@ -143,6 +150,8 @@ void Bank_t::copyPartition(ID_t &id) {
    output.open(partition->var_name.c_str(), (mode | ios::out));
    copyFile(prevVersion->var, output);
    output.close(); 
+
+   partition->touch (0, 0);
 }
 
 //----------------------------------------------------- addPartition -----------
@@ -170,6 +179,11 @@ void Bank_t::addPartition (bool create)
     //-- Try to create/open the FIX and VAR partition files
     touchFile (partition->fix_name, FILE_MODE, create);
     touchFile (partition->var_name, FILE_MODE, create);
+    if ( create )
+      {
+        partition->touch (0, 0);
+        partition->startLiveSums (CHECKSUM_BLOCK_SIZE);
+      }
   }
   catch (Exception_t) {
     partitions_m.pop_back();
@@ -222,25 +236,19 @@ void Bank_t::appendBID (IBankable_t & obj)
   obj.flags_m.is_removed  = false;
   obj.flags_m.is_modified = false;
 
-  //-- data is written in the following order to the FIX and VAR streams
-  //   FIX = [VAR streampos] [BankableFlags] [OBJECT FIX] [VAR size]
-  //   VAR = [OBJECT VAR]
   partition->fix.seekp (0, ios::end);
   partition->var.seekp (0, ios::end);
   bankstreamoff fpos = partition->fix.tellp();
   bankstreamoff vpos = partition->var.tellp();
-  writeLE (partition->fix, &vpos);
-  writeLE (partition->fix, &(obj.flags_m));
-  obj.writeRecord (partition->fix, partition->var);
-  Size_t vsize = (std::streamoff)partition->var.tellp() - vpos;
-  writeLE (partition->fix, &vsize);
+  bool written = appendRecord (partition, obj, fpos, vpos);
 
   //-- If fix_size is not yet known, calculate it
   Size_t fsize = (std::streamoff)partition->fix.tellp() - fpos;
   if ( fix_size_m == 0 )
     fix_size_m = fsize;
 
-  if ( fix_size_m != fsize  ||
+  if ( ! written  ||
+       fix_size_m != fsize  ||
        partition->fix.fail()  ||
        partition->var.fail() )
     AMOS_THROW_IO ("Unknown file write error in append, bank corrupted");
@@ -250,6 +258,53 @@ void Bank_t::appendBID (IBankable_t & obj)
 }
 
 
+//----------------------------------------------------- appendRecord -----------
+bool Bank_t::appendRecord (BankPartition_t * partition, IBankable_t & obj,
+                           int64_t fpos, int64_t vpos)
+{
+  //-- Untouched since open, continue the checksums if they are current
+  if ( ! partition->live_sums  &&
+       partition->fix_dirty < 0  &&  partition->var_dirty < 0 )
+    {
+      StoreSums_t fix, var;
+      if ( readSums (getSumsPath (partition), fix, var)  &&
+           fix.block == CHECKSUM_BLOCK_SIZE  &&
+           fix.length == (uint64_t) fpos  &&
+           var.length == (uint64_t) vpos )
+        {
+          partition->fix_live = fix;
+          partition->var_live = var;
+          partition->live_sums = true;
+        }
+    }
+
+  partition->touch (fpos, vpos, partition->live_sums);
+
+  SumsBuffer_t fixsums (partition->fix.rdbuf(), partition->fix_live);
+  SumsBuffer_t varsums (partition->var.rdbuf(), partition->var_live);
+  streambuf * fixbuf = partition->fix.rdbuf();
+  streambuf * varbuf = partition->var.rdbuf();
+  ostream fix (partition->live_sums ? &fixsums : fixbuf);
+  ostream var (partition->live_sums ? &varsums : varbuf);
+
+  //-- data is written in the following order to the FIX and VAR streams
+  //   FIX = [VAR streampos] [BankableFlags] [OBJECT FIX] [VAR size]
+  //   VAR = [OBJECT VAR]
+  bankstreamoff vstart = vpos;
+  writeLE (fix, &vstart);
+  writeLE (fix, &(obj.flags_m));
+  obj.writeRecord (fix, var);
+  if ( partition->live_sums )
+    var.flush();
+  Size_t vsize = (std::streamoff)partition->var.tellp() - vpos;
+  writeLE (fix, &vsize);
+  if ( partition->live_sums )
+    fix.flush();
+
+  return ! fix.fail()  &&  ! var.fail();
+}
+
+
 //----------------------------------------------------- assignEID --------------
 void Bank_t::assignEID (ID_t iid, const string & eid)
 {
@@ -284,6 +339,35 @@ void Bank_t::assignIID (const string & eid, ID_t iid)
 }
 
 
+//----------------------------------------------------- checkBlocks ------------
+void Bank_t::checkBlocks (int fd, StoreSums_t & sums, int64_t off, int64_t len,
+                          const string & path)
+{
+  if ( len <= 0 )
+    return;
+
+  vector<char> buffer;
+  uint64_t last = (off + len - 1) / sums.block;
+
+  //-- Blocks past the end of the sums were never checksummed
+  for ( uint64_t b = off / sums.block; b <= last  &&  b < sums.sums.size(); ++ b )
+    {
+      if ( sums.checked [b] )
+        continue;
+
+      uint64_t beg = b * sums.block;
+      size_t size = min ((uint64_t) sums.block, sums.length - beg);
+      buffer.resize (size);
+      if ( ! readFully (fd, &buffer[0], size, beg) )
+        AMOS_THROW_IO ("Unknown file read error in fetch, bank corrupted");
+      if ( CRC32C (0, &buffer[0], size) != sums.sums [b] )
+        AMOS_THROW_IO ("Checksum mismatch in " + path + ", bank corrupted");
+
+      sums.checked [b] = true;
+    }
+}
+
+
 //----------------------------------------------------- clean ------------------
 void Bank_t::clean()
 {
@@ -328,6 +412,7 @@ void Bank_t::clean()
 	        link ((*tmpbnk.partitions_m [i]) [version]->var_name.c_str(),
 		            (* partitions_m [i]) [version]->var_name.c_str()) )
 	     AMOS_THROW_IO ("Unknown file link error in clean, bank corrupted");
+	   (*partitions_m [i]) [version]->touch (0, 0);
         }
      }
   }
@@ -382,6 +467,7 @@ void Bank_t::clearVersion (Size_t &version, bool recreate)
       (*partitions_m [i]) [version]->var.close();
       unlink ((*partitions_m [i]) [version]->fix_name.c_str());
       unlink ((*partitions_m [i]) [version]->var_name.c_str());
+      unlink (getSumsPath ((*partitions_m [i]) [version]).c_str());
       delete ((*partitions_m [i]) [version]);
 
       if (recreate) {
@@ -400,6 +486,7 @@ void Bank_t::clearVersion (Size_t &version, bool recreate)
              //-- Try to create/open the FIX and VAR partition files
              touchFile ((*partitions_m [i]) [version]->fix_name, FILE_MODE, true);
              touchFile ((*partitions_m [i]) [version]->var_name, FILE_MODE, true);
+             (*partitions_m [i]) [version]->touch (0, 0);
           }
           catch (Exception_t) {
              delete (*partitions_m [i] ) [version];
@@ -428,6 +515,11 @@ void Bank_t::close()
       if ( map_stream.fail() )
 	AMOS_THROW_IO ("Unknown file write error in close, bank corrupted");
       map_stream.close();
+
+      //-- Checksum the blocks written since open
+      for ( Size_t i = 0; i != npartitions_m; i ++ )
+        for ( Size_t version = 0; version != nversions_m; version ++ )
+          syncChecksums ((*partitions_m [i]) [version]);
     }
   
   //-- Close/free the partitions
@@ -477,6 +569,7 @@ void Bank_t::concat (Bank_t & s)
   //-- Seek to the end of current bank
   tp->fix.seekp (0, ios::end);
   tp->var.seekp (0, ios::end);
+  tp->touch ((std::streamoff)tp->fix.tellp(), (std::streamoff)tp->var.tellp());
 
   //-- For each source partition
   ID_t sbid = 0;
@@ -662,6 +755,96 @@ bool Bank_t::exists (const string & dir, Size_t version ) const
    return ( ! access (map_path.str().c_str(), R_OK) );
 }
 
+//----------------------------------------------------- StatTime ---------------
+#ifdef __APPLE__
+# define st_mtim st_mtimespec
+# define st_ctim st_ctimespec
+#endif
+
+static inline uint64_t StatTime (const struct timespec & ts)
+{
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+
+//----------------------------------------------------- MixStamp ---------------
+static const uint64_t FNV_BASIS = 0xcbf29ce484222325ULL;
+static const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+static inline uint64_t MixStamp (uint64_t h, uint64_t v)
+{
+  //-- 64-bit FNV-1a over the bytes of v
+  for ( int i = 0; i < 8; ++ i, v >>= 8 )
+    h = (h ^ (v & 0xff)) * FNV_PRIME;
+  return h;
+}
+
+
+//----------------------------------------------------- getStoreStamp ----------
+void Bank_t::getStoreStamp (const string & dir, NCode_t type,
+                            int64_t stamp [2])
+{
+  string prefix = Decode (type) + '.';
+  struct dirent * de;
+  struct stat st;
+
+  stamp[0] = stamp[1] = 0;
+
+  DIR * dp = opendir (dir.c_str());
+  if ( dp == NULL )
+    return;
+
+  while ( (de = readdir (dp)) != NULL )
+    {
+      string name (de->d_name);
+      if ( name.compare (0, prefix.size(), prefix) != 0 )
+        continue;
+
+      size_t dot = name.rfind ('.');
+      string suffix = name.substr (dot);
+      if ( suffix != FIX_STORE_SUFFIX  &&
+           suffix != VAR_STORE_SUFFIX  &&
+           suffix != MAP_STORE_SUFFIX )
+        continue;
+
+      if ( stat ((dir + '/' + name).c_str(), &st) == 0 )
+        {
+          //-- Summed, so the directory order does not matter
+          stamp[0] += st.st_size;
+          uint64_t h = FNV_BASIS;
+          for ( string::size_type i = 0; i < name.size(); ++ i )
+            h = (h ^ (unsigned char) name[i]) * FNV_PRIME;
+          h = MixStamp (h, (uint64_t) st.st_size);
+          h = MixStamp (h, (uint64_t) st.st_ino);
+          h = MixStamp (h, StatTime (st.st_mtim));
+          h = MixStamp (h, StatTime (st.st_ctim));
+          stamp[1] += h;
+        }
+    }
+
+  closedir (dp);
+}
+
+
+//----------------------------------------------------- makeTempStore ----------
+string Bank_t::makeTempStore (const string & path)
+{
+  string tmpl = path + TMP_STORE_SUFFIX + ".XXXXXX";
+  vector<char> name (tmpl.begin(), tmpl.end());
+  name.push_back ('\0');
+
+  int fd = mkstemp (&name[0]);
+  if ( fd == -1 )
+    AMOS_THROW_IO ("Could not create temporary store, " + tmpl +
+                   ", " + strerror (errno));
+
+  //-- mkstemp makes it private, the stores it replaces are not
+  fchmod (fd, 0644);
+  ::close (fd);
+  return string (&name[0]);
+}
+
+
 //----------------------------------------------------- fetchBID ---------------
 void Bank_t::fetchBID (ID_t bid, IBankable_t & obj)
 {
@@ -670,9 +853,18 @@ void Bank_t::fetchBID (ID_t bid, IBankable_t & obj)
   if (banktype_m != obj.getNCode())
     AMOS_THROW_ARGUMENT ("Cannot fetch, incompatible object type");
 
+  if ( (mode_m & B_MAP) )
+    {
+      fetchBIDMapped (bid, obj, false);
+      return;
+    }
+
   //-- Seek to the record and read the data
   BankPartition_t * partition = localizeBID (bid);
 
+  if ( (mode_m & B_VERIFY) )
+    verifyRecord (partition, bid, true);
+
   bankstreamoff vpos;
   bankstreamoff off = bid * fix_size_m;
   partition->fix.seekg (off);
@@ -694,9 +886,18 @@ void Bank_t::fetchBIDFix(ID_t bid, IBankable_t & obj)
   if (banktype_m != obj.getNCode())
     AMOS_THROW_ARGUMENT ("Cannot fetch, incompatible object type");
 
+  if ( (mode_m & B_MAP) )
+    {
+      fetchBIDMapped (bid, obj, true);
+      return;
+    }
+
   //-- Seek to the record and read the data
   BankPartition_t * partition = localizeBID (bid);
 
+  if ( (mode_m & B_VERIFY) )
+    verifyRecord (partition, bid, false);
+
   bankstreamoff vpos;
   bankstreamoff off = bid * fix_size_m;
   partition->fix.seekg (off);
@@ -710,6 +911,51 @@ void Bank_t::fetchBIDFix(ID_t bid, IBankable_t & obj)
 }
 
 
+//----------------------------------------------------- fetchBIDMapped ---------
+void Bank_t::fetchBIDMapped (ID_t bid, IBankable_t & obj, bool fixonly) const
+{
+  if ( bid == NULL_ID  ||  bid > last_bid_m [version_m] )
+    AMOS_THROW_ARGUMENT ("Cannot fetch, BID out of range");
+
+  ID_t pid = (-- bid) / partition_size_m;
+  if ( pid >= partitions_m.size() )
+    AMOS_THROW_IO ("Unknown file read error in fetch, bank corrupted");
+  bid -= pid * partition_size_m;
+  const BankPartition_t * partition = (*partitions_m [pid]) [version_m];
+
+  size_t off = (size_t) bid * fix_size_m;
+  if ( partition->fix_map == NULL  ||  off + fix_size_m > partition->fix_map_size )
+    AMOS_THROW_IO ("Unknown file read error in fetch, bank corrupted");
+
+  MappedBuffer_t fixbuf (partition->fix_map + off,
+                         partition->fix_map + off + fix_size_m);
+  istream fix (&fixbuf);
+
+  bankstreamoff vpos;
+  readLE (fix, &vpos);
+  readLE (fix, &(obj.flags_m));
+
+  if ( fixonly )
+    {
+      obj.readRecordFix (fix);
+      if ( fix.fail() )
+        AMOS_THROW_IO ("Unknown file read error in fetch, bank corrupted");
+      return;
+    }
+
+  if ( vpos < 0  ||  (size_t) vpos > partition->var_map_size )
+    AMOS_THROW_IO ("Unknown file read error in fetch, bank corrupted");
+
+  MappedBuffer_t varbuf (partition->var_map + vpos,
+                         partition->var_map + partition->var_map_size);
+  istream var (&varbuf);
+  obj.readRecord (fix, var);
+
+  if ( fix.fail()  ||  var.fail() )
+    AMOS_THROW_IO ("Unknown file read error in fetch, bank corrupted");
+}
+
+
 //----------------------------------------------------- getMaxIID --------------
 ID_t Bank_t::getMaxIID() const
 {
@@ -735,6 +981,15 @@ ID_t Bank_t::getMaxBID() const
 }
 
 
+//----------------------------------------------------- getSumsPath ------------
+string Bank_t::getSumsPath (const BankPartition_t * partition) const
+{
+  const string & name = partition->fix_name;
+  return name.substr (0, name.size() - FIX_STORE_SUFFIX.size())
+    + SUM_STORE_SUFFIX;
+}
+
+
 //----------------------------------------------------- lookupBID --------------
 ID_t Bank_t::lookupBID (const string & eid) const
 {
@@ -853,6 +1108,24 @@ void Bank_t::open (const string & dir, BankMode_t mode, Size_t version, bool inP
 	 last_bid_m [version_m] > max_bid_m  ||
 	 partitions_m.size() != npartitions_m )
       AMOS_THROW_IO ("Unknown file read error in open, bank corrupted");
+
+    //-- Map the stores up front, so fetches never change the bank
+    if ( (mode_m & B_MAP) )
+      for ( Size_t i = 0; i != npartitions_m; i ++ )
+        (*partitions_m [i]) [version_m] -> map( );
+
+    //-- Mapped fetches bypass verifyRecord, so check everything now
+    if ( (mode_m & B_MAP)  &&  (mode_m & B_VERIFY) )
+      for ( Size_t i = 0; i != npartitions_m; i ++ )
+        {
+          string report;
+          bool checksummed;
+          if ( verifyPartition (i, report, checksummed) != 0 )
+            {
+              close( );          // drop the read lock taken above
+              AMOS_THROW_IO ("Checksum error in open, bank corrupted\n" + report);
+            }
+        }
   }
   catch (Exception_t) {
     init();
@@ -902,6 +1175,78 @@ Bank_t::BankPartition_t * Bank_t::openPartition (ID_t id, Size_t version)
 }
 
 
+//----------------------------------------------------- readFully --------------
+bool Bank_t::readFully (int fd, char * buf, size_t size, int64_t off)
+{
+  while ( size > 0 )
+    {
+      ssize_t n = pread (fd, buf, size, off);
+      if ( n < 0  &&  errno == EINTR )
+        continue;
+      if ( n <= 0 )
+        return false;
+      buf += n;
+      size -= n;
+      off += n;
+    }
+  return true;
+}
+
+
+//----------------------------------------------------- readSums ---------------
+bool Bank_t::readSums (const string & path, StoreSums_t & fix, StoreSums_t & var)
+{
+  ifstream in (path.c_str(), ios::binary);
+  if ( ! in.is_open() )
+    return false;
+
+  //-- [block] then [length] [count] [sums] for the fix and the var store
+  uint32_t block, count;
+  readLE (in, &block);
+
+  StoreSums_t * stores [2] = { &fix, &var };
+  for ( int i = 0; i != 2; ++ i )
+    {
+      StoreSums_t & sums = *stores [i];
+      sums.block = block;
+      readLE (in, &sums.length);
+      readLE (in, &count);
+      if ( in.fail()  ||  block == 0  ||
+           count != (sums.length + block - 1) / block )
+        return false;
+
+      sums.sums.resize (count);
+      for ( uint32_t j = 0; j != count; ++ j )
+        readLE (in, &(sums.sums [j]));
+      sums.checked.assign (count, false);
+    }
+
+  return ! in.fail();
+}
+
+
+//----------------------------------------------------- recordChecksums --------
+Size_t Bank_t::recordChecksums ( )
+{
+  if ( ! is_open_m  ||  ! (mode_m & B_WRITE) )
+    AMOS_THROW_IO ("Cannot record checksums, bank not open for writing");
+
+  Size_t n = 0;
+  for ( Size_t i = 0; i != npartitions_m; i ++ )
+    {
+      BankPartition_t * partition = (*partitions_m [i]) [version_m];
+      if ( ! access (getSumsPath (partition).c_str(), R_OK) )
+        continue;
+
+      partition->touch (0, 0);
+      syncChecksums (partition);
+      ++ n;
+    }
+
+  return n;
+}
+
+
 //----------------------------------------------------- removeBID --------------
 void Bank_t::removeBID (ID_t bid)
 {
@@ -917,6 +1262,7 @@ void Bank_t::removeBID (ID_t bid)
   readLE (partition->fix, &flags);
   flags.is_removed = true;
   partition->fix.seekp (off);
+  partition->touch (off, -1);
   writeLE (partition->fix, &flags);
 
   if ( partition->fix.fail()  ||  partition->var.fail() )
@@ -997,6 +1343,7 @@ void Bank_t::replaceBID (ID_t bid, IBankable_t & obj)
   partition->fix.seekp (off);
   partition->var.seekp (0, ios::end);
   bankstreamoff vpos = partition->var.tellp();
+  partition->touch (off, vpos);
   writeLE (partition->fix, &vpos);
   writeLE (partition->fix, &(obj.flags_m));
   obj.writeRecord (partition->fix, partition->var);
@@ -1008,6 +1355,52 @@ void Bank_t::replaceBID (ID_t bid, IBankable_t & obj)
 }
 
 
+//----------------------------------------------------- syncChecksums ----------
+void Bank_t::syncChecksums (BankPartition_t * partition)
+{
+  if ( partition->fix_dirty < 0  &&  partition->var_dirty < 0 )
+    return;
+
+  //-- Get the written records to disk before reading them back
+  if ( partition->fix.is_open() )
+    partition->fix.flush();
+  if ( partition->var.is_open() )
+    partition->var.flush();
+  if ( partition->fix.fail()  ||  partition->var.fail() )
+    AMOS_THROW_IO ("Unknown file write error in close, bank corrupted");
+
+  string path = getSumsPath (partition);
+
+  //-- Only appended to, the running checksums already cover the stores
+  if ( partition->live_sums )
+    {
+      writeSums (path, partition->fix_live, partition->var_live);
+      partition->fix_dirty = partition->var_dirty = -1;
+      partition->sums_loaded = false;
+      return;
+    }
+
+  StoreSums_t fix, var;
+  int64_t fixfrom = partition->fix_dirty;
+  int64_t varfrom = partition->var_dirty;
+
+  //-- No usable checksums yet, so cover the stores from the start
+  if ( ! readSums (path, fix, var)  ||  fix.block != CHECKSUM_BLOCK_SIZE )
+    {
+      fix = var = StoreSums_t();
+      fix.block = var.block = CHECKSUM_BLOCK_SIZE;
+      fixfrom = varfrom = 0;
+    }
+
+  updateSums (partition->fix_name, fix, fixfrom);
+  updateSums (partition->var_name, var, varfrom);
+  writeSums (path, fix, var);
+
+  partition->fix_dirty = partition->var_dirty = -1;
+  partition->sums_loaded = false;
+}
+
+
 //----------------------------------------------------- syncIFO ----------------
 void Bank_t::syncIFO (IFOMode_t mode)
 {
@@ -1284,6 +1677,276 @@ void Bank_t::unlockIFO()
 }
 
 
+//----------------------------------------------------- updateSums -------------
+void Bank_t::updateSums (const string & path, StoreSums_t & sums, int64_t from)
+{
+  struct stat st;
+
+  int fd = ::open (path.c_str(), O_RDONLY);
+  if ( fd == -1 )
+    AMOS_THROW_IO ("Could not open bank partition, " + path);
+  if ( fstat (fd, &st) == -1 )
+    {
+      ::close (fd);
+      AMOS_THROW_IO ("Could not open bank partition, " + path);
+    }
+
+  //-- Keep the sums of the blocks before the first byte written
+  uint64_t size = st.st_size;
+  if ( from < 0  ||  (uint64_t) from > sums.length )
+    from = sums.length;
+  if ( (uint64_t) from > size )
+    from = size;
+
+  uint64_t beg = from / sums.block * sums.block;
+  sums.sums.resize (from / sums.block);
+
+  vector<char> buffer (sums.block);
+  for ( ; beg < size; beg += sums.block )
+    {
+      size_t n = min ((uint64_t) sums.block, size - beg);
+      if ( ! readFully (fd, &buffer[0], n, beg) )
+        {
+          ::close (fd);
+          AMOS_THROW_IO ("Unknown file read error in close, bank corrupted");
+        }
+      sums.sums.push_back (CRC32C (0, &buffer[0], n));
+    }
+  ::close (fd);
+
+  sums.length = size;
+  sums.checked.assign (sums.sums.size(), false);
+}
+
+
+//----------------------------------------------------- verifyPartition --------
+static void NoteProblem (string & report, Size_t & count,
+                         const string & path, const string & problem)
+{
+  if ( count ++ < MAX_REPORT_LINES )
+    report += path + ": " + problem + '\n';
+}
+
+
+Size_t Bank_t::verifyPartition (Size_t pid, string & report,
+                                bool & checksummed) const
+{
+  if ( ! is_open_m  ||  ! (mode_m & B_READ) )
+    AMOS_THROW_IO ("Cannot verify, bank not open for reading");
+  if ( pid < 0  ||  pid >= npartitions_m )
+    AMOS_THROW_ARGUMENT ("Cannot verify, partition does not exist");
+
+  const BankPartition_t * partition = (*partitions_m [pid]) [version_m];
+  const string * paths [2] = { &partition->fix_name, &partition->var_name };
+
+  StoreSums_t sums [2];
+  string sums_path = getSumsPath (partition);
+  checksummed = readSums (sums_path, sums [0], sums [1]);
+
+  int fds [2] = { -1, -1 };
+  uint64_t sizes [2];
+  Size_t problems = 0;
+
+  //-- A checksum store that is there but will not parse has been damaged
+  if ( ! checksummed  &&  ! access (sums_path.c_str(), F_OK) )
+    {
+      report += sums_path + ": checksum store cannot be read\n";
+      problems ++;
+    }
+
+  try {
+    for ( int i = 0; i != 2; ++ i )
+      {
+        struct stat st;
+        fds [i] = ::open (paths [i]->c_str(), O_RDONLY);
+        if ( fds [i] == -1  ||  fstat (fds [i], &st) == -1 )
+          AMOS_THROW_IO ("Could not open bank partition, " + *paths [i]);
+        sizes [i] = st.st_size;
+      }
+
+    //-- The fix store is also walked record by record
+    Size_t tail = fix_size_m
+      - sizeof (bankstreamoff) - sizeof (BankFlags_t) - sizeof (Size_t);
+    ID_t bid = pid * partition_size_m;
+    string carry;
+
+    for ( int i = 0; i != 2; ++ i )
+      {
+        Size_t count = 0;
+        uint64_t block = checksummed ? sums [i].block : CHECKSUM_BLOCK_SIZE;
+        vector<char> buffer (block);
+
+        if ( checksummed  &&  sums [i].length != sizes [i] )
+          {
+            ostringstream ss;
+            ss << "store is " << sizes [i] << " bytes but checksums cover "
+               << sums [i].length;
+            NoteProblem (report, count, *paths [i], ss.str());
+          }
+
+        for ( uint64_t b = 0, beg = 0; beg < sizes [i]; ++ b, beg += block )
+          {
+            size_t n = min (block, sizes [i] - beg);
+            if ( ! readFully (fds [i], &buffer[0], n, beg) )
+              AMOS_THROW_IO ("Unknown file read error in verify, " + *paths [i]);
+
+            if ( checksummed  &&  b < sums [i].sums.size()  &&
+                 CRC32C (0, &buffer[0], min ((uint64_t) n, sums [i].length - beg))
+                 != sums [i].sums [b] )
+              {
+                ostringstream ss;
+                ss << "checksum mismatch in bytes " << beg << '-' << beg + n;
+                NoteProblem (report, count, *paths [i], ss.str());
+              }
+
+            if ( i != 0  ||  fix_size_m == 0 )
+              continue;
+
+            //-- Every live record must point inside the var store
+            carry.append (&buffer[0], n);
+            size_t whole = carry.size() - carry.size() % fix_size_m;
+            MappedBuffer_t recbuf (carry.data(), carry.data() + whole);
+            istream records (&recbuf);
+
+            bankstreamoff vpos;
+            BankFlags_t flags;
+            Size_t vsize;
+            for ( size_t off = 0; off != whole; off += fix_size_m )
+              {
+                ++ bid;
+                readLE (records, &vpos);
+                readLE (records, &flags);
+                records.ignore (tail);
+                readLE (records, &vsize);
+                if ( ! flags.is_removed  &&
+                     (vpos < 0  ||  vsize < 0  ||
+                      (uint64_t) vpos + vsize > sizes [1]) )
+                  {
+                    ostringstream ss;
+                    ss << "record " << bid << " points outside the var store";
+                    NoteProblem (report, count, *paths [i], ss.str());
+                  }
+              }
+            carry.erase (0, whole);
+          }
+
+        if ( i == 0  &&  ! carry.empty() )
+          {
+            ostringstream ss;
+            ss << "partial record of " << carry.size() << " bytes at the end";
+            NoteProblem (report, count, *paths [i], ss.str());
+          }
+
+        if ( count > MAX_REPORT_LINES )
+          {
+            ostringstream ss;
+            ss << "... and " << count - MAX_REPORT_LINES << " more";
+            report += *paths [i] + ": " + ss.str() + '\n';
+          }
+        problems += count;
+      }
+  }
+  catch (Exception_t) {
+    for ( int i = 0; i != 2; ++ i )
+      if ( fds [i] != -1 )
+        ::close (fds [i]);
+    throw;
+  }
+
+  ::close (fds [0]);
+  ::close (fds [1]);
+
+  return problems;
+}
+
+
+//----------------------------------------------------- verifyRecord -----------
+void Bank_t::verifyRecord (BankPartition_t * partition, ID_t lid, bool withvar)
+{
+  if ( ! partition->sums_loaded )
+    {
+      string sums_path = getSumsPath (partition);
+      partition->has_sums = readSums (sums_path,
+                                      partition->fix_sums, partition->var_sums);
+      if ( ! partition->has_sums  &&  ! access (sums_path.c_str(), F_OK) )
+        AMOS_THROW_IO ("Checksum store cannot be read, bank corrupted, "
+                       + sums_path);
+      partition->sums_loaded = true;
+    }
+  if ( ! partition->has_sums )
+    return;
+
+  if ( partition->fix_fd == -1  &&
+       (partition->fix_fd = ::open (partition->fix_name.c_str(), O_RDONLY)) == -1 )
+    AMOS_THROW_IO ("Could not open bank partition, " + partition->fix_name);
+
+  int64_t off = (int64_t) lid * fix_size_m;
+  checkBlocks (partition->fix_fd, partition->fix_sums, off, fix_size_m,
+               partition->fix_name);
+  if ( ! withvar )
+    return;
+
+  //-- The fix record checked out, so its var range can be trusted
+  vector<char> record (fix_size_m);
+  if ( ! readFully (partition->fix_fd, &record[0], fix_size_m, off) )
+    AMOS_THROW_IO ("Unknown file read error in fetch, bank corrupted");
+
+  MappedBuffer_t recbuf (&record[0], &record[0] + fix_size_m);
+  istream in (&recbuf);
+
+  bankstreamoff vpos;
+  BankFlags_t flags;
+  Size_t vsize;
+  readLE (in, &vpos);
+  readLE (in, &flags);
+  in.ignore (fix_size_m - sizeof (bankstreamoff) - sizeof (BankFlags_t)
+             - sizeof (Size_t));
+  readLE (in, &vsize);
+  if ( in.fail() )
+    AMOS_THROW_IO ("Unknown file read error in fetch, bank corrupted");
+  if ( flags.is_removed )
+    return;
+
+  if ( partition->var_fd == -1  &&
+       (partition->var_fd = ::open (partition->var_name.c_str(), O_RDONLY)) == -1 )
+    AMOS_THROW_IO ("Could not open bank partition, " + partition->var_name);
+
+  checkBlocks (partition->var_fd, partition->var_sums, vpos, vsize,
+               partition->var_name);
+}
+
+
+//----------------------------------------------------- writeSums --------------
+void Bank_t::writeSums (const string & path,
+                        const StoreSums_t & fix, const StoreSums_t & var)
+{
+  //-- Write aside and rename, so readers never see a torn store
+  string tmp_path = path + TMP_STORE_SUFFIX;
+  ofstream out (tmp_path.c_str(), ios::binary | ios::trunc);
+  if ( ! out.is_open() )
+    AMOS_THROW_IO ("Could not open checksum store, " + tmp_path);
+
+  writeLE (out, &fix.block);
+
+  const StoreSums_t * stores [2] = { &fix, &var };
+  for ( int i = 0; i != 2; ++ i )
+    {
+      uint32_t count = stores [i]->sums.size();
+      writeLE (out, &(stores [i]->length));
+      writeLE (out, &count);
+      for ( uint32_t j = 0; j != count; ++ j )
+        writeLE (out, &(stores [i]->sums [j]));
+    }
+
+  out.close();
+  if ( out.fail()  ||  rename (tmp_path.c_str(), path.c_str()) )
+    {
+      unlink (tmp_path.c_str());
+      AMOS_THROW_IO ("Unknown file write error in close, bank corrupted");
+    }
+}
+
+
 //--------------------------------------------------- BankExists ---------------
 bool AMOS::BankExists (NCode_t ncode, const string & dir)
 {
@@ -1303,9 +1966,62 @@ void AMOS::PrintBankVersion (const char * s)
 
 
 
+//================================================ SumsBuffer_t ================
+//----------------------------------------------------- extend -----------------
+void Bank_t::SumsBuffer_t::extend (StoreSums_t & sums,
+                                   const char * buf, size_t len)
+{
+  while ( len > 0 )
+    {
+      size_t used = sums.length % sums.block;
+      size_t n = min (len, (size_t) sums.block - used);
+      if ( used == 0 )
+        sums.sums.push_back (CRC32C (0, buf, n));
+      else
+        sums.sums.back() = CRC32C (sums.sums.back(), buf, n);
+      sums.length += n;
+      buf += n;
+      len -= n;
+    }
+}
+
+
+//----------------------------------------------------- overflow ---------------
+Bank_t::SumsBuffer_t::int_type Bank_t::SumsBuffer_t::overflow (int_type c)
+{
+  if ( sync() == -1 )
+    return traits_type::eof();
+
+  if ( ! traits_type::eq_int_type (c, traits_type::eof()) )
+    {
+      *pptr() = traits_type::to_char_type (c);
+      pbump (1);
+    }
+  return traits_type::not_eof (c);
+}
+
+
+//----------------------------------------------------- sync -------------------
+int Bank_t::SumsBuffer_t::sync ( )
+{
+  streamsize n = pptr() - pbase();
+  if ( n == 0 )
+    return 0;
+
+  streamsize put = dest_m->sputn (pbase(), n);
+  if ( put > 0 )
+    extend (sums_m, pbase(), put);
+  setp (buff_m, buff_m + sizeof (buff_m));
+  return put == n ? 0 : -1;
+}
+
+
 //================================================ BankPartition_t =============
 //----------------------------------------------------- BankPartition_t --------
 Bank_t::BankPartition_t::BankPartition_t (Size_t buffer_size)
+  : fix_map (NULL), var_map (NULL), fix_map_size (0), var_map_size (0),
+    fix_dirty (-1), var_dirty (-1), sums_loaded (false), has_sums (false),
+    live_sums (false), fix_fd (-1), var_fd (-1)
 {
   fix_buff = (char *) SafeMalloc (buffer_size);
   var_buff = (char *) SafeMalloc (buffer_size);
@@ -1321,6 +2037,58 @@ Bank_t::BankPartition_t::~BankPartition_t()
   fix.close();
   var.close();
 
+  if ( fix_map != NULL )
+    munmap ((void *) fix_map, fix_map_size);
+  if ( var_map != NULL )
+    munmap ((void *) var_map, var_map_size);
+
+  if ( fix_fd != -1 )
+    ::close (fix_fd);
+  if ( var_fd != -1 )
+    ::close (var_fd);
+
   free (fix_buff);
   free (var_buff);
 }
+
+
+//----------------------------------------------------- map --------------------
+static const char * MapStore (const string & path, size_t & size)
+{
+  struct stat st;
+
+  int fd = ::open (path.c_str(), O_RDONLY);
+  if ( fd == -1 )
+    AMOS_THROW_IO ("Could not open bank partition, " + path);
+
+  if ( fstat (fd, &st) == -1 )
+    {
+      ::close (fd);
+      AMOS_THROW_IO ("Could not open bank partition, " + path);
+    }
+
+  //-- An empty store maps to nothing, which no record can reference
+  size = st.st_size;
+  void * p = NULL;
+  if ( size > 0 )
+    {
+      p = mmap (NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+      if ( p == MAP_FAILED )
+        {
+          ::close (fd);
+          AMOS_THROW_IO ("Could not map bank partition, " + path);
+        }
+    }
+  ::close (fd);
+
+  return (const char *) p;
+}
+
+
+void Bank_t::BankPartition_t::map()
+{
+  if ( fix_map == NULL )
+    fix_map = MapStore (fix_name, fix_map_size);
+  if ( var_map == NULL )
+    var_map = MapStore (var_name, var_map_size);
+}
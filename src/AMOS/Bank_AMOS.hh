@@ -35,6 +35,21 @@ const BankMode_t B_READ   = 0x1;  //!< protected reading mode
 const BankMode_t B_WRITE  = 0x2;  //!< protected writing mode
 const BankMode_t B_SPY    = 0x4;
 //!< unprotected reading mode, overrides all other modes
+const BankMode_t B_MAP    = 0x8;
+//!< map the stores into memory so fetch is thread safe, excludes B_WRITE
+const BankMode_t B_VERIFY = 0x10;
+//!< check records against the store checksums as they are read, excludes B_WRITE
+
+//-- Fixed store fields for a projected BankStream_t scan, the IID and bank
+//   flags are always read
+typedef uint32_t BankFields_t;
+const BankFields_t P_ALL      = 0xffffffff; //!< full record, fixed and variable
+const BankFields_t P_EID      = 0x01;  //!< external ID
+const BankFields_t P_LENGTH   = 0x02;  //!< sequence length
+const BankFields_t P_CLEAR    = 0x04;  //!< clear, quality and vector ranges
+const BankFields_t P_FRAGMENT = 0x08;  //!< parent fragment link
+const BankFields_t P_READS    = 0x10;  //!< overlapping read pair
+const BankFields_t P_HANGS    = 0x20;  //!< overlap hangs and score
 
 
 
@@ -105,6 +120,25 @@ protected:
   virtual void readRecordFix(std::istream & fix) = 0;
 
 
+  //--------------------------------------------------- readRecordFields -------
+  //! \brief Read only the requested class members from a fixed store
+  //!
+  //! Like readRecordFix, but only the members covered by fields need to be
+  //! decoded, the rest may be skipped and left empty. The whole fixed record
+  //! must still be consumed. Classes without a specialised projection read
+  //! the full fixed record.
+  //!
+  //! \param fix The fixed length stream (stores all fixed length members)
+  //! \param fields Bitwise OR of the P_ field flags to decode
+  //! \pre The get pointer of fix is at the beginning of the record
+  //! \return void
+  //!
+  virtual void readRecordFields (std::istream & fix, BankFields_t fields)
+  {
+    readRecordFix (fix);
+  }
+
+
   //--------------------------------------------------- writeRecord ------------
   //! \brief Write selected class members to a biserial record
   //!
@@ -345,6 +379,77 @@ protected:
       I_CLOSE
     };
 
+  //================================================ MappedBuffer_t ============
+  //! \brief A read only stream buffer over records already in memory
+  //!
+  //! Lets the record decoders read from mapped or prefetched store bytes.
+  //!
+  //============================================================================
+  class MappedBuffer_t : public std::streambuf
+  {
+
+  public:
+
+    MappedBuffer_t (const char * beg, const char * end)
+    {
+      setg ((char *) beg, (char *) beg, (char *) end);
+    }
+
+  };
+
+
+  //================================================ StoreSums_t ===============
+  //! \brief The block checksums of one store of a partition
+  //!
+  //============================================================================
+  struct StoreSums_t
+  {
+    uint32_t block;                  //!< Bytes per block
+    uint64_t length;                 //!< Store bytes covered by the checksums
+    std::vector<uint32_t> sums;      //!< CRC-32C of each block
+    std::vector<bool> checked;       //!< Blocks already verified by B_VERIFY
+
+    StoreSums_t ( ) : block (0), length (0) { }
+  };
+
+
+  //================================================ SumsBuffer_t ==============
+  //! \brief An output stream buffer that checksums the bytes it passes on
+  //!
+  //! Collects the writes of a record and passes them to the store's own
+  //! buffer on sync, adding them to the block checksums of the store, so
+  //! appends need not be read back to checksum them.
+  //!
+  //============================================================================
+  class SumsBuffer_t : public std::streambuf
+  {
+
+  private:
+
+    std::streambuf * dest_m;   //!< The store's buffer
+    StoreSums_t & sums_m;      //!< Checksums of the store up to the put point
+    char buff_m [4096];        //!< Bytes not yet passed on
+
+  public:
+
+    SumsBuffer_t (std::streambuf * dest, StoreSums_t & sums)
+      : dest_m (dest), sums_m (sums)
+    {
+      setp (buff_m, buff_m + sizeof (buff_m));
+    }
+
+    //! \brief Adds bytes at the end of a store to its checksums
+    static void extend (StoreSums_t & sums, const char * buf, size_t len);
+
+  protected:
+
+    virtual int_type overflow (int_type c);
+
+    virtual int sync ( );
+
+  };
+
+
   //================================================ BankPartition_t ===========
   //! \brief A single partition of the file-based bank
   //!
@@ -367,6 +472,24 @@ protected:
     std::fstream fix;  //!< The fstream for this partition's fix len store
     std::fstream var;  //!< The fstream for this partition's var len store
 
+    const char * fix_map;    //!< The mapped fix len store, or NULL
+    const char * var_map;    //!< The mapped var len store, or NULL
+    size_t fix_map_size;     //!< Size of the fix len mapping
+    size_t var_map_size;     //!< Size of the var len mapping
+
+    int64_t fix_dirty;       //!< Lowest fix len offset written, or -1
+    int64_t var_dirty;       //!< Lowest var len offset written, or -1
+
+    bool sums_loaded;        //!< fix_sums and var_sums are loaded
+    bool has_sums;           //!< The partition has a checksum store
+    StoreSums_t fix_sums;    //!< Checksums of the fix len store
+    StoreSums_t var_sums;    //!< Checksums of the var len store
+    bool live_sums;          //!< fix_live and var_live cover the stores
+    StoreSums_t fix_live;    //!< Running checksums of the fix len store
+    StoreSums_t var_live;    //!< Running checksums of the var len store
+    int fix_fd;              //!< Descriptor for verifying the fix len store
+    int var_fd;              //!< Descriptor for verifying the var len store
+
     //------------------------------------------------- BankPartition_t --------
     //! \brief Allocates stream buffers for fix and var streams
     //!
@@ -378,9 +501,83 @@ protected:
     //!
     ~BankPartition_t ( );
 
+
+    //------------------------------------------------- map --------------------
+    //! \brief Maps the fix and var stores read only into memory
+    //!
+    //! \throws IOException_t
+    //!
+    void map ( );
+
+
+    //------------------------------------------------- touch ------------------
+    //! \brief Notes that the stores were written from these offsets on
+    //!
+    //! The checksums of the written blocks are recomputed when the bank is
+    //! closed, unless every write was an append through the running sums.
+    //!
+    //! \param fixoff First fix len byte written, or -1 for none
+    //! \param varoff First var len byte written, or -1 for none
+    //! \param appended The bytes go through SumsBuffer_t to the running sums
+    //!
+    void touch (int64_t fixoff, int64_t varoff, bool appended = false)
+    {
+      if ( fixoff >= 0  &&  (fix_dirty < 0  ||  fixoff < fix_dirty) )
+        fix_dirty = fixoff;
+      if ( varoff >= 0  &&  (var_dirty < 0  ||  varoff < var_dirty) )
+        var_dirty = varoff;
+      if ( ! appended )
+        live_sums = false;
+    }
+
+
+    //------------------------------------------------- startLiveSums ----------
+    //! \brief Starts running checksums for the empty stores of a new partition
+    //!
+    void startLiveSums (uint32_t block)
+    {
+      fix_live = var_live = StoreSums_t();
+      fix_live.block = var_live.block = block;
+      live_sums = true;
+    }
+
   };
 
 
+  //--------------------------------------------------- appendRecord -----------
+  //! \brief Writes an object at the put positions of a partition
+  //!
+  //! Writes the fix and var records of an append, through the running
+  //! checksums of the partition when it has them, and starts them on the
+  //! first append to a partition whose checksum store is current.
+  //!
+  //! \param partition The partition, with both put positions at the ends
+  //! \param obj The object, flags already set
+  //! \param fpos The fix len put position
+  //! \param vpos The var len put position
+  //! \return false if a write failed
+  //!
+  bool appendRecord (BankPartition_t * partition, IBankable_t & obj,
+                     int64_t fpos, int64_t vpos);
+
+
+  //--------------------------------------------------- checkBlocks ------------
+  //! \brief Checks the blocks of a store overlapping a byte range
+  //!
+  //! Blocks already checked or not covered by the checksums are skipped.
+  //!
+  //! \throws IOException_t on a mismatch
+  //!
+  static void checkBlocks (int fd, StoreSums_t & sums, int64_t off, int64_t len,
+                           const std::string & path);
+
+
+  //--------------------------------------------------- getSumsPath ------------
+  //! \brief Returns the checksum store of a partition
+  //!
+  std::string getSumsPath (const BankPartition_t * partition) const;
+
+
   //--------------------------------------------------- nextVersion -----------
   //! \brief Adds a new version to the store  
   //!
@@ -449,6 +646,18 @@ protected:
   void fetchBIDFix(ID_t iid, IBankable_t & obj);
 
 
+  //--------------------------------------------------- fetchBIDMapped ---------
+  //! \brief Fetch an object by BID from the mapped stores
+  //!
+  //! Reads through streams over the mapped records, and changes no bank
+  //! state, so any number of threads may call it at once.
+  //!
+  //! \throws ArgumentException_t if the BID is out of range
+  //! \throws IOException_t
+  //!
+  void fetchBIDMapped (ID_t bid, IBankable_t & obj, bool fixonly) const;
+
+
   //--------------------------------------------------- getPartition -----------
   //! \brief Returns the requested BankPartition, opening it if necessary
   //!
@@ -533,12 +742,72 @@ protected:
   void removeBID (ID_t bid);
 
 
+  //--------------------------------------------------- readFully --------------
+  //! \brief Reads exactly size bytes at off, false on a short read
+  //!
+  static bool readFully (int fd, char * buf, size_t size, int64_t off);
+
+
+  //--------------------------------------------------- readSums ---------------
+  //! \brief Reads a checksum store, false if missing or unreadable
+  //!
+  static bool readSums (const std::string & path,
+                        StoreSums_t & fix, StoreSums_t & var);
+
+
   //--------------------------------------------------- replaceBID -------------
   //! \brief Replace an object by BID
   //!
   void replaceBID (ID_t bid, IBankable_t & obj);
 
 
+  //--------------------------------------------------- syncChecksums ----------
+  //! \brief Recomputes the checksums of the written blocks of a partition
+  //!
+  //! A partition without a checksum store is checksummed from the start. A
+  //! partition only appended to writes its running checksums instead.
+  //!
+  //! \throws IOException_t
+  //!
+  void syncChecksums (BankPartition_t * partition);
+
+
+  //--------------------------------------------------- updateSums -------------
+  //! \brief Recomputes the checksums of a store from an offset to its end
+  //!
+  //! \param path The store
+  //! \param sums The checksums to update
+  //! \param from First byte written, or -1 to only cover appended bytes
+  //! \throws IOException_t
+  //!
+  static void updateSums (const std::string & path, StoreSums_t & sums,
+                          int64_t from);
+
+
+  //--------------------------------------------------- verifyRecord -----------
+  //! \brief Checks the blocks holding a record against their checksums
+  //!
+  //! Used by B_VERIFY, each block is read and checked the first time one of
+  //! its records is fetched. Partitions without checksums are not checked,
+  //! but a checksum store that cannot be read is an error.
+  //!
+  //! \param partition The partition of the record
+  //! \param lid The local BID of the record (0 based)
+  //! \param withvar Also check the variable record
+  //! \throws IOException_t
+  //!
+  void verifyRecord (BankPartition_t * partition, ID_t lid, bool withvar);
+
+
+  //--------------------------------------------------- writeSums --------------
+  //! \brief Writes a checksum store
+  //!
+  //! \throws IOException_t
+  //!
+  static void writeSums (const std::string & path,
+                         const StoreSums_t & fix, const StoreSums_t & var);
+
+
   //----------------------------------------------------- setMode --------------
   //! \brief validates and sets the BankMode
   //!
@@ -549,14 +818,22 @@ protected:
   //!
   void setMode (BankMode_t mode)
   {
-    if ( mode & ~(B_READ | B_WRITE | B_SPY) )
+    if ( mode & ~(B_READ | B_WRITE | B_SPY | B_MAP | B_VERIFY) )
       AMOS_THROW_ARGUMENT ("Invalid BankMode: unknown mode");
 
     if ( ! mode & (B_READ | B_WRITE | B_SPY) )
       AMOS_THROW_ARGUMENT ("Invalid BankMode: mode not specified");
 
+    if ( (mode & B_MAP)  &&  (mode & B_WRITE)  &&  ! (mode & B_SPY) )
+      AMOS_THROW_ARGUMENT ("Invalid BankMode: B_MAP is read only");
+
+    if ( (mode & B_VERIFY)  &&  (mode & B_WRITE)  &&  ! (mode & B_SPY) )
+      AMOS_THROW_ARGUMENT ("Invalid BankMode: B_VERIFY is read only");
+
     if ( mode & B_SPY )
-      mode = B_SPY | B_READ;
+      mode = B_SPY | B_READ | (mode & (B_MAP | B_VERIFY));
+    else if ( mode & (B_MAP | B_VERIFY) )
+      mode |= B_READ;
 
       mode_m = mode;
   }
@@ -658,6 +935,9 @@ public:
   static const std::string VAR_STORE_SUFFIX;  //!< the variable length stores
 
   static const std::string TMP_STORE_SUFFIX;  //!< the temporary store
+  static const std::string SUM_STORE_SUFFIX;  //!< the partition checksums
+
+  static const Size_t CHECKSUM_BLOCK_SIZE;    //!< bytes per checksum block
 
   static const char WRITE_LOCK_CHAR;          //!< write lock char
   static const char READ_LOCK_CHAR;           //!< read lock char
@@ -912,6 +1192,40 @@ public:
   bool exists (const std::string & dir) const;
   bool exists (const std::string & dir, Size_t version) const;
 
+
+  //--------------------------------------------------- getStoreStamp ----------
+  //! \brief Fingerprints the data stores of one bank type in a directory
+  //!
+  //! Sums the sizes of the fixed, variable and map stores of the type, and
+  //! mixes the nanosecond modification and change times, inode and size of
+  //! each into a second word, ignoring the info and lock stores which change
+  //! on every open. Any append, replace or remove changes the stamp, even a
+  //! same size rewrite within the second, so indices kept next to the bank
+  //! can tell when they are stale. A missing bank stamps as zeros.
+  //!
+  //! \param dir The bank directory
+  //! \param type The NCode of the bank type
+  //! \param stamp Set to the total size and the store mix, in that order
+  //! \return void
+  //!
+  static void getStoreStamp (const std::string & dir, NCode_t type,
+                             int64_t stamp [2]);
+
+
+  //--------------------------------------------------- makeTempStore ----------
+  //! \brief Creates a uniquely named empty file to write a store aside
+  //!
+  //! The file is made by mkstemp next to path, so it can be renamed over
+  //! path when complete, and concurrent writers never share a temporary.
+  //! The caller must rename or unlink it.
+  //!
+  //! \param path The store the temporary will replace
+  //! \pre The directory of path is writable
+  //! \return The path of the new temporary
+  //! \throws IOException_t if the file could not be created
+  //!
+  static std::string makeTempStore (const std::string & path);
+
   //--------------------------------------------------- existsEID --------------
   //! \brief Returns true if EID exists in the bank
   //!
@@ -934,7 +1248,8 @@ public:
   //! \brief Fetches a Bankable object from the bank by its IID
   //!
   //! Retrieves an object from the bank by its IID and stores it in a bankable
-  //! object.
+  //! object. If the bank was opened with B_MAP, fetch and fetchFix may be
+  //! called from any number of threads at once.
   //!
   //! \param iid The IID of the object to fetch
   //! \param obj A Bankable object to store the data
@@ -1059,6 +1374,15 @@ public:
   ID_t getMaxBID ( ) const;
 
 
+  //--------------------------------------------------- getPartitionCount ------
+  //! \brief Get the number of disk partitions of the open version
+  //!
+  Size_t getPartitionCount ( ) const
+  {
+    return npartitions_m;
+  }
+
+
 
 
   //--------------------------------------------------- getSize ----------------
@@ -1175,6 +1499,20 @@ public:
   //!
   void open (const std::string & dir, BankMode_t mode = B_READ | B_WRITE, Size_t version = OPEN_LATEST_VERSION, bool inPlace = true);
 
+
+  //--------------------------------------------------- recordChecksums --------
+  //! \brief Checksums the partitions that have no checksum store yet
+  //!
+  //! Partitions written by this version of the bank are checksummed as they
+  //! are written, this covers banks written before that.
+  //!
+  //! \pre The bank is open for writing
+  //! \throws IOException_t
+  //! \return The number of partitions checksummed
+  //!
+  Size_t recordChecksums ( );
+
+
   //--------------------------------------------------- remove -----------------
   //! \brief Removes an object from the bank by its IID
   //!
@@ -1254,6 +1592,25 @@ public:
     status_m = status;
   }
 
+
+  //--------------------------------------------------- verifyPartition --------
+  //! \brief Checks a partition of the open version for corruption
+  //!
+  //! Reads both stores of the partition and checks every block against its
+  //! checksum, and every live record for a variable record inside the var
+  //! store. Uses its own file descriptors and changes no bank state, so
+  //! different partitions may be verified from different threads at once.
+  //! A checksum store that is there but cannot be read counts as a problem.
+  //!
+  //! \param pid The partition to check (0 based)
+  //! \param report Appended a line for every problem found
+  //! \param checksummed Set to false if the partition has no usable checksums
+  //! \throws IOException_t if the stores cannot be read
+  //! \return The number of problems found
+  //!
+  Size_t verifyPartition (Size_t pid, std::string & report,
+                          bool & checksummed) const;
+
 };
 
 
@@ -0,0 +1,488 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Source for ContigRangeIndex_t
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ContigRangeIndex_AMOS.hh"
+#include "Bank_AMOS.hh"
+#include "BankStream_AMOS.hh"
+#include "Contig_AMOS.hh"
+#include "Feature_AMOS.hh"
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace AMOS;
+using namespace std;
+
+
+
+
+//================================================ ContigRangeIndex_t ==========
+const string ContigRangeIndex_t::STORE_SUFFIX = ".rix";
+
+static const char INDEX_MAGIC [8] = {'A','M','O','S','R','I','X','1'};
+static const uint32_t INDEX_ORDER = 0x01020304;
+
+typedef ContigRangeIndex_t::Entry_t Entry_t;
+
+
+//-- File layout: header, the tile then feature trees of every contig, padding
+//   to 8 bytes, and the contig directory sorted by IID
+struct ContigRangeIndex_t::Header_t
+{
+  char magic [8];           //!< INDEX_MAGIC
+  uint32_t order;           //!< INDEX_ORDER in the writer's byte order
+  uint32_t ncontigs;        //!< directory size
+  uint64_t nentries;        //!< total intervals
+  int64_t stamp [4];        //!< contig and feature store stamps
+};
+
+struct ContigRangeIndex_t::Block_t
+{
+  ID_t iid;                 //!< contig IID
+  uint32_t ntiles;          //!< tile tree size
+  uint32_t nfeatures;       //!< feature tree size, follows the tiles
+  uint32_t pad;
+  uint64_t offset;          //!< index of the first tile entry
+
+  bool operator< (const Block_t & b) const
+  {
+    return iid < b . iid;
+  }
+};
+
+
+//----------------------------------------------------- IndexPath --------------
+static string IndexPath (const string & bankname)
+{
+  return bankname + '/' + Decode (Contig_t::NCODE)
+    + ContigRangeIndex_t::STORE_SUFFIX;
+}
+
+
+//----------------------------------------------------- EntryLess --------------
+static bool EntryLess (const Entry_t & a, const Entry_t & b)
+{
+  if ( a . begin != b . begin )
+    return a . begin < b . begin;
+  return a . end < b . end;
+}
+
+
+//----------------------------------------------------- IndexTree --------------
+//! Sorts intervals by begin and sets the subtree max ends of the implicit
+//! tree, in which the nodes at level k are the indices whose lowest k bits
+//! are set and the next is clear, so leaves are the even indices
+static void IndexTree (vector<Entry_t> & a)
+{
+  int64_t n = a . size( );
+  int64_t i, x, last_i = 0;
+  Pos_t last = 0;
+
+  sort (a . begin( ), a . end( ), EntryLess);
+
+  for ( i = 0; i < n; i += 2 )
+    {
+      last_i = i;
+      last = a[i] . maxend = a[i] . end;
+    }
+
+  for ( int k = 1; ((int64_t) 1 << k) <= n; k ++ )
+    {
+      x = (int64_t) 1 << (k - 1);
+      for ( i = (x << 1) - 1; i < n; i += x << 2 )
+        {
+          //-- The right child may be past the end, then use the max end of
+          //   the rightmost subtree instead
+          Pos_t e = a[i] . end;
+          e = max (e, a[i - x] . maxend);
+          e = max (e, i + x < n ? a[i + x] . maxend : last);
+          a[i] . maxend = e;
+        }
+
+      //-- Move to the parent of the last node
+      last_i = ((last_i >> k) & 1) ? last_i - x : last_i + x;
+      if ( last_i < n  &&  a[last_i] . maxend > last )
+        last = a[last_i] . maxend;
+    }
+}
+
+
+//----------------------------------------------------- WriteTree --------------
+static void WriteTree (ofstream & out, vector<Entry_t> & a)
+{
+  IndexTree (a);
+  if ( ! a . empty( ) )
+    out . write ((const char *) &a[0], a . size( ) * sizeof (Entry_t));
+}
+
+
+//----------------------------------------------------- ContigRangeIndex_t -----
+ContigRangeIndex_t::ContigRangeIndex_t ( )
+  : data_m (NULL), size_m (0),
+    header_m (NULL), blocks_m (NULL), entries_m (NULL)
+{
+
+}
+
+
+//----------------------------------------------------- ~ContigRangeIndex_t ----
+ContigRangeIndex_t::~ContigRangeIndex_t ( )
+{
+  close( );
+}
+
+
+//----------------------------------------------------- build ------------------
+void ContigRangeIndex_t::build (const string & bankname)
+{
+  HASHMAP::hash_map<ID_t, vector<Entry_t> > features;
+  HASHMAP::hash_map<ID_t, vector<Entry_t> >::iterator fi;
+  vector<Entry_t> tiles;
+  vector<Block_t> blocks;
+  Header_t header;
+  Entry_t e;
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header . magic, INDEX_MAGIC, sizeof (INDEX_MAGIC));
+  header . order = INDEX_ORDER;
+  Bank_t::getStoreStamp (bankname, Contig_t::NCODE, header . stamp);
+  Bank_t::getStoreStamp (bankname, Feature_t::NCODE, header . stamp + 2);
+
+  //-- Group the contig features first, they are not in contig order
+  BankStream_t fea_bank (Feature_t::NCODE);
+  if ( fea_bank . exists (bankname) )
+    {
+      Feature_t fea;
+      pair<ID_t, NCode_t> src;
+
+      fea_bank . open (bankname, B_READ);
+      while ( fea_bank >> fea )
+        {
+          src = fea . getSource( );
+          if ( src . first == NULL_ID  ||  src . second != Contig_t::NCODE )
+            continue;
+
+          e . begin = fea . getRange( ) . getLo( );
+          e . end = max (fea . getRange( ) . getHi( ), e . begin + 1);
+          e . maxend = e . end;
+          e . index = 0;
+          e . iid = fea . getIID( );
+          features [src . first] . push_back (e);
+        }
+      fea_bank . close( );
+    }
+
+  //-- One pass over the contigs, writing the trees as we go
+  BankStream_t ctg_bank (Contig_t::NCODE);
+  Contig_t ctg;
+  Block_t block;
+
+  memset (&block, 0, sizeof (block));
+  ctg_bank . open (bankname, B_READ);
+
+  string path = IndexPath (bankname);
+  string tmp = Bank_t::makeTempStore (path);
+  ofstream out (tmp . c_str( ), ios::out | ios::binary | ios::trunc);
+  if ( ! out )
+    {
+      unlink (tmp . c_str( ));
+      AMOS_THROW_IO ("Could not open contig range index, " + tmp);
+    }
+
+  out . write ((const char *) &header, sizeof (header));
+
+  try {
+    while ( ctg_bank >> ctg )
+      {
+        if ( ctg . getIID( ) == NULL_ID )
+          continue;
+
+        const vector<Tile_t> & tiling = ctg . getReadTiling( );
+        tiles . resize (tiling . size( ));
+        for ( uint32_t t = 0; t < tiling . size( ); t ++ )
+          {
+            tiles[t] . begin = tiling[t] . offset;
+            tiles[t] . end = tiling[t] . offset + tiling[t] . getGappedLength( );
+            tiles[t] . index = t;
+            tiles[t] . iid = tiling[t] . source;
+          }
+
+        block . iid = ctg . getIID( );
+        block . offset = header . nentries;
+        block . ntiles = tiles . size( );
+        block . nfeatures = 0;
+        WriteTree (out, tiles);
+
+        fi = features . find (block . iid);
+        if ( fi != features . end( ) )
+          {
+            block . nfeatures = fi -> second . size( );
+            WriteTree (out, fi -> second);
+            features . erase (fi);
+          }
+
+        header . nentries += block . ntiles + block . nfeatures;
+        blocks . push_back (block);
+      }
+  }
+  catch (...) {
+    out . close( );
+    unlink (tmp . c_str( ));
+    throw;
+  }
+
+  ctg_bank . close( );
+
+  sort (blocks . begin( ), blocks . end( ));
+  header . ncontigs = blocks . size( );
+
+  //-- Align the directory for its 64-bit offsets
+  static const char PAD [8] = {0};
+  out . write (PAD, (8 - (sizeof (header)
+                          + header . nentries * sizeof (Entry_t)) % 8) % 8);
+  if ( ! blocks . empty( ) )
+    out . write ((const char *) &blocks[0], blocks . size( ) * sizeof (Block_t));
+
+  out . seekp (0);
+  out . write ((const char *) &header, sizeof (header));
+  out . close( );
+
+  if ( out . fail( ) )
+    {
+      unlink (tmp . c_str( ));
+      AMOS_THROW_IO ("Could not write contig range index, " + tmp);
+    }
+
+  if ( rename (tmp . c_str( ), path . c_str( )) != 0 )
+    {
+      string err = strerror (errno);
+      unlink (tmp . c_str( ));
+      AMOS_THROW_IO ("Could not rename contig range index, " + path +
+                     ", " + err);
+    }
+}
+
+
+//----------------------------------------------------- exists -----------------
+bool ContigRangeIndex_t::exists (const string & bankname)
+{
+  return ! access (IndexPath (bankname) . c_str( ), R_OK);
+}
+
+
+//----------------------------------------------------- isCurrent --------------
+bool ContigRangeIndex_t::isCurrent (const string & bankname)
+{
+  try {
+    ContigRangeIndex_t index;
+    index . open (bankname);
+  }
+  catch (const IOException_t &) {
+    return false;
+  }
+  return true;
+}
+
+
+//----------------------------------------------------- open -------------------
+void ContigRangeIndex_t::open (const string & bankname)
+{
+  close( );
+
+  string path = IndexPath (bankname);
+  struct stat st;
+
+  int fd = ::open (path . c_str( ), O_RDONLY);
+  if ( fd == -1 )
+    AMOS_THROW_IO ("Could not open contig range index, " + path +
+                   ", " + strerror (errno));
+
+  if ( fstat (fd, &st) == -1  ||  st . st_size < (off_t) sizeof (Header_t) )
+    {
+      ::close (fd);
+      AMOS_THROW_IO ("Could not read contig range index, " + path);
+    }
+
+  void * p = mmap (NULL, st . st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close (fd);
+  if ( p == MAP_FAILED )
+    AMOS_THROW_IO ("Could not map contig range index, " + path +
+                   ", " + strerror (errno));
+
+  data_m = (char *) p;
+  size_m = st . st_size;
+  header_m = (const Header_t *) data_m;
+
+  //-- Check the format, the byte order and that the layout fits the file
+  uint64_t dir = sizeof (Header_t) + header_m -> nentries * sizeof (Entry_t);
+  dir += (8 - dir % 8) % 8;
+
+  if ( memcmp (header_m -> magic, INDEX_MAGIC, sizeof (INDEX_MAGIC)) != 0  ||
+       header_m -> order != INDEX_ORDER  ||
+       dir + header_m -> ncontigs * sizeof (Block_t) != size_m )
+    {
+      close( );
+      AMOS_THROW_IO ("Not a contig range index for this platform, " + path);
+    }
+
+  int64_t stamp [4];
+  Bank_t::getStoreStamp (bankname, Contig_t::NCODE, stamp);
+  Bank_t::getStoreStamp (bankname, Feature_t::NCODE, stamp + 2);
+  if ( memcmp (stamp, header_m -> stamp, sizeof (stamp)) != 0 )
+    {
+      close( );
+      AMOS_THROW_IO ("Contig range index is older than the bank, " + path);
+    }
+
+  entries_m = (const Entry_t *) (data_m + sizeof (Header_t));
+  blocks_m = (const Block_t *) (data_m + dir);
+}
+
+
+//----------------------------------------------------- close ------------------
+void ContigRangeIndex_t::close ( )
+{
+  if ( data_m != NULL )
+    munmap (data_m, size_m);
+
+  data_m = NULL;
+  size_m = 0;
+  header_m = NULL;
+  blocks_m = NULL;
+  entries_m = NULL;
+}
+
+
+//----------------------------------------------------- getNumContigs ----------
+Size_t ContigRangeIndex_t::getNumContigs ( ) const
+{
+  return header_m == NULL ? 0 : header_m -> ncontigs;
+}
+
+
+//----------------------------------------------------- getNumTiles ------------
+Size_t ContigRangeIndex_t::getNumTiles (ID_t contig) const
+{
+  const Block_t * block = findBlock (contig);
+  return block == NULL ? 0 : block -> ntiles;
+}
+
+
+//----------------------------------------------------- getNumFeatures ---------
+Size_t ContigRangeIndex_t::getNumFeatures (ID_t contig) const
+{
+  const Block_t * block = findBlock (contig);
+  return block == NULL ? 0 : block -> nfeatures;
+}
+
+
+//----------------------------------------------------- getTiles ---------------
+void ContigRangeIndex_t::getTiles (ID_t contig, Range_t range,
+                                   vector<Entry_t> & entries) const
+{
+  const Block_t * block = findBlock (contig);
+  if ( block != NULL )
+    query (entries_m + block -> offset, block -> ntiles,
+           range . getLo( ), range . getHi( ), entries);
+}
+
+
+//----------------------------------------------------- getFeatures ------------
+void ContigRangeIndex_t::getFeatures (ID_t contig, Range_t range,
+                                      vector<Entry_t> & entries) const
+{
+  const Block_t * block = findBlock (contig);
+  if ( block != NULL )
+    query (entries_m + block -> offset + block -> ntiles, block -> nfeatures,
+           range . getLo( ), range . getHi( ), entries);
+}
+
+
+//----------------------------------------------------- findBlock --------------
+const ContigRangeIndex_t::Block_t *
+ContigRangeIndex_t::findBlock (ID_t contig) const
+{
+  if ( header_m == NULL )
+    return NULL;
+
+  const Block_t * lo = blocks_m;
+  const Block_t * hi = blocks_m + header_m -> ncontigs;
+
+  while ( lo < hi )
+    {
+      const Block_t * mid = lo + (hi - lo) / 2;
+      if ( mid -> iid < contig )
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return (lo != blocks_m + header_m -> ncontigs  &&  lo -> iid == contig)
+    ? lo : NULL;
+}
+
+
+//----------------------------------------------------- query ------------------
+void ContigRangeIndex_t::query (const Entry_t * a, uint32_t n,
+                                Pos_t begin, Pos_t end,
+                                vector<Entry_t> & entries)
+{
+  //-- Subtree level, root index and whether its left child is done
+  struct Frame_t { int k; int64_t x; bool left; };
+  Frame_t stack [64], z;
+  int t = 0, k = 0;
+  int64_t i, i0, i1;
+
+  if ( n == 0  ||  begin >= end )
+    return;
+
+  while ( ((int64_t) 1 << (k + 1)) <= n )
+    k ++;
+
+  z . k = k;
+  z . x = ((int64_t) 1 << k) - 1;
+  z . left = false;
+  stack[t ++] = z;
+
+  while ( t > 0 )
+    {
+      z = stack[-- t];
+
+      if ( z . k <= 3 )
+        {
+          //-- Small subtree, scan it
+          i0 = z . x >> z . k << z . k;
+          i1 = min ((int64_t) n, i0 + ((int64_t) 1 << (z . k + 1)) - 1);
+          for ( i = i0; i < i1  &&  a[i] . begin < end; i ++ )
+            if ( begin < a[i] . end )
+              entries . push_back (a[i]);
+        }
+      else if ( ! z . left )
+        {
+          //-- Revisit this node after the left child, which may be past the
+          //   end of the array but still have nodes in it
+          int64_t y = z . x - ((int64_t) 1 << (z . k - 1));
+          z . left = true;
+          stack[t ++] = z;
+          if ( y >= n  ||  a[y] . maxend > begin )
+            {
+              z . k --; z . x = y; z . left = false;
+              stack[t ++] = z;
+            }
+        }
+      else if ( z . x < n  &&  a[z . x] . begin < end )
+        {
+          if ( begin < a[z . x] . end )
+            entries . push_back (a[z . x]);
+          z . k --; z . x += (int64_t) 1 << z . k; z . left = false;
+          stack[t ++] = z;
+        }
+    }
+}
@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Header for ContigRangeIndex_t
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __ContigRangeIndex_AMOS_HH
+#define __ContigRangeIndex_AMOS_HH 1
+
+#include "datatypes_AMOS.hh"
+#include <string>
+#include <vector>
+
+
+
+
+namespace AMOS {
+
+//================================================ ContigRangeIndex_t ==========
+//! \brief An on-disk interval index of the tiles and features of each contig
+//!
+//! Answers "which reads or features of contig c cover [a,b)" without fetching
+//! the contig. The index is a single file in the bank directory, built in one
+//! pass over the contig and feature banks. For each contig it holds the read
+//! tiles and the contig features as two arrays sorted by begin position, each
+//! laid out as an implicit augmented interval tree, i.e. every element also
+//! stores the max end position of the subtree it roots. A query is
+//! O(log n + k) for n intervals and k hits, and reads only the parts of the
+//! file it visits since the file is memory mapped.
+//!
+//! The file is in native byte order and records a fingerprint of the bank
+//! stores it was built from. open will refuse a file from another byte order
+//! or one that is out of date with respect to the bank, in which case it
+//! should simply be rebuilt.
+//!
+//==============================================================================
+class ContigRangeIndex_t
+{
+
+public:
+
+  //============================================== Entry_t =====================
+  //! \brief One indexed interval, in gapped contig coordinates
+  //!
+  //! For tiles, index is the position of the tile in the contig's read tiling
+  //! and iid the read IID. For features, index is 0 and iid the feature IID.
+  //! Empty feature ranges are indexed as one base wide.
+  //!
+  struct Entry_t
+  {
+    Pos_t begin;        //!< first position
+    Pos_t end;          //!< one past the last position
+    Pos_t maxend;       //!< max end of the implicit subtree, internal
+    uint32_t index;     //!< tile index
+    ID_t iid;           //!< read or feature IID
+  };
+
+
+  static const std::string STORE_SUFFIX;  //!< the index file suffix
+
+
+  //--------------------------------------------------- ContigRangeIndex_t -----
+  //! \brief Constructs an unopened index
+  //!
+  ContigRangeIndex_t ( );
+
+
+  //--------------------------------------------------- ~ContigRangeIndex_t ----
+  //! \brief Closes the index if it is open
+  //!
+  ~ContigRangeIndex_t ( );
+
+
+  //--------------------------------------------------- build ------------------
+  //! \brief Builds the index file for a bank
+  //!
+  //! Streams through the contig bank, and the feature bank if there is one,
+  //! and (re)writes the index file. Features are gathered first, so memory
+  //! use is bounded by the features and the largest contig.
+  //!
+  //! \param bankname Name of the bank directory to index
+  //! \throws IOException_t
+  //! \return void
+  //!
+  static void build (const std::string & bankname);
+
+
+  //--------------------------------------------------- exists -----------------
+  //! \brief Checks for an index file in a bank, current or not
+  //!
+  static bool exists (const std::string & bankname);
+
+
+  //--------------------------------------------------- isCurrent --------------
+  //! \brief Checks that the index file of a bank can be opened and is current
+  //!
+  static bool isCurrent (const std::string & bankname);
+
+
+  //--------------------------------------------------- open -------------------
+  //! \brief Maps the index file of a bank into memory
+  //!
+  //! \param bankname Name of the bank directory
+  //! \pre The index has been built and the bank not changed since
+  //! \throws IOException_t
+  //! \return void
+  //!
+  void open (const std::string & bankname);
+
+
+  //--------------------------------------------------- close ------------------
+  //! \brief Unmaps the index file, does nothing if not open
+  //!
+  void close ( );
+
+
+  //--------------------------------------------------- isOpen -----------------
+  bool isOpen ( ) const
+  {
+    return data_m != NULL;
+  }
+
+
+  //--------------------------------------------------- getNumContigs ----------
+  //! \brief Returns the number of indexed contigs
+  //!
+  Size_t getNumContigs ( ) const;
+
+
+  //--------------------------------------------------- getNumTiles ------------
+  //! \brief Returns the number of tiles indexed for a contig, 0 if unknown
+  //!
+  Size_t getNumTiles (ID_t contig) const;
+
+
+  //--------------------------------------------------- getNumFeatures ---------
+  //! \brief Returns the number of features indexed for a contig, 0 if unknown
+  //!
+  Size_t getNumFeatures (ID_t contig) const;
+
+
+  //--------------------------------------------------- getTiles ---------------
+  //! \brief Finds the tiles of a contig that overlap a range
+  //!
+  //! Hits are appended to entries in order of begin position. An unknown
+  //! contig IID has no hits.
+  //!
+  //! \param contig The contig IID
+  //! \param range The gapped contig range [begin, end) to look up
+  //! \param entries The hits are appended here
+  //! \pre isOpen( )
+  //! \return void
+  //!
+  void getTiles (ID_t contig, Range_t range,
+                 std::vector<Entry_t> & entries) const;
+
+
+  //--------------------------------------------------- getFeatures ------------
+  //! \brief Finds the features of a contig that overlap a range
+  //!
+  //! Same as getTiles, for the features whose source is the contig.
+  //!
+  void getFeatures (ID_t contig, Range_t range,
+                    std::vector<Entry_t> & entries) const;
+
+
+private:
+
+  struct Header_t;
+  struct Block_t;
+
+  //--------------------------------------------------- findBlock --------------
+  //! \brief Returns the directory entry of a contig, or NULL
+  //!
+  const Block_t * findBlock (ID_t contig) const;
+
+
+  //--------------------------------------------------- query ------------------
+  //! \brief Appends the intervals of an implicit tree that overlap a range
+  //!
+  static void query (const Entry_t * tree, uint32_t n,
+                     Pos_t begin, Pos_t end,
+                     std::vector<Entry_t> & entries);
+
+
+  ContigRangeIndex_t (const ContigRangeIndex_t & source);
+  ContigRangeIndex_t & operator= (const ContigRangeIndex_t & source);
+
+
+  char * data_m;                  //!< the mapped file, or NULL
+  size_t size_m;                  //!< size of the mapping
+  const Header_t * header_m;      //!< file header
+  const Block_t * blocks_m;       //!< per contig directory, sorted by IID
+  const Entry_t * entries_m;      //!< all intervals
+};
+
+} // namespace AMOS
+
+#endif // #ifndef __ContigRangeIndex_AMOS_HH
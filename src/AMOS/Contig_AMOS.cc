@@ -20,23 +20,81 @@ using namespace std;
 const NCode_t Contig_t::NCODE = M_CONTIG;
 
 
+//----------------------------------------------------- PopCount -------------
+static inline int PopCount (uint64_t w)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll (w);
+#else
+  w = w - ((w >> 1) & 0x5555555555555555ULL);
+  w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+  w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (int)((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+
+//----------------------------------------------------- SelectBit ------------
+//! Returns the bit offset of the nth (1-based) set bit in w
+static inline int SelectBit (uint64_t w, int n)
+{
+  int base = 0;
+
+  //-- Skip whole bytes, then whole bits
+  for ( int c; (c = PopCount (w & 0xff)) < n; w >>= 8, base += 8 )
+    n -= c;
+  for ( ; ; w >>= 1, base ++ )
+    if ( (w & 1) && -- n == 0 )
+      return base;
+}
+
+
 //----------------------------------------------------- indexGaps --------------
 void Contig_t::indexGaps()
 {
   if (gapsvalid_m) { return; }
   gapsvalid_m = true;
 
-  gaps_m.clear();
-
   Pos_t len = getLength();
+  Pos_t words = (len + 63) / 64;
+
+  basebits_m.assign(words, 0);
+  baserank_m.resize(words + 1);
+  baseselect_m.clear();
+  basecount_m = 0;
 
-  for (Pos_t i = 0; i < len; i++)
+  for (Pos_t w = 0; w < words; w++)
   {
-    if (getBase(i).first == '-')
+    Pos_t lo = w * 64;
+    Pos_t hi = lo + 64 < len ? lo + 64 : len;
+    uint64_t bits = 0;
+
+    //-- Uncompressed consensus is read straight from the sequence buffer
+    if (!isCompressed())
     {
-      gaps_m.push_back(i);
+      const uint8_t * seq = seq_m + lo;
+      for (Pos_t i = 0; i < hi - lo; i++)
+        bits |= (uint64_t)(seq[i] != '-') << i;
     }
+    else
+    {
+      for (Pos_t i = lo; i < hi; i++)
+        bits |= (uint64_t)(getBase(i).first != '-') << (i - lo);
+    }
+
+    basebits_m[w] = bits;
+    baserank_m[w] = basecount_m;
+
+    //-- Remember the word holding every 64th base
+    int count = PopCount (bits);
+    for (Pos_t k = basecount_m / 64 + (basecount_m % 64 ? 1 : 0);
+         k * 64 < basecount_m + count; k++)
+      baseselect_m.push_back(w);
+
+    basecount_m += count;
   }
+
+  baserank_m[words] = basecount_m;
 }
 
 
@@ -45,18 +103,17 @@ Pos_t Contig_t::gap2ungap (Pos_t gap)
 {
   indexGaps();
 
-  int l = gaps_m.size();
+  Pos_t len = getLength();
 
-  Pos_t retval = gap;
+  if (gap < 0) { return gap + 1; }
+  if (gap >= len) { return gap + 1 - (len - basecount_m); }
 
-  for (int i = 0; (i < l) && (gaps_m[i] <= gap); i++)
-  {
-    retval--;
-  }
-
-  retval++;
+  //-- Count the bases in [0, gap]
+  Pos_t w = gap / 64;
+  int bit = gap % 64;
+  uint64_t mask = (bit == 63) ? ~(uint64_t)0 : (((uint64_t)1 << (bit + 1)) - 1);
 
-  return retval;
+  return baserank_m[w] + PopCount (basebits_m[w] & mask);
 }
 
 
@@ -65,16 +122,15 @@ Size_t Contig_t::ungap2gap (Pos_t ungap)
 {
   indexGaps();
 
-  int l = gaps_m.size();
+  if (ungap < 1) { return ungap - 1; }
+  if (ungap > basecount_m) { return ungap - 1 + (getLength() - basecount_m); }
 
-  Pos_t retval = ungap-1;
-
-  for (int i = 0; (i < l) && (gaps_m[i] <= retval); i++)
-  {
-    retval++;
-  }
+  //-- Start from the sampled word and step over any long gap runs
+  Pos_t w = baseselect_m[(ungap - 1) / 64];
+  while (baserank_m[w + 1] < ungap)
+    w++;
 
-  return retval;
+  return w * 64 + SelectBit (basebits_m[w], ungap - baserank_m[w]);
 }
 
 
@@ -385,6 +441,21 @@ void Contig_t::readRecordFix (istream & fix)
 }
 
 
+//----------------------------------------------------- readRecordFields -------
+void Contig_t::readRecordFields (istream & fix, BankFields_t fields)
+{
+  gapsvalid_m = false;
+  Sequence_t::readRecordFields (fix, fields);
+
+  readLE (fix, &scf_m);
+  Size_t sizet;
+  readLE (fix, &sizet);
+
+  reads_m.clear();
+  reads_m . resize (sizet);
+}
+
+
 //----------------------------------------------------- readUMD ----------------
 bool Contig_t::readUMD (istream & in)
 {
@@ -36,8 +36,11 @@ class Contig_t : public Sequence_t
 {
   
 private:
-  bool gapsvalid_m;                   //<! indicates if gaps_m is up to date
-  std::vector<Pos_t> gaps_m;          //!< consensus gaps
+  bool gapsvalid_m;                   //<! indicates if the gap index is up to date
+  Size_t basecount_m;                 //!< number of non-gap consensus positions
+  std::vector<uint64_t> basebits_m;   //!< one bit per position, set if not a gap
+  std::vector<Pos_t> baserank_m;      //!< non-gap positions before each word
+  std::vector<Pos_t> baseselect_m;    //!< word holding every 64th non-gap
   std::vector<Tile_t> reads_m;        //!< read tiling
   ID_t scf_m;                         //!< the IID of the parent scaffold 
 
@@ -54,12 +57,30 @@ private:
 
 
   //--------------------------------------------------- indexGaps --------------
-  //! \brief Records the positions of the consensus gaps for fast coordinate translation
+  //! \brief Builds the rank/select gap index for fast coordinate translation
+  //!
+  //! The consensus is packed into a bitvector with one bit per gapped
+  //! position, set for every non-gap. A running count of set bits is kept
+  //! for each 64-bit word (rank) along with the word holding every 64th set
+  //! bit (select), so both translations need a constant number of popcounts.
+  //! The index is built on first use and rebuilt after the consensus changes.
   //!
   void indexGaps();
 
 protected:
 
+  //--------------------------------------------------- sequenceChanged --------
+  //! \brief Invalidates the gap index whenever the consensus is modified
+  //!
+  //! Sequence_t calls this from every mutator, so edits made through a
+  //! Sequence_t reference are seen as well.
+  //!
+  virtual void sequenceChanged ( )
+  {
+    gapsvalid_m = false;
+  }
+
+
   //--------------------------------------------------- readRecord -------------
   virtual void readRecord (std::istream & fix, std::istream & var);
 
@@ -67,6 +88,10 @@ protected:
   //--------------------------------------------------- readRecordFix ----------
   virtual void readRecordFix (std::istream & fix);
 
+  //--------------------------------------------------- readRecordFields -------
+  virtual void readRecordFields (std::istream & fix, BankFields_t fields);
+
+
 
   //--------------------------------------------------- writeRecord ------------
   virtual void writeRecord (std::ostream & fix, std::ostream & var) const;
@@ -82,7 +107,7 @@ public:
   //! \brief Constructs an empty Contig_t object
   //!
   Contig_t ( )
-   : gapsvalid_m(false), scf_m(NULL_ID)
+   : gapsvalid_m(false), basecount_m(0), scf_m(NULL_ID)
   {
 
   }
@@ -110,7 +135,10 @@ public:
   virtual void clear ( )
   {
     Sequence_t::clear( );
-    gaps_m . clear( );
+    basebits_m . clear( );
+    baserank_m . clear( );
+    baseselect_m . clear( );
+    basecount_m = 0;
     reads_m . clear( );
     gapsvalid_m = false;
     scf_m = NULL_ID;
@@ -127,7 +155,9 @@ public:
   //--------------------------------------------------- gap2ungap --------------
   //! \brief Translates a 0-based gapped position (offset) to a 1-based ungapped position (sequence coordinate)
   //!
-  //! This method requires O(num gaps). If the gapped position points to a gap
+  //! This method requires constant time once the gap index is built, the
+  //! first call after the consensus changes requires linear time. If the
+  //! gapped position points to a gap
   //! the returned ungapped position will point to the base immediately
   //! preceeding the gap.
   //!
@@ -141,7 +171,8 @@ public:
   //--------------------------------------------------- ungap2gap --------------
   //! \brief Translates an 1-based ungapped position to a 0-based gapped position
   //!
-  //! This method requires O(number gaps) time.
+  //! This method requires constant time once the gap index is built, the
+  //! first call after the consensus changes requires linear time.
   //!
   //! \param The ungapped position
   //! \pre ungap < getUngappedLength( )
@@ -402,28 +433,6 @@ public:
     reads_m = layout . getTiling( );
   }
 
-  //--------------------------------------------------- setSequence -----------
-  //! \brief Set the consensus sequence of the contig
-  //!
-  //! See Sequence_t::setSequence()
-  //!
-  void setSequence (const char * seq, const char * qual)
-  {
-    gapsvalid_m = false;
-    Sequence_t::setSequence(seq, qual);
-  }
-
-  //--------------------------------------------------- setSequence -----------
-  //! \brief Set the consensus sequence of the contig
-  //!
-  //! See Sequence_t::setSequence()
-  //!
-  void setSequence (const std::string & seq, const std::string & qual)
-  {
-    gapsvalid_m = false;
-    Sequence_t::setSequence(seq, qual);
-  }
-
   //--------------------------------------------------- writeMessage -----------
   virtual void writeMessage (Message_t & msg) const;
 
@@ -106,6 +106,7 @@ void Index_t::buildReadLibrary (const std::string bankname)
 
   frg_bank . open (bankname, B_READ);
   red_bank . open (bankname, B_READ);
+  red_bank . setProjection (P_FRAGMENT);
 
   while ( red_bank >> red )
     {
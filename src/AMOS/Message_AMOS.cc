@@ -9,6 +9,7 @@
 
 #include "Message_AMOS.hh"
 #include <cstdio>
+#include <cstring>
 using namespace AMOS;
 using namespace std;
 using namespace HASHMAP;
@@ -76,8 +77,7 @@ bool Message_t::read (istream & in)
 	//-- If a nested message, read it in
 	else if ( ch == '{' )
 	  {
-	    subs_m . push_back (Message_t ( ));
-	    subs_m . back( ) . read (in);
+	    newSubMessage( ) . read (in);
 	    continue;
 	  }
 	//-- If end of message
@@ -161,6 +161,40 @@ void Message_t::setField (NCode_t fcode, const string & data)
 }
 
 
+//----------------------------------------------------- setField ---------------
+void Message_t::setField (NCode_t fcode, const char * data, Size_t len)
+{
+  if ( len == 0 )
+    return;
+
+  //-- Check pre-conditions
+  if ( data [len - 1] != NL_CHAR  &&  memchr (data, NL_CHAR, len) != NULL )
+    AMOS_THROW_ARGUMENT ("Invalid multi-line message field format");
+
+  //-- Insert new field, overwrite if already exists
+  fields_m [fcode] . assign (data, len);
+}
+
+
+//----------------------------------------------------- newSubMessage ----------
+Message_t & Message_t::newSubMessage ( )
+{
+  //-- Grow by swapping the old sub-messages over instead of copying them
+  if ( subs_m . size( ) == subs_m . capacity( ) )
+    {
+      vector<Message_t> subs;
+      subs . reserve (subs_m . empty( ) ? 4 : subs_m . size( ) * 2);
+      subs . resize (subs_m . size( ));
+      for ( vector<Message_t>::size_type i = 0; i < subs_m . size( ); i ++ )
+	subs [i] . swap (subs_m [i]);
+      subs_m . swap (subs);
+    }
+
+  subs_m . resize (subs_m . size( ) + 1);
+  return subs_m . back( );
+}
+
+
 //----------------------------------------------------- skip -------------------
 NCode_t Message_t::skip (istream & in) // static const
 {
@@ -204,11 +238,27 @@ NCode_t Message_t::skip (istream & in) // static const
 
 //----------------------------------------------------- write ------------------
 void Message_t::write (ostream & out) const
+{
+  //-- Format the whole message, then hand it to the stream at once
+  string buff;
+  write (buff);
+  out . write (buff . data( ), buff . size( ));
+
+  //-- Check stream 'goodness'
+  if ( !out . good( ) )
+    AMOS_THROW_IO ("Message write failure");
+}
+
+
+//----------------------------------------------------- write ------------------
+void Message_t::write (string & out) const
 {
   bool mline = false;
 
   //-- Write opening of message
-  out << '{' << Decode (mcode_m) << endl;
+  out += '{';
+  out += Decode (mcode_m);
+  out += NL_CHAR;
 
   //-- Write all fields
   hash_map<NCode_t,string>::const_iterator mi;
@@ -217,24 +267,299 @@ void Message_t::write (ostream & out) const
       //-- Set multi-line message flag
       mline = *(mi -> second . rbegin( )) == NL_CHAR ? true : false;
 
-      out << Decode (mi -> first) << FIELD_SEPARATOR;
+      out += Decode (mi -> first);
+      out += FIELD_SEPARATOR;
       if ( mline )
-	out . put (NL_CHAR);
-      out << mi -> second;
+	out += NL_CHAR;
+      out += mi -> second;
       if ( mline )
-	out . put (FIELD_TERMINATOR);
-      out . put (NL_CHAR);
+	out += FIELD_TERMINATOR;
+      out += NL_CHAR;
     }
 
   //-- Write all sub-messages
- vector<Message_t>::const_iterator vi;
+  vector<Message_t>::const_iterator vi;
   for ( vi = subs_m . begin( ); vi != subs_m . end( ); vi ++ )
     vi -> write (out);
 
   //-- Close out message
-  out << '}' << endl;
+  out += '}';
+  out += NL_CHAR;
+}
 
-  //-- Check stream 'goodness'
-  if ( !out . good( ) )
-    AMOS_THROW_IO ("Message write failure");
+
+
+
+//================================================ MessageReader_t =============
+//----------------------------------------------------- MessageReader_t --------
+MessageReader_t::MessageReader_t (istream & in, size_t block)
+  : in_m (&in), block_m (block > 0 ? block : 1),
+    size_m (0), pos_m (0), offset_m (0), eof_m (false)
+{
+
+}
+
+
+//----------------------------------------------------- MessageReader_t --------
+MessageReader_t::MessageReader_t (const string & text)
+  : in_m (NULL), buff_m (text . begin( ), text . end( )), block_m (1),
+    size_m (text . size( )), pos_m (0), offset_m (0), eof_m (true)
+{
+
+}
+
+
+//----------------------------------------------------- fill -------------------
+bool MessageReader_t::fill ( )
+{
+  if ( eof_m )
+    return false;
+
+  if ( buff_m . size( ) < size_m + block_m )
+    buff_m . resize (size_m + block_m);
+
+  in_m -> read (&buff_m [size_m], block_m);
+  streamsize n = in_m -> gcount( );
+
+  if ( !in_m -> good( ) )
+    eof_m = true;
+  if ( n <= 0 )
+    return false;
+
+  size_m += n;
+  return true;
+}
+
+
+//----------------------------------------------------- compact ----------------
+void MessageReader_t::compact ( )
+{
+  //-- Drop the parsed chars once they outnumber the unparsed ones, so the
+  //   total cost of moving the buffer stays linear in the input size
+  if ( pos_m > 0  &&  pos_m >= size_m - pos_m )
+    {
+      if ( size_m > pos_m )
+	memmove (&buff_m [0], &buff_m [pos_m], size_m - pos_m);
+      offset_m += pos_m;
+      size_m -= pos_m;
+      pos_m = 0;
+    }
+}
+
+
+//----------------------------------------------------- find -------------------
+size_t MessageReader_t::find (size_t pos, char ch)
+{
+  while ( true )
+    {
+      if ( pos < size_m )
+	{
+	  const char * beg = &buff_m [0];
+	  const char * p = (const char *) memchr (beg + pos, ch, size_m - pos);
+	  if ( p != NULL )
+	    return p - beg;
+	  pos = size_m;
+	}
+
+      if ( !fill( ) )
+	return size_m;
+    }
+}
+
+
+//----------------------------------------------------- read -------------------
+bool MessageReader_t::read (Message_t & msg)
+{
+  compact( );
+
+  //-- Search for the beginning of the message
+  pos_m = find (pos_m, '{');
+  if ( pos_m == size_m )
+    return false;
+  pos_m ++;
+
+  //-- Empty the object
+  msg . clear( );
+
+  try {
+    parse (msg);
+  }
+  catch (Exception_t) {
+
+    //-- Clean up and rethrow
+    msg . clear( );
+    throw;
+  }
+
+  return true;
+}
+
+
+//----------------------------------------------------- readText ---------------
+bool MessageReader_t::readText (string & text)
+{
+  compact( );
+
+  //-- Search for the beginning of the message
+  pos_m = find (pos_m, '{');
+  if ( pos_m == size_m )
+    return false;
+
+  //-- Find its end from the nesting alone, without parsing the fields
+  size_t beg = pos_m ++;
+  scan( );
+
+  text . assign (&buff_m [beg], pos_m - beg);
+  return true;
+}
+
+
+//----------------------------------------------------- parse ------------------
+void MessageReader_t::parse (Message_t & msg)
+{
+  size_t beg, end;
+  NCode_t mcode, fcode;
+
+  //-- Get the type name
+  if ( !ensure (NCODE_SIZE + 1)  ||  buff_m [pos_m + NCODE_SIZE] != NL_CHAR )
+    AMOS_THROW_IO ("Could not parse message NCode: " +
+		   string (buff_m . begin( ) + pos_m, buff_m . begin( ) +
+			   min (pos_m + NCODE_SIZE, size_m)));
+  mcode = Encode (string (&buff_m [pos_m], NCODE_SIZE));
+  msg . setMessageCode (mcode);
+  pos_m += NCODE_SIZE + 1;
+
+  //-- Until end of message
+  while ( true )
+    {
+      //-- If unexpected EOF
+      if ( !ensure (1) )
+	AMOS_THROW_IO ("Unbalanced message nesting");
+
+      //-- If a nested message, build it in place
+      if ( buff_m [pos_m] == '{' )
+	{
+	  pos_m ++;
+	  parse (msg . newSubMessage( ));
+	  continue;
+	}
+      //-- If end of message
+      else if ( buff_m [pos_m] == '}' )
+	{
+	  end = find (pos_m, NL_CHAR);
+	  pos_m = end == size_m ? size_m : end + 1;
+	  break;
+	}
+      //-- If spacing
+      else if ( buff_m [pos_m] == NL_CHAR )
+	{
+	  pos_m ++;
+	  continue;
+	}
+
+      //-- Get the field name
+      if ( !ensure (NCODE_SIZE + 1)  ||
+	   buff_m [pos_m + NCODE_SIZE] != FIELD_SEPARATOR )
+	AMOS_THROW_IO ("Could not parse field code in '" +
+		       Decode (mcode) + "' message");
+      fcode = Encode (string (&buff_m [pos_m], NCODE_SIZE));
+      pos_m += NCODE_SIZE + 1;
+
+      //-- Find the end of the first line of the field
+      end = find (pos_m, NL_CHAR);
+      if ( end == size_m )
+	AMOS_THROW_IO ("Could not parse single-line field data in '" +
+		       Decode (mcode) + "' message");
+
+      //-- If single-line field
+      if ( end != pos_m )
+	{
+	  msg . setField (fcode, &buff_m [pos_m], end - pos_m);
+	  pos_m = end + 1;
+	  continue;
+	}
+
+      //-- Multi-line field, find the '.' that starts a line and ends one
+      beg = end = pos_m + 1;
+      while ( true )
+	{
+	  end = find (end, FIELD_TERMINATOR);
+	  if ( end == size_m )
+	    AMOS_THROW_IO ("Unterminated multi-line field in '" +
+			   Decode (mcode) + "' message");
+
+	  if ( end == beg  ||  buff_m [end - 1] == NL_CHAR )
+	    {
+	      while ( end + 1 >= size_m )
+		if ( !fill( ) )
+		  AMOS_THROW_IO ("Unterminated multi-line field in '" +
+				 Decode (mcode) + "' message");
+	      if ( buff_m [end + 1] == NL_CHAR )
+		break;
+	    }
+
+	  end ++;
+	}
+
+      msg . setField (fcode, &buff_m [beg], end - beg);
+      pos_m = end + 2;
+    }
+}
+
+
+//----------------------------------------------------- skip -------------------
+NCode_t MessageReader_t::skip ( )
+{
+  compact( );
+
+  //-- Search for the beginning of the message
+  pos_m = find (pos_m, '{');
+  if ( pos_m == size_m )
+    return NULL_NCODE;
+  pos_m ++;
+
+  return scan( );
+}
+
+
+//----------------------------------------------------- scan -------------------
+NCode_t MessageReader_t::scan ( )
+{
+  int level;
+  size_t end;
+
+  //-- Get the type name
+  if ( !ensure (NCODE_SIZE + 1)  ||  buff_m [pos_m + NCODE_SIZE] != NL_CHAR )
+    AMOS_THROW_IO ("Could not parse message header: " +
+		   string (buff_m . begin( ) + pos_m, buff_m . begin( ) +
+			   min (pos_m + NCODE_SIZE, size_m)));
+  NCode_t mcode = Encode (string (&buff_m [pos_m], NCODE_SIZE));
+  pos_m += NCODE_SIZE + 1;
+
+  //-- Until end of message, jump from one '}' to the next and count the
+  //   nested messages opened before it; either only counts at line start
+  level = 1;
+  while ( level != 0 )
+    {
+      end = find (pos_m, '}');
+      if ( end == size_m )
+	AMOS_THROW_IO ("Unbalanced message nesting");
+
+      const char * p = &buff_m [pos_m];
+      const char * q = &buff_m [end];
+      while ( (p = (const char *) memchr (p, '{', q - p)) != NULL )
+	{
+	  if ( p [-1] == NL_CHAR )
+	    level ++;
+	  p ++;
+	}
+      if ( q [-1] == NL_CHAR )
+	level --;
+
+      //-- Suck in rest of line
+      pos_m = find (end, NL_CHAR);
+      pos_m = pos_m == size_m ? size_m : pos_m + 1;
+    }
+
+  return mcode;
 }
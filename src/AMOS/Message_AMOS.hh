@@ -292,6 +292,18 @@ public:
   }
 
 
+  //--------------------------------------------------- newSubMessage ----------
+  //! \brief Appends an empty sub-message and returns a reference to it
+  //!
+  //! Lets a parser build nested messages in place. When the sub-message
+  //! vector has to grow, the existing sub-messages are swapped rather than
+  //! copied into the new storage, so deep messages are never duplicated.
+  //!
+  //! \return The new, empty sub-message
+  //!
+  Message_t & newSubMessage ( );
+
+
   //--------------------------------------------------- getMessageCode ---------
   //! \brief Get the NCode type  of this message
   //!
@@ -394,6 +406,22 @@ public:
   void setField (NCode_t fcode, const std::string & data);
 
 
+  //--------------------------------------------------- setField ---------------
+  //! \brief Set field data by field NCode from a character range
+  //!
+  //! Same as the string version, but copies the data straight from a parse
+  //! buffer without building a temporary string.
+  //!
+  //! \param fcode The field NCode
+  //! \param data The new field data
+  //! \param len The length of data
+  //! \pre The data field ends in '\n' if it is multiple lines
+  //! \throws ArugmentException_t
+  //! \return void
+  //!
+  void setField (NCode_t fcode, const char * data, Size_t len);
+
+
   //--------------------------------------------------- setField ---------------
   //! \brief Set field data by field name
   //!
@@ -461,6 +489,20 @@ public:
   static NCode_t skip (std::istream & in); // const
 
 
+  //--------------------------------------------------- swap -------------------
+  //! \brief Swaps the contents of two messages in constant time
+  //!
+  //! \param msg The message to swap with
+  //! \return void
+  //!
+  void swap (Message_t & msg)
+  {
+    std::swap (mcode_m, msg . mcode_m);
+    subs_m . swap (msg . subs_m);
+    fields_m . swap (msg . fields_m);
+  }
+
+
   //--------------------------------------------------- write ------------------
   //! \brief Write the message object to an output stream
   //!
@@ -475,6 +517,165 @@ public:
   //!
   void write (std::ostream & out) const;
 
+
+  //--------------------------------------------------- write ------------------
+  //! \brief Appends the NCode ASCII representation of the message to a string
+  //!
+  //! The stream version formats into a string with this method and hands it
+  //! to the stream in a single write.
+  //!
+  //! \param out The string to append to
+  //! \return void
+  //!
+  void write (std::string & out) const;
+
+};
+
+
+
+
+//================================================ MessageReader_t =============
+//! \brief A buffered reader for streams of NCode messages
+//!
+//! Reads the input stream in large blocks and parses messages directly out
+//! of the block with memchr, instead of going through the istream a
+//! character at a time. Accepts exactly the same grammar as Message_t::read
+//! and throws the same exceptions, but since it reads ahead, the underlying
+//! stream should not be used directly while the reader is in use. Use tell
+//! instead of tellg to find the position of the last parsed message.
+//!
+//==============================================================================
+class MessageReader_t
+{
+
+private:
+
+  std::istream * in_m;              //!< the input stream, or NULL
+  std::vector<char> buff_m;         //!< the parse buffer
+  size_t block_m;                   //!< read block size
+  size_t size_m;                    //!< number of valid chars in buff_m
+  size_t pos_m;                     //!< parse position in buff_m
+  std::streamoff offset_m;          //!< input offset of buff_m [0]
+  bool eof_m;                       //!< true if in_m has been exhausted
+
+
+  //--------------------------------------------------- compact ----------------
+  //! \brief Discards already parsed chars from the front of the buffer
+  //!
+  void compact ( );
+
+
+  //--------------------------------------------------- fill -------------------
+  //! \brief Reads another block from the stream, returns false on EOF
+  //!
+  bool fill ( );
+
+
+  //--------------------------------------------------- ensure -----------------
+  //! \brief Makes sure n chars are buffered past pos_m, returns false on EOF
+  //!
+  bool ensure (size_t n)
+  {
+    while ( size_m - pos_m < n )
+      if ( !fill( ) )
+        return false;
+    return true;
+  }
+
+
+  //--------------------------------------------------- find -------------------
+  //! \brief Finds the next ch at or after pos, buffering as needed
+  //!
+  //! \return The buffer index of ch, or size_m if EOF was reached first
+  //!
+  size_t find (size_t pos, char ch);
+
+
+  //--------------------------------------------------- parse ------------------
+  //! \brief Parses the body of a message whose '{' has been consumed
+  //!
+  void parse (Message_t & msg);
+
+
+  //--------------------------------------------------- scan -------------------
+  //! \brief Moves past the body of a message whose '{' has been consumed
+  //!
+  //! Only the message code and the nesting of the lines that start with
+  //! '{' or '}' are checked, as for skip.
+  //!
+  //! \return NCode of the message
+  //!
+  NCode_t scan ( );
+
+
+public:
+
+  //--------------------------------------------------- MessageReader_t --------
+  //! \brief Constructs a reader on an open input stream
+  //!
+  //! \param in The input stream to read from
+  //! \param block The number of chars to read from the stream at a time
+  //!
+  MessageReader_t (std::istream & in, size_t block = 1024 * 1024);
+
+
+  //--------------------------------------------------- MessageReader_t --------
+  //! \brief Constructs a reader on a copy of an in-memory message string
+  //!
+  //! \param text The messages to read, e.g. from readText
+  //!
+  MessageReader_t (const std::string & text);
+
+
+  //--------------------------------------------------- read -------------------
+  //! \brief Read the next message from the stream
+  //!
+  //! \param msg The message to populate
+  //! \pre The incoming message is properly formatted
+  //! \throws IOException_t
+  //! \return true if a message was read, false if no message read (EOF)
+  //!
+  bool read (Message_t & msg);
+
+
+  //--------------------------------------------------- readText ---------------
+  //! \brief Reads the raw text of the next message from the stream
+  //!
+  //! The end of the message is found from its nesting alone, as skip
+  //! finds it, so the fields are not parsed or checked; read the text with
+  //! a MessageReader_t of its own for that. This lets callers split the
+  //! input at top-level message boundaries cheaply and parse the pieces
+  //! elsewhere, e.g. on other threads.
+  //!
+  //! \param text The string to store the message text in
+  //! \pre The incoming message is properly formatted
+  //! \throws IOException_t
+  //! \return true if a message was read, false if no message read (EOF)
+  //!
+  bool readText (std::string & text);
+
+
+  //--------------------------------------------------- skip -------------------
+  //! \brief Skips the next message, returning its NCode
+  //!
+  //! Like Message_t::skip, only the message code and nesting are checked.
+  //!
+  //! \throws IOException_t
+  //! \return NCode of the skipped message, or NULL_NCODE if no message found
+  //!
+  NCode_t skip ( );
+
+
+  //--------------------------------------------------- tell -------------------
+  //! \brief Returns the offset just past the last parsed message
+  //!
+  //! The offset is relative to the stream position the reader started at.
+  //!
+  std::streamoff tell ( ) const
+  {
+    return offset_m + pos_m;
+  }
+
 };
 
 
@@ -135,6 +135,43 @@ void Overlap_t::readRecordFix (istream & fix)
 }
 
 
+//----------------------------------------------------- readRecordFields -------
+void Overlap_t::readRecordFields (istream & fix, BankFields_t fields)
+{
+  Oriented_t::readRecordFix (fix);
+
+  if ( fields & P_HANGS )
+    {
+      readLE (fix, &aHang_m);
+      readLE (fix, &bHang_m);
+    }
+  else
+    {
+      fix . ignore (sizeof (Size_t) * 2);
+      aHang_m = bHang_m = 0;
+    }
+
+  if ( fields & P_READS )
+    {
+      readLE (fix, &(reads_m . first));
+      readLE (fix, &(reads_m . second));
+    }
+  else
+    {
+      fix . ignore (sizeof (ID_t) * 2);
+      reads_m . first = reads_m . second = NULL_ID;
+    }
+
+  if ( fields & P_HANGS )
+    readLE (fix, &score_m);
+  else
+    {
+      fix . ignore (sizeof (score_m));
+      score_m = 0;
+    }
+}
+
+
 //----------------------------------------------------- writeMessage -----------
 void Overlap_t::writeMessage (Message_t & msg) const
 {
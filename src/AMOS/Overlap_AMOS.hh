@@ -53,6 +53,10 @@ protected:
   //--------------------------------------------------- readRecordFix ----------
   virtual void readRecordFix (std::istream & fix);
 
+  //--------------------------------------------------- readRecordFields -------
+  virtual void readRecordFields (std::istream & fix, BankFields_t fields);
+
+
   //--------------------------------------------------- writeRecord ------------
   virtual void writeRecord (std::ostream & fix, std::ostream & var) const;
 
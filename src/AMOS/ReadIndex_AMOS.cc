@@ -0,0 +1,494 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Source for ReadIndex_t
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ReadIndex_AMOS.hh"
+#include "Bank_AMOS.hh"
+#include "BankStream_AMOS.hh"
+#include "Contig_AMOS.hh"
+#include "Fragment_AMOS.hh"
+#include "Read_AMOS.hh"
+#include "Scaffold_AMOS.hh"
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace AMOS;
+using namespace std;
+
+
+
+
+//================================================ ReadIndex_t =================
+const string ReadIndex_t::STORE_SUFFIX = ".rdx";
+
+static const char INDEX_MAGIC [8] = {'A','M','O','S','R','D','X','1'};
+static const uint32_t INDEX_ORDER = 0x01020304;
+
+typedef ReadIndex_t::Record_t Record_t;
+
+
+//-- File layout: header, the read records sorted by IID, padding to 8 bytes,
+//   and the state of every contig at the last update sorted by BID
+struct ReadIndex_t::Header_t
+{
+  char magic [8];           //!< INDEX_MAGIC
+  uint32_t order;           //!< INDEX_ORDER in the writer's byte order
+  uint32_t pad;
+  uint64_t nreads;          //!< record count
+  uint64_t ncontigs;        //!< contig state count
+  int64_t stamp [8];        //!< read, fragment, contig, scaffold store stamps
+};
+
+struct ReadIndex_t::ContigState_t
+{
+  ID_t bid;                 //!< contig BID
+  ID_t iid;                 //!< contig IID
+  int64_t vpos;             //!< var store offset, changes on every replace
+};
+
+
+//----------------------------------------------------- IndexPath --------------
+static string IndexPath (const string & bankname)
+{
+  return bankname + '/' + Decode (Read_t::NCODE) + ReadIndex_t::STORE_SUFFIX;
+}
+
+
+//----------------------------------------------------- StampBank --------------
+static void StampBank (const string & bankname, int64_t * stamp)
+{
+  Bank_t::getStoreStamp (bankname, Read_t::NCODE, stamp);
+  Bank_t::getStoreStamp (bankname, Fragment_t::NCODE, stamp + 2);
+  Bank_t::getStoreStamp (bankname, Contig_t::NCODE, stamp + 4);
+  Bank_t::getStoreStamp (bankname, Scaffold_t::NCODE, stamp + 6);
+}
+
+
+//----------------------------------------------------- RecordLess -------------
+static bool RecordLess (const Record_t & a, const Record_t & b)
+{
+  return a . read < b . read;
+}
+
+
+//----------------------------------------------------- FindRecord -------------
+static Record_t * FindRecord (vector<Record_t> & records, ID_t read)
+{
+  Record_t key;
+  key . read = read;
+  vector<Record_t>::iterator i =
+    lower_bound (records . begin( ), records . end( ), key, RecordLess);
+  return (i != records . end( )  &&  i -> read == read) ? &*i : NULL;
+}
+
+
+//----------------------------------------------------- ReadIndex_t ------------
+ReadIndex_t::ReadIndex_t ( )
+  : data_m (NULL), size_m (0),
+    header_m (NULL), records_m (NULL), contigs_m (NULL)
+{
+
+}
+
+
+//----------------------------------------------------- ~ReadIndex_t -----------
+ReadIndex_t::~ReadIndex_t ( )
+{
+  close( );
+}
+
+
+//----------------------------------------------------- build ------------------
+void ReadIndex_t::build (const string & bankname)
+{
+  vector<Record_t> records;
+  Record_t rec;
+  Header_t header;
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header . magic, INDEX_MAGIC, sizeof (INDEX_MAGIC));
+  header . order = INDEX_ORDER;
+  StampBank (bankname, header . stamp);
+
+  //-- One record per read, from the fixed store
+  BankStream_t red_bank (Read_t::NCODE);
+  Read_t red;
+
+  memset (&rec, 0, sizeof (rec));
+  red_bank . open (bankname, B_READ);
+  red_bank . setProjection (P_FRAGMENT);
+  records . reserve (red_bank . getSize( ));
+
+  while ( red_bank >> red )
+    {
+      if ( red . getIID( ) == NULL_ID )
+        continue;
+      rec . read = red . getIID( );
+      rec . fragment = red . getFragment( );
+      records . push_back (rec);
+    }
+  red_bank . close( );
+
+  sort (records . begin( ), records . end( ), RecordLess);
+
+  //-- Mates come from the fragments, libraries and types through the reads
+  BankStream_t frg_bank (Fragment_t::NCODE);
+  if ( frg_bank . exists (bankname) )
+    {
+      HASHMAP::hash_map<ID_t, pair<ID_t, FragmentType_t> > frags;
+      HASHMAP::hash_map<ID_t, pair<ID_t, FragmentType_t> >::iterator fi;
+      Fragment_t frg;
+      Record_t * r;
+
+      frg_bank . open (bankname, B_READ);
+      frg_bank . setFixedStoreOnly (true);
+
+      while ( frg_bank >> frg )
+        {
+          frags [frg . getIID( )] = make_pair (frg . getLibrary( ), frg . getType( ));
+
+          pair<ID_t, ID_t> mates = frg . getMatePair( );
+          if ( mates . first  &&  (r = FindRecord (records, mates . first)) )
+            r -> mate = mates . second;
+          if ( mates . second  &&  (r = FindRecord (records, mates . second)) )
+            r -> mate = mates . first;
+        }
+      frg_bank . close( );
+
+      for ( vector<Record_t>::iterator i = records . begin( );
+            i != records . end( ); ++ i )
+        if ( i -> fragment != NULL_ID  &&
+             (fi = frags . find (i -> fragment)) != frags . end( ) )
+          {
+            i -> library = fi -> second . first;
+            i -> type = fi -> second . second;
+          }
+    }
+
+  write (bankname, header, records, vector<ContigState_t>( ));
+}
+
+
+//----------------------------------------------------- update -----------------
+bool ReadIndex_t::update (const string & bankname)
+{
+  vector<Record_t> records;
+  vector<ContigState_t> known;
+  Header_t header;
+  int64_t stamp [8];
+
+  {
+    ReadIndex_t index;
+    try {
+      index . map (bankname);
+    }
+    catch (const IOException_t &) {
+      build (bankname);
+      return true;
+    }
+
+    StampBank (bankname, stamp);
+    if ( memcmp (stamp, index . header_m -> stamp, sizeof (stamp)) == 0 )
+      return false;
+
+    //-- New or edited reads and fragments can move any record
+    if ( memcmp (stamp, index . header_m -> stamp, 4 * sizeof (int64_t)) != 0 )
+      {
+        index . close( );
+        build (bankname);
+        return true;
+      }
+
+    header = *index . header_m;
+    records . assign (index . records_m, index . records_m + header . nreads);
+    known . assign (index . contigs_m, index . contigs_m + header . ncontigs);
+  }
+
+  memcpy (header . stamp, stamp, sizeof (stamp));
+  write (bankname, header, records, known);
+  return true;
+}
+
+
+//----------------------------------------------------- write ------------------
+void ReadIndex_t::write (const string & bankname,
+                         Header_t & header,
+                         vector<Record_t> & records,
+                         const vector<ContigState_t> & known)
+{
+  vector<ContigState_t> contigs;
+  vector<ID_t> stale, dirty;
+  vector<Record_t>::iterator ri;
+  Record_t * r;
+
+  //-- Compare the contig fixed store against the last update, both by BID
+  BankStream_t ctg_bank (Contig_t::NCODE);
+  if ( ctg_bank . exists (bankname) )
+    {
+      vector<ContigState_t>::const_iterator ki = known . begin( );
+      AMOS::Contig_t ctg;
+      ContigState_t cs;
+
+      ctg_bank . open (bankname, B_READ);
+      ctg_bank . setFixedStoreOnly (true);
+
+      while ( ctg_bank >> ctg )
+        {
+          cs . bid = ctg_bank . tellg( ) - 1;
+          cs . iid = ctg . getIID( );
+          cs . vpos = ctg_bank . tellv( );
+          if ( cs . iid == NULL_ID )
+            continue;
+          contigs . push_back (cs);
+
+          //-- Known contigs skipped over have been removed
+          for ( ; ki != known . end( )  &&  ki -> bid < cs . bid; ++ ki )
+            stale . push_back (ki -> iid);
+
+          if ( ki != known . end( )  &&  ki -> bid == cs . bid )
+            {
+              if ( ki -> iid == cs . iid  &&  ki -> vpos == cs . vpos )
+                {
+                  ++ ki;
+                  continue;
+                }
+              stale . push_back (ki -> iid);
+              ++ ki;
+            }
+          dirty . push_back (cs . bid);
+        }
+
+      for ( ; ki != known . end( ); ++ ki )
+        stale . push_back (ki -> iid);
+    }
+  else
+    {
+      for ( vector<ContigState_t>::const_iterator
+              ki = known . begin( ); ki != known . end( ); ++ ki )
+        stale . push_back (ki -> iid);
+    }
+
+  //-- Unlink the reads of changed contigs, then relink from the new tilings
+  sort (stale . begin( ), stale . end( ));
+  if ( ! stale . empty( ) )
+    for ( ri = records . begin( ); ri != records . end( ); ++ ri )
+      if ( binary_search (stale . begin( ), stale . end( ), ri -> contig) )
+        ri -> contig = NULL_ID;
+
+  if ( ! dirty . empty( ) )
+    {
+      AMOS::Contig_t ctg;
+
+      ctg_bank . setFixedStoreOnly (false);
+      for ( vector<ID_t>::iterator di = dirty . begin( );
+            di != dirty . end( ); ++ di )
+        {
+          ctg_bank . seekg (*di);
+          ctg_bank >> ctg;
+
+          const vector<Tile_t> & tiling = ctg . getReadTiling( );
+          for ( vector<Tile_t>::const_iterator
+                  ti = tiling . begin( ); ti != tiling . end( ); ++ ti )
+            if ( (r = FindRecord (records, ti -> source)) != NULL )
+              r -> contig = ctg . getIID( );
+        }
+    }
+
+  if ( ctg_bank . isOpen( ) )
+    ctg_bank . close( );
+
+  //-- Scaffolds are few, always reapply them all
+  HASHMAP::hash_map<ID_t, ID_t> scaffs;
+  HASHMAP::hash_map<ID_t, ID_t>::iterator si;
+
+  BankStream_t scf_bank (Scaffold_t::NCODE);
+  if ( scf_bank . exists (bankname) )
+    {
+      Scaffold_t scf;
+
+      scf_bank . open (bankname, B_READ);
+      while ( scf_bank >> scf )
+        {
+          const vector<Tile_t> & tiling = scf . getContigTiling( );
+          for ( vector<Tile_t>::const_iterator
+                  ti = tiling . begin( ); ti != tiling . end( ); ++ ti )
+            scaffs [ti -> source] = scf . getIID( );
+        }
+      scf_bank . close( );
+    }
+
+  for ( ri = records . begin( ); ri != records . end( ); ++ ri )
+    ri -> scaffold = (ri -> contig != NULL_ID  &&
+                      (si = scaffs . find (ri -> contig)) != scaffs . end( ))
+      ? si -> second : NULL_ID;
+
+  header . nreads = records . size( );
+  header . ncontigs = contigs . size( );
+
+  //-- Write to a temporary and rename, so readers never see a partial file
+  string path = IndexPath (bankname);
+  string tmp = Bank_t::makeTempStore (path);
+  ofstream out (tmp . c_str( ), ios::out | ios::binary | ios::trunc);
+  if ( ! out )
+    {
+      unlink (tmp . c_str( ));
+      AMOS_THROW_IO ("Could not open read index, " + tmp);
+    }
+
+  static const char PAD [8] = {0};
+  out . write ((const char *) &header, sizeof (header));
+  if ( ! records . empty( ) )
+    out . write ((const char *) &records[0], records . size( ) * sizeof (Record_t));
+  out . write (PAD, (8 - (records . size( ) * sizeof (Record_t)) % 8) % 8);
+  if ( ! contigs . empty( ) )
+    out . write ((const char *) &contigs[0],
+                 contigs . size( ) * sizeof (ContigState_t));
+  out . close( );
+
+  if ( out . fail( ) )
+    {
+      unlink (tmp . c_str( ));
+      AMOS_THROW_IO ("Could not write read index, " + tmp);
+    }
+
+  if ( rename (tmp . c_str( ), path . c_str( )) != 0 )
+    {
+      string err = strerror (errno);
+      unlink (tmp . c_str( ));
+      AMOS_THROW_IO ("Could not rename read index, " + path + ", " + err);
+    }
+}
+
+
+//----------------------------------------------------- exists -----------------
+bool ReadIndex_t::exists (const string & bankname)
+{
+  return ! access (IndexPath (bankname) . c_str( ), R_OK);
+}
+
+
+//----------------------------------------------------- isCurrent --------------
+bool ReadIndex_t::isCurrent (const string & bankname)
+{
+  try {
+    ReadIndex_t index;
+    index . open (bankname);
+  }
+  catch (const IOException_t &) {
+    return false;
+  }
+  return true;
+}
+
+
+//----------------------------------------------------- open -------------------
+void ReadIndex_t::open (const string & bankname)
+{
+  map (bankname);
+
+  int64_t stamp [8];
+  StampBank (bankname, stamp);
+  if ( memcmp (stamp, header_m -> stamp, sizeof (stamp)) != 0 )
+    {
+      close( );
+      AMOS_THROW_IO ("Read index is older than the bank, " +
+                     IndexPath (bankname));
+    }
+}
+
+
+//----------------------------------------------------- map --------------------
+void ReadIndex_t::map (const string & bankname)
+{
+  close( );
+
+  string path = IndexPath (bankname);
+  struct stat st;
+
+  int fd = ::open (path . c_str( ), O_RDONLY);
+  if ( fd == -1 )
+    AMOS_THROW_IO ("Could not open read index, " + path +
+                   ", " + strerror (errno));
+
+  if ( fstat (fd, &st) == -1  ||  st . st_size < (off_t) sizeof (Header_t) )
+    {
+      ::close (fd);
+      AMOS_THROW_IO ("Could not read read index, " + path);
+    }
+
+  void * p = mmap (NULL, st . st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close (fd);
+  if ( p == MAP_FAILED )
+    AMOS_THROW_IO ("Could not map read index, " + path +
+                   ", " + strerror (errno));
+
+  data_m = (char *) p;
+  size_m = st . st_size;
+  header_m = (const Header_t *) data_m;
+
+  //-- Check the format, the byte order and that the layout fits the file
+  uint64_t dir = sizeof (Header_t) + header_m -> nreads * sizeof (Record_t);
+  dir += (8 - dir % 8) % 8;
+
+  if ( memcmp (header_m -> magic, INDEX_MAGIC, sizeof (INDEX_MAGIC)) != 0  ||
+       header_m -> order != INDEX_ORDER  ||
+       dir + header_m -> ncontigs * sizeof (ContigState_t) != size_m )
+    {
+      close( );
+      AMOS_THROW_IO ("Not a read index for this platform, " + path);
+    }
+
+  records_m = (const Record_t *) (data_m + sizeof (Header_t));
+  contigs_m = (const ContigState_t *) (data_m + dir);
+}
+
+
+//----------------------------------------------------- close ------------------
+void ReadIndex_t::close ( )
+{
+  if ( data_m != NULL )
+    munmap (data_m, size_m);
+
+  data_m = NULL;
+  size_m = 0;
+  header_m = NULL;
+  records_m = NULL;
+  contigs_m = NULL;
+}
+
+
+//----------------------------------------------------- getSize ----------------
+Size_t ReadIndex_t::getSize ( ) const
+{
+  return header_m == NULL ? 0 : header_m -> nreads;
+}
+
+
+//----------------------------------------------------- find -------------------
+const Record_t * ReadIndex_t::find (ID_t read) const
+{
+  if ( header_m == NULL )
+    return NULL;
+
+  const Record_t * lo = records_m;
+  const Record_t * hi = records_m + header_m -> nreads;
+
+  while ( lo < hi )
+    {
+      const Record_t * mid = lo + (hi - lo) / 2;
+      if ( mid -> read < read )
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return (lo != records_m + header_m -> nreads  &&  lo -> read == read)
+    ? lo : NULL;
+}
@@ -0,0 +1,257 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Header for ReadIndex_t
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __ReadIndex_AMOS_HH
+#define __ReadIndex_AMOS_HH 1
+
+#include "datatypes_AMOS.hh"
+#include <string>
+#include <vector>
+
+
+
+
+namespace AMOS {
+
+//================================================ ReadIndex_t =================
+//! \brief An on-disk reverse index from reads to their fragment, library,
+//! mate, contig and scaffold
+//!
+//! The persistent counterpart of the read lookups in Index_t. The index is a
+//! single file in the bank directory holding one fixed size record per read,
+//! sorted by read IID, so it can be memory mapped and searched in place
+//! instead of being rebuilt by scanning the read, fragment and contig banks
+//! each time a bank is opened.
+//!
+//! The file records a fingerprint of the read, fragment, contig and scaffold
+//! stores it was built from, and open refuses a stale file. update brings a
+//! stale file up to date: a change to the reads or fragments rebuilds it, but
+//! contig appends, replaces and removes only refetch the contigs that changed
+//! since the last update, found from the fixed store alone, before the
+//! scaffolds are reapplied.
+//!
+//==============================================================================
+class ReadIndex_t
+{
+
+public:
+
+  //============================================== Record_t ====================
+  //! \brief The index record of one read, NULL_ID where there is no link
+  //!
+  struct Record_t
+  {
+    ID_t read;          //!< read IID
+    ID_t fragment;      //!< fragment IID
+    ID_t library;       //!< library IID of the fragment
+    ID_t mate;          //!< IID of the other read of the fragment
+    ID_t contig;        //!< IID of the contig tiling the read
+    ID_t scaffold;      //!< IID of the scaffold tiling the contig
+    uint32_t type;      //!< FragmentType_t of the fragment
+  };
+
+
+  static const std::string STORE_SUFFIX;  //!< the index file suffix
+
+
+  //--------------------------------------------------- ReadIndex_t ------------
+  //! \brief Constructs an unopened index
+  //!
+  ReadIndex_t ( );
+
+
+  //--------------------------------------------------- ~ReadIndex_t -----------
+  //! \brief Closes the index if it is open
+  //!
+  ~ReadIndex_t ( );
+
+
+  //--------------------------------------------------- build ------------------
+  //! \brief Builds the index file for a bank from scratch
+  //!
+  //! Streams the read and fragment fixed stores, then the contig and
+  //! scaffold banks if there are any, and (re)writes the index file. Needs
+  //! memory for one record per read.
+  //!
+  //! \param bankname Name of the bank directory to index
+  //! \pre The bank has a read store
+  //! \throws IOException_t
+  //! \return void
+  //!
+  static void build (const std::string & bankname);
+
+
+  //--------------------------------------------------- update -----------------
+  //! \brief Brings the index file of a bank up to date
+  //!
+  //! Does nothing if the index is current, builds it if there is no usable
+  //! index, and otherwise refreshes only what changed as described above.
+  //!
+  //! \param bankname Name of the bank directory
+  //! \throws IOException_t
+  //! \return true if the index was rewritten
+  //!
+  static bool update (const std::string & bankname);
+
+
+  //--------------------------------------------------- exists -----------------
+  //! \brief Checks for an index file in a bank, current or not
+  //!
+  static bool exists (const std::string & bankname);
+
+
+  //--------------------------------------------------- isCurrent --------------
+  //! \brief Checks that the index file of a bank can be opened and is current
+  //!
+  static bool isCurrent (const std::string & bankname);
+
+
+  //--------------------------------------------------- open -------------------
+  //! \brief Maps the index file of a bank into memory
+  //!
+  //! \param bankname Name of the bank directory
+  //! \pre The index has been built and the bank not changed since
+  //! \throws IOException_t
+  //! \return void
+  //!
+  void open (const std::string & bankname);
+
+
+  //--------------------------------------------------- close ------------------
+  //! \brief Unmaps the index file, does nothing if not open
+  //!
+  void close ( );
+
+
+  //--------------------------------------------------- isOpen -----------------
+  bool isOpen ( ) const
+  {
+    return data_m != NULL;
+  }
+
+
+  //--------------------------------------------------- getSize ----------------
+  //! \brief Returns the number of indexed reads
+  //!
+  Size_t getSize ( ) const;
+
+
+  //--------------------------------------------------- begin ------------------
+  //! \brief Returns the first record, records are sorted by read IID
+  //!
+  const Record_t * begin ( ) const
+  {
+    return records_m;
+  }
+
+
+  //--------------------------------------------------- end --------------------
+  //! \brief Returns one past the last record
+  //!
+  const Record_t * end ( ) const
+  {
+    return records_m + getSize( );
+  }
+
+
+  //--------------------------------------------------- find -------------------
+  //! \brief Returns the record of a read, or NULL if it is not indexed
+  //!
+  //! \param read The read IID
+  //! \pre isOpen( )
+  //! \return The record or NULL
+  //!
+  const Record_t * find (ID_t read) const;
+
+
+  //--------------------------------------------------- getFragment ------------
+  //! \brief Returns the fragment IID of a read, or NULL_ID
+  //!
+  ID_t getFragment (ID_t read) const
+  {
+    const Record_t * r = find (read);
+    return r == NULL ? NULL_ID : r -> fragment;
+  }
+
+
+  //--------------------------------------------------- getLibrary -------------
+  //! \brief Returns the library IID of a read, or NULL_ID
+  //!
+  ID_t getLibrary (ID_t read) const
+  {
+    const Record_t * r = find (read);
+    return r == NULL ? NULL_ID : r -> library;
+  }
+
+
+  //--------------------------------------------------- getMate ----------------
+  //! \brief Returns the IID of the mate of a read, or NULL_ID
+  //!
+  ID_t getMate (ID_t read) const
+  {
+    const Record_t * r = find (read);
+    return r == NULL ? NULL_ID : r -> mate;
+  }
+
+
+  //--------------------------------------------------- getContig --------------
+  //! \brief Returns the IID of the contig containing a read, or NULL_ID
+  //!
+  ID_t getContig (ID_t read) const
+  {
+    const Record_t * r = find (read);
+    return r == NULL ? NULL_ID : r -> contig;
+  }
+
+
+  //--------------------------------------------------- getScaffold ------------
+  //! \brief Returns the IID of the scaffold containing a read, or NULL_ID
+  //!
+  ID_t getScaffold (ID_t read) const
+  {
+    const Record_t * r = find (read);
+    return r == NULL ? NULL_ID : r -> scaffold;
+  }
+
+
+private:
+
+  struct Header_t;
+  struct ContigState_t;
+
+  //--------------------------------------------------- map --------------------
+  //! \brief Maps the index file and checks its format, but not its stamp
+  //!
+  void map (const std::string & bankname);
+
+
+  //--------------------------------------------------- write ------------------
+  //! \brief Refreshes the contigs and scaffolds of the records and writes
+  //! the index file
+  //!
+  //! Contigs whose BID, IID and variable store offset match an entry of
+  //! known are assumed unchanged and are not fetched.
+  //!
+  static void write (const std::string & bankname,
+                     Header_t & header,
+                     std::vector<Record_t> & records,
+                     const std::vector<ContigState_t> & known);
+
+
+  ReadIndex_t (const ReadIndex_t & source);
+  ReadIndex_t & operator= (const ReadIndex_t & source);
+
+
+  char * data_m;                  //!< the mapped file, or NULL
+  size_t size_m;                  //!< size of the mapping
+  const Header_t * header_m;      //!< file header
+  const Record_t * records_m;     //!< read records sorted by IID
+  const ContigState_t * contigs_m;  //!< contig states sorted by BID
+};
+
+} // namespace AMOS
+
+#endif // #ifndef __ReadIndex_AMOS_HH
@@ -166,6 +166,54 @@ void Read_t::readRecordFix (istream & fix)
 }
 
 
+//----------------------------------------------------- readRecordFields -------
+void Read_t::readRecordFields (istream & fix, BankFields_t fields)
+{
+  Sequence_t::readRecordFields (fix, fields);
+
+  //-- Skipped members are reset so stale values never leak between records
+  if ( fields & P_CLEAR )
+    {
+      readLE (fix, &(clear_m . begin));
+      readLE (fix, &(clear_m . end));
+    }
+  else
+    {
+      fix . ignore (sizeof (Pos_t) * 2);
+      clear_m . clear( );
+    }
+
+  if ( fields & P_FRAGMENT )
+    readLE (fix, &frag_m);
+  else
+    {
+      fix . ignore (sizeof (ID_t));
+      frag_m = NULL_ID;
+    }
+
+  if ( fields & P_CLEAR )
+    {
+      readLE (fix, &(qclear_m . begin));
+      readLE (fix, &(qclear_m . end));
+      type_m = fix . get( );
+      readLE (fix, &(vclear_m . begin));
+      readLE (fix, &(vclear_m . end));
+    }
+  else
+    {
+      fix . ignore (sizeof (Pos_t) * 4 + 1);
+      qclear_m . clear( );
+      vclear_m . clear( );
+      type_m = NULL_READ;
+    }
+
+  readLE (fix, &pos_m);
+  fix . ignore (sizeof (Size_t));
+
+  bcp_m.clear();
+}
+
+
 //----------------------------------------------------- setType ----------------
 void Read_t::setType (ReadType_t type)
 {
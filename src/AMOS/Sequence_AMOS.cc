@@ -30,6 +30,8 @@ void Sequence_t::clear ( )
   length_m = 0;
   if ( compress )
     flags_m . nibble |= COMPRESS_BIT;
+
+  sequenceChanged( );
 }
 
 
@@ -42,6 +44,8 @@ void Sequence_t::compress ( )
   //-- store compression flag in bit COMPRESS_BIT
   flags_m . nibble |= COMPRESS_BIT;
 
+  sequenceChanged( );
+
   if (seq_m == NULL)
     return;
 
@@ -141,6 +145,8 @@ void Sequence_t::readRecord (istream & fix, istream & var)
       qual_m = (uint8_t *) SafeRealloc (qual_m, length_m);
       var . read ((char *)qual_m, length_m);
     }
+
+  sequenceChanged( );
 }
 
 //----------------------------------------------------- readRecordFix ----------
@@ -154,6 +160,30 @@ void Sequence_t::readRecordFix (istream & fix)
   free(qual_m);
 
   seq_m = qual_m = NULL;
+
+  sequenceChanged( );
+}
+
+
+//----------------------------------------------------- readRecordFields -------
+void Sequence_t::readRecordFields (istream & fix, BankFields_t fields)
+{
+  Universal_t::readRecordFix (fix);
+
+  if ( fields & P_LENGTH )
+    readLE (fix, &length_m);
+  else
+    {
+      fix . ignore (sizeof (Size_t));
+      length_m = 0;
+    }
+
+  free(seq_m);
+  free(qual_m);
+
+  seq_m = qual_m = NULL;
+
+  sequenceChanged( );
 }
 
 
@@ -190,6 +220,8 @@ void Sequence_t::setSequence (const char * seq, const char * qual)
       if ( !isCompressed( ) )
 	qual_m = (uint8_t *) SafeRealloc (qual_m, length_m);
     }
+
+  sequenceChanged( );
 }
 
 
@@ -224,6 +256,8 @@ void Sequence_t::setSequence (const string & seq, const string & qual)
       if ( !isCompressed( ) )
 	qual_m = (uint8_t *) SafeRealloc (qual_m, length_m);
     }
+
+  sequenceChanged( );
 }
 
 
@@ -236,6 +270,8 @@ void Sequence_t::uncompress ( )
   //-- store compression flag in bit COMPRESS_BIT
   flags_m . nibble &= ~COMPRESS_BIT;
 
+  sequenceChanged( );
+
   if (seq_m == NULL)
     return;
 
@@ -329,6 +365,8 @@ Sequence_t & Sequence_t::operator= (const Sequence_t & source)
 	qual_m = NULL;
 
       length_m = source . length_m;
+
+      sequenceChanged( );
     }
 
   return *this;
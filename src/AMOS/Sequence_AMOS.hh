@@ -112,12 +112,32 @@ protected:
   }
 
 
+  //--------------------------------------------------- sequenceChanged --------
+  //! \brief Called whenever the sequence data is modified
+  //!
+  //! Every method that changes the bases, including those of derived
+  //! classes reached through a Sequence_t reference, ends by calling this
+  //! hook. Derived classes that cache information computed from the bases
+  //! override it to invalidate the cache, see Contig_t.
+  //!
+  //! \return void
+  //!
+  virtual void sequenceChanged ( )
+  {
+
+  }
+
+
   //--------------------------------------------------- readRecord -------------
   virtual void readRecord (std::istream & fix, std::istream & var);
 
   //--------------------------------------------------- readRecordFix ----------
   virtual void readRecordFix (std::istream & fix);
 
+  //--------------------------------------------------- readRecordFields -------
+  virtual void readRecordFields (std::istream & fix, BankFields_t fields);
+
+
   //--------------------------------------------------- writeRecord ------------
   virtual void writeRecord (std::ostream & fix, std::ostream & var) const;
 
@@ -385,6 +405,8 @@ public:
 	seq_m  [index] = seqchar;
 	qual_m [index] = qualchar;
       }
+
+    sequenceChanged( );
   }
 
 
@@ -0,0 +1,303 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Source for TraceArchive_t
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#include "TraceArchive_AMOS.hh"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace AMOS;
+using namespace std;
+
+
+
+
+//================================================ TraceArchive_t ==============
+static const char ARCHIVE_MAGIC [8] = {'A','M','O','S','T','R','C','1'};
+static const uint32_t ARCHIVE_ORDER = 0x01020304;
+
+
+//-- File layout: header, the traces, the index entries sorted by EID and
+//   the nul terminated EIDs of the entries
+struct TraceArchive_t::Header_t
+{
+  char magic [8];           //!< ARCHIVE_MAGIC
+  uint32_t order;           //!< ARCHIVE_ORDER in the writer's byte order
+  uint32_t pad;
+  uint64_t ntraces;         //!< index entry count
+  uint64_t index;           //!< file offset of the index
+};
+
+struct TraceArchive_t::Entry_t
+{
+  uint64_t offset;          //!< file offset of the trace
+  uint32_t size;            //!< trace size
+  uint32_t name;            //!< offset of the EID in the names
+};
+
+
+//----------------------------------------------------- EntryNameCmp -----------
+struct EntryNameCmp
+{
+  const char * names;
+
+  EntryNameCmp (const char * n) : names (n) { }
+
+  template <class E>
+  bool operator() (const E & a, const E & b) const
+  {
+    return strcmp (names + a . name, names + b . name) < 0;
+  }
+
+  template <class E>
+  bool operator() (const E & a, const char * b) const
+  {
+    return strcmp (names + a . name, b) < 0;
+  }
+};
+
+
+//----------------------------------------------------- TraceArchive_t ---------
+TraceArchive_t::TraceArchive_t ( )
+  : data_m (NULL), size_m (0), header_m (NULL), entries_m (NULL),
+    names_m (NULL), fp_m (NULL), pending_m (NULL)
+{
+
+}
+
+
+//----------------------------------------------------- ~TraceArchive_t --------
+TraceArchive_t::~TraceArchive_t ( )
+{
+  try {
+    close( );
+  }
+  catch (const Exception_t & e) {
+    cerr << "WARNING: " << e . what( ) << endl
+         << "  could not close trace archive " << path_m << endl;
+  }
+  delete pending_m;
+}
+
+
+//----------------------------------------------------- isArchive --------------
+bool TraceArchive_t::isArchive (const string & path)
+{
+  Header_t header;
+  FILE * fp = fopen (path . c_str( ), "r");
+  if ( fp == NULL )
+    return false;
+
+  bool ok = fread (&header, sizeof (header), 1, fp) == 1  &&
+    memcmp (header . magic, ARCHIVE_MAGIC, sizeof (ARCHIVE_MAGIC)) == 0  &&
+    header . order == ARCHIVE_ORDER;
+  fclose (fp);
+
+  return ok;
+}
+
+
+//----------------------------------------------------- create -----------------
+void TraceArchive_t::create (const string & path)
+{
+  close( );
+
+  string tmp = path + ".tmp";
+  fp_m = fopen (tmp . c_str( ), "w");
+  if ( fp_m == NULL )
+    AMOS_THROW_IO ("Could not create trace archive, " + tmp +
+                   ", " + strerror (errno));
+
+  //-- Space for the header, written on close
+  Header_t header;
+  memset (&header, 0, sizeof (header));
+  if ( fwrite (&header, sizeof (header), 1, fp_m) != 1 )
+    AMOS_THROW_IO ("Could not write trace archive, " + tmp);
+
+  path_m = path;
+  if ( pending_m == NULL )
+    pending_m = new vector<Entry_t>;
+  pending_m -> clear( );
+  pendnames_m . clear( );
+}
+
+
+//----------------------------------------------------- append -----------------
+void TraceArchive_t::append (const string & eid, const char * data, Size_t size)
+{
+  if ( fp_m == NULL )
+    AMOS_THROW_IO ("Cannot append to a trace archive that was not created");
+
+  Entry_t entry;
+  entry . offset = ftello (fp_m);
+  entry . size = size;
+  entry . name = pendnames_m . size( );
+
+  if ( size > 0  &&  fwrite (data, size, 1, fp_m) != 1 )
+    AMOS_THROW_IO ("Could not write trace archive, " + path_m + ".tmp");
+
+  pendnames_m . append (eid . c_str( ), eid . size( ) + 1);
+  pending_m -> push_back (entry);
+}
+
+
+//----------------------------------------------------- open -------------------
+void TraceArchive_t::open (const string & path)
+{
+  close( );
+
+  struct stat st;
+
+  int fd = ::open (path . c_str( ), O_RDONLY);
+  if ( fd == -1 )
+    AMOS_THROW_IO ("Could not open trace archive, " + path +
+                   ", " + strerror (errno));
+
+  if ( fstat (fd, &st) == -1  ||  st . st_size < (off_t) sizeof (Header_t) )
+    {
+      ::close (fd);
+      AMOS_THROW_IO ("Could not read trace archive, " + path);
+    }
+
+  void * p = mmap (NULL, st . st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close (fd);
+  if ( p == MAP_FAILED )
+    AMOS_THROW_IO ("Could not map trace archive, " + path +
+                   ", " + strerror (errno));
+
+  data_m = (char *) p;
+  size_m = st . st_size;
+  header_m = (const Header_t *) data_m;
+
+  //-- Check the format, the byte order and that the index fits the file
+  if ( memcmp (header_m -> magic, ARCHIVE_MAGIC, sizeof (ARCHIVE_MAGIC)) != 0  ||
+       header_m -> order != ARCHIVE_ORDER  ||
+       header_m -> index > size_m  ||
+       header_m -> ntraces > (size_m - header_m -> index) / sizeof (Entry_t) )
+    {
+      close( );
+      AMOS_THROW_IO ("Not a trace archive for this platform, " + path);
+    }
+
+  entries_m = (const Entry_t *) (data_m + header_m -> index);
+  names_m = (const char *) (entries_m + header_m -> ntraces);
+}
+
+
+//----------------------------------------------------- close ------------------
+void TraceArchive_t::close ( )
+{
+  if ( data_m != NULL )
+    munmap (data_m, size_m);
+
+  data_m = NULL;
+  size_m = 0;
+  header_m = NULL;
+  entries_m = NULL;
+  names_m = NULL;
+
+  if ( fp_m == NULL )
+    return;
+
+  //-- Sort the index by EID, keeping the last trace of repeated EIDs
+  FILE * fp = fp_m;
+  vector<Entry_t> & entries = *pending_m;
+  EntryNameCmp cmp (pendnames_m . c_str( ));
+  fp_m = NULL;
+
+  stable_sort (entries . begin( ), entries . end( ), cmp);
+
+  vector<Entry_t>::iterator last = entries . begin( );
+  for ( vector<Entry_t>::iterator
+          ei = entries . begin( ); ei != entries . end( ); ++ ei )
+    {
+      if ( last != entries . begin( )  &&  ! cmp (*(last - 1), *ei) )
+        *(last - 1) = *ei;
+      else
+        *(last ++) = *ei;
+    }
+  entries . erase (last, entries . end( ));
+
+  //-- Renumber the names to drop those of replaced traces
+  string names;
+  for ( vector<Entry_t>::iterator
+          ei = entries . begin( ); ei != entries . end( ); ++ ei )
+    {
+      const char * eid = pendnames_m . c_str( ) + ei -> name;
+      ei -> name = names . size( );
+      names . append (eid, strlen (eid) + 1);
+    }
+
+  Header_t header;
+  memset (&header, 0, sizeof (header));
+  memcpy (header . magic, ARCHIVE_MAGIC, sizeof (ARCHIVE_MAGIC));
+  header . order = ARCHIVE_ORDER;
+  header . ntraces = entries . size( );
+
+  //-- Align the index to 8 bytes
+  off_t pos = ftello (fp);
+  while ( pos % 8 )
+    {
+      fputc ('\0', fp);
+      pos ++;
+    }
+  header . index = pos;
+
+  string tmp = path_m + ".tmp";
+  bool ok =
+    (entries . empty( )  ||
+     fwrite (&entries[0], sizeof (Entry_t), entries . size( ), fp)
+     == entries . size( ))  &&
+    fwrite (names . data( ), 1, names . size( ), fp) == names . size( )  &&
+    fseeko (fp, 0, SEEK_SET) == 0  &&
+    fwrite (&header, sizeof (header), 1, fp) == 1;
+  ok = (fclose (fp) == 0)  &&  ok;
+
+  entries . clear( );
+  pendnames_m . clear( );
+
+  if ( ! ok  ||  rename (tmp . c_str( ), path_m . c_str( )) != 0 )
+    {
+      unlink (tmp . c_str( ));
+      AMOS_THROW_IO ("Could not write trace archive, " + path_m);
+    }
+}
+
+
+//----------------------------------------------------- getSize ----------------
+Size_t TraceArchive_t::getSize ( ) const
+{
+  if ( header_m != NULL )
+    return header_m -> ntraces;
+  if ( pending_m != NULL )
+    return pending_m -> size( );
+  return 0;
+}
+
+
+//----------------------------------------------------- find -------------------
+const char * TraceArchive_t::find (const string & eid, Size_t & size) const
+{
+  size = 0;
+  if ( entries_m == NULL )
+    return NULL;
+
+  const Entry_t * end = entries_m + header_m -> ntraces;
+  const Entry_t * e = lower_bound (entries_m, end, eid . c_str( ),
+                                   EntryNameCmp (names_m));
+
+  if ( e == end  ||  strcmp (names_m + e -> name, eid . c_str( )) != 0  ||
+       e -> offset + e -> size > size_m )
+    return NULL;
+
+  size = e -> size;
+  return data_m + e -> offset;
+}
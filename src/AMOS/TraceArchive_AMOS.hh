@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Header for TraceArchive_t
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __TraceArchive_AMOS_HH
+#define __TraceArchive_AMOS_HH 1
+
+#include "datatypes_AMOS.hh"
+#include <string>
+#include <vector>
+#include <cstdio>
+
+
+
+
+namespace AMOS {
+
+//================================================ TraceArchive_t ==============
+//! \brief A single file archive of chromatogram traces keyed by read EID
+//!
+//! Holds the trace files of many reads, in whatever format they were given
+//! (SCF, ZTR, ABI...), one after the other, followed by an index of their
+//! offsets sorted by EID. A reader maps the file and finds a trace with a
+//! binary search, instead of probing the file system for a file per read.
+//!
+//! An archive is either created and appended to, or opened for reading.
+//! Writing goes to a temporary file that replaces the archive on close, so
+//! readers never see a partial archive.
+//!
+//==============================================================================
+class TraceArchive_t
+{
+
+public:
+
+  //--------------------------------------------------- TraceArchive_t ---------
+  //! \brief Constructs an unopened archive
+  //!
+  TraceArchive_t ( );
+
+
+  //--------------------------------------------------- ~TraceArchive_t --------
+  //! \brief Closes the archive if it is open
+  //!
+  ~TraceArchive_t ( );
+
+
+  //--------------------------------------------------- isArchive --------------
+  //! \brief Checks if a file is a trace archive for this platform
+  //!
+  static bool isArchive (const std::string & path);
+
+
+  //--------------------------------------------------- create -----------------
+  //! \brief Starts a new archive, replacing any old one on close
+  //!
+  //! \param path The archive file
+  //! \throws IOException_t
+  //! \return void
+  //!
+  void create (const std::string & path);
+
+
+  //--------------------------------------------------- append -----------------
+  //! \brief Adds a trace to a created archive
+  //!
+  //! If an EID is appended more than once, the last trace is kept.
+  //!
+  //! \param eid The read EID
+  //! \param data The trace file contents
+  //! \param size The trace file size
+  //! \pre The archive was created, not opened
+  //! \throws IOException_t
+  //! \return void
+  //!
+  void append (const std::string & eid, const char * data, Size_t size);
+
+
+  //--------------------------------------------------- open -------------------
+  //! \brief Maps an archive into memory for reading
+  //!
+  //! \param path The archive file
+  //! \throws IOException_t
+  //! \return void
+  //!
+  void open (const std::string & path);
+
+
+  //--------------------------------------------------- close ------------------
+  //! \brief Closes the archive, writing the index of a created archive
+  //!
+  //! Does nothing if the archive is not open.
+  //!
+  //! \throws IOException_t
+  //! \return void
+  //!
+  void close ( );
+
+
+  //--------------------------------------------------- isOpen -----------------
+  bool isOpen ( ) const
+  {
+    return data_m != NULL  ||  fp_m != NULL;
+  }
+
+
+  //--------------------------------------------------- getSize ----------------
+  //! \brief Returns the number of traces in the archive
+  //!
+  Size_t getSize ( ) const;
+
+
+  //--------------------------------------------------- find -------------------
+  //! \brief Finds the trace of a read
+  //!
+  //! \param eid The read EID
+  //! \param size Set to the trace file size
+  //! \pre The archive was opened for reading
+  //! \return The trace file contents, valid until close, or NULL
+  //!
+  const char * find (const std::string & eid, Size_t & size) const;
+
+
+private:
+
+  struct Header_t;
+  struct Entry_t;
+
+  TraceArchive_t (const TraceArchive_t & source);
+  TraceArchive_t & operator= (const TraceArchive_t & source);
+
+
+  char * data_m;                    //!< the mapped archive, or NULL
+  size_t size_m;                    //!< size of the mapping
+  const Header_t * header_m;        //!< archive header
+  const Entry_t * entries_m;        //!< index sorted by EID
+  const char * names_m;             //!< EIDs of the index entries
+
+  FILE * fp_m;                      //!< the temporary file of a new archive
+  std::string path_m;               //!< archive path of a new archive
+  std::vector<Entry_t> * pending_m; //!< index of a new archive
+  std::string pendnames_m;          //!< EIDs of a new archive
+};
+
+} // namespace AMOS
+
+#endif // #ifndef __TraceArchive_AMOS_HH
@@ -0,0 +1,110 @@
+#!/usr/bin/env python
+#
+# Checks the batch array views of the Python bindings on a bank with reads
+# and contigs, in particular that a view keeps its batch alive and that the
+# batch is not refilled under its views.
+#
+#   python batchtest.py bank
+#
+# Run where the AMOS module built from AMOS.i can be imported.
+
+import gc
+import sys
+import AMOS
+
+if len (sys.argv) != 2:
+    sys.stderr.write ("USAGE: %s bank\n" % sys.argv[0])
+    sys.exit (1)
+
+fails = 0
+
+def check (ok, what):
+    global fails
+    if not ok:
+        sys.stderr.write ("FAIL: %s\n" % what)
+        fails += 1
+
+
+#-- Read columns, copied while the batch is alive
+reds = AMOS.BankStream_t (AMOS.Read_t ().getNCode ())
+reds.open (sys.argv[1], AMOS.B_READ)
+batch = AMOS.ReadBatch_t (True)
+n = batch.fill (reds, 100)
+reds.close ()
+
+iids = batch.iids ()
+lengths = batch.lengths ()
+offsets = batch.seq_offsets ()
+seqs = batch.seqs ()
+quals = batch.quals ()
+want = (iids.tolist (), lengths.tolist (), offsets.tolist (),
+        seqs.tolist (), quals.tolist ())
+
+check (n > 0, "no reads in the bank")
+check (len (iids) == n  and  len (offsets) == n + 1, "column lengths")
+check (offsets[n] == len (seqs)  and  len (quals) == len (seqs),
+       "sequence buffer lengths")
+for i in range (n):
+    check (offsets[i + 1] - offsets[i] == lengths[i], "read %d offsets" % i)
+check (iids.readonly, "views are writable")
+
+#-- A refill would free the arrays under the views, it must be refused
+reds = AMOS.BankStream_t (AMOS.Read_t ().getNCode ())
+reds.open (sys.argv[1], AMOS.B_READ)
+for refill in (lambda: batch.fill (reds, 100), batch.clear):
+    try:
+        refill ()
+        check (False, "batch refilled under its views")
+    except BufferError:
+        pass
+reds.close ()
+check ((iids.tolist (), lengths.tolist (), offsets.tolist (),
+        seqs.tolist (), quals.tolist ()) == want,
+       "read views changed by a refused refill")
+
+#-- Drop the batch, churn the heap, the views must still hold the data
+del batch
+gc.collect ()
+junk = [bytearray (4096) for i in range (2000)]
+check ((iids.tolist (), lengths.tolist (), offsets.tolist (),
+        seqs.tolist (), quals.tolist ()) == want,
+       "read views changed after the batch was deleted")
+del junk, iids, lengths, offsets, seqs, quals
+
+
+#-- Tile columns of one contig, same again
+ctgs = AMOS.BankStream_t (AMOS.Contig_t ().getNCode ())
+ctgs.open (sys.argv[1], AMOS.B_READ)
+tiles = AMOS.TileBatch_t ()
+tiles.fill (ctgs, 1)
+ctgs.close ()
+
+sources = tiles.sources ()
+offsets = tiles.offsets ()
+want = (sources.tolist (), offsets.tolist ())
+check (len (sources) == len (offsets)  and  len (sources) > 0, "tile columns")
+
+del tiles
+gc.collect ()
+junk = [bytearray (4096) for i in range (2000)]
+check ((sources.tolist (), offsets.tolist ()) == want,
+       "tile views changed after the batch was deleted")
+
+#-- Once the views are gone the batch can be filled again
+reds = AMOS.BankStream_t (AMOS.Read_t ().getNCode ())
+reds.open (sys.argv[1], AMOS.B_READ)
+batch = AMOS.ReadBatch_t ()
+batch.fill (reds, 10)
+iids = batch.iids ()
+del iids
+gc.collect ()
+check (batch.fill (reds, 10) > 0, "batch not refilled after its views were deleted")
+reds.close ()
+
+#-- An empty batch gives empty views
+check (AMOS.ReadBatch_t ().iids ().tolist () == [], "empty batch")
+
+if fails:
+    sys.stderr.write ("FAILED\n")
+    sys.exit (1)
+sys.stderr.write ("PASSED\n")
@@ -12,5 +12,9 @@
 
 #include "Bank_AMOS.hh"
 #include "BankStream_AMOS.hh"
+#include "BankBatch_AMOS.hh"
+#include "ContigRangeIndex_AMOS.hh"
+#include "ReadIndex_AMOS.hh"
+#include "TraceArchive_AMOS.hh"
 
 #endif // #ifndef __databanks_AMOS_HH
@@ -0,0 +1,154 @@
+#include "foundation_AMOS.hh"
+#include <cstdlib>
+#include <sstream>
+#include <iostream>
+#include <unistd.h>
+
+#ifdef AMOS_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace AMOS;
+
+const string BANK_STORE_DIR = "_fetch_";
+const ID_t NREADS = 5000;
+
+
+//-- Exposes fetchBID, to hand the mapped fetch BIDs no IID maps to
+class TestBank_t : public Bank_t
+{
+public:
+
+  TestBank_t (NCode_t type)
+    : Bank_t (type)
+  { }
+
+  using Bank_t::fetchBID;
+};
+
+
+static string RandomSequence (Size_t len)
+{
+  string seq (len, 'A');
+  for ( Size_t i = 0; i < len; i ++ )
+    seq[i] = "ACGT"[rand( ) % 4];
+  return seq;
+}
+
+
+int main (int argc, char ** argv)
+{
+  int threads = argc > 1 ? atoi (argv[1]) : 8;
+  vector<string> seqs (NREADS + 1);
+  int fails = 0;
+
+  srand (1);
+
+  try {
+
+    //-- Reads of random lengths, a seventh replaced so the var store has holes
+    {
+      Bank_t bank (Read_t::NCODE);
+      Read_t red;
+      ostringstream ss;
+
+      if ( bank . exists (BANK_STORE_DIR) )
+        {
+          bank . open (BANK_STORE_DIR);
+          bank . destroy( );
+        }
+      bank . create (BANK_STORE_DIR);
+
+      for ( ID_t i = 1; i <= NREADS; i ++ )
+        {
+          seqs[i] = RandomSequence (50 + rand( ) % 1000);
+          ss . str (NULL_STRING);
+          ss << 'r' << i;
+          red . setIID (i);
+          red . setEID (ss . str( ));
+          red . setSequence (seqs[i], string (seqs[i] . size( ), 'X'));
+          red . setClearRange (Range_t (0, seqs[i] . size( )));
+          bank . append (red);
+        }
+
+      for ( ID_t i = 7; i <= NREADS; i += 7 )
+        {
+          bank . fetch (i, red);
+          seqs[i] = RandomSequence (50 + rand( ) % 1000);
+          red . setSequence (seqs[i], string (seqs[i] . size( ), 'X'));
+          red . setClearRange (Range_t (0, seqs[i] . size( )));
+          bank . replace (i, red);
+        }
+
+      bank . close( );
+    }
+
+    TestBank_t bank (Read_t::NCODE);
+    bank . open (BANK_STORE_DIR, B_READ | B_MAP);
+
+#ifdef AMOS_HAVE_OPENMP
+    omp_set_num_threads (threads);
+#endif
+
+    //-- Every thread fetches all the reads, each from a different start
+#pragma omp parallel for reduction(+:fails) schedule(static, 1)
+    for ( int t = 0; t < threads; t ++ )
+      {
+        Read_t red;
+        ostringstream ss;
+
+        for ( ID_t k = 0; k < NREADS; k ++ )
+          {
+            ID_t i = 1 + (k + (ID_t) t * 997) % NREADS;
+            ss . str (NULL_STRING);
+            ss << 'r' << i;
+
+            try {
+              if ( k % 2 )
+                bank . fetch (i, red);
+              else
+                bank . fetch (ss . str( ), red);
+            }
+            catch (const Exception_t & e) {
+              fails ++;
+              continue;
+            }
+
+            if ( red . getIID( ) != i  ||  red . getEID( ) != ss . str( )  ||
+                 red . getSeqString( ) != seqs[i]  ||
+                 red . getClearRange( ) . getHi( ) != (Pos_t) seqs[i] . size( ) )
+              fails ++;
+          }
+      }
+
+    if ( fails )
+      cerr << "FAIL: " << fails << " bad concurrent fetches" << endl;
+
+    //-- No IID maps outside the records, fetchBID must refuse them
+    ID_t bad [] = { NULL_ID, NREADS + 1, NREADS + 1000000 };
+    for ( int k = 0; k < 3; k ++ )
+      {
+        Read_t red;
+        try {
+          bank . fetchBID (bad[k], red);
+          cerr << "FAIL: fetched BID " << bad[k] << endl;
+          fails ++;
+        }
+        catch (const ArgumentException_t & e) {
+        }
+      }
+
+    bank . close( );
+
+    bank . open (BANK_STORE_DIR);
+    bank . destroy( );
+  }
+  catch (const Exception_t & e) {
+    cerr << "FAIL: " << e << endl;
+    return EXIT_FAILURE;
+  }
+
+  cerr << (fails ? "FAILED" : "PASSED") << endl;
+  return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+#include "foundation_AMOS.hh"
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+using namespace std;
+using namespace AMOS;
+
+
+//-- The gap list translation the rank/select index replaced
+struct GapList_t
+{
+  vector<Pos_t> gaps;
+
+  GapList_t (const Sequence_t & seq)
+  {
+    for ( Pos_t i = 0; i < seq . getLength( ); i ++ )
+      if ( seq . getBase (i) . first == '-' )
+        gaps . push_back (i);
+  }
+
+  Pos_t gap2ungap (Pos_t gap) const
+  {
+    Pos_t retval = gap;
+    for ( size_t i = 0; i < gaps . size( ) && gaps[i] <= gap; i ++ )
+      retval --;
+    return retval + 1;
+  }
+
+  Pos_t ungap2gap (Pos_t ungap) const
+  {
+    Pos_t retval = ungap - 1;
+    for ( size_t i = 0; i < gaps . size( ) && gaps[i] <= retval; i ++ )
+      retval ++;
+    return retval;
+  }
+};
+
+
+static string RandomConsensus (Pos_t len, int gappct)
+{
+  string seq (len, 'A');
+  for ( Pos_t i = 0; i < len; i ++ )
+    {
+      //-- Mostly single gaps, with the odd run longer than a word
+      if ( rand( ) % 100 < gappct )
+        seq[i] = '-';
+      else if ( rand( ) % 5000 == 0 )
+        for ( Pos_t j = 0; j < 100 + rand( ) % 100 && i < len; j ++, i ++ )
+          seq[i] = '-';
+      else
+        seq[i] = "ACGT"[rand( ) % 4];
+    }
+  return seq;
+}
+
+
+//-- Compares every position, and a few out of range, with the gap list
+static int Check (Contig_t & ctg, const string & what)
+{
+  GapList_t ref (ctg);
+  Pos_t len = ctg . getLength( );
+  Pos_t ulen = ctg . getUngappedLength( );
+  int fails = 0;
+
+  for ( Pos_t i = -3; i < len + 3 && fails < 5; i ++ )
+    if ( ctg . gap2ungap (i) != ref . gap2ungap (i) )
+      {
+        cerr << "FAIL: " << what << " gap2ungap(" << i << ") = "
+             << ctg . gap2ungap (i) << ", not " << ref . gap2ungap (i) << endl;
+        fails ++;
+      }
+
+  for ( Pos_t i = -2; i < ulen + 3 && fails < 5; i ++ )
+    if ( (Pos_t) ctg . ungap2gap (i) != ref . ungap2gap (i) )
+      {
+        cerr << "FAIL: " << what << " ungap2gap(" << i << ") = "
+             << ctg . ungap2gap (i) << ", not " << ref . ungap2gap (i) << endl;
+        fails ++;
+      }
+
+  return fails;
+}
+
+
+int main (int argc, char ** argv)
+{
+  srand (argc > 1 ? atoi (argv[1]) : 1);
+  Pos_t benchlen = argc > 2 ? atoi (argv[2]) : 10000000;
+  int fails = 0;
+
+  try {
+
+    for ( int round = 0; round < 20; round ++ )
+      {
+        Contig_t ctg;
+        Pos_t len = (round == 0) ? 0 : rand( ) % 5000;
+        string seq = RandomConsensus (len, round % 4 == 3 ? 60 : 5);
+        ctg . setSequence (seq, string (len, 'X'));
+        fails += Check (ctg, "new");
+
+        if ( len == 0 )
+          continue;
+
+        //-- Edits through the base class must invalidate the index
+        Sequence_t & base = ctg;
+        for ( int k = 0; k < 20; k ++ )
+          {
+            Pos_t i = rand( ) % len;
+            base . setBase (ctg . getBase (i) . first == '-' ? 'C' : '-', 'X', i);
+          }
+        fails += Check (ctg, "setBase");
+
+        seq = RandomConsensus (len / 2 + 1, 10);
+        base . setSequence (seq . c_str( ), string (seq . size( ), 'X') . c_str( ));
+        fails += Check (ctg, "setSequence");
+
+        Sequence_t other;
+        seq = RandomConsensus (len, 20);
+        other . setSequence (seq, string (len, 'X'));
+        base = other;
+        fails += Check (ctg, "operator=");
+
+        Sequence_t * ptr = &ctg;
+        ptr -> clear( );
+        fails += Check (ctg, "clear");
+
+        //-- A copy keeps a valid index of its own
+        ctg . setSequence (seq, string (len, 'X'));
+        ctg . gap2ungap (0);
+        Contig_t copy (ctg);
+        fails += Check (copy, "copy");
+      }
+
+    //-- Timings against the gap list it replaced
+    if ( benchlen > 0 )
+      {
+        Contig_t ctg;
+        string seq = RandomConsensus (benchlen, 5);
+        ctg . setSequence (seq, string (benchlen, 'X'));
+        seq . clear( );
+
+        Pos_t ulen = ctg . getUngappedLength( );
+        int calls = 10000000, refcalls = 1000;
+        Pos_t sum = 0;
+
+        clock_t t0 = clock( );
+        sum += ctg . gap2ungap (0);
+        clock_t t1 = clock( );
+        for ( int k = 0; k < calls; k ++ )
+          sum += ctg . gap2ungap ((Pos_t) (((int64_t) k * 7919) % benchlen));
+        clock_t t2 = clock( );
+        for ( int k = 0; k < calls; k ++ )
+          sum += ctg . ungap2gap (1 + (Pos_t) (((int64_t) k * 7919) % ulen));
+        clock_t t3 = clock( );
+
+        GapList_t ref (ctg);
+        clock_t t4 = clock( );
+        for ( int k = 0; k < refcalls; k ++ )
+          sum += ref . gap2ungap ((Pos_t) (((int64_t) k * 7919) % benchlen));
+        clock_t t5 = clock( );
+
+        double ns = 1e9 / CLOCKS_PER_SEC;
+        cerr << "consensus " << benchlen << " bp, "
+             << benchlen - ulen << " gaps" << endl
+             << "  index build        " << (t1 - t0) * ns / 1e6 << " ms" << endl
+             << "  gap2ungap          " << (t2 - t1) * ns / calls << " ns/call" << endl
+             << "  ungap2gap          " << (t3 - t2) * ns / calls << " ns/call" << endl
+             << "  gap list gap2ungap " << (t5 - t4) * ns / refcalls << " ns/call"
+             << (sum == 0 ? " " : "") << endl;
+      }
+  }
+  catch (const Exception_t & e) {
+    cerr << "FAIL: " << e << endl;
+    return EXIT_FAILURE;
+  }
+
+  cerr << (fails ? "FAILED" : "PASSED") << endl;
+  return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+#include "foundation_AMOS.hh"
+#include <cstdlib>
+#include <iostream>
+#include <unistd.h>
+using namespace std;
+using namespace AMOS;
+
+const string BANK_STORE_DIR = "_rindex_";
+const ID_t NREADS = 3000;
+const ID_t NCONTIGS = 30;
+
+
+//-- Expected links of every read, by read IID
+static vector<ID_t> Contig, Scaffold;
+static HASHMAP::hash_map<ID_t, ID_t> ContigScaffold;
+
+
+static ID_t FragmentOf (ID_t r)
+{
+  ID_t f = (r + 1) / 2;
+  return (f % 10 == 0  &&  r % 2 == 0) ? NULL_ID : f;
+}
+
+
+static ID_t MateOf (ID_t r)
+{
+  ID_t f = (r + 1) / 2;
+  if ( f % 10 == 0 )
+    return NULL_ID;
+  return (r % 2) ? r + 1 : r - 1;
+}
+
+
+static void MakeContig (ID_t iid, const vector<ID_t> & reads, Contig_t & ctg)
+{
+  vector<Tile_t> tiling;
+  Tile_t tle;
+
+  for ( vector<ID_t>::const_iterator i = reads . begin( ); i != reads . end( ); ++ i )
+    {
+      tle . source = *i;
+      tle . offset = rand( ) % 10000;
+      tle . range = Range_t (0, 100);
+      tiling . push_back (tle);
+      Contig[*i] = iid;
+    }
+
+  ctg . clear( );
+  ctg . setIID (iid);
+  ctg . setReadTiling (tiling);
+}
+
+
+//-- Unplaced reads, claimed for a new or edited contig
+static vector<ID_t> Unplaced (int n)
+{
+  vector<ID_t> reads;
+  for ( ID_t r = 1; r <= NREADS  &&  (int) reads . size( ) < n; r ++ )
+    if ( Contig[r] == NULL_ID  &&  rand( ) % 4 == 0 )
+      reads . push_back (r);
+  return reads;
+}
+
+
+static int Check (const char * when)
+{
+  ReadIndex_t index;
+  int fails = 0;
+
+  index . open (BANK_STORE_DIR);
+  if ( index . getSize( ) != (Size_t) NREADS )
+    {
+      cerr << "FAIL: " << when << ", " << index . getSize( ) << " reads" << endl;
+      return 1;
+    }
+
+  for ( ID_t r = 1; r <= NREADS; r ++ )
+    {
+      const ReadIndex_t::Record_t * rec = index . find (r);
+      ID_t f = FragmentOf (r);
+      ID_t s = Contig[r] ? ContigScaffold [Contig[r]] : NULL_ID;
+
+      if ( rec == NULL  ||
+           rec -> fragment != f  ||
+           rec -> library != (f ? f % 3 + 1 : NULL_ID)  ||
+           rec -> mate != MateOf (r)  ||
+           rec -> type != (f ? Fragment_t::INSERT : Fragment_t::NULL_FRAGMENT)  ||
+           rec -> contig != Contig[r]  ||
+           rec -> scaffold != s )
+        {
+          if ( fails ++ < 5 )
+            cerr << "FAIL: " << when << ", read " << r << " contig "
+                 << (rec ? rec -> contig : 0) << " expected " << Contig[r] << endl;
+        }
+    }
+
+  if ( index . find (NREADS + 1) != NULL )
+    {
+      cerr << "FAIL: " << when << ", found an unknown read" << endl;
+      fails ++;
+    }
+
+  return fails;
+}
+
+
+int main (int argc, char ** argv)
+{
+  srand (argc > 1 ? atoi (argv[1]) : 1);
+
+  try {
+
+    Bank_t red_bank (Read_t::NCODE);
+    Bank_t frg_bank (Fragment_t::NCODE);
+    Bank_t ctg_bank (Contig_t::NCODE);
+    Bank_t scf_bank (Scaffold_t::NCODE);
+    int fails = 0;
+    ID_t i;
+
+    red_bank . create (BANK_STORE_DIR);
+    frg_bank . create (BANK_STORE_DIR);
+    ctg_bank . create (BANK_STORE_DIR);
+    scf_bank . create (BANK_STORE_DIR);
+
+    //-- Mated reads, except for every tenth fragment which has just one
+    Contig . assign (NREADS + 1, NULL_ID);
+    for ( i = 1; i <= NREADS; i ++ )
+      {
+        Read_t red;
+        red . setIID (i);
+        red . setFragment (FragmentOf (i));
+        red_bank . append (red);
+      }
+
+    for ( i = 1; i <= NREADS / 2; i ++ )
+      {
+        Fragment_t frg;
+        frg . setIID (i);
+        frg . setLibrary (i % 3 + 1);
+        frg . setType (Fragment_t::INSERT);
+        if ( i % 10 == 0 )
+          frg . setReads (make_pair (2 * i - 1, NULL_ID));
+        else
+          frg . setReads (make_pair (2 * i - 1, 2 * i));
+        frg_bank . append (frg);
+      }
+
+    //-- Contigs of random reads, every third one left out of the scaffolds
+    for ( i = 1; i <= NCONTIGS; i ++ )
+      {
+        Contig_t ctg;
+        MakeContig (i, Unplaced (1 + rand( ) % 150), ctg);
+        ctg_bank . append (ctg);
+      }
+
+    for ( i = 1; i <= NCONTIGS / 3; i ++ )
+      {
+        Scaffold_t scf;
+        vector<Tile_t> tiling;
+        Tile_t tle;
+        for ( ID_t c = 3 * i - 2; c <= 3 * i - 1; c ++ )
+          {
+            tle . source = c;
+            tle . range = Range_t (0, 10000);
+            tiling . push_back (tle);
+            ContigScaffold [c] = i;
+          }
+        scf . setIID (i);
+        scf . setContigTiling (tiling);
+        scf_bank . append (scf);
+      }
+
+    red_bank . close( );
+    frg_bank . close( );
+    ctg_bank . close( );
+    scf_bank . close( );
+
+    ReadIndex_t::build (BANK_STORE_DIR);
+    fails += Check ("build");
+
+    if ( ReadIndex_t::update (BANK_STORE_DIR) )
+      {
+        cerr << "FAIL: updated a current index" << endl;
+        fails ++;
+      }
+
+    //-- Append one contig and replace another twice, moving reads about
+    Contig_t ctg;
+    vector<ID_t> reads;
+
+    sleep (1);
+    ctg_bank . open (BANK_STORE_DIR);
+    MakeContig (NCONTIGS + 1, Unplaced (100), ctg);
+    ctg_bank . append (ctg);
+
+    for ( int pass = 0; pass < 2; pass ++ )
+      {
+        ctg_bank . fetch (5, ctg);
+        reads . clear( );
+        const vector<Tile_t> & tiling = ctg . getReadTiling( );
+        for ( vector<Tile_t>::const_iterator
+                ti = tiling . begin( ); ti != tiling . end( ); ++ ti )
+          {
+            if ( rand( ) % 2 )
+              reads . push_back (ti -> source);
+            else
+              Contig [ti -> source] = NULL_ID;
+          }
+        vector<ID_t> more = Unplaced (20);
+        reads . insert (reads . end( ), more . begin( ), more . end( ));
+        MakeContig (5, reads, ctg);
+        ctg_bank . replace (5, ctg);
+      }
+    ctg_bank . close( );
+
+    if ( ReadIndex_t::isCurrent (BANK_STORE_DIR) )
+      {
+        cerr << "FAIL: index still current after an edit" << endl;
+        fails ++;
+      }
+    ReadIndex_t::update (BANK_STORE_DIR);
+    fails += Check ("append and replace");
+
+    //-- Remove a scaffolded contig
+    sleep (1);
+    ctg_bank . open (BANK_STORE_DIR);
+    ctg_bank . fetch (7, ctg);
+    for ( i = 1; i <= NREADS; i ++ )
+      if ( Contig[i] == 7 )
+        Contig[i] = NULL_ID;
+    ctg_bank . remove (7);
+    ctg_bank . close( );
+
+    ReadIndex_t::update (BANK_STORE_DIR);
+    fails += Check ("remove");
+
+    red_bank . open (BANK_STORE_DIR);
+    red_bank . destroy( );
+    frg_bank . open (BANK_STORE_DIR);
+    frg_bank . destroy( );
+    ctg_bank . open (BANK_STORE_DIR);
+    ctg_bank . destroy( );
+    scf_bank . open (BANK_STORE_DIR);
+    scf_bank . destroy( );
+    unlink ((BANK_STORE_DIR + "/RED" + ReadIndex_t::STORE_SUFFIX) . c_str( ));
+    rmdir (BANK_STORE_DIR . c_str( ));
+
+    cerr << (fails ? "FAILED" : "PASSED") << endl;
+    return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+  catch (const Exception_t & e) {
+    cerr << "FAIL: " << e << endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,175 @@
+#include "foundation_AMOS.hh"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <unistd.h>
+using namespace std;
+using namespace AMOS;
+
+const string BANK_STORE_DIR = "_range_";
+
+
+//-- Brute force answer to a range query, in index order
+static void Scan (const vector<ContigRangeIndex_t::Entry_t> & all,
+                  Pos_t a, Pos_t b, vector<ID_t> & hits)
+{
+  hits . clear( );
+  for ( vector<ContigRangeIndex_t::Entry_t>::const_iterator
+          i = all . begin( ); i != all . end( ); ++ i )
+    if ( i -> begin < b  &&  a < i -> end )
+      hits . push_back (i -> iid);
+  sort (hits . begin( ), hits . end( ));
+}
+
+
+static void Hits (const vector<ContigRangeIndex_t::Entry_t> & entries,
+                  vector<ID_t> & hits)
+{
+  hits . clear( );
+  for ( vector<ContigRangeIndex_t::Entry_t>::const_iterator
+          i = entries . begin( ); i != entries . end( ); ++ i )
+    {
+      if ( i != entries . begin( )  &&  i -> begin < (i - 1) -> begin )
+        {
+          cerr << "FAIL: hits out of order" << endl;
+          exit (EXIT_FAILURE);
+        }
+      hits . push_back (i -> iid);
+    }
+  sort (hits . begin( ), hits . end( ));
+}
+
+
+int main (int argc, char ** argv)
+{
+  srand (argc > 1 ? atoi (argv[1]) : 1);
+
+  try {
+
+    Bank_t ctg_bank (Contig_t::NCODE);
+    Bank_t fea_bank (Feature_t::NCODE);
+    vector< vector<ContigRangeIndex_t::Entry_t> > tiles, feats;
+    ContigRangeIndex_t::Entry_t e;
+    ID_t i, j, nctg = 20, fiid = 0;
+
+    ctg_bank . create (BANK_STORE_DIR);
+    fea_bank . create (BANK_STORE_DIR);
+
+    //-- Random contigs, from empty to deep, with a few long reads and features
+    tiles . resize (nctg + 1);
+    feats . resize (nctg + 1);
+    for ( i = 1; i <= nctg; i ++ )
+      {
+        Contig_t ctg;
+        vector<Tile_t> tiling;
+        Pos_t len = 1000 + rand( ) % 50000;
+        ID_t n = (i == 1) ? 0 : rand( ) % 5000;
+
+        for ( j = 0; j < n; j ++ )
+          {
+            Tile_t tle;
+            Pos_t rlen = (rand( ) % 20 == 0) ? rand( ) % len : 50 + rand( ) % 1000;
+            tle . source = i * 10000 + j;
+            tle . offset = rand( ) % len;
+            tle . range = Range_t (0, rlen);
+            tiling . push_back (tle);
+
+            e . begin = tle . offset;
+            e . end = tle . offset + rlen;
+            e . iid = tle . source;
+            tiles[i] . push_back (e);
+          }
+
+        for ( j = rand( ) % 50; j > 0; j -- )
+          {
+            Feature_t fea;
+            Pos_t a = rand( ) % len, b = rand( ) % len;
+            fea . setIID (++ fiid);
+            fea . setSource (make_pair (i, Contig_t::NCODE));
+            fea . setRange (Range_t (a, b));
+            fea_bank . append (fea);
+
+            e . begin = min (a, b);
+            e . end = max (max (a, b), e . begin + 1);
+            e . iid = fiid;
+            feats[i] . push_back (e);
+          }
+
+        ctg . setIID (i);
+        ctg . setReadTiling (tiling);
+        ctg_bank . append (ctg);
+      }
+
+    ctg_bank . close( );
+    fea_bank . close( );
+
+    ContigRangeIndex_t::build (BANK_STORE_DIR);
+
+    ContigRangeIndex_t index;
+    vector<ContigRangeIndex_t::Entry_t> entries;
+    vector<ID_t> want, got;
+    int fails = 0;
+
+    index . open (BANK_STORE_DIR);
+    if ( index . getNumContigs( ) != (Size_t) nctg )
+      {
+        cerr << "FAIL: " << index . getNumContigs( ) << " contigs indexed" << endl;
+        fails ++;
+      }
+
+    for ( int q = 0; q < 20000; q ++ )
+      {
+        i = rand( ) % (nctg + 2);
+        Pos_t a = rand( ) % 60000 - 1000;
+        Pos_t b = a + ((q % 2) ? 1 : 1 + rand( ) % 5000);
+        bool fea = q % 3 == 0;
+        const vector<ContigRangeIndex_t::Entry_t> & all =
+          (i <= nctg) ? (fea ? feats[i] : tiles[i]) : tiles[0];
+
+        entries . clear( );
+        if ( fea )
+          index . getFeatures (i, Range_t (b, a), entries);
+        else
+          index . getTiles (i, Range_t (a, b), entries);
+        Hits (entries, got);
+        Scan (all, a, b, want);
+
+        if ( got != want )
+          {
+            cerr << "FAIL: contig " << i << (fea ? " features " : " tiles ")
+                 << a << ',' << b << " found " << got . size( )
+                 << " of " << want . size( ) << endl;
+            fails ++;
+          }
+      }
+    index . close( );
+
+    //-- Any change to the bank makes the index stale
+    sleep (1);
+    ctg_bank . open (BANK_STORE_DIR);
+    Contig_t ctg;
+    ctg . setIID (nctg + 1);
+    ctg_bank . append (ctg);
+    ctg_bank . close( );
+
+    if ( ContigRangeIndex_t::isCurrent (BANK_STORE_DIR) )
+      {
+        cerr << "FAIL: index still current after an append" << endl;
+        fails ++;
+      }
+
+    ctg_bank . open (BANK_STORE_DIR);
+    ctg_bank . destroy( );
+    fea_bank . open (BANK_STORE_DIR);
+    fea_bank . destroy( );
+    unlink ((BANK_STORE_DIR + "/CTG" + ContigRangeIndex_t::STORE_SUFFIX) . c_str( ));
+    rmdir (BANK_STORE_DIR . c_str( ));
+
+    cerr << (fails ? "FAILED" : "PASSED") << endl;
+    return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+  catch (const Exception_t & e) {
+    cerr << "FAIL: " << e << endl;
+    return EXIT_FAILURE;
+  }
+}
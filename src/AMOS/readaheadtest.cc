@@ -0,0 +1,260 @@
+// Checks BankStream_t read-ahead against plain stream scans of a bank with
+// removed and replaced records: whole scans for limits from 1 to 100000
+// records, seeks in the middle of a scan, fixed store only and projected
+// scans, and a switch from a fixed store only scan to full records.
+
+#include "foundation_AMOS.hh"
+#include <cstdlib>
+#include <sstream>
+#include <iostream>
+
+using namespace std;
+using namespace AMOS;
+
+const string BANK_STORE_DIR = "_readahead_";
+const ID_t NREADS = 3000;
+
+
+static string RandomSequence (Size_t len)
+{
+  string seq (len, 'A');
+  for ( Size_t i = 0; i < len; i ++ )
+    seq[i] = "ACGT"[rand( ) % 4];
+  return seq;
+}
+
+
+//-- Everything operator>> gave for a record: its message, var store offset
+//   and the BID following it
+struct Record_t
+{
+  string text;
+  Bank_t::bankstreamoff vpos;
+  ID_t next;
+
+  bool operator!= (const Record_t & r) const
+  {
+    return text != r . text  ||  vpos != r . vpos  ||  next != r . next;
+  }
+};
+
+
+static Record_t Get (BankStream_t & bank)
+{
+  Read_t red;
+  Message_t msg;
+  Record_t rec;
+
+  bank >> red;
+  red . writeMessage (msg);
+  msg . write (rec . text);
+  rec . vpos = bank . tellv( );
+  rec . next = bank . tellg( );
+  return rec;
+}
+
+
+//-- Reads up to n records, or to the end of the stream if n < 0
+static vector<Record_t> Scan (BankStream_t & bank, int n = -1)
+{
+  vector<Record_t> recs;
+  while ( n -- != 0  &&  ! bank . eof( ) )
+    {
+      Record_t rec = Get (bank);
+      if ( bank . eof( ) )
+        break;
+      recs . push_back (rec);
+    }
+  return recs;
+}
+
+
+//-- Index of the first plain scan record at or after BID bid
+static size_t After (const vector<Record_t> & plain, ID_t bid)
+{
+  size_t i = 0;
+  while ( i < plain . size( )  &&  plain[i] . next <= bid )
+    i ++;
+  return i;
+}
+
+
+static int Compare (const vector<Record_t> & got,
+                    const vector<Record_t> & plain, size_t from,
+                    const string & what)
+{
+  size_t n = got . size( );
+  bool same = from + n <= plain . size( );
+  for ( size_t i = 0; same  &&  i < n; i ++ )
+    same = ! (got[i] != plain[from + i]);
+
+  if ( same )
+    return 0;
+  cerr << "FAIL: " << what << " differs from a plain scan" << endl;
+  return 1;
+}
+
+
+int main (int argc, char ** argv)
+{
+  Size_t sizes[] = { 1, 2, 3, 7, 64, 1000, 100000 };
+  const int NSIZES = sizeof (sizes) / sizeof (sizes[0]);
+  vector<Record_t> plain, fixed, lengths;
+  ID_t nlive = NREADS;
+  int fails = 0;
+
+  srand (1);
+
+  try {
+
+    //-- Reads of random lengths, an eleventh removed and a seventh replaced
+    //   so the var store is out of order and the fixed store has holes
+    {
+      Bank_t bank (Read_t::NCODE);
+      Read_t red;
+      ostringstream ss;
+
+      if ( bank . exists (BANK_STORE_DIR) )
+        {
+          bank . open (BANK_STORE_DIR);
+          bank . destroy( );
+        }
+      bank . create (BANK_STORE_DIR);
+
+      for ( ID_t i = 1; i <= NREADS; i ++ )
+        {
+          string seq = RandomSequence (50 + rand( ) % 1000);
+          ss . str (NULL_STRING);
+          ss << 'r' << i;
+          red . setIID (i);
+          red . setEID (ss . str( ));
+          red . setSequence (seq, string (seq . size( ), 'X'));
+          red . setClearRange (Range_t (rand( ) % 20, seq . size( )));
+          bank . append (red);
+        }
+
+      for ( ID_t i = 7; i <= NREADS; i += 7 )
+        {
+          bank . fetch (i, red);
+          string seq = RandomSequence (50 + rand( ) % 1000);
+          red . setSequence (seq, string (seq . size( ), 'Y'));
+          bank . replace (i, red);
+        }
+
+      for ( ID_t i = 11; i <= NREADS; i += 11, nlive -- )
+        bank . remove (i);
+
+      //-- and a run of removed records longer than a read-ahead chunk
+      for ( ID_t i = 1500; i < 1600; i ++ )
+        if ( i % 11 )
+          {
+            bank . remove (i);
+            nlive --;
+          }
+
+      bank . close( );
+    }
+
+    BankStream_t bank (Read_t::NCODE);
+    bank . open (BANK_STORE_DIR, B_READ);
+
+    plain = Scan (bank);
+    bank . seekg (1);
+    bank . setFixedStoreOnly (true);
+    fixed = Scan (bank);
+    bank . setFixedStoreOnly (false);
+    bank . seekg (1);
+    bank . setProjection (P_EID | P_LENGTH);
+    lengths = Scan (bank);
+    bank . setProjection (P_ALL);
+
+    if ( (ID_t) plain . size( ) != nlive )
+      {
+        cerr << "FAIL: plain scan gave " << plain . size( ) << " of "
+             << nlive << " reads" << endl;
+        fails ++;
+      }
+
+    for ( int s = 0; s < NSIZES; s ++ )
+      {
+        ostringstream what;
+        what << "read-ahead of " << sizes[s];
+        bank . setReadAhead (sizes[s]);
+
+        //-- Whole scans, full, fixed store only and projected
+        bank . seekg (1);
+        fails += Compare (Scan (bank), plain, 0, what . str( ) + " scan");
+        if ( Scan (bank) . size( ) != 0  ||  ! bank . eof( ) )
+          {
+            cerr << "FAIL: " << what . str( ) << " read past the end" << endl;
+            fails ++;
+          }
+
+        bank . seekg (1);
+        bank . setFixedStoreOnly (true);
+        fails += Compare (Scan (bank), fixed, 0,
+                          what . str( ) + " fixed store scan");
+
+        //-- a fixed store only scan that turns into a full one halfway
+        bank . seekg (1);
+        vector<Record_t> half = Scan (bank, plain . size( ) / 2);
+        fails += Compare (half, fixed, 0, what . str( ) + " fixed store half");
+        bank . setFixedStoreOnly (false);
+        fails += Compare (Scan (bank), plain, half . size( ),
+                          what . str( ) + " scan after fixed store half");
+
+        bank . seekg (1);
+        bank . setProjection (P_EID | P_LENGTH);
+        fails += Compare (Scan (bank), lengths, 0,
+                          what . str( ) + " projected scan");
+        bank . setProjection (P_ALL);
+
+        //-- Seeks in the middle of a scan: back, forward, onto removed
+        //   records, into the removed run and to the last record
+        ID_t seeks[] = { 200, 5, 2222, 11, 1499, 1550, 2000, 1, NREADS };
+        const int NSEEKS = sizeof (seeks) / sizeof (seeks[0]);
+        bank . seekg (1);
+        Scan (bank, 100);
+        for ( int k = 0; k < NSEEKS; k ++ )
+          {
+            ostringstream seek;
+            seek << what . str( ) << " seek to " << seeks[k];
+            bank . seekg (seeks[k]);
+            fails += Compare (Scan (bank, 37), plain, After (plain, seeks[k]),
+                              seek . str( ));
+          }
+
+        //-- Relative seeks skip live records only
+        bank . seekg (1);
+        Scan (bank, 10);
+        bank . seekg (500, BankStream_t::CURR);
+        fails += Compare (Scan (bank, 20), plain, 510,
+                          what . str( ) + " relative seek");
+
+        //-- and past the end sets eof
+        bank . seekg (NREADS + 1);
+        if ( ! bank . eof( ) )
+          {
+            cerr << "FAIL: " << what . str( ) << " seek past the end" << endl;
+            fails ++;
+          }
+      }
+
+    //-- A byte limit smaller than one record still moves a record at a time
+    bank . setReadAhead (100, 16);
+    bank . seekg (1);
+    fails += Compare (Scan (bank), plain, 0, "read-ahead of 16 bytes scan");
+
+    bank . close( );
+
+    bank . open (BANK_STORE_DIR);
+    bank . destroy( );
+  }
+  catch (const Exception_t & e) {
+    cerr << "FAIL: " << e << endl;
+    return EXIT_FAILURE;
+  }
+
+  cerr << (fails ? "FAILED" : "PASSED") << endl;
+  return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
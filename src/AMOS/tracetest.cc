@@ -0,0 +1,85 @@
+#include "foundation_AMOS.hh"
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+using namespace std;
+using namespace AMOS;
+
+const string ARCHIVE = "_traces_.trc";
+const int NTRACES = 2000;
+
+
+//-- Random binary contents of a trace, nul bytes included
+static string MakeTrace ( )
+{
+  string trace (rand( ) % 5000, '\0');
+  for ( string::size_type i = 0; i < trace . size( ); i ++ )
+    trace[i] = rand( ) % 256;
+  return trace;
+}
+
+
+int main (int argc, char ** argv)
+{
+  srand (argc > 1 ? atoi (argv[1]) : 1);
+
+  try {
+
+    vector<string> eids, traces;
+    TraceArchive_t archive;
+    int fails = 0;
+
+    archive . create (ARCHIVE);
+    for ( int i = 0; i < NTRACES; i ++ )
+      {
+        ostringstream eid;
+        eid << "read" << rand( ) % 100000 << "." << i;
+        eids . push_back (eid . str( ));
+        traces . push_back (MakeTrace( ));
+        archive . append (eids . back( ), traces . back( ) . data( ),
+                          traces . back( ) . size( ));
+      }
+
+    //-- A trace appended again replaces the first
+    traces[7] = MakeTrace( );
+    archive . append (eids[7], traces[7] . data( ), traces[7] . size( ));
+    archive . close( );
+
+    if ( ! TraceArchive_t::isArchive (ARCHIVE) )
+      {
+        cerr << "FAIL: written archive not recognized" << endl;
+        fails ++;
+      }
+
+    archive . open (ARCHIVE);
+
+    for ( int i = 0; i < NTRACES; i ++ )
+      {
+        Size_t size;
+        const char * data = archive . find (eids[i], size);
+        if ( data == NULL  ||  string (data, size) != traces[i] )
+          if ( fails ++ < 5 )
+            cerr << "FAIL: trace of " << eids[i] << " differs" << endl;
+      }
+
+    Size_t size;
+    if ( archive . find ("noread", size) != NULL  ||
+         archive . find ("", size) != NULL )
+      {
+        cerr << "FAIL: found the trace of an unknown read" << endl;
+        fails ++;
+      }
+
+    archive . close( );
+    unlink (ARCHIVE . c_str( ));
+
+    cerr << (fails ? "FAILED" : "PASSED") << endl;
+    return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+  catch (const Exception_t & e) {
+    cerr << "FAIL: " << e << endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -12,6 +12,14 @@
 #include <cstring>
 using namespace AMOS;
 using namespace std;
+
+// The hardware CRC-32C needs x86-64 and a compiler that can build SSE4.2
+// code for single functions, the processor is checked at run time
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ > 4 || \
+    (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define AMOS_CRC32C_SSE42
+#include <nmmintrin.h>
+#endif
  
 
 const signed char COMPLEMENT_DNA[256] =
@@ -86,3 +94,92 @@ void AMOS::Reverse (char * str)
 {
   reverse (str, str + strlen (str));
 }
+
+
+//--------------------------------------------------- CRC32C -------------------
+//-- Slice-by-8 tables for the reflected Castagnoli polynomial
+struct CRC32CTable_t
+{
+  uint32_t t [8] [256];
+  bool sse42;
+
+  CRC32CTable_t ( )
+  {
+    for ( uint32_t i = 0; i < 256; ++ i )
+      {
+        uint32_t c = i;
+        for ( int k = 0; k < 8; ++ k )
+          c = (c & 1) ? (c >> 1) ^ 0x82F63B78 : c >> 1;
+        t [0] [i] = c;
+      }
+    for ( uint32_t i = 0; i < 256; ++ i )
+      for ( int k = 1; k < 8; ++ k )
+        t [k] [i] = (t [k - 1] [i] >> 8) ^ t [0] [t [k - 1] [i] & 0xff];
+
+#ifdef AMOS_CRC32C_SSE42
+    __builtin_cpu_init( );
+    sse42 = __builtin_cpu_supports ("sse4.2");
+#else
+    sse42 = false;
+#endif
+  }
+};
+
+static const CRC32CTable_t CRC32C_TABLE;
+
+
+static uint32_t CRC32CScalar (uint32_t crc, const unsigned char * p, size_t len)
+{
+  const uint32_t (* t) [256] = CRC32C_TABLE . t;
+
+  while ( len >= 8 )
+    {
+      uint32_t lo = crc ^ (p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24);
+      uint32_t hi = p[4] | p[5] << 8 | p[6] << 16 | (uint32_t) p[7] << 24;
+      crc = t[7][lo & 0xff] ^ t[6][lo >> 8 & 0xff] ^
+        t[5][lo >> 16 & 0xff] ^ t[4][lo >> 24] ^
+        t[3][hi & 0xff] ^ t[2][hi >> 8 & 0xff] ^
+        t[1][hi >> 16 & 0xff] ^ t[0][hi >> 24];
+      p += 8;
+      len -= 8;
+    }
+  while ( len -- > 0 )
+    crc = (crc >> 8) ^ t[0][(crc ^ *p ++) & 0xff];
+
+  return crc;
+}
+
+
+#ifdef AMOS_CRC32C_SSE42
+__attribute__ ((target ("sse4.2")))
+static uint32_t CRC32CSSE42 (uint32_t crc, const unsigned char * p, size_t len)
+{
+  uint64_t c = crc;
+  while ( len >= 8 )
+    {
+      uint64_t v;
+      memcpy (&v, p, 8);
+      c = _mm_crc32_u64 (c, v);
+      p += 8;
+      len -= 8;
+    }
+  crc = (uint32_t) c;
+  while ( len -- > 0 )
+    crc = _mm_crc32_u8 (crc, *p ++);
+
+  return crc;
+}
+#endif
+
+
+uint32_t AMOS::CRC32C (uint32_t crc, const void * buf, size_t len)
+{
+  const unsigned char * p = (const unsigned char *) buf;
+
+  crc = ~crc;
+#ifdef AMOS_CRC32C_SSE42
+  if ( CRC32C_TABLE . sse42 )
+    return ~CRC32CSSE42 (crc, p, len);
+#endif
+  return ~CRC32CScalar (crc, p, len);
+}
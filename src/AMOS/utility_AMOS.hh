@@ -210,6 +210,20 @@ void Reverse (std::string & str);
 void Reverse (char * str);
 
 
+//--------------------------------------------------- CRC32C -------------------
+//! \brief Adds a buffer to a CRC-32C (Castagnoli) checksum
+//!
+//! Uses the SSE4.2 crc32 instruction when the processor has it, otherwise a
+//! table driven loop. Checksums of consecutive buffers can be chained.
+//!
+//! \param crc The checksum of the preceding data, 0 to start
+//! \param buf The bytes to add
+//! \param len The number of bytes
+//! \return The updated checksum
+//!
+uint32_t CRC32C (uint32_t crc, const void * buf, size_t len);
+
+
 //------------------------------------------------- writeLE ------------------
 //! \brief Writes an 8-bit int in little-endian byte order
 //!
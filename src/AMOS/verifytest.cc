@@ -0,0 +1,265 @@
+// Checks that the bank checksums catch a single flipped byte: anywhere in the
+// fix and var stores or in the checksums themselves, verifyPartition (what
+// bank-verify runs), B_VERIFY fetches and stream reads, and a B_MAP|B_VERIFY
+// open must all fail, and must all pass again once the byte is put back.
+// The bank is built by appending, reopening and appending again, then
+// replacing some reads, so the running sums of every kind of session count.
+
+#include "foundation_AMOS.hh"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <sys/stat.h>
+
+using namespace std;
+using namespace AMOS;
+
+const string BANK_STORE_DIR = "_verify_";
+const string STORE_PFX = BANK_STORE_DIR + "/RED.0.0";
+const ID_t NREADS = 3000;
+
+
+static string RandomSequence (Size_t len)
+{
+  string seq (len, 'A');
+  for ( Size_t i = 0; i < len; i ++ )
+    seq[i] = "ACGT"[rand( ) % 4];
+  return seq;
+}
+
+
+static long FileSize (const string & path)
+{
+  struct stat st;
+  return stat (path . c_str( ), &st) ? -1 : (long) st . st_size;
+}
+
+
+static void FlipByte (const string & path, long off)
+{
+  fstream f (path . c_str( ), ios::in | ios::out | ios::binary);
+  f . seekg (off);
+  char c = f . get( );
+  f . seekp (off);
+  f . put (c ^ 0x10);
+}
+
+
+//-- Appends reads from to to, or replaces every step'th of them
+static void Write (ID_t from, ID_t to, ID_t step, vector<string> & seqs)
+{
+  Bank_t bank (Read_t::NCODE);
+  Read_t red;
+  ostringstream ss;
+
+  bank . open (BANK_STORE_DIR, B_READ | B_WRITE);
+  for ( ID_t i = from; i <= to; i += step )
+    {
+      seqs[i] = RandomSequence (50 + rand( ) % 1000);
+      ss . str (NULL_STRING);
+      ss << 'r' << i;
+      red . setIID (i);
+      red . setEID (ss . str( ));
+      red . setSequence (seqs[i], string (seqs[i] . size( ), 'X'));
+      red . setClearRange (Range_t (0, seqs[i] . size( )));
+      if ( step == 1 )
+        bank . append (red);
+      else
+        bank . replace (i, red);
+    }
+  bank . close( );
+}
+
+
+//-- Problems verifyPartition finds in the bank
+static Size_t Verify ( )
+{
+  Bank_t bank (Read_t::NCODE);
+  Size_t problems = 0;
+  string report;
+  bool checksummed;
+
+  bank . open (BANK_STORE_DIR, B_READ);
+  for ( Size_t i = 0; i != bank . getPartitionCount( ); i ++ )
+    {
+      problems += bank . verifyPartition (i, report, checksummed);
+      if ( ! checksummed )
+        problems ++;
+    }
+  bank . close( );
+  return problems;
+}
+
+
+//-- B_VERIFY fetches of every read that fail, -1 if any fetch gives the
+//   wrong read
+static int Fetch (const vector<string> & seqs)
+{
+  Bank_t bank (Read_t::NCODE);
+  Read_t red;
+  int failed = 0;
+
+  bank . open (BANK_STORE_DIR, B_READ | B_VERIFY);
+  for ( ID_t i = 1; i <= NREADS; i ++ )
+    {
+      try {
+        bank . fetch (i, red);
+      }
+      catch (const IOException_t & e) {
+        failed ++;
+        continue;
+      }
+      if ( red . getSeqString( ) != seqs[i] )
+        return -1;
+    }
+  bank . close( );
+  return failed;
+}
+
+
+//-- Whether a B_VERIFY stream scan fails
+static bool Stream ( )
+{
+  BankStream_t bank (Read_t::NCODE);
+  Read_t red;
+
+  bank . open (BANK_STORE_DIR, B_READ | B_VERIFY);
+  try {
+    while ( bank >> red )
+      ;
+  }
+  catch (const IOException_t & e) {
+    return true;
+  }
+  bank . close( );
+  return false;
+}
+
+
+//-- Whether a B_MAP|B_VERIFY open fails
+static bool MapOpen ( )
+{
+  Bank_t bank (Read_t::NCODE);
+
+  try {
+    bank . open (BANK_STORE_DIR, B_READ | B_MAP | B_VERIFY);
+  }
+  catch (const IOException_t & e) {
+    return true;
+  }
+  bank . close( );
+  return false;
+}
+
+
+int main (int argc, char ** argv)
+{
+  vector<string> seqs (NREADS + 1);
+  int fails = 0;
+
+  srand (1);
+
+  try {
+
+    {
+      Bank_t bank (Read_t::NCODE);
+      if ( bank . exists (BANK_STORE_DIR) )
+        {
+          bank . open (BANK_STORE_DIR);
+          bank . destroy( );
+        }
+      bank . create (BANK_STORE_DIR);
+      bank . close( );
+    }
+
+    //-- Append, reopen and append again, so the second session picks up
+    //   the running sums of the first
+    Write (1, NREADS / 2, 1, seqs);
+    long fix1 = FileSize (STORE_PFX + ".fix");
+    long var1 = FileSize (STORE_PFX + ".var");
+    Write (NREADS / 2 + 1, NREADS, 1, seqs);
+
+    if ( Verify( ) != 0  ||  Fetch (seqs) != 0  ||  Stream( )  ||  MapOpen( ) )
+      {
+        cerr << "FAIL: appended bank does not verify" << endl;
+        fails ++;
+      }
+
+    Write (97, NREADS, 97, seqs);
+
+    if ( Verify( ) != 0  ||  Fetch (seqs) != 0  ||  Stream( )  ||  MapOpen( ) )
+      {
+        cerr << "FAIL: bank with replaced reads does not verify" << endl;
+        fails ++;
+      }
+
+    //-- Flip a byte at the start, end and middle of each store, at the
+    //   end of the first checksum block and where the second append began
+    struct { string suffix; long first; } stores[] =
+      { { ".fix", fix1 }, { ".var", var1 }, { ".crc", -1 } };
+
+    for ( int s = 0; s < 3; s ++ )
+      {
+        string path = STORE_PFX + stores[s] . suffix;
+        long size = FileSize (path);
+        long offs[] = { 0, (long) Bank_t::CHECKSUM_BLOCK_SIZE - 1,
+                        stores[s] . first, size / 2, size - 1 };
+
+        for ( int k = 0; k < 5; k ++ )
+          {
+            if ( offs[k] < 0  ||  offs[k] >= size )
+              continue;
+
+            ostringstream what;
+            what << "byte " << offs[k] << " of " << path << " flipped, ";
+
+            FlipByte (path, offs[k]);
+            if ( Verify( ) == 0 )
+              {
+                cerr << "FAIL: " << what . str( ) << "verifyPartition passed"
+                     << endl;
+                fails ++;
+              }
+            if ( Fetch (seqs) <= 0 )
+              {
+                cerr << "FAIL: " << what . str( ) << "B_VERIFY fetches passed"
+                     << endl;
+                fails ++;
+              }
+            if ( ! Stream( ) )
+              {
+                cerr << "FAIL: " << what . str( ) << "B_VERIFY stream passed"
+                     << endl;
+                fails ++;
+              }
+            if ( ! MapOpen( ) )
+              {
+                cerr << "FAIL: " << what . str( ) << "B_MAP|B_VERIFY opened"
+                     << endl;
+                fails ++;
+              }
+
+            FlipByte (path, offs[k]);
+            if ( Verify( ) != 0  ||  Fetch (seqs) != 0  ||
+                 Stream( )  ||  MapOpen( ) )
+              {
+                cerr << "FAIL: " << what . str( ) << "bank does not verify once"
+                     << " put back" << endl;
+                fails ++;
+              }
+          }
+      }
+
+    Bank_t bank (Read_t::NCODE);
+    bank . open (BANK_STORE_DIR);
+    bank . destroy( );
+  }
+  catch (const Exception_t & e) {
+    cerr << "FAIL: " << e << endl;
+    return EXIT_FAILURE;
+  }
+
+  cerr << (fails ? "FAILED" : "PASSED") << endl;
+  return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
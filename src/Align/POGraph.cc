@@ -0,0 +1,693 @@
+#include "POGraph.hh"
+#include <climits>
+#include <cstring>
+#include <algorithm>
+
+// The AVX2 scoring loops need x86-64 and a compiler that can build AVX2
+// code for single functions, the processor is checked at run time
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ > 4 || \
+    (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define POGRAPH_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace std;
+using namespace AMOS;
+
+// Unreachable DP cell, far enough from INT_MIN to add penalties to
+static const int NEG_INF = INT_MIN / 4;
+
+// Bands are widened this many times before a read is given up on
+static const int BAND_RETRIES = 2;
+
+
+//----------------------------------------------------------------------------
+// Scoring loops, h[k] = max(h[k], p[k] + s[k]) and h[k] = max(h[k], p[k] + s)
+
+static void maxDiagScalar(int * h, const int * p, const int * s, int n)
+{
+  for (int k = 0; k < n; k++)
+  {
+    int v = p[k] + s[k];
+    if (v > h[k]) { h[k] = v; }
+  }
+}
+
+static void maxVertScalar(int * h, const int * p, int s, int n)
+{
+  for (int k = 0; k < n; k++)
+  {
+    int v = p[k] + s;
+    if (v > h[k]) { h[k] = v; }
+  }
+}
+
+#ifdef POGRAPH_AVX2
+__attribute__ ((target ("avx2")))
+static void maxDiagAVX2(int * h, const int * p, const int * s, int n)
+{
+  int k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    __m256i v = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) (p + k)),
+                                 _mm256_loadu_si256((const __m256i *) (s + k)));
+    __m256i o = _mm256_loadu_si256((const __m256i *) (h + k));
+    _mm256_storeu_si256((__m256i *) (h + k), _mm256_max_epi32(o, v));
+  }
+  maxDiagScalar(h + k, p + k, s + k, n - k);
+}
+
+__attribute__ ((target ("avx2")))
+static void maxVertAVX2(int * h, const int * p, int s, int n)
+{
+  __m256i sv = _mm256_set1_epi32(s);
+  int k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    __m256i v = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) (p + k)), sv);
+    __m256i o = _mm256_loadu_si256((const __m256i *) (h + k));
+    _mm256_storeu_si256((__m256i *) (h + k), _mm256_max_epi32(o, v));
+  }
+  maxVertScalar(h + k, p + k, s, n - k);
+}
+#endif
+
+
+//----------------------------------------------------------------------------
+POGraph::POGraph(int band)
+  : m_band(band),
+    m_match(2), m_mismatch(-3), m_indel(-2),
+    m_simd(simdAvailable()),
+    m_last(-1),
+    m_lastOffset(0),
+    m_profile(256),
+    m_profiled(256, 0)
+{
+  if (m_band < 1) { m_band = 1; }
+}
+
+
+bool POGraph::simdAvailable()
+{
+#ifdef POGRAPH_AVX2
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+
+void POGraph::addRead(const string & seq, int offset)
+{
+  int first = m_nodes.size();
+
+  if (m_nodes.empty() || seq.empty())
+  {
+    appendRead(seq, -1);
+  }
+  else
+  {
+    // Columns run ahead of offsets as insertions accumulate, so find where
+    // the read starts from the last read placed, which it should overlap
+    int start = offset;
+    if (m_last >= 0)
+    {
+      const vector<int> & last = m_paths[m_last];
+      int p = max(0, offset - m_lastOffset);
+      start = (p < (int) last.size()) ? m_nodes[last[p]].m_column
+        : m_nodes[last.back()].m_column + p - (int) last.size() + 1;
+    }
+
+    for (unsigned int b = 0; b < m_profiled.size(); b++) { m_profiled[b] = 0; }
+
+    vector<int> matched;
+    int anchor;
+    int band = m_band;
+    bool aligned = false;
+
+    for (int tries = 0; !aligned && tries <= BAND_RETRIES; tries++, band *= 2)
+    {
+      aligned = alignRead(seq, start, band, matched, anchor);
+    }
+
+    if (aligned)
+    {
+      mergeRead(seq, matched, anchor);
+    }
+    else
+    {
+      // Nothing reached the end of the read, hang it off the graph unaligned
+      appendRead(seq, start);
+    }
+  }
+
+  updateColumns(first);
+
+  if (!m_paths.back().empty())
+  {
+    m_last = m_paths.size() - 1;
+    m_lastOffset = offset;
+  }
+}
+
+
+const int * POGraph::getProfile(char base, const string & seq)
+{
+  // prof[i] is the score of base against read position i-1, so it lines
+  // up with the DP row index of a diagonal move
+  unsigned char b = base;
+  vector<int> & prof = m_profile[b];
+
+  if (!m_profiled[b])
+  {
+    prof.resize(seq.size() + 1);
+    prof[0] = 0;
+    for (unsigned int i = 0; i < seq.size(); i++)
+    {
+      prof[i+1] = (seq[i] == base) ? m_match : m_mismatch;
+    }
+    m_profiled[b] = 1;
+  }
+
+  return &prof[0];
+}
+
+
+bool POGraph::alignRead(const string & seq, int start, int band,
+                        vector<int> & matched, int & anchor)
+{
+  int len = seq.size();
+  int reach = start + band;
+  unsigned int k, pi;
+
+  void (* maxDiag)(int *, const int *, const int *, int) = maxDiagScalar;
+  void (* maxVert)(int *, const int *, int, int) = maxVertScalar;
+#ifdef POGRAPH_AVX2
+  if (m_simd) { maxDiag = maxDiagAVX2; maxVert = maxVertAVX2; }
+#endif
+
+  // Only the nodes of the last alignment have a slot to clear
+  for (k = 0; k < m_rows.size(); k++) { m_slot[m_rows[k].m_node] = -1; }
+  m_slot.resize(m_nodes.size(), -1);
+  m_rows.clear();
+  m_score.clear();
+
+  // Nodes are scored in column order, starting a band left of the read
+  for (k = firstAtColumn(start - band); k < m_order.size(); k++)
+  {
+    int n = m_order[k];
+    const Node & node = m_nodes[n];
+
+    // No scored node has an edge this far right
+    if (node.m_column > reach) { break; }
+
+    Row row;
+    row.m_node = n;
+    row.m_entry = (node.m_column <= start + band);
+
+    // The band follows the best scores of the predecessors, and near the
+    // layout offset also covers where the read would start
+    int center = -1;
+    for (pi = 0; pi < node.m_left.size(); pi++)
+    {
+      int s = m_slot[node.m_left[pi]];
+      if (s >= 0 && m_rows[s].m_best + 1 > center) { center = m_rows[s].m_best + 1; }
+    }
+
+    int lo = center, hi = center;
+    if (row.m_entry)
+    {
+      int expect = max(0, node.m_column - start);
+      if (center < 0) { lo = hi = expect; }
+      else { lo = min(lo, expect); hi = max(hi, expect); }
+    }
+    else if (center < 0)
+    {
+      continue;
+    }
+
+    row.m_lo = max(0, lo - band);
+    row.m_hi = min(len, hi + band);
+    if (row.m_lo > row.m_hi) { continue; }
+
+    row.m_cell = m_score.size();
+    m_score.resize(m_score.size() + row.m_hi - row.m_lo + 1, NEG_INF);
+
+    int * h = &m_score[row.m_cell];
+    const int * prof = getProfile(node.m_base, seq);
+
+    // Free start, the read begins after this node or at it
+    if (row.m_entry)
+    {
+      if (row.m_lo == 0) { h[0] = 0; }
+      if (row.m_lo <= 1 && row.m_hi >= 1) { h[1 - row.m_lo] = max(h[1 - row.m_lo], prof[1]); }
+    }
+
+    for (pi = 0; pi < node.m_left.size(); pi++)
+    {
+      int s = m_slot[node.m_left[pi]];
+      if (s < 0) { continue; }
+
+      const Row & prow = m_rows[s];
+      const int * p = &m_score[prow.m_cell];
+
+      // Read base i-1 aligned to this node
+      int a = max(max(row.m_lo, 1), prow.m_lo + 1);
+      int b = min(row.m_hi, prow.m_hi + 1);
+      if (a <= b) { maxDiag(h + a - row.m_lo, p + a - 1 - prow.m_lo, prof + a, b - a + 1); }
+
+      // Gap in the read
+      a = max(row.m_lo, prow.m_lo);
+      b = min(row.m_hi, prow.m_hi);
+      if (a <= b) { maxVert(h + a - row.m_lo, p + a - prow.m_lo, m_indel, b - a + 1); }
+    }
+
+    // Insertions in the read depend on the cell to the left, so stay scalar
+    int w = row.m_hi - row.m_lo;
+    row.m_best = 0;
+    for (int i = 1; i <= w; i++)
+    {
+      if (h[i-1] + m_indel > h[i]) { h[i] = h[i-1] + m_indel; }
+      if (h[i] > h[row.m_best]) { row.m_best = i; }
+    }
+
+    if (h[row.m_best] <= NEG_INF / 2)
+    {
+      m_score.resize(row.m_cell);
+      continue;
+    }
+
+    row.m_best += row.m_lo;
+    m_slot[n] = m_rows.size();
+    m_rows.push_back(row);
+
+    for (pi = 0; pi < node.m_right.size(); pi++)
+    {
+      reach = max(reach, m_nodes[node.m_right[pi]].m_column);
+    }
+  }
+
+  // The whole read must align, the graph either side of it is free. The
+  // read may also run off the end of the graph, its tail then extends it
+  int cur = -1, i = -1, best = NEG_INF;
+  for (k = 0; k < m_rows.size(); k++)
+  {
+    const Row & row = m_rows[k];
+    const int * h = &m_score[row.m_cell];
+
+    if (row.m_hi == len && h[len - row.m_lo] > best)
+    {
+      cur = k; i = len; best = h[len - row.m_lo];
+    }
+    if (m_nodes[row.m_node].m_right.empty() && h[row.m_best - row.m_lo] > best)
+    {
+      cur = k; i = row.m_best; best = h[row.m_best - row.m_lo];
+    }
+  }
+
+  if (cur < 0 || best <= NEG_INF / 2)
+  {
+    return false;
+  }
+
+  // Trace back, recomputing which move gave each score
+  matched.assign(len, -1);
+  anchor = -1;
+
+  while (i > 0)
+  {
+    const Row & row = m_rows[cur];
+    const Node & node = m_nodes[row.m_node];
+    const int * h = &m_score[row.m_cell];
+    const int * prof = getProfile(node.m_base, seq);
+    int score = h[i - row.m_lo];
+    int next = -1;
+
+    if (row.m_entry && i == 1 && score == prof[1])
+    {
+      matched[0] = row.m_node;
+      break;
+    }
+
+    for (pi = 0; next < 0 && pi < node.m_left.size(); pi++)
+    {
+      int s = m_slot[node.m_left[pi]];
+      if (s < 0) { continue; }
+      const Row & prow = m_rows[s];
+      if (i - 1 >= prow.m_lo && i - 1 <= prow.m_hi &&
+          m_score[prow.m_cell + i - 1 - prow.m_lo] + prof[i] == score)
+      {
+        matched[i-1] = row.m_node;
+        i--;
+        next = s;
+      }
+    }
+
+    for (pi = 0; next < 0 && pi < node.m_left.size(); pi++)
+    {
+      int s = m_slot[node.m_left[pi]];
+      if (s < 0) { continue; }
+      const Row & prow = m_rows[s];
+      if (i >= prow.m_lo && i <= prow.m_hi &&
+          m_score[prow.m_cell + i - prow.m_lo] + m_indel == score)
+      {
+        next = s;
+      }
+    }
+
+    if (next < 0 && i - 1 >= row.m_lo && h[i - 1 - row.m_lo] + m_indel == score)
+    {
+      i--;
+      next = cur;
+    }
+
+    if (next < 0)
+    {
+      AMOS_THROW_ARGUMENT("POGraph traceback failed");
+    }
+
+    cur = next;
+  }
+
+  // The read starts after this node
+  if (i == 0) { anchor = m_rows[cur].m_node; }
+
+  return true;
+}
+
+
+void POGraph::mergeRead(const string & seq, const vector<int> & matched,
+                        int anchor)
+{
+  vector<int> path;
+  int prev = anchor;
+
+  for (unsigned int j = 0; j < seq.size(); j++)
+  {
+    int m = matched[j];
+    int n = -1;
+
+    if (m >= 0 && m_nodes[m].m_base == seq[j])
+    {
+      n = m;
+    }
+    else if (m >= 0 && prev >= 0)
+    {
+      // Reuse a mismatch node another read already added in this column
+      const vector<int> & right = m_nodes[prev].m_right;
+      for (unsigned int r = 0; n < 0 && r < right.size(); r++)
+      {
+        const Node & s = m_nodes[right[r]];
+        if (s.m_base == seq[j] && s.m_column == m_nodes[m].m_column) { n = right[r]; }
+      }
+    }
+
+    if (n < 0)
+    {
+      n = m_nodes.size();
+      m_nodes.push_back(Node(seq[j]));
+
+      // A mismatch on the first base branches from before the matched node
+      if (prev < 0 && m >= 0 && !m_nodes[m].m_left.empty())
+      {
+        addEdge(m_nodes[m].m_left[0], n);
+      }
+    }
+
+    if (prev >= 0) { addEdge(prev, n); }
+    path.push_back(n);
+    prev = n;
+  }
+
+  m_paths.push_back(path);
+}
+
+
+void POGraph::appendRead(const string & seq, int start)
+{
+  // A new chain of nodes, linked after a node left of start if there is one
+  vector<int> path;
+  int prev = -1;
+
+  if (start > 0)
+  {
+    unsigned int k = firstAtColumn(start);
+    if (k > 0) { prev = m_order[k-1]; }
+  }
+
+  for (unsigned int j = 0; j < seq.size(); j++)
+  {
+    int n = m_nodes.size();
+    m_nodes.push_back(Node(seq[j]));
+    if (prev >= 0) { addEdge(prev, n); }
+    path.push_back(n);
+    prev = n;
+  }
+
+  m_paths.push_back(path);
+}
+
+
+void POGraph::addEdge(int from, int to)
+{
+  vector<int> & right = m_nodes[from].m_right;
+  if (find(right.begin(), right.end(), to) == right.end())
+  {
+    right.push_back(to);
+    m_nodes[to].m_left.push_back(from);
+    m_touched.push_back(to);
+  }
+}
+
+
+void POGraph::updateColumns(int first)
+{
+  // A column is the longest path from the sources. New edges only make
+  // paths longer, so only the new nodes and the nodes downstream of a new
+  // edge move, and only to the right. Relax them forward from there
+  int nn = m_nodes.size();
+  int lo = INT_MAX;
+  vector<int> & work = m_touched;
+  unsigned int k, r;
+
+  for (int n = first; n < nn; n++) { work.push_back(n); }
+
+  for (k = 0; k < work.size(); k++)
+  {
+    Node & node = m_nodes[work[k]];
+    int column = 0;
+    for (r = 0; r < node.m_left.size(); r++)
+    {
+      column = max(column, m_nodes[node.m_left[r]].m_column + 1);
+    }
+
+    if (work[k] >= first)
+    {
+      lo = min(lo, column);
+    }
+    if (column > node.m_column)
+    {
+      if (column >= nn)
+      {
+        m_touched.clear();
+        AMOS_THROW_ARGUMENT("POGraph has a cycle");
+      }
+      if (work[k] < first) { lo = min(lo, node.m_column); }
+      node.m_column = column;
+      work.insert(work.end(), node.m_right.begin(), node.m_right.end());
+    }
+  }
+  m_touched.clear();
+
+  if (lo == INT_MAX) { return; }
+
+  // Nodes left of lo kept their columns, so re-sort m_order from there on,
+  // by column and then by index. With reads added in layout order this is
+  // the few columns at the right end of the graph
+  unsigned int from = firstAtColumn(lo);
+  vector<pair<int, int> > tail;
+
+  tail.reserve(m_order.size() - from + nn - first);
+  for (k = from; k < m_order.size(); k++)
+  {
+    tail.push_back(make_pair(m_nodes[m_order[k]].m_column, m_order[k]));
+  }
+  for (int n = first; n < nn; n++)
+  {
+    tail.push_back(make_pair(m_nodes[n].m_column, n));
+  }
+  sort(tail.begin(), tail.end());
+
+  m_order.resize(from + tail.size());
+  for (k = 0; k < tail.size(); k++) { m_order[from + k] = tail[k].second; }
+}
+
+
+unsigned int POGraph::firstAtColumn(int column) const
+{
+  unsigned int lo = 0, hi = m_order.size();
+
+  while (lo < hi)
+  {
+    unsigned int mid = (lo + hi) / 2;
+    if (m_nodes[m_order[mid]].m_column < column) { lo = mid + 1; }
+    else { hi = mid; }
+  }
+
+  return lo;
+}
+
+
+int POGraph::getWidth() const
+{
+  return m_order.empty() ? 0 : m_nodes[m_order.back()].m_column + 1;
+}
+
+
+int POGraph::getStartOffset(int r) const
+{
+  const vector<int> & path = m_paths[r];
+  return path.empty() ? 0 : m_nodes[path[0]].m_column;
+}
+
+
+vector<Pos_t> POGraph::getGaps(int r) const
+{
+  const vector<int> & path = m_paths[r];
+  vector<Pos_t> gaps;
+
+  for (unsigned int j = 1; j < path.size(); j++)
+  {
+    for (int c = m_nodes[path[j-1]].m_column + 1; c < m_nodes[path[j]].m_column; c++)
+    {
+      gaps.push_back(j);
+    }
+  }
+
+  return gaps;
+}
+
+
+void POGraph::getConsensus(string & cons, string & qual) const
+{
+  static const char * BASES = "ACGTN-";
+  int width = getWidth();
+  int nn = m_nodes.size();
+  vector<int> counts(width * 6, 0);
+  vector<vector<int> > weight(nn);
+  unsigned int j, k;
+  int n;
+
+  for (n = 0; n < nn; n++)
+  {
+    weight[n].assign(m_nodes[n].m_right.size(), 0);
+  }
+
+  // Column votes, and the number of reads along each edge
+  for (unsigned int r = 0; r < m_paths.size(); r++)
+  {
+    const vector<int> & path = m_paths[r];
+    for (j = 0; j < path.size(); j++)
+    {
+      const Node & node = m_nodes[path[j]];
+      const char * b = strchr(BASES, toupper(node.m_base));
+      counts[node.m_column * 6 + ((b && *b != '-') ? b - BASES : 4)]++;
+
+      if (j > 0)
+      {
+        const Node & prev = m_nodes[path[j-1]];
+        for (int c = prev.m_column + 1; c < node.m_column; c++)
+        {
+          counts[c * 6 + 5]++;
+        }
+
+        k = find(prev.m_right.begin(), prev.m_right.end(), path[j]) - prev.m_right.begin();
+        weight[path[j-1]][k]++;
+      }
+    }
+  }
+
+  // The consensus is the heaviest path through the graph, so a base split
+  // over several columns by differing alignments is still called once
+  vector<int> score(nn, 0), from(nn, -1);
+  int last = -1;
+  for (j = 0; j < m_order.size(); j++)
+  {
+    n = m_order[j];
+    const Node & node = m_nodes[n];
+    for (k = 0; k < node.m_right.size(); k++)
+    {
+      int s = node.m_right[k];
+      if (score[n] + weight[n][k] > score[s])
+      {
+        score[s] = score[n] + weight[n][k];
+        from[s] = n;
+      }
+    }
+    if (last < 0 || score[n] > score[last]) { last = n; }
+  }
+
+  cons.assign(width, '-');
+  for (n = last; n >= 0; n = from[n])
+  {
+    cons[m_nodes[n].m_column] = toupper(m_nodes[n].m_base);
+  }
+
+  qual.resize(width);
+  for (int c = 0; c < width; c++)
+  {
+    const char * b = strchr(BASES, cons[c]);
+    int total = 0;
+    for (int i = 0; i < 6; i++) { total += counts[c * 6 + i]; }
+
+    int agree = counts[c * 6 + (b ? b - BASES : 4)];
+    int q = 10 * (agree - (total - agree));
+    qual[c] = MIN_QUALITY + max(0, min(q, MAX_QUALITY - MIN_QUALITY));
+  }
+}
+
+
+void POGraph::alignLayout(const Layout_t & lay, const vector<string> & seqs,
+                          Contig_t & ctg)
+{
+  const vector<Tile_t> & tiling = lay.getTiling();
+  unsigned int t;
+
+  if (tiling.size() != seqs.size())
+  {
+    AMOS_THROW_ARGUMENT("Layout and read sequence counts differ");
+  }
+  if (!m_nodes.empty())
+  {
+    AMOS_THROW_ARGUMENT("alignLayout needs an empty POGraph");
+  }
+
+  // Reads must go in in layout order
+  vector<pair<Pos_t, unsigned int> > order;
+  for (t = 0; t < tiling.size(); t++)
+  {
+    order.push_back(make_pair(tiling[t].offset, t));
+  }
+  sort(order.begin(), order.end());
+
+  for (t = 0; t < order.size(); t++)
+  {
+    addRead(seqs[order[t].second], order[t].first);
+  }
+
+  vector<Tile_t> ctgtiling(tiling.size());
+  for (t = 0; t < order.size(); t++)
+  {
+    Tile_t & tile = ctgtiling[t];
+    tile = tiling[order[t].second];
+    tile.offset = getStartOffset(t);
+    tile.gaps = getGaps(t);
+  }
+
+  string cons, qual;
+  getConsensus(cons, qual);
+
+  ctg.setSequence(cons, qual);
+  ctg.setReadTiling(ctgtiling);
+}
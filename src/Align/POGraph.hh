@@ -0,0 +1,116 @@
+#ifndef POGRAPH_HH
+#define POGRAPH_HH 1
+
+#include <vector>
+#include <string>
+#include "foundation_AMOS.hh"
+
+// Partial order graph (POA) multiple alignment of the reads of a layout.
+//
+// Reads are added in layout order. Each one is aligned to the part of the
+// graph near its layout offset with a banded dynamic program, and then
+// merged into the graph: matching bases join existing nodes, mismatches and
+// insertions add new ones. The MSA column of a node is its longest path
+// distance from the graph sources, which is also the topological order the
+// nodes are scored in. Merging a read only moves the columns downstream of
+// it, so adding the reads of a layout in order costs about the same per read
+// however long the layout gets.
+//
+// A POGraph holds no global state, so separate contigs can be built on
+// separate threads.
+
+class POGraph
+{
+public:
+  static const int DEFAULT_BAND = 64;
+
+  POGraph(int band = DEFAULT_BAND);
+
+  // Scores used by the alignment, defaults are 2, -3, -2
+  void setScores(int match, int mismatch, int indel)
+  {
+    m_match = match; m_mismatch = mismatch; m_indel = indel;
+  }
+
+  // Use the vectorized scoring loops, if the processor supports them.
+  // On by default, results are identical either way.
+  void setSIMD(bool simd) { m_simd = simd && simdAvailable(); }
+
+  static bool simdAvailable();
+
+  // Align seq, whose layout offset is offset, and merge it into the graph
+  void addRead(const std::string & seq, int offset);
+
+  int getNumReads() const { return m_paths.size(); }
+  int getNumNodes() const { return m_nodes.size(); }
+
+  // Number of MSA columns
+  int getWidth() const;
+
+  // Gapped MSA offset, and gap positions in the read for read number r
+  int getStartOffset(int r) const;
+  std::vector<AMOS::Pos_t> getGaps(int r) const;
+
+  // Gapped consensus along the path through the graph most reads follow,
+  // and quality from the agreement of each MSA column with it
+  void getConsensus(std::string & cons, std::string & qual) const;
+
+  // Add the reads of layout lay to this (empty) graph and set the tiling,
+  // consensus and quality of ctg from the result. Tile i of lay has
+  // sequence seqs[i], as returned by Read_t::getSeqString(tile.range)
+  void alignLayout(const AMOS::Layout_t & lay,
+                   const std::vector<std::string> & seqs,
+                   AMOS::Contig_t & ctg);
+
+private:
+  struct Node
+  {
+    Node(char base) : m_base(base), m_column(0) {}
+
+    char m_base;
+    int m_column;
+    std::vector<int> m_left;
+    std::vector<int> m_right;
+  };
+
+  // Banded DP row of one node in the current alignment
+  struct Row
+  {
+    int m_node;
+    int m_lo, m_hi;   // read positions [m_lo, m_hi] are in the band
+    int m_cell;       // m_score index of position m_lo
+    int m_best;       // read position of the best score
+    bool m_entry;     // near the read's layout offset, the read may start here
+  };
+
+  bool alignRead(const std::string & seq, int start, int band,
+                 std::vector<int> & matched, int & anchor);
+  void mergeRead(const std::string & seq, const std::vector<int> & matched,
+                 int anchor);
+  void appendRead(const std::string & seq, int start);
+  void addEdge(int from, int to);
+  void updateColumns(int first);
+  unsigned int firstAtColumn(int column) const;
+  const int * getProfile(char base, const std::string & seq);
+
+  int m_band;
+  int m_match, m_mismatch, m_indel;
+  bool m_simd;
+  int m_last;         // last read with any bases
+  int m_lastOffset;   // and its layout offset
+
+  std::vector<Node> m_nodes;
+  std::vector<int> m_order;                // nodes sorted by column, index
+  std::vector<int> m_touched;              // nodes given an edge since the
+                                           // columns were last updated
+  std::vector<std::vector<int> > m_paths;  // nodes of each read
+
+  // Alignment workspace, kept between reads
+  std::vector<Row> m_rows;
+  std::vector<int> m_slot;     // m_rows index of each node, or -1
+  std::vector<int> m_score;
+  std::vector<std::vector<int> > m_profile;
+  std::vector<char> m_profiled;
+};
+
+#endif
@@ -247,17 +247,17 @@ void  Vote_t :: Incr_After
 //  Add  incr_val  to the  after  count in this  Vote_t  for  ch .
 
   {
-   const char  * p;
+   int  k;
 
-   p = strchr (ALPHABET, tolower (ch));
-   if  (p == NULL)
+   k = Align_Alphabet_t :: Index (ch);
+   if  (k < 0)
        {
         sprintf (Clean_Exit_Msg_Line, "ERROR:  Bad character %c (ASCII %d)\n",
                  ch, ch);
         Clean_Exit (Clean_Exit_Msg_Line, __FILE__, __LINE__);
        }
 
-   after [p - ALPHABET] += incr_val;
+   after [k] += incr_val;
 
    return;
   }
@@ -285,17 +285,17 @@ void  Vote_t :: Incr_By
 //  count for a blank.
 
   {
-   const char  * p;
+   int  k;
 
-   p = strchr (ALPHABET, tolower (ch));
-   if  (p == NULL)
+   k = Align_Alphabet_t :: Index (ch);
+   if  (k < 0)
        {
         sprintf (Clean_Exit_Msg_Line, "ERROR:  Bad character %c (ASCII %d)\n",
                  ch, ch);
         Clean_Exit (Clean_Exit_Msg_Line, __FILE__, __LINE__);
        }
 
-   here [p - ALPHABET] += incr_val;
+   here [k] += incr_val;
    if (with_blank)
      after [ALPHABET_SIZE] += incr_val;
 
@@ -357,20 +357,20 @@ void  Vote_t :: Set_To
 
   {
    int  i;
-   const char * p;
+   int  k;
 
    for  (i = 0;  i <= ALPHABET_SIZE;  i ++)
      here [i] = after [i] = 0;
 
-   p = strchr (ALPHABET, tolower (ch));
-   if  (p == NULL)
+   k = Align_Alphabet_t :: Index (ch);
+   if  (k < 0)
        {
         sprintf (Clean_Exit_Msg_Line, "ERROR:  Bad character %c (ASCII %d)\n",
                  ch, ch);
         Clean_Exit (Clean_Exit_Msg_Line, __FILE__, __LINE__);
        }
 
-   here [p - ALPHABET] = 1;
+   here [k] = 1;
    if  (with_blank)
        after [ALPHABET_SIZE] = 1;
 
@@ -666,7 +666,7 @@ void  Alignment_t :: Check_Fix_Start
            i = b_lo - indels;
            matches = 0;
            for (j = 0; j < indels; j ++)
-             if (s [a_lo + j] == t [i + j])
+             if (Align_Alphabet_t :: Match (s [a_lo + j], t [i + j]))
                matches ++;
 
            if (indels - 1 <= matches)
@@ -3864,12 +3864,19 @@ void  Gapped_Multi_Alignment_t :: Set_Consensus_And_Qual
 //  Reset the consensus base values using the libSlice package
 //  and assign the corresponding quality for each one in the
 //  con_qual string. All ambiguous read bases or consensus base
-//  are handled as an N. Strings in alignment are in  s  and
-// their quality values are in  q .
+//  are handled as an N, except when built with  ALIGN_POLY , where
+//  columns supporting several bases get the IUPAC code for them.
+//  Strings in alignment are in  s  and their quality values are in  q .
 
   {
 
+#ifdef  ALIGN_POLY
+   libSlice_Slice  sl;
+   libSlice_Consensus  cns;
+   vector <char>  rc;
+#else
    unsigned int  qvsum [5];
+#endif
    unsigned int  cns_qv;
    char  cns_ch;
    vector <Gapped_MA_Bead_t>  active_bead;
@@ -3935,12 +3942,27 @@ void  Gapped_Multi_Alignment_t :: Set_Consensus_And_Qual
          next ++;
         }
 
+      col_len = seq_column . length ();
+
+#ifdef  ALIGN_POLY
+      rc . assign (col_len + 1, 0);
+      memset (& sl, 0, sizeof (sl));
+      sl . bc = (char *) seq_column . c_str ();
+      sl . qv = (char *) qual_column . c_str ();
+      sl . rc = & rc [0];
+      sl . dcov = col_len;
+
+      libSlice_getConsensusParam (& sl, & cns, NULL, 0, 1);
+      libSlice_updateAmbiguityConic (& sl, & cns, 0, 0);
+
+      cns_ch = libSlice_convertAmbiguityFlags (cns . ambiguityFlags);
+      cns_qv = cns . qvConsensus;
+#else
       // Array of sum of quality scores in the slice for A,C,G,T,- resp.
-      for (j = 0; j < 6; j ++)
+      for (j = 0; j < 5; j ++)
         qvsum [j] = 0;
 
       int nof_ambiguities = 0;
-      col_len = seq_column . length ();
       for (j = 0; j < col_len; j ++)
         switch (tolower (seq_column [j]))
           {
@@ -3966,6 +3988,7 @@ void  Gapped_Multi_Alignment_t :: Set_Consensus_And_Qual
           }
 
       libSlice_ConsensusLight (qvsum, nof_ambiguities, & cns_ch, & cns_qv);
+#endif
 
       consensus [i] = cns_ch;
       con_qual [i] = MIN_QUALITY + Min (cns_qv, unsigned (MAX_QUALITY_CHAR));
@@ -4469,7 +4492,7 @@ void  Align_Row_Update
 
       prev . Get_Max (mxs, mxf);
       p -> diag_score = mxs
-           + ((ch == s [i - 1]) ? match_score : mismatch_score);
+           + ((Align_Alphabet_t :: Match (ch, s [i - 1])) ? match_score : mismatch_score);
       p -> diag_from = mxf;
       p -> diag_ref = prev . Get_Ref (mxf);
 
@@ -4532,7 +4555,7 @@ void  Align_Row_Update_With_Errors
 
       prev . Get_Max (mxs, mxf);
       p -> diag_score = mxs
-           + ((ch == s [i - 1]) ? match_score : mismatch_score);
+           + ((Align_Alphabet_t :: Match (ch, s [i - 1])) ? match_score : mismatch_score);
       p -> diag_from = mxf;
       p -> diag_ref = prev . Get_Ref (mxf);
       p -> diag_errors = prev . Get_Errors (mxf);
@@ -5024,7 +5047,7 @@ void  Complete_Align_Full_Matrix
          p -> Get_Max (mxs, mxf);
          entry . diag_score = mxs;
          entry . diag_from = mxf;
-         entry . diag_score += ((t [i] == s [j]) ? match_score : mismatch_score);
+         entry . diag_score += ((Align_Alphabet_t :: Match (t [i], s [j])) ? match_score : mismatch_score);
 
          p = & (a [r] [c - 1]);
          p -> Get_Max_Left (mxs, mxf, gap_score);
@@ -5367,7 +5390,7 @@ void  Global_Align
               entry . diag_score = p -> top_score;
               entry . diag_from = FROM_TOP;
              }
-         entry . diag_score += ((t [i] == s [c - 1]) ? match_score : mismatch_score);
+         entry . diag_score += ((Align_Alphabet_t :: Match (t [i], s [c - 1])) ? match_score : mismatch_score);
 
          p = & (a [r] [c - 1]);
          if  (p -> left_score < p -> diag_score)
@@ -5846,7 +5869,7 @@ void  Overlap_Align_Full_Matrix
          p -> Get_Max (mxs, mxf);
          entry . diag_score = mxs;
          entry . diag_from = mxf;
-         entry . diag_score += ((t [i] == s [c - 1]) ? match_score : mismatch_score);
+         entry . diag_score += ((Align_Alphabet_t :: Match (t [i], s [c - 1])) ? match_score : mismatch_score);
 
          p = & (a [r] [c - 1]);
          p -> Get_Max_Left (mxs, mxf, gap_score);
@@ -7112,7 +7135,7 @@ void  Update_Banded_Row
 
         save . Get_Max (mxs, mxf);
         p -> diag_score = mxs
-             + ((ch == s [left_col]) ? match_score : mismatch_score);
+             + ((Align_Alphabet_t :: Match (ch, s [left_col])) ? match_score : mismatch_score);
         p -> diag_from = mxf;
         p -> diag_ref = save . Get_Ref (mxf);
         p -> diag_errors = save . Get_Errors (mxf);
@@ -7151,7 +7174,7 @@ void  Update_Banded_Row
 
       save . Get_Max (mxs, mxf);
       p -> diag_score = mxs
-           + ((ch == s [c]) ? match_score : mismatch_score);
+           + ((Align_Alphabet_t :: Match (ch, s [c])) ? match_score : mismatch_score);
       p -> diag_from = mxf;
       p -> diag_ref = save . Get_Ref (mxf);
       p -> diag_errors = save . Get_Errors (mxf);
@@ -7167,3 +7190,431 @@ void  Update_Banded_Row
 
    return;
   }
+
+
+
+static int  Window_Errors
+    (const vector < vector <int> > & column, const vector <string> & read_seq,
+     const vector <int> & first_in, const vector <int> & end_in,
+     const string & cons, int lo, int hi);
+
+
+
+int  Update_Contig_Reads
+    (AMOS :: Contig_t & contig, AMOS :: Bank_t & read_bank,
+     const vector <AMOS :: ID_t> & changed, int margin, int offset_delta,
+     double error_rate, int min_overlap)
+
+//  Recompute the layout and consensus of  contig  around the reads
+//  whose IIDs are in  changed , using  Update_Contig_Window  on
+//  each cluster of those reads.  Windows that come within  margin
+//  columns of each other are merged, and they are done from right
+//  to left so the positions of the remaining ones stay valid.
+//  Return the total change in gapped contig length.
+
+  {
+   vector <AMOS :: Tile_t> & tiling = contig . getReadTiling ();
+   vector < pair <int, int> >  window;
+   vector <AMOS :: ID_t>  want (changed);
+   int  delta;
+   int  i, j, n;
+
+   sort (want . begin (), want . end ());
+
+   n = tiling . size ();
+   for  (i = 0;  i < n;  i ++)
+     if  (binary_search (want . begin (), want . end (), tiling [i] . source))
+         window . push_back (make_pair (int (tiling [i] . offset),
+              int (tiling [i] . offset + tiling [i] . getGappedLength ())));
+
+   sort (window . begin (), window . end ());
+
+   n = window . size ();
+   j = 0;
+   for  (i = 1;  i < n;  i ++)
+     if  (window [i] . first <= window [j] . second + 2 * margin)
+         window [j] . second = Max (window [j] . second, window [i] . second);
+       else
+         window [++ j] = window [i];
+   if  (n > 0)
+       window . resize (j + 1);
+
+   delta = 0;
+   for  (i = int (window . size ()) - 1;  i >= 0;  i --)
+     delta += Update_Contig_Window (contig, read_bank, window [i] . first,
+          window [i] . second, margin, offset_delta, error_rate, min_overlap);
+
+   return  delta;
+  }
+
+
+
+int  Update_Contig_Window
+    (AMOS :: Contig_t & contig, AMOS :: Bank_t & read_bank, int lo, int hi,
+     int margin, int offset_delta, double error_rate, int min_overlap)
+
+//  Recompute the layout and consensus of  contig  between gapped
+//  positions  lo  and  hi  (half-open), widened by  margin  columns
+//  on each side, and then out to the nearest column boundary, within
+//  another  margin  columns, where neither the consensus nor any read
+//  has a gap on either side.  The part of every read that falls in
+//  that window is realigned with  Multi_Align  and consensus and
+//  quality for the window are redone with  Set_Consensus_And_Qual .
+//  The result is kept only if it has fewer disagreements (see
+//   Window_Errors ) than the window had, so updating a window that
+//  is already consistent, or updating the same window twice, leaves
+//  the contig as it is.  Gap columns in the window with no read
+//  bases are removed either way.  Read bases outside the window keep their
+//  columns, except that everything to the right of it moves by the
+//  change in window length.  Reads are fetched from  read_bank ,
+//  which must be open.   offset_delta ,  error_rate  and  min_overlap
+//  are as for  Multi_Align .  Return the change in gapped contig
+//  length.   contig  is left unchanged if the alignment throws.
+
+  {
+   vector <AMOS :: Tile_t>  tiling = contig . getReadTiling ();
+   string  cons = contig . getSeqString ();
+   string  qual = contig . getQualString ();
+   vector < vector <int> >  column, old_column;
+   vector <string>  read_seq;
+   vector <int>  member, first_in, end_in;
+   vector <char *>  s, q, tag;
+   vector <int>  frag_off, offset, ref;
+   vector <AMOS :: Range_t>  clr_list;
+   Gapped_Multi_Alignment_t  gma;
+   AMOS :: Contig_t  win;
+   AMOS :: Read_t  read;
+   string  win_cons, win_qual, new_cons;
+   char  tag_buff [100];
+   int  cons_len, win_lo, win_hi, delta, old_errors, squeezed;
+   int  i, j, k, m, n;
+
+   cons_len = cons . length ();
+   win_lo = Max (lo - margin, 0);
+   win_hi = Min (hi + margin, cons_len);
+   if  (win_lo >= win_hi)
+       return  0;
+
+   // Move each edge of the window to a clean cut.  A gap next to the
+   // cut could otherwise slide across it from one update to the next
+   {
+    int  ext_lo = Max (win_lo - margin, 0);
+    int  ext_hi = Min (win_hi + margin, cons_len);
+    vector <bool>  clean (ext_hi - ext_lo, true);
+
+    for  (i = ext_lo;  i < ext_hi;  i ++)
+      if  (cons [i] == '-')
+          clean [i - ext_lo] = false;
+
+    n = tiling . size ();
+    for  (i = 0;  i < n;  i ++)
+      {
+       const AMOS :: Tile_t  & t = tiling [i];
+
+       if  (t . offset >= ext_hi
+              || t . offset + int (t . getGappedLength ()) <= ext_lo)
+           continue;
+       for  (j = 0;  j < int (t . gaps . size ());  j ++)
+         {
+          k = t . offset + t . gaps [j] + j;
+          if  (ext_lo <= k && k < ext_hi)
+              clean [k - ext_lo] = false;
+         }
+      }
+
+    while  (win_lo > ext_lo
+              && ! (clean [win_lo - 1 - ext_lo] && clean [win_lo - ext_lo]))
+      win_lo --;
+    while  (win_hi < ext_hi
+              && ! (clean [win_hi - 1 - ext_lo] && clean [win_hi - ext_lo]))
+      win_hi ++;
+   }
+
+   // Find the reads with columns in the window, the columns of
+   // their bases, and the part of each that lies in the window
+   n = tiling . size ();
+   for  (i = 0;  i < n;  i ++)
+     {
+      const AMOS :: Tile_t  & t = tiling [i];
+      AMOS :: Range_t  clr = t . range;
+      string  seq, qv;
+      int  len, g;
+
+      if  (t . offset >= win_hi
+             || t . offset + int (t . getGappedLength ()) <= win_lo)
+          continue;
+
+      len = t . range . getLength ();
+      column . push_back (vector <int> (len));
+      vector <int>  & col = column . back ();
+      for  (j = g = 0;  j < len;  j ++)
+        {
+         while  (g < int (t . gaps . size ()) && int (t . gaps [g]) <= j)
+           g ++;
+         col [j] = t . offset + j + g;
+        }
+
+      read_bank . fetch (t . source, read);
+      if  (clr . isReverse ())
+          clr . swap ();
+      seq = read . getSeqString (clr);
+      qv = read . getQualString (clr);
+      if  (t . range . isReverse ())
+          {
+           Reverse_Complement (seq);
+           reverse (qv . begin (), qv . end ());
+          }
+      if  (int (seq . length ()) != len || int (qv . length ()) != len)
+          AMOS_THROW_ARGUMENT ("Read length does not match its tile");
+      for  (j = 0;  j < len;  j ++)
+        seq [j] = tolower (seq [j]);
+
+      member . push_back (i);
+      read_seq . push_back (seq);
+      first_in . push_back (lower_bound (col . begin (), col . end (), win_lo)
+           - col . begin ());
+      end_in . push_back (lower_bound (col . begin (), col . end (), win_hi)
+           - col . begin ());
+
+      m = member . size () - 1;
+      if  (first_in [m] < end_in [m])
+          {
+           s . push_back (strdup (seq . substr (first_in [m],
+                end_in [m] - first_in [m]) . c_str ()));
+           q . push_back (strdup (qv . substr (first_in [m],
+                end_in [m] - first_in [m]) . c_str ()));
+           sprintf (tag_buff, "%d", m + 1);
+           tag . push_back (strdup (tag_buff));
+          }
+     }
+
+   n = s . size ();
+   if  (n == 0)
+       return  0;
+
+   // Squeeze out window columns where no read has a base, such as
+   // one made by  insertGapColumn .  The result, with those read
+   // gaps dropped, is the layout the realignment has to beat
+   {
+    vector <int>  squeeze (win_hi - win_lo + 1, 0);
+
+    for  (m = 0;  m < int (member . size ());  m ++)
+      for  (j = first_in [m];  j < end_in [m];  j ++)
+        squeeze [column [m] [j] - win_lo] = 1;
+    for  (i = win_hi - win_lo - 1;  i >= 0;  i --)
+      if  (squeeze [i] == 0 && cons [win_lo + i] == '-')
+          {
+           cons . erase (win_lo + i, 1);
+           qual . erase (win_lo + i, 1);
+           squeeze [i] = 1;
+          }
+        else
+          squeeze [i] = 0;
+    for  (i = 1;  i <= win_hi - win_lo;  i ++)
+      squeeze [i] += squeeze [i - 1];
+
+    for  (m = 0;  m < int (member . size ());  m ++)
+      for  (j = first_in [m];  j < end_in [m];  j ++)
+        column [m] [j] -= squeeze [column [m] [j] - win_lo];
+    squeezed = squeeze [win_hi - win_lo];
+    win_hi -= squeezed;
+   }
+
+   for  (m = 0;  m < int (member . size ());  m ++)
+     if  (first_in [m] < end_in [m])
+         frag_off . push_back (column [m] [first_in [m]] - win_lo);
+
+   old_column = column;
+   old_errors = Window_Errors (column, read_seq, first_in, end_in, cons,
+        win_lo, win_hi);
+
+   // Multi_Align wants the strings in order with each offset
+   // relative to the previous string
+   vector < pair <int, int> >  by_off (n);
+   vector <int>  order (n);
+   for  (i = 0;  i < n;  i ++)
+     by_off [i] = make_pair (frag_off [i], i);
+   sort (by_off . begin (), by_off . end ());
+   for  (i = 0;  i < n;  i ++)
+     order [i] = by_off [i] . second;
+   Permute (s, order);
+   Permute (q, order);
+   Permute (tag, order);
+   for  (i = 0;  i < n;  i ++)
+     offset . push_back (i == 0 ? 0
+          : frag_off [order [i]] - frag_off [order [i - 1]]);
+
+   try
+     {
+      Multi_Align (contig . getEID (), s, offset, offset_delta, error_rate,
+           min_overlap, gma, & ref, & tag);
+      Permute (q, ref);
+      gma . Set_Consensus_And_Qual (s, q);
+      for  (i = 0;  i < n;  i ++)
+        clr_list . push_back (AMOS :: Range_t (0, strlen (s [i])));
+      gma . Make_AMOS_Contig (clr_list, tag, win);
+     }
+   catch  (...)
+     {
+      for  (i = 0;  i < n;  i ++)
+        {
+         free (s [i]);
+         free (q [i]);
+         free (tag [i]);
+        }
+      throw;
+     }
+
+   for  (i = 0;  i < n;  i ++)
+     {
+      free (s [i]);
+      free (q [i]);
+      free (tag [i]);
+     }
+
+   if  (int (win . getReadTiling () . size ()) != n)
+       AMOS_THROW_ARGUMENT ("Reads were left out of the window alignment");
+
+   delta = win . getLength () - (win_hi - win_lo);
+
+   // Realigned bases go where the window alignment put them
+   for  (i = 0;  i < n;  i ++)
+     {
+      const AMOS :: Tile_t  & w = win . getReadTiling () [i];
+      int  len = w . range . getLength ();
+
+      m = w . source - 1;
+      vector <int>  & col = column [m];
+      for  (j = k = 0;  j < len;  j ++)
+        {
+         while  (k < int (w . gaps . size ()) && int (w . gaps [k]) <= j)
+           k ++;
+         col [first_in [m] + j] = win_lo + w . offset + j + k;
+        }
+     }
+
+   // Keep the window as it was, less any squeezed columns, unless
+   // the realignment is better
+   win_cons = win . getSeqString ();
+   win_qual = win . getQualString ();
+   new_cons = cons;
+   new_cons . replace (win_lo, win_hi - win_lo, win_cons);
+   if  (Window_Errors (column, read_seq, first_in, end_in, new_cons,
+            win_lo, win_hi + delta) >= old_errors)
+       {
+        if  (squeezed == 0)
+            return  0;
+        column = old_column;
+        delta = 0;
+       }
+     else
+       {
+        cons = new_cons;
+        qual . replace (win_lo, win_hi - win_lo, win_qual);
+       }
+
+   // Rebuild the tiles from the new base columns
+   for  (m = 0;  m < int (member . size ());  m ++)
+     {
+      AMOS :: Tile_t  & t = tiling [member [m]];
+      vector <int>  & col = column [m];
+      int  len = col . size ();
+      int  trailing = 0;
+
+      // Gaps after the last base survive only right of the window
+      for  (j = 0;  j < int (t . gaps . size ());  j ++)
+        if  (int (t . gaps [j]) >= len
+               && t . offset + len + j >= win_hi + squeezed)
+            trailing ++;
+
+      for  (j = end_in [m];  j < len;  j ++)
+        col [j] += delta - squeezed;
+
+      if  (t . offset >= win_lo && len > 0)
+          t . offset = col [0];
+
+      t . gaps . clear ();
+      for  (j = k = 0;  j < len;  j ++)
+        while  (t . offset + j + k < col [j])
+          {
+           t . gaps . push_back (j);
+           k ++;
+          }
+      for  (j = 0;  j < trailing;  j ++)
+        t . gaps . push_back (len);
+     }
+
+   // Reads wholly right of the window move by its change in length.
+   // The window's own reads already have their final columns
+   {
+    vector <bool>  in_window (tiling . size (), false);
+
+    for  (m = 0;  m < int (member . size ());  m ++)
+      in_window [member [m]] = true;
+    n = tiling . size ();
+    for  (i = 0;  i < n;  i ++)
+      if  (! in_window [i] && tiling [i] . offset >= win_hi + squeezed)
+          tiling [i] . offset += delta - squeezed;
+   }
+
+   contig . setSequence (cons, qual);
+   contig . setReadTiling (tiling);
+
+   return  delta - squeezed;
+  }
+
+
+
+static int  Window_Errors
+    (const vector < vector <int> > & column, const vector <string> & read_seq,
+     const vector <int> & first_in, const vector <int> & end_in,
+     const string & cons, int lo, int hi)
+
+//  Return the number of disagreements in columns  lo .. hi-1  of a
+//  layout whose consensus is  cons :  read characters, bases or gaps,
+//  that differ from the consensus, plus columns where no read has a
+//  base.   column [m]  is the column of each base of the lower-case
+//  read  read_seq [m] , whose bases  first_in [m] .. end_in [m]-1  are
+//  in the window.  A read has a gap in every column between those
+//  bases, and out to the window edge on a side where it goes on.
+
+  {
+   vector <bool>  has_base (hi - lo, false);
+   int  errors = 0;
+   int  c, j, m, len, start, end;
+
+   for  (m = 0;  m < int (column . size ());  m ++)
+     {
+      const vector <int>  & col = column [m];
+
+      len = col . size ();
+      if  (first_in [m] > 0)
+          start = lo;
+      else if  (first_in [m] < end_in [m])
+          start = col [first_in [m]];
+        else
+          continue;
+      if  (end_in [m] < len)
+          end = hi;
+      else if  (first_in [m] < end_in [m])
+          end = col [end_in [m] - 1] + 1;
+        else
+          end = lo;
+
+      for  (c = start, j = first_in [m];  c < end;  c ++)
+        if  (j < end_in [m] && col [j] == c)
+            {
+             has_base [c - lo] = true;
+             if  (read_seq [m] [j ++] != tolower (cons [c]))
+                 errors ++;
+            }
+        else if  (cons [c] != '-')
+            errors ++;
+     }
+
+   for  (c = lo;  c < hi;  c ++)
+     if  (! has_base [c - lo])
+         errors ++;
+
+   return  errors;
+  }
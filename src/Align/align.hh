@@ -13,10 +13,13 @@
 #include  "datatypes_AMOS.hh"
 #include  "utility_AMOS.hh"
 #include  "Contig_AMOS.hh"
+#include  "Read_AMOS.hh"
+#include  "Bank_AMOS.hh"
 #include  "delcher.hh"
 #include  "fasta.hh"
 #include  "prob.hh"
 #include  "matrix.hh"
+#include  "alphabet.hh"
 #include  "CelMsg.hh"
 #include  "Slice.h"
 #include  <iostream>
@@ -41,8 +44,19 @@
 typedef  vector <int>  Delta_Encoding_t;
 
 
+#ifdef  ALIGN_POLY
+const char  ALPHABET [] = "acgtmrwsykvhdbn";
+const int  ALPHABET_SIZE = 15;
+typedef  Alphabet_Table_t <IUPAC_Alphabet_t>  Align_Alphabet_t;
+#else
 const char  ALPHABET [] = "acgtn";
 const int  ALPHABET_SIZE = 5;
+typedef  Alphabet_Table_t <DNA_Alphabet_t>  Align_Alphabet_t;
+#endif
+  // Lookup tables for the characters in  ALPHABET .  Every character
+  // comparison in the alignment routines goes through them, so
+  // defining  ALIGN_POLY  builds the same routines for the IUPAC
+  // alphabet (libAlign_poly.a , included via  align_poly.hh )
 const int  MATCH_FROM_TOP = 0;
 const int  MATCH_FROM_NW = 1;
 const int  MATCH_FROM_NE = -1;
@@ -89,6 +103,17 @@ const int  DEFAULT_GAP_SCORE = -1;
   // Extra penalty for first insertion/deletion in a run
 
 
+//  Default for incremental consensus updates
+const int  DEFAULT_UPDATE_MARGIN = 50;
+  // Columns added to each side of an edited region before it is realigned
+const int  DEFAULT_UPDATE_WIGGLE = 15;
+  // Positions either side of a read's column to look for its alignment
+const double  DEFAULT_UPDATE_ERROR_RATE = 0.06;
+  // Alignment error rate for realigned reads
+const int  DEFAULT_UPDATE_MIN_OVERLAP = 5;
+  // Minimum overlap bases between consecutive realigned reads
+
+
 class  Align_Score_Entry_t
   {
   public:
@@ -720,6 +745,19 @@ void  Update_Banded_Row
      int s_len, int left_col, int right_col, int match_score,
      int mismatch_score, int indel_score, int gap_score, int first_score,
      int first_error);
+int  Update_Contig_Reads
+    (AMOS :: Contig_t & contig, AMOS :: Bank_t & read_bank,
+     const vector <AMOS :: ID_t> & changed,
+     int margin = DEFAULT_UPDATE_MARGIN,
+     int offset_delta = DEFAULT_UPDATE_WIGGLE,
+     double error_rate = DEFAULT_UPDATE_ERROR_RATE,
+     int min_overlap = DEFAULT_UPDATE_MIN_OVERLAP);
+int  Update_Contig_Window
+    (AMOS :: Contig_t & contig, AMOS :: Bank_t & read_bank, int lo, int hi,
+     int margin = DEFAULT_UPDATE_MARGIN,
+     int offset_delta = DEFAULT_UPDATE_WIGGLE,
+     double error_rate = DEFAULT_UPDATE_ERROR_RATE,
+     int min_overlap = DEFAULT_UPDATE_MIN_OVERLAP);
 
 
 
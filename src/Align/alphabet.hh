@@ -0,0 +1,147 @@
+//
+//  File:  alphabet.hh
+//
+//  Alphabet traits for the alignment routines in  align.cc , which
+//  are built once for each alphabet (see  ALIGN_POLY  in  align.hh ).
+//  Each traits class lists its letters and the set of nucleotides
+//  each letter stands for.  Alphabet_Table_t  turns that into
+//  character lookup tables, built once, which the voting and
+//  dynamic-programming loops use in place of  strchr  and
+//  per-character set comparisons.
+
+
+#ifndef  __ALPHABET_HH_INCLUDED
+#define  __ALPHABET_HH_INCLUDED
+
+
+#include  <cctype>
+#include  <cstring>
+
+
+const unsigned char  NUC_A = 0x1;
+const unsigned char  NUC_C = 0x2;
+const unsigned char  NUC_G = 0x4;
+const unsigned char  NUC_T = 0x8;
+
+
+
+struct  DNA_Alphabet_t
+  {
+   //  Plain  acgt  plus  n .  Characters only match themselves.
+
+   static const bool  Exact = true;
+   static const char *  Letters
+       (void)
+     { return  "acgtn"; }
+   static unsigned char  Bases
+       (char ch)
+     { return  0; }
+   static bool  Wildcard
+       (char ch)
+     { return  false; }
+  };
+
+
+
+struct  IUPAC_Alphabet_t
+  {
+   //  All the IUPAC ambiguity codes.  Two characters match if one
+   //  stands for a subset of the other's nucleotides, and  n
+   //  matches anything.
+
+   static const bool  Exact = false;
+   static const char *  Letters
+       (void)
+     { return  "acgtmrwsykvhdbn"; }
+   static bool  Wildcard
+       (char ch)
+     { return  (ch == 'n'); }
+   static unsigned char  Bases
+       (char ch)
+     {
+      switch  (ch)
+        {
+         case  'a' :  return  NUC_A;
+         case  'c' :  return  NUC_C;
+         case  'g' :  return  NUC_G;
+         case  't' :  return  NUC_T;
+         case  'm' :  return  NUC_A | NUC_C;
+         case  'r' :  return  NUC_A | NUC_G;
+         case  'w' :  return  NUC_A | NUC_T;
+         case  's' :  return  NUC_C | NUC_G;
+         case  'y' :  return  NUC_C | NUC_T;
+         case  'k' :  return  NUC_G | NUC_T;
+         case  'v' :  return  NUC_A | NUC_C | NUC_G;
+         case  'h' :  return  NUC_A | NUC_C | NUC_T;
+         case  'd' :  return  NUC_A | NUC_G | NUC_T;
+         case  'b' :  return  NUC_C | NUC_G | NUC_T;
+        }
+      return  0;
+     }
+  };
+
+
+
+template <class AT>
+class  Alphabet_Table_t
+  {
+  public:
+   static int  Index
+       (char ch)
+     //  Return the subscript of  tolower (ch)  in the alphabet, the
+     //  alphabet size (the blank slot) for  '\0' , and  -1  if
+     //  ch  is not in the alphabet.  Same as  strchr  on the letters.
+     { return  table . index [(unsigned char) ch]; }
+   static bool  Match
+       (char a, char b)
+     //  Return true if  a  and  b  are compatible:  the same,
+     //  either is a wildcard, or one stands for a subset of the other.
+     //  Alphabets where characters only match themselves skip the table.
+     {
+      if  (AT :: Exact)
+          return  (a == b);
+      return  (table . match [(unsigned char) a] [(unsigned char) b] != 0);
+     }
+
+  private:
+   struct  Table_t
+     {
+      signed char  index [256];
+      unsigned char  match [256] [256];
+
+      Table_t
+          (void)
+        {
+         const char  * letters = AT :: Letters ();
+         const char  * p;
+         unsigned char  ma, mb;
+         int  a, b;
+
+         for  (a = 0;  a < 256;  a ++)
+           {
+            p = strchr (letters, tolower (a));
+            index [a] = (p == NULL ? -1 : p - letters);
+           }
+
+         for  (a = 0;  a < 256;  a ++)
+           for  (b = 0;  b < 256;  b ++)
+             {
+              ma = AT :: Bases (a);
+              mb = AT :: Bases (b);
+              match [a] [b] = (a == b || AT :: Wildcard (a) || AT :: Wildcard (b)
+                   || (ma != 0 && mb != 0
+                         && ((ma & mb) == ma || (ma & mb) == mb)));
+             }
+        }
+     };
+
+   static const Table_t  table;
+  };
+
+
+template <class AT>
+const typename Alphabet_Table_t <AT> :: Table_t  Alphabet_Table_t <AT> :: table;
+
+
+
+#endif
@@ -53,7 +53,7 @@ int  main (int argc, char * argv [])
     string helptext = 
 "\n"
 ".USAGE.\n"
-"  count-kmers [-f fasta] [-r bnk] [-c bnk] [-n bnk]\n"
+"  count-kmers [-f fasta] [-r bnk] [-c bnk] [-n bnk] [-R n]\n"
 "\n"
 ".DESCRIPTION.\n"
 "  Count kmers in a multifasta file or in read or contig banks.\n"
@@ -67,7 +67,9 @@ int  main (int argc, char * argv [])
 "  -m <min>   Minimum count to report (default: 1)\n"
 "  -F         Only count the forward strand\n"
 "  -S         Print using simple nmer count format: mer count\n"
-"  -s         Just print statistics on unique mers\n";
+"  -s         Just print statistics on unique mers\n"
+"  -R <n>     Load n bank records ahead of the counting in a background\n"
+"             thread (default: 0, off)\n";
 "\n.KEYWORDS.\n"
 "  kmers, fasta\n";
 
@@ -77,6 +79,7 @@ int  main (int argc, char * argv [])
     string normalizedbank;
 
     int min_count = 1;
+    int readahead = 0;
 
     tf = new AMOS_Foundation(version, helptext, "", argc, argv);
     tf->disableOptionHelp();
@@ -89,6 +92,7 @@ int  main (int argc, char * argv [])
     tf->getOptions()->addOptionResult("S",   &PRINT_SIMPLE);
     tf->getOptions()->addOptionResult("s",   &PRINT_STATS);
     tf->getOptions()->addOptionResult("F",   &FORWARD_ONLY);
+    tf->getOptions()->addOptionResult("R=i", &readahead);
 
     tf->handleStandardOptions();
 
@@ -140,6 +144,7 @@ int  main (int argc, char * argv [])
       cerr << "Processing reads in " << readbank << "..." << endl;
       BankStream_t bank(Read_t::NCODE);
       bank.open(readbank, B_READ);
+      bank.setReadAhead(readahead);
 
       Read_t red;
       while (bank >> red)
@@ -152,6 +157,7 @@ int  main (int argc, char * argv [])
       cerr << "Processing contigs in " << contigbank << "..." << endl;
       BankStream_t bank(Contig_t::NCODE);
       bank.open(contigbank, B_READ);
+      bank.setReadAhead(readahead);
 
       Contig_t contig;
       while (bank >> contig)
@@ -163,9 +169,11 @@ int  main (int argc, char * argv [])
     {
       BankStream_t rbank(Read_t::NCODE);
       rbank.open(normalizedbank, B_READ);
+      rbank.setReadAhead(readahead);
 
       BankStream_t cbank(Contig_t::NCODE);
       cbank.open(normalizedbank, B_READ);
+      cbank.setReadAhead(readahead);
 
       cerr << "Processing reads in " << normalizedbank << "..." << endl;
       Read_t red;
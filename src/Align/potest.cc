@@ -0,0 +1,199 @@
+// Checks POGraph on simulated layouts: error free reads must give back the
+// genome and their layout offsets, noisy reads a consensus within a few
+// edits of the genome with every read agreeing with the columns it is put
+// in, and the SIMD and scalar scoring loops the same contig.
+
+#include "POGraph.hh"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace AMOS;
+
+static const int GENOME_LEN = 20000;
+
+
+static string randomBases(int len)
+{
+  string s(len, 'A');
+  for (int i = 0; i < len; i++) { s[i] = "ACGT"[rand() % 4]; }
+  return s;
+}
+
+
+// Reads of 1500 to 4000 bases every 100 to 300 bases of genome, with
+// substitutions, deletions and insertions at rate err
+static void makeLayout(const string & genome, double err,
+                       Layout_t & lay, vector<string> & seqs)
+{
+  vector<Tile_t> tiling;
+  ID_t iid = 0;
+
+  for (int pos = 0; pos < (int) genome.size() - 1500; pos += 100 + rand() % 201)
+  {
+    int len = min(1500 + rand() % 2501, (int) genome.size() - pos);
+    string seq;
+
+    for (int k = pos; k < pos + len; k++)
+    {
+      double r = rand() / (RAND_MAX + 1.0);
+      if (r < err * 0.2) { seq += "ACGT"[rand() % 4]; }
+      else if (r < err * 0.6) { }
+      else if (r < err) { seq += genome[k]; seq += "ACGT"[rand() % 4]; }
+      else { seq += genome[k]; }
+    }
+
+    Tile_t tile;
+    tile.source = ++iid;
+    tile.offset = pos;
+    tile.range = Range_t(0, seq.size());
+    tiling.push_back(tile);
+    seqs.push_back(seq);
+  }
+
+  lay.setTiling(tiling);
+}
+
+
+// Edit distance of a and b, within band of the diagonal
+static int editDistance(const string & a, const string & b, int band)
+{
+  int n = a.size(), m = b.size();
+  vector<int> prev(m + 1), cur(m + 1);
+  const int INF = n + m;
+
+  for (int j = 0; j <= m; j++) { prev[j] = (j <= band) ? j : INF; }
+  for (int i = 1; i <= n; i++)
+  {
+    int center = (long long) i * m / n;
+    int lo = max(0, center - band), hi = min(m, center + band);
+    cur.assign(m + 1, INF);
+    if (lo == 0) { cur[0] = i; }
+    for (int j = max(1, lo); j <= hi; j++)
+    {
+      cur[j] = min(min(prev[j], cur[j-1]) + 1,
+                   prev[j-1] + (a[i-1] != b[j-1]));
+    }
+    prev.swap(cur);
+  }
+
+  return prev[m];
+}
+
+
+// Read bases that differ from the consensus column they are put in
+static int disagreements(const Contig_t & ctg, const vector<string> & seqs)
+{
+  const vector<Tile_t> & tiling = ctg.getReadTiling();
+  string cons = ctg.getSeqString();
+  int bad = 0;
+
+  for (unsigned int t = 0; t < tiling.size(); t++)
+  {
+    const Tile_t & tile = tiling[t];
+    const string & seq = seqs[tile.source - 1];
+    unsigned int g = 0;
+
+    for (int j = 0; j < (int) seq.size(); j++)
+    {
+      while (g < tile.gaps.size() && tile.gaps[g] <= j) { g++; }
+      int c = tile.offset + j + g;
+      if (c < 0 || c >= (int) cons.size()) { return -1; }
+      if (cons[c] != seq[j]) { bad++; }
+    }
+  }
+
+  return bad;
+}
+
+
+int main()
+{
+  int fails = 0;
+
+  srand(1);
+
+  try
+  {
+    string genome = randomBases(GENOME_LEN);
+
+    //-- Error free reads
+    {
+      Layout_t lay;
+      vector<string> seqs;
+      Contig_t ctg;
+      POGraph graph;
+
+      makeLayout(genome, 0, lay, seqs);
+      graph.alignLayout(lay, seqs, ctg);
+
+      if (ctg.getSeqString() != genome)
+      {
+        cerr << "FAIL: error free consensus differs from the genome" << endl;
+        fails++;
+      }
+
+      const vector<Tile_t> & tiling = ctg.getReadTiling();
+      for (unsigned int t = 0; t < tiling.size(); t++)
+      {
+        if (tiling[t].offset != lay.getTiling()[tiling[t].source - 1].offset ||
+            !tiling[t].gaps.empty())
+        {
+          cerr << "FAIL: error free read " << tiling[t].source << " moved" << endl;
+          fails++;
+        }
+      }
+    }
+
+    //-- Noisy reads, with both scoring loops
+    for (int pct = 2; pct <= 5; pct += 3)
+    {
+      Layout_t lay;
+      vector<string> seqs;
+      Contig_t ctg, scalar;
+      POGraph graph, graph2;
+
+      makeLayout(genome, pct / 100.0, lay, seqs);
+      graph.alignLayout(lay, seqs, ctg);
+      graph2.setSIMD(false);
+      graph2.alignLayout(lay, seqs, scalar);
+
+      string cons = ctg.getUngappedSeqString();
+      int edits = editDistance(cons, genome, 200);
+      int bad = disagreements(ctg, seqs);
+      int bases = 0;
+      for (unsigned int r = 0; r < seqs.size(); r++) { bases += seqs[r].size(); }
+
+      cerr << pct << "% error: " << seqs.size() << " reads, " << edits
+           << " consensus edits, " << bad << " read bases off consensus" << endl;
+
+      if (edits > GENOME_LEN / 500)
+      {
+        cerr << "FAIL: consensus too far from the genome" << endl;
+        fails++;
+      }
+      if (bad < 0 || bad > bases * pct / 50)
+      {
+        cerr << "FAIL: reads do not agree with their columns" << endl;
+        fails++;
+      }
+      if (ctg.getSeqString() != scalar.getSeqString() ||
+          ctg.getQualString() != scalar.getQualString() ||
+          ctg.getReadTiling() != scalar.getReadTiling())
+      {
+        cerr << "FAIL: SIMD and scalar contigs differ" << endl;
+        fails++;
+      }
+    }
+  }
+  catch (const Exception_t & e)
+  {
+    cerr << "FAIL: " << e << endl;
+    return EXIT_FAILURE;
+  }
+
+  cerr << (fails ? "FAILED" : "PASSED") << endl;
+  return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
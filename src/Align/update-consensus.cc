@@ -0,0 +1,225 @@
+//  File:  update-consensus.cc
+//
+//  Realign the reads in part of a contig already in a bank and
+//  recompute consensus there, leaving the rest of the contig alone.
+//  For use after a layout has been edited, instead of re-running
+//  make-consensus  on the whole contig.
+
+
+#include  "foundation_AMOS.hh"
+#include  "delcher.hh"
+#include  "align.hh"
+#include  <iostream>
+#include  <fstream>
+#include  <vector>
+#include  <string>
+
+
+using namespace std;
+using namespace AMOS;
+
+static int  Align_Wiggle = DEFAULT_UPDATE_WIGGLE;
+  // Passed to  Multi_Align
+static string  Bank_Name;
+  // Name of the bank holding the contig and its reads
+static string  Contig_ID;
+  // EID (or IID with  -i ) of the contig to update
+static bool  Contig_By_IID = false;
+  // If set true,  Contig_ID  is an IID
+static double  Error_Rate = DEFAULT_UPDATE_ERROR_RATE;
+  // Alignment error rate
+static int  Margin = DEFAULT_UPDATE_MARGIN;
+  // Columns added to each side of the region
+static int  Min_Overlap = DEFAULT_UPDATE_MIN_OVERLAP;
+  // Minimum overlap bases between consecutive reads
+static string  Read_File;
+  // File of EIDs of the reads that were edited
+static int  Window_Lo = -1, Window_Hi = -1;
+  // Gapped contig region to update
+
+
+static void  Parse_Command_Line
+    (int argc, char * argv []);
+static void  Usage
+    (const char * command);
+
+
+
+int  main
+    (int argc, char * argv [])
+
+  {
+   Bank_t  read_bank (Read_t :: NCODE);
+   Bank_t  contig_bank (Contig_t :: NCODE);
+   Contig_t  contig;
+   int  old_len, delta;
+
+   Verbose = 0;
+
+   Parse_Command_Line (argc, argv);
+
+   try
+     {
+      read_bank . open (Bank_Name, B_READ);
+      contig_bank . open (Bank_Name, B_READ | B_WRITE);
+
+      if  (Contig_By_IID)
+          contig_bank . fetch (ID_t (strtol (Contig_ID . c_str (), NULL, 10)),
+               contig);
+        else
+          contig_bank . fetch (Contig_ID, contig);
+
+      old_len = contig . getLength ();
+
+      if  (! Read_File . empty ())
+          {
+           vector <ID_t>  changed;
+           ifstream  in (Read_File . c_str ());
+           string  eid;
+
+           if  (! in)
+               AMOS_THROW_IO ("Could not open read file " + Read_File);
+           while  (in >> eid)
+             changed . push_back (read_bank . lookupIID (eid));
+
+           delta = Update_Contig_Reads (contig, read_bank, changed, Margin,
+                Align_Wiggle, Error_Rate, Min_Overlap);
+          }
+        else
+          delta = Update_Contig_Window (contig, read_bank, Window_Lo,
+               Window_Hi, Margin, Align_Wiggle, Error_Rate, Min_Overlap);
+
+      contig_bank . replace (contig . getIID (), contig);
+
+      cerr << "Updated contig " << contig . getEID () << "  gapped length "
+           << old_len << " -> " << old_len + delta << endl;
+
+      contig_bank . close ();
+      read_bank . close ();
+     }
+   catch  (Exception_t & e)
+     {
+      cerr << "ERROR: -- Fatal AMOS Exception --\n" << e;
+      return  EXIT_FAILURE;
+     }
+
+   return  EXIT_SUCCESS;
+  }
+
+
+
+static void  Parse_Command_Line
+    (int argc, char * argv [])
+
+//  Get options and parameters from command line with  argc
+//  arguments in  argv [0 .. (argc - 1)] .
+
+  {
+   bool  errflg = false;
+   int  ch;
+
+   optarg = NULL;
+
+   while  (! errflg
+             && ((ch = getopt (argc, argv, "e:hil:m:o:r:v:w:")) != EOF))
+     switch  (ch)
+       {
+        case  'e' :
+          Error_Rate = strtod (optarg, NULL);
+          break;
+
+        case  'h' :
+          errflg = true;
+          break;
+
+        case  'i' :
+          Contig_By_IID = true;
+          break;
+
+        case  'l' :
+          if  (sscanf (optarg, "%d,%d", & Window_Lo, & Window_Hi) != 2
+                 || Window_Lo < 0 || Window_Hi <= Window_Lo)
+              {
+               fprintf (stderr, "ERROR:  Bad region \"%s\"\n", optarg);
+               errflg = true;
+              }
+          break;
+
+        case  'm' :
+          Margin = strtol (optarg, NULL, 10);
+          break;
+
+        case  'o' :
+          Min_Overlap = strtol (optarg, NULL, 10);
+          break;
+
+        case  'r' :
+          Read_File = optarg;
+          break;
+
+        case  'v' :
+          Verbose = strtol (optarg, NULL, 10);
+          break;
+
+        case  'w' :
+          Align_Wiggle = strtol (optarg, NULL, 10);
+          break;
+
+        case  '?' :
+          fprintf (stderr, "Unrecognized option -%c\n", optopt);
+
+        default :
+          errflg = true;
+       }
+
+   if  (! errflg && (Window_Lo < 0) == Read_File . empty ())
+       {
+        fprintf (stderr, "\nERROR:  Must specify exactly one of -l or -r\n\n");
+        errflg = true;
+       }
+
+   if  (errflg || optind != argc - 2)
+       {
+        Usage (argv [0]);
+        exit (EXIT_FAILURE);
+       }
+
+   Bank_Name = argv [optind ++];
+   Contig_ID = argv [optind ++];
+
+   return;
+  }
+
+
+
+static void  Usage
+    (const char * command)
+
+//  Print to stderr description of options and command line for
+//  this program.   command  is the command that was used to
+//  invoke it.
+
+  {
+   fprintf (stderr,
+           "USAGE:  %s  [options]  <bank-name>  <contig-eid>\n"
+           "\n"
+           "Realign the reads in one region of a contig in <bank-name>\n"
+           "and recompute consensus and quality there.  The rest of the\n"
+           "contig is kept as is, apart from shifting by the change in\n"
+           "the region's length.  The contig is replaced in the bank.\n"
+           "\n"
+           "Options:\n"
+           "  -e <x>      Set alignment error rate to <x> (default %.2f)\n"
+           "  -h          Print this usage message\n"
+           "  -i          <contig-eid> is an IID\n"
+           "  -l <a>,<b>  Update gapped contig positions <a> .. <b>-1\n"
+           "  -m <n>      Widen the region by <n> columns each side (default %d)\n"
+           "  -o <n>      Set minimum overlap bases to <n> (default %d)\n"
+           "  -r <fn>     Update around the reads whose EIDs are listed in <fn>\n"
+           "  -v <n>      Set verbose level to <n>.  Higher produces more output\n"
+           "  -w <n>      Set alignment wiggle to <n> (default %d)\n"
+           "\n", command, DEFAULT_UPDATE_ERROR_RATE, DEFAULT_UPDATE_MARGIN,
+           DEFAULT_UPDATE_MIN_OVERLAP, DEFAULT_UPDATE_WIGGLE);
+
+   return;
+  }
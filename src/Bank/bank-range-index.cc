@@ -0,0 +1,138 @@
+#include "foundation_AMOS.hh"
+#include "amp.hh"
+#include "AMOS_Foundation.hh"
+
+using namespace AMOS;
+using namespace std;
+
+
+int main (int argc, char ** argv)
+{
+  AMOS_Foundation * tf = NULL;
+  int retval = 0;
+
+  try
+  {
+    string version =  "Version 1.0";
+    string dependencies = "";
+    string helptext =
+"\n.USAGE.\n"
+"  bank-range-index [options] bankname\n"
+"\n.DESCRIPTION.\n"
+"  Builds the contig range index of a bank, which finds the reads and\n"
+"  features of a contig that overlap a range without loading the contig.\n"
+"  The index is rebuilt whenever the contigs or features change.\n\n"
+"  With -q, answers a query instead. Output lines are:\n"
+"  TLE tileindex readiid begin end\n"
+"  FEA featureiid begin end\n"
+"  in gapped contig coordinates, end exclusive\n"
+"\n.OPTIONS.\n"
+"  -q contig,begin,end  Report the tiles and features overlapping the range\n"
+"  -e   the contig is given by eid instead of iid\n"
+"  -f   rebuild the index even if it is current\n"
+"\n.KEYWORDS.\n"
+"  amos bank, index\n";
+
+    string query;
+    int USEEID = 0;
+    int FORCE = 0;
+
+    tf = new AMOS_Foundation (version, helptext, dependencies, argc, argv);
+    tf->disableOptionHelp();
+    tf->getOptions()->addOptionResult("q=s", &query);
+    tf->getOptions()->addOptionResult("e", &USEEID);
+    tf->getOptions()->addOptionResult("f", &FORCE);
+    tf->handleStandardOptions();
+
+    list<string> argvv = tf->getOptions()->getAllOtherData();
+
+    if (argvv.size() != 1)
+    {
+      cerr << "Usage: bank-range-index [options] bankname" << endl;
+      return EXIT_FAILURE;
+    }
+
+    string bank_name = argvv.front();
+
+    if (FORCE || !ContigRangeIndex_t::isCurrent(bank_name))
+    {
+      cerr << "Indexing " << bank_name << " at " << Date() << endl;
+      ContigRangeIndex_t::build(bank_name);
+    }
+
+    ContigRangeIndex_t index;
+    index.open(bank_name);
+
+    if (query.empty())
+    {
+      cerr << "Indexed " << index.getNumContigs() << " contigs" << endl;
+    }
+    else
+    {
+      size_t c1 = query.find(',');
+      size_t c2 = (c1 == string::npos) ? c1 : query.find(',', c1 + 1);
+      if (c2 == string::npos)
+      {
+        cerr << "ERROR: query must be contig,begin,end" << endl;
+        return EXIT_FAILURE;
+      }
+
+      string contig = query.substr(0, c1);
+      Range_t range(atoi(query.substr(c1 + 1, c2 - c1 - 1).c_str()),
+                    atoi(query.substr(c2 + 1).c_str()));
+      ID_t iid = atoi(contig.c_str());
+
+      if (USEEID)
+      {
+        Bank_t contig_bank(Contig_t::NCODE);
+        contig_bank.open(bank_name, B_READ);
+        iid = contig_bank.lookupIID(contig);
+        contig_bank.close();
+      }
+
+      vector<ContigRangeIndex_t::Entry_t> entries;
+      vector<ContigRangeIndex_t::Entry_t>::const_iterator ei;
+
+      index.getTiles(iid, range, entries);
+      for (ei = entries.begin(); ei != entries.end(); ei++)
+      {
+        cout << "TLE " << ei->index << " " << ei->iid << " "
+             << ei->begin << " " << ei->end << endl;
+      }
+
+      entries.clear();
+      index.getFeatures(iid, range, entries);
+      for (ei = entries.begin(); ei != entries.end(); ei++)
+      {
+        cout << "FEA " << ei->iid << " "
+             << ei->begin << " " << ei->end << endl;
+      }
+    }
+  }
+  catch (Exception_t & e)
+  {
+    cerr << "ERROR: -- Fatal AMOS Exception --\n" << e;
+    retval = 1;
+  }
+  catch (const ExitProgramNormally & e)
+  {
+    retval = 0;
+  }
+  catch (const amosException & e)
+  {
+    cerr << e << endl;
+    retval = 100;
+  }
+
+  try
+  {
+    if (tf) delete tf;
+  }
+  catch (const amosException & e)
+  {
+    cerr << "amosException while deleting tf: " << e << endl;
+    retval = 105;
+  }
+
+  return retval;
+}
@@ -0,0 +1,154 @@
+#include "foundation_AMOS.hh"
+#include "amp.hh"
+#include "AMOS_Foundation.hh"
+
+using namespace AMOS;
+using namespace std;
+
+
+int main (int argc, char ** argv)
+{
+  AMOS_Foundation * tf = NULL;
+  int retval = 0;
+
+  try
+  {
+    string version =  "Version 1.0";
+    string dependencies = "";
+    string helptext =
+"\n.USAGE.\n"
+"  bank-read-index [options] bankname\n"
+"\n.DESCRIPTION.\n"
+"  Builds or updates the read index of a bank, which links every read to its\n"
+"  fragment, library, mate, contig and scaffold. hawkeye and findMissingMates\n"
+"  use a current index instead of indexing the whole bank on every open.\n"
+"  After contigs are appended, replaced or removed only the changed contigs\n"
+"  are reindexed, other changes rebuild the index.\n\n"
+"  With -r, reports the records of the given reads instead. Output lines are:\n"
+"  read fragment library mate contig scaffold\n"
+"  as iids, or eids with -e\n"
+"\n.OPTIONS.\n"
+"  -r read,read,...  Report the index records of these reads\n"
+"  -e   reads are given and reported by eid instead of iid\n"
+"  -f   rebuild the index from scratch\n"
+"\n.KEYWORDS.\n"
+"  amos bank, index\n";
+
+    string query;
+    int USEEID = 0;
+    int FORCE = 0;
+
+    tf = new AMOS_Foundation (version, helptext, dependencies, argc, argv);
+    tf->disableOptionHelp();
+    tf->getOptions()->addOptionResult("r=s", &query);
+    tf->getOptions()->addOptionResult("e", &USEEID);
+    tf->getOptions()->addOptionResult("f", &FORCE);
+    tf->handleStandardOptions();
+
+    list<string> argvv = tf->getOptions()->getAllOtherData();
+
+    if (argvv.size() != 1)
+    {
+      cerr << "Usage: bank-read-index [options] bankname" << endl;
+      return EXIT_FAILURE;
+    }
+
+    string bank_name = argvv.front();
+
+    if (FORCE)
+    {
+      cerr << "Indexing " << bank_name << " at " << Date() << endl;
+      ReadIndex_t::build(bank_name);
+    }
+    else if (ReadIndex_t::update(bank_name))
+    {
+      cerr << "Updated index of " << bank_name << " at " << Date() << endl;
+    }
+
+    ReadIndex_t index;
+    index.open(bank_name);
+
+    if (query.empty())
+    {
+      cerr << "Indexed " << index.getSize() << " reads" << endl;
+    }
+    else
+    {
+      Bank_t read_bank(Read_t::NCODE);
+      Bank_t frag_bank(Fragment_t::NCODE);
+      Bank_t lib_bank(Library_t::NCODE);
+      Bank_t contig_bank(Contig_t::NCODE);
+      Bank_t scaff_bank(Scaffold_t::NCODE);
+
+      read_bank.open(bank_name, B_READ);
+
+      if (USEEID)
+      {
+        // only open the banks whose eids are needed
+        if (frag_bank.exists(bank_name))   { frag_bank.open(bank_name, B_READ); }
+        if (lib_bank.exists(bank_name))    { lib_bank.open(bank_name, B_READ); }
+        if (contig_bank.exists(bank_name)) { contig_bank.open(bank_name, B_READ); }
+        if (scaff_bank.exists(bank_name))  { scaff_bank.open(bank_name, B_READ); }
+      }
+
+      string::size_type start = 0, comma;
+      do
+      {
+        comma = query.find(',', start);
+        string read = query.substr(start, comma - start);
+        start = comma + 1;
+
+        ID_t iid = USEEID ? read_bank.lookupIID(read) : atoi(read.c_str());
+        const ReadIndex_t::Record_t * rec = index.find(iid);
+
+        if (rec == NULL)
+        {
+          cerr << "WARNING: read " << read << " is not indexed" << endl;
+          continue;
+        }
+
+        if (USEEID)
+        {
+          cout << read_bank.lookupEID(rec->read) << " "
+               << (frag_bank.isOpen() ? frag_bank.lookupEID(rec->fragment) : "") << " "
+               << (lib_bank.isOpen() ? lib_bank.lookupEID(rec->library) : "") << " "
+               << read_bank.lookupEID(rec->mate) << " "
+               << (contig_bank.isOpen() ? contig_bank.lookupEID(rec->contig) : "") << " "
+               << (scaff_bank.isOpen() ? scaff_bank.lookupEID(rec->scaffold) : "") << endl;
+        }
+        else
+        {
+          cout << rec->read << " " << rec->fragment << " "
+               << rec->library << " " << rec->mate << " "
+               << rec->contig << " " << rec->scaffold << endl;
+        }
+      } while (comma != string::npos);
+    }
+  }
+  catch (Exception_t & e)
+  {
+    cerr << "ERROR: -- Fatal AMOS Exception --\n" << e;
+    retval = 1;
+  }
+  catch (const ExitProgramNormally & e)
+  {
+    retval = 0;
+  }
+  catch (const amosException & e)
+  {
+    cerr << e << endl;
+    retval = 100;
+  }
+
+  try
+  {
+    if (tf) delete tf;
+  }
+  catch (const amosException & e)
+  {
+    cerr << "amosException while deleting tf: " << e << endl;
+    retval = 105;
+  }
+
+  return retval;
+}
@@ -19,6 +19,11 @@
 #include <iostream>
 #include <vector>
 #include <unistd.h>
+
+#ifdef AMOS_HAVE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace AMOS;
 using namespace std;
 using namespace HASHMAP;
@@ -35,6 +40,8 @@ bool   OPT_Reassign    = false;      // Reassign IIDs
 string OPT_BankName;                 // bank name parameter
 string OPT_MessageName;              // message name parameter
 
+const int BATCH_SIZE = 128;          // messages per batch, three in flight
+
 
 
 
@@ -66,16 +73,82 @@ void PrintHelp (const char * s);
 void PrintUsage (const char * s);
 
 
+//----------------------------------------------------- Transaction_t ----------
+//! \brief A top-level message and the object it converts to
+//!
+//! Messages are split off the input serially, parsed and converted to
+//! objects on worker threads, and then committed to the banks one at a time
+//! in input order. Each transaction has its own set of objects so
+//! conversions do not clash.
+//!
+struct Transaction_t
+{
+  string text;                      // raw message text
+  streamoff end;                    // input offset just past the message
+  Message_t msg;                    // the parsed message
+  UniversalSet_t objs;              // conversion objects for this slot
+  Universal_t * op;                 // the converted object, or NULL
+  bool malformed;                   // true if the text did not parse
+  bool failed;                      // true if the conversion failed
+  string error;                     // the parse or conversion error
+};
+
+
+//----------------------------------------------------- ConvertMessage ---------
+//! \brief Parses a transaction's text and converts it to its object
+//!
+//! Only touches the transaction itself, so it is safe to run concurrently.
+//!
+//! \return void
+//!
+void ConvertMessage (Transaction_t & t);
+
+
+//----------------------------------------------------- TransactMessages -------
+//! \brief Reads, converts and commits all the messages from a reader
+//!
+//! Batches go through three stages: one thread commits a batch and then
+//! splits the next one off the input, while the other threads convert the
+//! batch in between.
+//!
+//! \param reader The message source
+//! \param dots Progress dots to update with the input offset, or NULL
+//! \return void
+//!
+void TransactMessages (MessageReader_t & reader, ProgressDots_t * dots);
+
+
+//----------------------------------------------------- ReadBatch --------------
+//! \brief Splits up to BATCH_SIZE messages off the reader into a batch
+//!
+//! \param error Set to a copy of the read error, if there is one
+//! \return The number of messages read before EOF or the error
+//!
+int ReadBatch (MessageReader_t & reader, vector<Transaction_t *> & batch,
+               Exception_t * & error);
+
+
+//----------------------------------------------------- CommitBatch ------------
+//! \brief Commits the first n converted transactions in input order
+//!
+//! \throws IOException_t at the first transaction whose text did not parse,
+//! after committing those before it
+//! \return void
+//!
+void CommitBatch (vector<Transaction_t *> & batch, int n, ProgressDots_t * dots);
+
+
 int exitcode = EXIT_SUCCESS;
 long int cnts = 0;                  // messages seen
 long int cnta = 0;                  // objects appended
 long int cntd = 0;                  // objects deleted
 long int cntr = 0;                  // objects replaced
+streamoff msgpos = 0;               // input offset of the last message read
 NCode_t ncode;                      // current NCode
 char act;                           // action enumeration
 
 BankStreamSet_t bnks;               // all the banks
-UniversalSet_t objs;                // all the objects
+UniversalSet_t objs;                // all the object types
 
 BankStream_t * bp;                  // current bank
 Universal_t * op;                   // current object
@@ -149,7 +222,7 @@ ReassignMap::iterator findOrCreate(ReassignMap & map, NCode_t ncode, ID_t oldiid
 
 
 
-void HandleMessage(Message_t & msg)
+void HandleMessage(Message_t & msg, Universal_t * obj, const string * error)
 {
         cnts ++;
         ncode = msg . getMessageCode( );
@@ -164,23 +237,21 @@ void HandleMessage(Message_t & msg)
           }
 
         bp = & (bnks [ncode]);
-        op = & (objs [ncode]);
+        op = obj;
         if ( bp -> getStatus( ) )
           return; // skip objects missing a bank
 
-        //-- Parse the message
-        try {
-          op -> readMessage (msg);
-        }
-        catch (const Exception_t & e) {
-          cerr << "ERROR: " << e . what( ) << endl
-               << "  could not parse '" << Decode (ncode)
-               << "' message with iid:"
-               << (msg . exists (F_IID) ? msg . getField (F_IID) : "NULL")
-               << ", message ignored" << endl;
-          exitcode = EXIT_FAILURE;
-          return;
-        }
+        //-- Check the message was converted
+        if ( error != NULL )
+          {
+            cerr << "ERROR: " << *error << endl
+                 << "  could not parse '" << Decode (ncode)
+                 << "' message with iid:"
+                 << (msg . exists (F_IID) ? msg . getField (F_IID) : "NULL")
+                 << ", message ignored" << endl;
+            exitcode = EXIT_FAILURE;
+            return;
+          }
 
         //-- Open the bank if necessary
         try {
@@ -292,11 +363,156 @@ void HandleMessage(Message_t & msg)
 
 
 
+//-------------------------------------------------------- ConvertMessage ----//
+void ConvertMessage (Transaction_t & t)
+{
+  t . op = NULL;
+  t . malformed = false;
+  t . failed = false;
+
+  try {
+    MessageReader_t (t . text) . read (t . msg);
+  }
+  catch (const Exception_t & e) {
+    t . malformed = true;
+    t . error = e . what( );
+    return;
+  }
+
+  try {
+    NCode_t nc = t . msg . getMessageCode( );
+    if ( t . objs . exists (nc) )
+      {
+        t . op = & (t . objs [nc]);
+        t . op -> readMessage (t . msg);
+      }
+  }
+  catch (const Exception_t & e) {
+    t . failed = true;
+    t . error = e . what( );
+  }
+}
+
+
+
+
+//------------------------------------------------------------- ReadBatch ----//
+int ReadBatch (MessageReader_t & reader, vector<Transaction_t *> & batch,
+               Exception_t * & error)
+{
+  int n = 0;
+
+  try {
+    while ( n < BATCH_SIZE  &&  reader . readText (batch [n] -> text) )
+      batch [n ++] -> end = reader . tell( );
+  }
+  catch (const Exception_t & e) {
+    error = new Exception_t (e);
+  }
+
+  return n;
+}
+
+
+
+
+//----------------------------------------------------------- CommitBatch ----//
+void CommitBatch (vector<Transaction_t *> & batch, int n, ProgressDots_t * dots)
+{
+  for ( int i = 0; i < n; i ++ )
+    {
+      if ( batch [i] -> malformed )
+        AMOS_THROW_IO (batch [i] -> error);
+
+      msgpos = batch [i] -> end;
+      if ( dots != NULL )
+        dots -> update (msgpos);
+      HandleMessage (batch [i] -> msg, batch [i] -> op,
+                     batch [i] -> failed ? &batch [i] -> error : NULL);
+    }
+}
+
+
+
+
+//------------------------------------------------------ TransactMessages ----//
+void TransactMessages (MessageReader_t & reader, ProgressDots_t * dots)
+{
+  vector<Transaction_t *> batch [3];
+  int n [3];
+  int done = 0, cur = 1, next = 2;  // committing, converting, reading
+  Exception_t * readerr = NULL;     // the reader's error, thrown last
+  Exception_t * error = NULL;       // a commit error, thrown at once
+  int i, k;
+
+  for ( k = 0; k < 3; k ++ )
+    for ( i = 0; i < BATCH_SIZE; i ++ )
+      {
+        batch [k] . push_back (new Transaction_t( ));
+
+        //-- Compress RED and SEQ if option is turned on
+        if ( OPT_Compress )
+          {
+            ((Read_t &)batch [k] [i] -> objs [Read_t::NCODE]) . compress( );
+            ((Sequence_t &)batch [k] [i] -> objs [Sequence_t::NCODE]) . compress( );
+          }
+      }
+
+  n [done] = 0;
+  n [cur] = ReadBatch (reader, batch [cur], readerr);
+
+  while ( n [done] > 0  ||  n [cur] > 0 )
+    {
+      bool more = ( n [cur] == BATCH_SIZE  &&  readerr == NULL );
+      n [next] = 0;
+
+#pragma omp parallel
+      {
+        //-- Commit the converted batch and read the next one on one thread
+#pragma omp single nowait
+        {
+          try {
+            CommitBatch (batch [done], n [done], dots);
+            if ( more )
+              n [next] = ReadBatch (reader, batch [next], readerr);
+          }
+          catch (const Exception_t & e) {
+            error = new Exception_t (e);
+          }
+        }
+
+        //-- Convert the batch in between on the rest
+#pragma omp for schedule(dynamic) nowait
+        for ( i = 0; i < n [cur]; i ++ )
+          ConvertMessage (*batch [cur] [i]);
+      }
+
+      if ( error != NULL )
+        break;
+
+      k = done; done = cur; cur = next; next = k;
+    }
+
+  for ( k = 0; k < 3; k ++ )
+    for ( i = 0; i < BATCH_SIZE; i ++ )
+      delete batch [k] [i];
+
+  if ( error != NULL  ||  readerr != NULL )
+    {
+      Exception_t e (error != NULL ? *error : *readerr);
+      delete error;
+      delete readerr;
+      throw e;
+    }
+}
+
+
+
+
 //========================================================= Function Defs ====//
 int main (int argc, char ** argv)
 {
 
-  Message_t msg;                      // current message
   ifstream  msgfile;                   // the message file stream
 
   //-- Parse the command line arguments
@@ -318,23 +534,12 @@ int main (int argc, char ** argv)
             i -> destroy ( );
           }
 
-    //-- Compress RED and SEQ if option is turned on
-    if ( OPT_Compress )
-      {
-        ((Read_t &)objs [Read_t::NCODE]) . compress( );
-        ((Sequence_t &)objs [Sequence_t::NCODE]) . compress( );
-      }
-
-
-
     //-- Read the Messages
     if (OPT_MessageName == "-")
     {
       cerr << "Reading messages from standard in" << endl;
-      while ( msg . read (cin) )
-      {
-        HandleMessage(msg);
-      }
+      MessageReader_t reader (cin);
+      TransactMessages (reader, NULL);
     }
     else
     {
@@ -352,11 +557,8 @@ int main (int argc, char ** argv)
            << "AFG ";
 
       //-- Read the message file
-      while ( msg . read (msgfile) )
-        {
-          dots . update (msgfile . tellg( ));
-          HandleMessage(msg);
-        }
+      MessageReader_t reader (msgfile);
+      TransactMessages (reader, &dots);
 
       dots . end( );
       msgfile . close( );
@@ -366,7 +568,7 @@ int main (int argc, char ** argv)
   }
   catch (const Exception_t & e) {
     cerr << "FATAL: " << e . what( ) << endl
-	 << "at offset: " << msgfile.tellg() << " in message file" << endl
+	 << "at offset: " << msgpos << " in message file" << endl
          << "  there has been a fatal error, abort" << endl;
     exitcode = EXIT_FAILURE;
   }
@@ -482,6 +684,9 @@ void PrintHelp (const char * s)
         << "  reference IIDs. If an object has a non-unique ID, the user will be\n"
         << "  warned and the object will be ignored. To retrieve information from\n"
         << "  a bank in message format, please use the bank-report utility.\n"
+        << "  Messages are converted to objects in parallel, but committed to the\n"
+        << "  bank in input order. Set OMP_NUM_THREADS to control the number of\n"
+        << "  threads.\n"
         << "\n.OPTIONS.\n"
         << "  -b path       The directory path of the banks to open or create\n"
         << "  -c            Create new bank directory if path does not exist\n"
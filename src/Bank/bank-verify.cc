@@ -0,0 +1,305 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Checks the partitions of a bank against their block checksums
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#include "foundation_AMOS.hh"
+#include "amp.hh"
+#include <set>
+#include <vector>
+#include <iostream>
+#include <unistd.h>
+#ifdef AMOS_HAVE_OPENMP
+#include <omp.h>
+#endif
+using namespace AMOS;
+using namespace std;
+
+
+
+
+//=============================================================== Globals ====//
+string  OPT_BankName;                        // bank name parameter
+bool    OPT_IsVerifyCodes = false;           // verify certain codes
+set<NCode_t> OPT_VerifyCodes;                // NCodes to verify
+bool    OPT_Record = false;                  // checksum unchecksummed stores
+int     OPT_Threads = 0;                     // 0 for the OpenMP default
+
+
+
+//========================================================== Fuction Decs ====//
+//----------------------------------------------------- ParseArgs --------------
+//! \brief Sets the global OPT_% values from the command line arguments
+//!
+//! \return void
+//!
+void ParseArgs (int argc, char ** argv);
+
+
+//----------------------------------------------------- PrintHelp --------------
+//! \brief Prints help information to cerr
+//!
+//! \param s The program name, i.e. argv[0]
+//! \return void
+//!
+void PrintHelp (const char * s);
+
+
+//----------------------------------------------------- PrintUsage -------------
+//! \brief Prints usage information to cerr
+//!
+//! \param s The program name, i.e. argv[0]
+//! \return void
+//!
+void PrintUsage (const char * s);
+
+
+
+//========================================================= Function Defs ====//
+int main (int argc, char ** argv)
+{
+  int exitcode = EXIT_SUCCESS;
+  long int cntp = 0;       // partitions verified
+  long int cntc = 0;       // partitions corrupted
+  long int cntu = 0;       // partitions without checksums
+  NCode_t ncode;           // current bank type
+  BankSet_t bnks;          // all the banks
+
+  BankSet_t::iterator bi;
+  set<NCode_t>::iterator ci;
+
+  vector<Bank_t *> tbanks; // bank of each partition to verify
+  vector<Size_t> tpids;    // partition to verify
+
+  //-- Parse the command line arguments
+  ParseArgs (argc, argv);
+
+#ifdef AMOS_HAVE_OPENMP
+  if ( OPT_Threads > 0 )
+    omp_set_num_threads (OPT_Threads);
+#endif
+
+  //-- Output the current time and bank directory
+  cerr << "START DATE: " << Date( ) << endl;
+  cerr << "Bank is: " << OPT_BankName << endl;
+
+  //-- BEGIN: MAIN EXCEPTION CATCH
+  try {
+
+    //-- Open each known bank and list its partitions
+    for ( bi = bnks.begin( ); bi != bnks.end( ); ++ bi )
+      {
+        ncode = bi -> getType( );
+
+	//-- Skip if we're not looking at this one or it doesn't exist
+	if ( (OPT_IsVerifyCodes  &&
+	      OPT_VerifyCodes . find (ncode) == OPT_VerifyCodes . end( ))
+	     ||
+             !bi -> exists (OPT_BankName) )
+	  continue;
+
+        OPT_VerifyCodes . erase (ncode);
+
+        try {
+          if ( OPT_Record )
+            {
+              bi -> open (OPT_BankName, B_READ | B_WRITE);
+              Size_t n = bi -> recordChecksums( );
+              bi -> close( );
+              if ( n > 0 )
+                cerr << Decode (ncode) << " ... "
+                     << n << " partitions checksummed\n";
+            }
+
+          bi -> open (OPT_BankName, B_READ);
+        }
+        catch (const Exception_t & e) {
+          cerr << "ERROR: " << e . what( ) << endl
+               << "  failed to open '" << Decode (ncode) << "' bank" << endl;
+          exitcode = EXIT_FAILURE;
+          continue;
+        }
+
+        for ( Size_t i = 0; i != bi -> getPartitionCount( ); ++ i )
+          {
+            tbanks . push_back (&(*bi));
+            tpids . push_back (i);
+          }
+      }
+
+    //-- Scrub the partitions of all the banks at once
+    int ntasks = tpids . size( );
+    vector<string> reports (ntasks);
+    vector<Size_t> problems (ntasks, 0);
+    vector<char> summed (ntasks, true);
+
+#pragma omp parallel for schedule(dynamic)
+    for ( int i = 0; i < ntasks; ++ i )
+      {
+        bool checksummed = true;
+        try {
+          problems [i] = tbanks [i] -> verifyPartition
+            (tpids [i], reports [i], checksummed);
+        }
+        catch (const Exception_t & e) {
+          reports [i] += string (e . what( )) + '\n';
+          problems [i] ++;
+        }
+        summed [i] = checksummed;
+      }
+
+    //-- Report in partition order
+    for ( int i = 0; i < ntasks; ++ i )
+      {
+        cntp ++;
+        if ( ! summed [i] )
+          cntu ++;
+        if ( problems [i] == 0 )
+          continue;
+
+        cntc ++;
+        cerr << "ERROR: " << Decode (tbanks [i] -> getType( ))
+             << " partition " << tpids [i] << " is corrupted" << endl
+             << reports [i];
+        exitcode = EXIT_FAILURE;
+      }
+
+    if ( cntu > 0 )
+      cerr << "WARNING: " << cntu << " partitions have no checksums,"
+           << " only their records were checked" << endl
+           << "  run with -r to checksum them" << endl;
+
+    for ( bi = bnks.begin( ); bi != bnks.end( ); ++ bi )
+      if ( bi -> isOpen( ) )
+        bi -> close( );
+
+  //-- Any codes unrecognized?
+  for ( ci = OPT_VerifyCodes.begin( ); ci != OPT_VerifyCodes.end( ); ++ ci )
+    {
+      cerr << "ERROR: Unrecognized bank type" << endl
+           << "  unknown bank type '" << Decode (*ci) << "' ignored" << endl;
+      exitcode = EXIT_FAILURE;
+    }
+  }
+  catch (const Exception_t & e) {
+    cerr << "FATAL: " << e . what( ) << endl
+         << "  there has been a fatal error, abort" << endl;
+    exitcode = EXIT_FAILURE;
+  }
+  //-- END: MAIN EXCEPTION CATCH
+
+
+  //-- Output the end time
+  cerr << "Partitions verified: " << cntp << endl
+       << "Partitions corrupted: " << cntc << endl
+       << "END DATE:   " << Date( ) << endl;
+
+  return exitcode;
+}
+
+
+
+
+//------------------------------------------------------------- ParseArgs ----//
+void ParseArgs (int argc, char ** argv)
+{
+  int ch, errflg = 0;
+  optarg = NULL;
+
+  while ( !errflg && ((ch = getopt (argc, argv, "b:hrt:v")) != EOF) )
+    switch (ch)
+      {
+      case 'b':
+        OPT_BankName = optarg;
+        break;
+
+      case 'h':
+        PrintHelp (argv[0]);
+        exit (EXIT_SUCCESS);
+        break;
+
+      case 'r':
+        OPT_Record = true;
+        break;
+
+      case 't':
+        OPT_Threads = atoi (optarg);
+        break;
+
+      case 'v':
+        PrintBankVersion (argv[0]);
+        exit (EXIT_SUCCESS);
+        break;
+
+      default:
+        errflg ++;
+      }
+
+  if ( OPT_BankName . empty( ) )
+    {
+      cerr << "ERROR: The -b option is mandatory\n";
+      errflg ++;
+    }
+
+  if ( access (OPT_BankName . c_str( ),
+               OPT_Record ? R_OK|W_OK|X_OK : R_OK|X_OK) )
+    {
+      cerr << "ERROR: Bank directory is not accessible, "
+	   << strerror (errno) << endl;
+      errflg ++;
+    }
+
+  if ( errflg > 0 )
+    {
+      PrintUsage (argv[0]);
+      cerr << "Try '" << argv[0] << " -h' for more information.\n";
+      exit (EXIT_FAILURE);
+    }
+
+  if ( optind != argc )
+    {
+      OPT_IsVerifyCodes = true;
+      while ( optind != argc )
+	OPT_VerifyCodes . insert (Encode (argv [optind ++]));
+    }
+}
+
+
+
+
+//------------------------------------------------------------- PrintHelp ----//
+void PrintHelp (const char * s)
+{
+  PrintUsage (s);
+  cerr
+    << "\n.DESCRIPTION.\n"
+    << "  Takes an AMOS bank directory as input. If no NCodes are listed on the\n"
+    << "  command line, all bank types will be verified. Otherwise, only the\n"
+    << "  listed bank types will be verified. Every partition is read in full\n"
+    << "  and checked against the block checksums recorded when it was written,\n"
+    << "  and every record is checked to point inside its variable store.\n"
+    << "  Partitions are verified in parallel. Exits with failure if any\n"
+    << "  partition is corrupted.\n"
+    << "\n.OPTIONS.\n"
+    << "  -b path       The directory path of the bank to verify\n"
+    << "  -h            Display help information\n"
+    << "  -r            Checksum partitions written without checksums first\n"
+    << "  -t num        Number of partitions verified at once\n"
+    << "  -v            Display the compatible bank version\n"
+    << "\n.KEYWORDS.\n"
+    << "  amos bank\n"
+    << endl;
+
+  return;
+}
+
+
+
+
+//------------------------------------------------------------ PrintUsage ----//
+void PrintUsage (const char * s)
+{
+  cerr << "\nUSAGE:\n" << "  " <<  s << "  [options]  -b <bank path>  [NCodes]\n";
+  return;
+}
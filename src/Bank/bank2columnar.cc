@@ -0,0 +1,677 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Exports the metadata of a bank as Arrow IPC tables
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#include "foundation_AMOS.hh"
+#include "amp.hh"
+#include "columnar.hh"
+#include <algorithm>
+#include <set>
+#include <vector>
+#include <iostream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef AMOS_HAVE_OPENMP
+#include <omp.h>
+#endif
+using namespace AMOS;
+using namespace std;
+
+
+
+
+//=============================================================== Globals ====//
+string  OPT_BankName;                        // bank name parameter
+string  OPT_OutDir = ".";                    // output directory
+int     OPT_Threads = 0;                     // 0 for the OpenMP default
+int     OPT_BatchSize = DEFAULT_COLUMNAR_BATCH; // objects per record batch
+bool    OPT_IsTables = false;                // export certain tables
+set<string> OPT_Tables;                      // tables to export
+
+const char * TABLES[] = {"reads", "fragments", "libraries", "contig_tiles",
+                         "scaffold_tiles", "features", "contig_edges"};
+const int NUM_TABLES = sizeof (TABLES) / sizeof (TABLES[0]);
+
+
+//-- The ID maps giving the EIDs of the objects tables refer to
+struct Lookup_t
+{
+  const IDMap_t * reads;
+  const IDMap_t * contigs;
+};
+
+
+
+//========================================================== Fuction Decs ====//
+//----------------------------------------------------- ExportTable ------------
+//! \brief Writes one row or more for each object of a bank to an Arrow file
+//!
+//! Objects are fetched from the mapped bank by several threads at once, each
+//! filling its own record batch, and the batches are written in bank order.
+//!
+//! \param name The table name, written to OPT_OutDir/name.arrow
+//! \param ncode The bank type
+//! \param fields The columns of the table
+//! \param add Appends the rows of one object to a batch
+//! \param fixonly Fetch only the fixed length part of the objects
+//! \return The number of rows written, or -1 if there is no such bank
+//!
+template <class T>
+int64_t ExportTable (const string & name, NCode_t ncode,
+                     const vector<Column_Field_t> & fields,
+                     void (* add) (T &, Column_Batch_t &, const Lookup_t &),
+                     const Lookup_t & lookup, bool fixonly);
+
+
+//----------------------------------------------------- ParseArgs --------------
+//! \brief Sets the global OPT_% values from the command line arguments
+//!
+//! \return void
+//!
+void ParseArgs (int argc, char ** argv);
+
+
+//----------------------------------------------------- PrintHelp --------------
+//! \brief Prints help information to cerr
+//!
+//! \param s The program name, i.e. argv[0]
+//! \return void
+//!
+void PrintHelp (const char * s);
+
+
+//----------------------------------------------------- PrintUsage -------------
+//! \brief Prints usage information to cerr
+//!
+//! \param s The program name, i.e. argv[0]
+//! \return void
+//!
+void PrintUsage (const char * s);
+
+
+
+//========================================================= Table Defs =======//
+static string Code (char c)
+{
+  return c == NULL_CHAR ? string( ) : string (1, c);
+}
+
+
+static bool ByBID (const IDMap_t::HashTriple_t * a,
+                   const IDMap_t::HashTriple_t * b)
+{
+  return a -> bid < b -> bid;
+}
+
+
+static vector<Column_Field_t> ReadFields ( )
+{
+  vector<Column_Field_t> f;
+  f . push_back (Column_Field_t ("iid", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("fragment", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("type", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("length", COLUMN_INT32));
+  f . push_back (Column_Field_t ("clear_begin", COLUMN_INT32));
+  f . push_back (Column_Field_t ("clear_end", COLUMN_INT32));
+  f . push_back (Column_Field_t ("quality_clear_begin", COLUMN_INT32));
+  f . push_back (Column_Field_t ("quality_clear_end", COLUMN_INT32));
+  f . push_back (Column_Field_t ("vector_clear_begin", COLUMN_INT32));
+  f . push_back (Column_Field_t ("vector_clear_end", COLUMN_INT32));
+  return f;
+}
+
+static void AddRead (Read_t & red, Column_Batch_t & rows, const Lookup_t &)
+{
+  Range_t clr = red . getClearRange( );
+  Range_t qclr = red . getQualityClearRange( );
+  Range_t vclr = red . getVectorClearRange( );
+
+  rows[0] . add_uint32 (red . getIID( ));
+  rows[1] . add_string (red . getEID( ));
+  rows[2] . add_uint32 (red . getFragment( ));
+  rows[3] . add_string (Code (red . getType( )));
+  rows[4] . add_int32 (red . getLength( ));
+  rows[5] . add_int32 (clr . begin);
+  rows[6] . add_int32 (clr . end);
+  rows[7] . add_int32 (qclr . begin);
+  rows[8] . add_int32 (qclr . end);
+  rows[9] . add_int32 (vclr . begin);
+  rows[10] . add_int32 (vclr . end);
+}
+
+
+static vector<Column_Field_t> FragmentFields ( )
+{
+  vector<Column_Field_t> f;
+  f . push_back (Column_Field_t ("iid", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("library", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("type", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("size", COLUMN_INT32));
+  f . push_back (Column_Field_t ("read_a", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("read_a_eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("read_b", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("read_b_eid", COLUMN_DICTIONARY));
+  return f;
+}
+
+static void AddFragment (Fragment_t & frg, Column_Batch_t & rows,
+                         const Lookup_t & lookup)
+{
+  pair<ID_t, ID_t> mates = frg . getMatePair( );
+
+  rows[0] . add_uint32 (frg . getIID( ));
+  rows[1] . add_string (frg . getEID( ));
+  rows[2] . add_uint32 (frg . getLibrary( ));
+  rows[3] . add_string (Code (frg . getType( )));
+  rows[4] . add_int32 (frg . getSize( ));
+  rows[5] . add_uint32 (mates . first);
+  rows[6] . add_string (lookup . reads -> lookupEID (mates . first));
+  rows[7] . add_uint32 (mates . second);
+  rows[8] . add_string (lookup . reads -> lookupEID (mates . second));
+}
+
+
+static vector<Column_Field_t> LibraryFields ( )
+{
+  vector<Column_Field_t> f;
+  f . push_back (Column_Field_t ("iid", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("mean", COLUMN_INT32));
+  f . push_back (Column_Field_t ("sd", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("adjacency", COLUMN_DICTIONARY));
+  return f;
+}
+
+static void AddLibrary (Library_t & lib, Column_Batch_t & rows, const Lookup_t &)
+{
+  Distribution_t dist = lib . getDistribution( );
+
+  rows[0] . add_uint32 (lib . getIID( ));
+  rows[1] . add_string (lib . getEID( ));
+  rows[2] . add_int32 (dist . mean);
+  rows[3] . add_uint32 (dist . sd);
+  rows[4] . add_string (Code (lib . getAdjacency( )));
+}
+
+
+static vector<Column_Field_t> ContigTileFields ( )
+{
+  vector<Column_Field_t> f;
+  f . push_back (Column_Field_t ("contig", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("contig_eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("read", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("read_eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("offset", COLUMN_INT32));
+  f . push_back (Column_Field_t ("range_begin", COLUMN_INT32));
+  f . push_back (Column_Field_t ("range_end", COLUMN_INT32));
+  f . push_back (Column_Field_t ("gapped_length", COLUMN_INT32));
+  f . push_back (Column_Field_t ("gaps", COLUMN_INT32));
+  return f;
+}
+
+static void AddContigTiles (Contig_t & ctg, Column_Batch_t & rows,
+                            const Lookup_t & lookup)
+{
+  const vector<Tile_t> & tiles = ctg . getReadTiling( );
+
+  for ( vector<Tile_t>::const_iterator
+          ti = tiles . begin( ); ti != tiles . end( ); ++ ti )
+    {
+      rows[0] . add_uint32 (ctg . getIID( ));
+      rows[1] . add_string (ctg . getEID( ));
+      rows[2] . add_uint32 (ti -> source);
+      rows[3] . add_string (lookup . reads -> lookupEID (ti -> source));
+      rows[4] . add_int32 (ti -> offset);
+      rows[5] . add_int32 (ti -> range . begin);
+      rows[6] . add_int32 (ti -> range . end);
+      rows[7] . add_int32 (ti -> getGappedLength( ));
+      rows[8] . add_int32 (ti -> gaps . size( ));
+    }
+}
+
+
+static vector<Column_Field_t> ScaffoldTileFields ( )
+{
+  vector<Column_Field_t> f;
+  f . push_back (Column_Field_t ("scaffold", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("scaffold_eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("contig", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("contig_eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("offset", COLUMN_INT32));
+  f . push_back (Column_Field_t ("range_begin", COLUMN_INT32));
+  f . push_back (Column_Field_t ("range_end", COLUMN_INT32));
+  f . push_back (Column_Field_t ("gapped_length", COLUMN_INT32));
+  return f;
+}
+
+static void AddScaffoldTiles (Scaffold_t & scf, Column_Batch_t & rows,
+                              const Lookup_t & lookup)
+{
+  const vector<Tile_t> & tiles = scf . getContigTiling( );
+
+  for ( vector<Tile_t>::const_iterator
+          ti = tiles . begin( ); ti != tiles . end( ); ++ ti )
+    {
+      rows[0] . add_uint32 (scf . getIID( ));
+      rows[1] . add_string (scf . getEID( ));
+      rows[2] . add_uint32 (ti -> source);
+      rows[3] . add_string (lookup . contigs -> lookupEID (ti -> source));
+      rows[4] . add_int32 (ti -> offset);
+      rows[5] . add_int32 (ti -> range . begin);
+      rows[6] . add_int32 (ti -> range . end);
+      rows[7] . add_int32 (ti -> getGappedLength( ));
+    }
+}
+
+
+static vector<Column_Field_t> FeatureFields ( )
+{
+  vector<Column_Field_t> f;
+  f . push_back (Column_Field_t ("iid", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("source", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("source_type", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("type", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("range_begin", COLUMN_INT32));
+  f . push_back (Column_Field_t ("range_end", COLUMN_INT32));
+  f . push_back (Column_Field_t ("comment", COLUMN_STRING));
+  return f;
+}
+
+static void AddFeature (Feature_t & fea, Column_Batch_t & rows, const Lookup_t &)
+{
+  pair<ID_t, NCode_t> source = fea . getSource( );
+  Range_t range = fea . getRange( );
+
+  rows[0] . add_uint32 (fea . getIID( ));
+  rows[1] . add_string (fea . getEID( ));
+  rows[2] . add_uint32 (source . first);
+  rows[3] . add_string (source . second == NULL_NCODE ?
+                        string( ) : Decode (source . second));
+  rows[4] . add_string (Code (fea . getType( )));
+  rows[5] . add_int32 (range . begin);
+  rows[6] . add_int32 (range . end);
+  rows[7] . add_string (fea . getComment( ));
+}
+
+
+static vector<Column_Field_t> ContigEdgeFields ( )
+{
+  vector<Column_Field_t> f;
+  f . push_back (Column_Field_t ("iid", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("contig_a", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("contig_a_eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("contig_b", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("contig_b_eid", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("adjacency", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("type", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("status", COLUMN_DICTIONARY));
+  f . push_back (Column_Field_t ("size", COLUMN_INT32));
+  f . push_back (Column_Field_t ("sd", COLUMN_UINT32));
+  f . push_back (Column_Field_t ("links", COLUMN_INT32));
+  return f;
+}
+
+static void AddContigEdge (ContigEdge_t & cte, Column_Batch_t & rows,
+                           const Lookup_t & lookup)
+{
+  pair<ID_t, ID_t> contigs = cte . getContigs( );
+
+  rows[0] . add_uint32 (cte . getIID( ));
+  rows[1] . add_string (cte . getEID( ));
+  rows[2] . add_uint32 (contigs . first);
+  rows[3] . add_string (lookup . contigs -> lookupEID (contigs . first));
+  rows[4] . add_uint32 (contigs . second);
+  rows[5] . add_string (lookup . contigs -> lookupEID (contigs . second));
+  rows[6] . add_string (Code (cte . getAdjacency( )));
+  rows[7] . add_string (Code (cte . getType( )));
+  rows[8] . add_string (Code (cte . getStatus( )));
+  rows[9] . add_int32 (cte . getSize( ));
+  rows[10] . add_uint32 (cte . getSD( ));
+  rows[11] . add_int32 (cte . getContigLinks( ) . size( ));
+}
+
+
+
+//========================================================= Function Defs ====//
+int main (int argc, char ** argv)
+{
+  int exitcode = EXIT_SUCCESS;
+  Bank_t red_bank (Read_t::NCODE);
+  Bank_t ctg_bank (Contig_t::NCODE);
+  IDMap_t empty;
+  Lookup_t lookup;
+
+  //-- Parse the command line arguments
+  ParseArgs (argc, argv);
+
+#ifdef AMOS_HAVE_OPENMP
+  if ( OPT_Threads > 0 )
+    omp_set_num_threads (OPT_Threads);
+#endif
+
+  //-- Output the current time and bank directory
+  cerr << "START DATE: " << Date( ) << endl;
+  cerr << "Bank is: " << OPT_BankName << endl;
+
+  //-- BEGIN: MAIN EXCEPTION CATCH
+  try {
+
+    //-- The read and contig EIDs are looked up for the tables refering to them
+    lookup . reads = lookup . contigs = &empty;
+    if ( red_bank . exists (OPT_BankName) )
+      {
+        red_bank . open (OPT_BankName, B_READ);
+        lookup . reads = &(red_bank . getIDMap( ));
+      }
+    if ( ctg_bank . exists (OPT_BankName) )
+      {
+        ctg_bank . open (OPT_BankName, B_READ);
+        lookup . contigs = &(ctg_bank . getIDMap( ));
+      }
+
+    for ( int i = 0; i < NUM_TABLES; i ++ )
+      {
+        string name = TABLES[i];
+        int64_t rows = -1;
+
+        if ( OPT_IsTables  &&  OPT_Tables . find (name) == OPT_Tables . end( ) )
+          continue;
+        OPT_Tables . erase (name);
+
+        try {
+          if ( name == "reads" )
+            rows = ExportTable<Read_t> (name, Read_t::NCODE, ReadFields( ),
+                                        AddRead, lookup, true);
+          else if ( name == "fragments" )
+            rows = ExportTable<Fragment_t> (name, Fragment_t::NCODE,
+                                            FragmentFields( ), AddFragment,
+                                            lookup, false);
+          else if ( name == "libraries" )
+            rows = ExportTable<Library_t> (name, Library_t::NCODE,
+                                           LibraryFields( ), AddLibrary,
+                                           lookup, false);
+          else if ( name == "contig_tiles" )
+            rows = ExportTable<Contig_t> (name, Contig_t::NCODE,
+                                          ContigTileFields( ), AddContigTiles,
+                                          lookup, false);
+          else if ( name == "scaffold_tiles" )
+            rows = ExportTable<Scaffold_t> (name, Scaffold_t::NCODE,
+                                            ScaffoldTileFields( ),
+                                            AddScaffoldTiles, lookup, false);
+          else if ( name == "features" )
+            rows = ExportTable<Feature_t> (name, Feature_t::NCODE,
+                                           FeatureFields( ), AddFeature,
+                                           lookup, false);
+          else
+            rows = ExportTable<ContigEdge_t> (name, ContigEdge_t::NCODE,
+                                              ContigEdgeFields( ),
+                                              AddContigEdge, lookup, false);
+        }
+        catch (const Exception_t & e) {
+          cerr << "ERROR: " << e . what( ) << endl
+               << "  failed to export '" << name << "' table" << endl;
+          exitcode = EXIT_FAILURE;
+          continue;
+        }
+
+        if ( rows < 0 )
+          {
+            if ( OPT_IsTables )
+              cerr << "WARNING: no bank for the '" << name << "' table" << endl;
+            continue;
+          }
+
+        cerr << name << " ... " << rows << " rows" << endl;
+      }
+
+  //-- Any tables unrecognized?
+  for ( set<string>::iterator ti = OPT_Tables . begin( );
+        ti != OPT_Tables . end( ); ++ ti )
+    {
+      cerr << "ERROR: Unrecognized table" << endl
+           << "  unknown table '" << *ti << "' ignored" << endl;
+      exitcode = EXIT_FAILURE;
+    }
+  }
+  catch (const Exception_t & e) {
+    cerr << "FATAL: " << e . what( ) << endl
+         << "  there has been a fatal error, abort" << endl;
+    exitcode = EXIT_FAILURE;
+  }
+  //-- END: MAIN EXCEPTION CATCH
+
+
+  //-- Output the end time
+  cerr << "END DATE:   " << Date( ) << endl;
+
+  return exitcode;
+}
+
+
+
+
+//----------------------------------------------------------- ExportTable ----//
+template <class T>
+int64_t ExportTable (const string & name, NCode_t ncode,
+                     const vector<Column_Field_t> & fields,
+                     void (* add) (T &, Column_Batch_t &, const Lookup_t &),
+                     const Lookup_t & lookup, bool fixonly)
+{
+  Bank_t bank (ncode);
+  Arrow_Writer_t writer;
+  vector<const IDMap_t::HashTriple_t *> items;
+
+  if ( ! bank . exists (OPT_BankName) )
+    return -1;
+
+  //-- Mapped, so any number of threads can fetch at once
+  bank . open (OPT_BankName, B_READ | B_MAP);
+
+  //-- Fetch in bank order, so each thread reads a stretch of the stores
+  for ( IDMap_t::const_iterator idmi = bank . getIDMap( ) . begin( );
+        idmi != bank . getIDMap( ) . end( ); ++ idmi )
+    items . push_back (idmi);
+  sort (items . begin( ), items . end( ), ByBID);
+
+  writer . open (OPT_OutDir + '/' + name + ".arrow", fields);
+
+  int nthreads = 1;
+#ifdef AMOS_HAVE_OPENMP
+  nthreads = omp_get_max_threads( );
+#endif
+  int64_t nitems = items . size( );
+  int64_t round = (int64_t) 2 * nthreads * OPT_BatchSize;
+  vector<Column_Batch_t> batches (2 * nthreads);
+
+  for ( int64_t start = 0; start < nitems; start += round )
+    {
+      int nbatches = (min (round, nitems - start) + OPT_BatchSize - 1)
+        / OPT_BatchSize;
+      string error;
+
+#pragma omp parallel for schedule(dynamic)
+      for ( int b = 0; b < nbatches; b ++ )
+        {
+          T obj;
+          int64_t lo = start + (int64_t) b * OPT_BatchSize;
+          int64_t hi = min (lo + OPT_BatchSize, nitems);
+
+          writer . init (batches[b]);
+          try {
+            for ( int64_t k = lo; k < hi; k ++ )
+              {
+                const IDMap_t::HashTriple_t * t = items[k];
+                if ( t -> iid != NULL_ID )
+                  {
+                    if ( fixonly )
+                      bank . fetchFix (t -> iid, obj);
+                    else
+                      bank . fetch (t -> iid, obj);
+                  }
+                else
+                  {
+                    if ( fixonly )
+                      bank . fetchFix (t -> eid, obj);
+                    else
+                      bank . fetch (t -> eid, obj);
+                  }
+                add (obj, batches[b], lookup);
+              }
+          }
+          catch (const Exception_t & e) {
+#pragma omp critical (ExportTable_Error)
+            if ( error . empty( ) )
+              error = e . what( );
+          }
+        }
+
+      if ( ! error . empty( ) )
+        AMOS_THROW_IO (error);
+
+      for ( int b = 0; b < nbatches; b ++ )
+        writer . write (batches[b]);
+    }
+
+  writer . close( );
+  bank . close( );
+
+  return writer . getRows( );
+}
+
+
+
+
+//------------------------------------------------------------- ParseArgs ----//
+void ParseArgs (int argc, char ** argv)
+{
+  int ch, errflg = 0;
+  optarg = NULL;
+
+  while ( !errflg && ((ch = getopt (argc, argv, "b:B:ho:t:v")) != EOF) )
+    switch (ch)
+      {
+      case 'b':
+        OPT_BankName = optarg;
+        break;
+
+      case 'B':
+        OPT_BatchSize = atoi (optarg);
+        if ( OPT_BatchSize <= 0 )
+          {
+            cerr << "ERROR: The batch size must be positive\n";
+            errflg ++;
+          }
+        break;
+
+      case 'h':
+        PrintHelp (argv[0]);
+        exit (EXIT_SUCCESS);
+        break;
+
+      case 'o':
+        OPT_OutDir = optarg;
+        break;
+
+      case 't':
+        OPT_Threads = atoi (optarg);
+        break;
+
+      case 'v':
+        PrintBankVersion (argv[0]);
+        exit (EXIT_SUCCESS);
+        break;
+
+      default:
+        errflg ++;
+      }
+
+  if ( OPT_BankName . empty( ) )
+    {
+      cerr << "ERROR: The -b option is mandatory\n";
+      errflg ++;
+    }
+
+  if ( access (OPT_BankName . c_str( ), R_OK|X_OK) )
+    {
+      cerr << "ERROR: Bank directory is not accessible, "
+	   << strerror (errno) << endl;
+      errflg ++;
+    }
+
+  mkdir (OPT_OutDir . c_str( ), 00755);
+  if ( access (OPT_OutDir . c_str( ), W_OK|X_OK) )
+    {
+      cerr << "ERROR: Output directory is not writable, "
+	   << strerror (errno) << endl;
+      errflg ++;
+    }
+
+  if ( errflg > 0 )
+    {
+      PrintUsage (argv[0]);
+      cerr << "Try '" << argv[0] << " -h' for more information.\n";
+      exit (EXIT_FAILURE);
+    }
+
+  if ( optind != argc )
+    {
+      OPT_IsTables = true;
+      while ( optind != argc )
+	OPT_Tables . insert (argv [optind ++]);
+    }
+}
+
+
+
+
+//------------------------------------------------------------- PrintHelp ----//
+void PrintHelp (const char * s)
+{
+  PrintUsage (s);
+  cerr
+    << "\n.DESCRIPTION.\n"
+    << "  Takes an AMOS bank directory as input and writes its metadata as\n"
+    << "  tables in Arrow IPC files, name.arrow in the output directory, for\n"
+    << "  loading into pyarrow, pandas, R, DuckDB or Polars. If no tables are\n"
+    << "  listed on the command line, all tables with a bank are written:\n"
+    << "    reads           RED clear ranges, fragment and type\n"
+    << "    fragments       FRG library, size and mate reads\n"
+    << "    libraries       LIB insert size distributions\n"
+    << "    contig_tiles    one row for each read placed in a CTG\n"
+    << "    scaffold_tiles  one row for each contig placed in a SCF\n"
+    << "    features        FEA ranges, types and comments\n"
+    << "    contig_edges    CTE contigs, orientation, size and links\n"
+    << "  EIDs and type codes are dictionary encoded. Objects are fetched by\n"
+    << "  several threads at once and written in bank order, one record batch\n"
+    << "  for every -B objects.\n"
+    << "\n.OPTIONS.\n"
+    << "  -b path       The directory path of the bank to export\n"
+    << "  -B num        Objects per record batch (default "
+    << DEFAULT_COLUMNAR_BATCH << ")\n"
+    << "  -h            Display help information\n"
+    << "  -o path       The directory for the table files (default .)\n"
+    << "  -t num        Number of threads fetching objects\n"
+    << "  -v            Display the compatible bank version\n"
+    << "\n.KEYWORDS.\n"
+    << "  amos bank, arrow\n"
+    << endl;
+
+  return;
+}
+
+
+
+
+//------------------------------------------------------------ PrintUsage ----//
+void PrintUsage (const char * s)
+{
+  cerr << "\nUSAGE:\n" << "  " <<  s << "  [options]  -b <bank path>  [tables]\n";
+  return;
+}
@@ -1,6 +1,7 @@
 #include "foundation_AMOS.hh"
 #include "amp.hh"
 #include "fasta.hh"
+#include "exporter.hh"
 
 using namespace AMOS;
 using namespace std;
@@ -11,6 +12,8 @@ bool OPT_UseEIDs = 0;
 bool OPT_UseIIDs = 0;
 bool OPT_Trapper = 0;
 bool OPT_SAM = 0;
+int OPT_Threads = 0;
+ExportCompression OPT_Compression = EXPORT_PLAIN;
 
 string OPT_BankName;
 
@@ -40,6 +43,8 @@ void PrintHelp (const char * s)
        << "  -S          Simple Layout style\n"
        << "  -s          SAM Format (http://samtools.sf.net)\n"
        << "  -T          XML Format suitable for DNPTrapper\n"
+       << "  -t n        Number of threads formatting and compressing the output\n"
+       << "  -z type     Compress the output as none, gzip or bgzf (default none)\n"
        << ".KEYWORDS.\n"
        << "  converters, bank, contigs\n\n"
        << endl;
@@ -51,7 +56,7 @@ void ParseArgs (int argc, char ** argv)
   int ch, errflg = 0;
   optarg = NULL;
 
-  while ( !errflg && ((ch = getopt (argc, argv, "hveiTLsSE:I:")) != EOF) )
+  while ( !errflg && ((ch = getopt (argc, argv, "hveiTLsSE:I:t:z:")) != EOF) )
   {
     switch (ch)
     {
@@ -73,6 +78,15 @@ void ParseArgs (int argc, char ** argv)
       case 'S': OPT_SimpleLayout = true; break;
       case 'T': OPT_Trapper = true;      break;
       case 's': OPT_SAM = true;          break;
+      case 't': OPT_Threads = atoi(optarg); break;
+
+      case 'z':
+        if (!Export_Parse_Compression(optarg, OPT_Compression))
+        {
+          cerr << "ERROR: unknown compression " << optarg << endl;
+          errflg++;
+        }
+        break;
 
       default: errflg ++;
       }
@@ -93,11 +107,21 @@ void ParseArgs (int argc, char ** argv)
 bool firstContig = true;
 
 
-void printContig(Contig_t & contig, Bank_t & read_bank)
+// A contig with its tiling sorted and the reads it needs, so that it can
+// be printed without the bank
+struct ContigJob_t
+{
+  Contig_t contig;
+  vector<Read_t> reads;     // by tile, empty if the sequences are not needed
+  vector<string> eids;      // by tile
+  bool first;               // first contig of the output
+};
+
+
+void printContig(ContigJob_t & job, string & out)
 {
-  Read_t read; 
+  Contig_t & contig = job.contig;
   std::vector<Tile_t> & tiling = contig.getReadTiling();
-  sort(tiling.begin(), tiling.end(), TileOrderCmp());
 
   if (OPT_SAM)
   {
@@ -123,7 +147,7 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
 
       // render the sequence
       
-      read_bank.fetch(ti->source, read);
+      Read_t & read = job.reads[ti - tiling.begin()];
 
       string fullseq = read.getSeqString();
       string qualstr  = read.getQualString();
@@ -148,14 +172,14 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
 
       if (OPT_UseEIDs) 
       { 
-        string s = read_bank.lookupEID(ti->source);
+        string s = job.eids[ti - tiling.begin()];
         int i = s.find(' ');
         if (i != s.npos) { s = s.substr(0,i); }
-        cout << s;
+        out += s;
       }
       else 
       { 
-        cout << ti->source;
+        Export_Printf(out, "%u", ti->source);
       }
 
       int flag = 0;
@@ -166,11 +190,8 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
         flag = 0x0010;
       }
 
-      cout << "\t" << flag 
-           << "\t" << contigeid 
-           << "\t" << contig.gap2ungap(ti->offset)
-           << "\t" << mapqual
-           << "\t";
+      Export_Printf(out, "\t%d\t%s\t%d\t%d\t",
+                    flag, contigeid.c_str(), contig.gap2ungap(ti->offset), mapqual);
 
       // now print cigar string
       
@@ -186,7 +207,7 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
 
       if (leftclip)
       {
-        cout << leftclip << 'S';
+        Export_Printf(out, "%dS", leftclip);
       }
       
       int pos = 0;
@@ -214,17 +235,17 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
           len++;
         }
 
-        cout << len << type;
+        Export_Printf(out, "%d%c", len, type);
       }
 
       if (rightclip)
       {
-        cout << rightclip << 'S';
+        Export_Printf(out, "%dS", rightclip);
       }
       
-      cout << "\t" << "*" // Mate reference sequence name
-           << "\t" << "0" // Mate position
-           << "\t" << "0"; // Insert size
+      out += "\t*"  // Mate reference sequence name
+             "\t0"  // Mate position
+             "\t0"; // Insert size
 
       // now sequence and qual
 
@@ -241,16 +262,14 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
         qualstr[i] = Char2Qual(qualstr[i]) + SAM_QUAL_BASE;
       }
 
-      cout << "\t" << fullseq
-           << "\t" << qualstr 
-           << "\n";
+      out += "\t" + fullseq + "\t" + qualstr + "\n";
     }
   }
   else if (OPT_Trapper)
   {
-    if (firstContig) { cout << "<TRAPPER>" << endl; firstContig = false;}
+    if (job.first) { out += "<TRAPPER>\n"; }
 
-    printf("<contig name=\"%s\">\n", contig.getEID().c_str());
+    Export_Printf(out, "<contig name=\"%s\">\n", contig.getEID().c_str());
 
     int row = 0;
 
@@ -264,10 +283,7 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
 
       if (clr.isReverse())
       {
-        Read_t read;
-        read_bank.fetch(ti->source, read);
-
-        lefttrim = read.getLength() - clr.getHi();
+        lefttrim = job.reads[ti - tiling.begin()].getLength() - clr.getHi();
       }
 
       if (ti->offset-lefttrim < leftmost)
@@ -282,12 +298,10 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
       bool rc = 0;
       Range_t range = ti->range;
       Range_t clr = range;
-      Pos_t gappedLen = ti->getGappedLength();
 
       if (ti->range.begin > ti->range.end) { rc = 1; } 
 
-      Read_t read;
-      read_bank.fetch(ti->source, read);
+      Read_t & read = job.reads[ti - tiling.begin()];
       string sequence = read.getSeqString();
       string qual     = read.getQualString();
 
@@ -329,28 +343,28 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
         else    { endGood = gappedseqlen; }
       }
 
-      printf("<ReadData row=\"%d\" name=\"%s\" startPos=\"%d\" endPos=\"%d\" strand=\"%c\" beginGood=\"%d\" endGood=\"%d\">\n",
-             row, read_bank.lookupEID(ti->source).c_str(), ti->offset-lefttrim-leftmost, ti->getRightOffset()+righttrim-leftmost, (rc ? 'C' : 'U'), beginGood, endGood);
+      Export_Printf(out, "<ReadData row=\"%d\" name=\"%s\" startPos=\"%d\" endPos=\"%d\" strand=\"%c\" beginGood=\"%d\" endGood=\"%d\">\n",
+                    row, job.eids[ti - tiling.begin()].c_str(), ti->offset-lefttrim-leftmost, ti->getRightOffset()+righttrim-leftmost, (rc ? 'C' : 'U'), beginGood, endGood);
 
-      printf("<DnaStrData startPos=\"%d\" endPos=\"%d\" trappervector=\"%s\"/>\n",
-             0, gappedseqlen, sequence.c_str());
+      Export_Printf(out, "<DnaStrData startPos=\"%d\" endPos=\"%d\" trappervector=\"%s\"/>\n",
+                    0, gappedseqlen, sequence.c_str());
 
-      printf("<QualityData startPos=\"%d\" endPos=\"%d\" trappervector=\"", 
-             0, gappedseqlen);
+      Export_Printf(out, "<QualityData startPos=\"%d\" endPos=\"%d\" trappervector=\"", 
+                    0, gappedseqlen);
  
       for (int i = 0; i < gappedseqlen; i++)
       {
-        printf(" %d", qual[i]-'0');
+        Export_Printf(out, " %d", qual[i]-'0');
       }
-      printf("\"/>\n");
+      out += "\"/>\n";
 
-      printf("<ChromatData startPos=\"%d\" endPos=\"%d\"/>\n",  
-             0, gappedseqlen);
+      Export_Printf(out, "<ChromatData startPos=\"%d\" endPos=\"%d\"/>\n",  
+                    0, gappedseqlen);
 
-      printf("</ReadData>\n");
+      out += "</ReadData>\n";
     }
 
-    printf("</contig>\n");
+    out += "</contig>\n";
   }
   else if (OPT_SimpleLayout)
   {
@@ -368,40 +382,37 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
     vector<Tile_t>::const_iterator ti;
     for (ti = tiling.begin(); ti != tiling.end(); ti++)
     {
-      cout << contigeid << "\t"
-           << status << "\t"
-           << read_bank.lookupEID(ti->source) << "\t"
-           << (ti->range.isReverse() ? 1 : 0) << "\t"
-           << ti->offset
-           << endl;
+      Export_Printf(out, "%s\t%c\t%s\t%d\t%d\n",
+                    contigeid.c_str(), status,
+                    job.eids[ti - tiling.begin()].c_str(),
+                    (ti->range.isReverse() ? 1 : 0), ti->offset);
     }
   }
   else
   {
-    cout << "##";
+    out += "##";
 
     if (OPT_UseEIDs) 
     { 
       string s(contig.getEID());
       int i = s.find(' ');
       if (i != s.npos) { s = s.substr(0,i); }
-      if (s.empty()) { cout << contig.getIID(); }
-      else           { cout << s; }
+      if (s.empty()) { Export_Printf(out, "%u", contig.getIID()); }
+      else           { out += s; }
     }
     else 
     { 
-      cout << contig.getIID(); 
+      Export_Printf(out, "%u", contig.getIID()); 
     }
 
     const string cons = contig.getSeqString();
 
-    cout << " "  << tiling.size()
-         << " "  << cons.length()
-         << " bases, 00000000 checksum." << endl;
+    Export_Printf(out, " %d %d bases, 00000000 checksum.\n",
+                  (int) tiling.size(), (int) cons.length());
 
     if (!OPT_LayoutOnly)
     {
-      Fasta_Print(stdout, cons.c_str(), NULL, 60);
+      Fasta_Append(out, cons, "", 60);
     }
 
     vector<Tile_t>::const_iterator i;
@@ -417,31 +428,29 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
       if (i->range.begin > i->range.end) { clr.end++; rc = 1; } 
       else                               { clr.begin++; }
 
-      cout << "#";
+      out += "#";
 
       if (OPT_UseEIDs) 
       { 
-        string s = read_bank.lookupEID(i->source);
+        string s = job.eids[i - tiling.begin()];
         int i = s.find(' ');
         if (i != s.npos) { s = s.substr(0,i); }
-        cout << s;
+        out += s;
       }
       else 
       { 
-        cout << i->source;
+        Export_Printf(out, "%u", i->source);
       }
 
-      cout << "(" << i->offset 
-           << ((rc) ? ") [RC] " : ") [] ") << gappedLen
-           << " bases, 00000000 checksum."
-           << " {" << clr.begin << " " << clr.end << "}"
-           << " <" << contig.gap2ungap(i->offset)
-           << " "  << contig.gap2ungap(i->getRightOffset())
-           << ">"  << endl;
+      Export_Printf(out, "(%d%s%d bases, 00000000 checksum. {%d %d} <%d %d>\n",
+                    i->offset, ((rc) ? ") [RC] " : ") [] "), gappedLen,
+                    clr.begin, clr.end,
+                    contig.gap2ungap(i->offset),
+                    contig.gap2ungap(i->getRightOffset()));
 
       if (!OPT_LayoutOnly)
       {
-        read_bank.fetch(i->source, read);
+        Read_t & read = job.reads[i - tiling.begin()];
         if (rc) { range.swap(); }
         string sequence = read.getSeqString(range);
         if (rc) { Reverse_Complement(sequence); }
@@ -458,16 +467,80 @@ void printContig(Contig_t & contig, Bank_t & read_bank)
         }
 
 
-        Fasta_Print(stdout, sequence.c_str(), NULL, 60);
+        Fasta_Append(out, sequence, "", 60);
       }
     }
   }
 }
 
+
+// Streams the selected contigs and their reads from the bank, prints them
+// in parallel
+class ContigExporter_t : public Exporter_t<ContigJob_t>
+{
+public:
+  ContigExporter_t(BankStream_t & contigs, Bank_t & reads, istream * ids, bool eids)
+    : contig_bank(contigs), read_bank(reads), idfile(ids), ideids(eids)
+  { }
+
+  bool read(ContigJob_t & job)
+  {
+    string id;
+
+    if (idfile == NULL)
+    {
+      if (!(contig_bank >> job.contig)) { return false; }
+    }
+    else
+    {
+      if (!(*idfile >> id)) { return false; }
+
+      if (ideids)
+        contig_bank.seekg(contig_bank.getIDMap().lookupBID(id));
+      else
+        contig_bank.seekg(contig_bank.getIDMap().lookupBID(atoi(id.c_str())));
+      contig_bank >> job.contig;
+    }
+
+    std::vector<Tile_t> & tiling = job.contig.getReadTiling();
+    sort(tiling.begin(), tiling.end(), TileOrderCmp());
+
+    bool needreads = OPT_SAM || OPT_Trapper || (!OPT_SimpleLayout && !OPT_LayoutOnly);
+
+    job.eids.resize(tiling.size());
+    job.reads.resize(needreads ? tiling.size() : 0);
+    for (unsigned int i = 0; i < tiling.size(); i++)
+    {
+      job.eids[i] = read_bank.lookupEID(tiling[i].source);
+      if (needreads) { read_bank.fetch(tiling[i].source, job.reads[i]); }
+    }
+
+    job.first = firstContig;
+    firstContig = false;
+
+    return true;
+  }
+
+  void format(ContigJob_t & job, string * out)
+  {
+    printContig(job, out[0]);
+  }
+
+private:
+  BankStream_t & contig_bank;
+  Bank_t & read_bank;
+  istream * idfile;
+  bool ideids;
+};
+
 int main (int argc, char ** argv)
 {
   ParseArgs (argc, argv);
 
+#ifdef AMOS_HAVE_OPENMP
+  if (OPT_Threads > 0) { omp_set_num_threads(OPT_Threads); }
+#endif
+
   BankStream_t contig_bank(Contig_t::NCODE);
   Bank_t read_bank(Read_t::NCODE);
 
@@ -478,9 +551,8 @@ int main (int argc, char ** argv)
     read_bank.open(OPT_BankName, B_READ);
     contig_bank.open(OPT_BankName, B_READ);
 
-    Contig_t contig;
     ifstream file;
-    string id;
+    istream * ids = NULL;
 
     if (!OPT_EIDFile.empty())
     {
@@ -491,12 +563,7 @@ int main (int argc, char ** argv)
         throw Exception_t("Couldn't open EID File", __LINE__, __FILE__);
       }
 
-      while (file >> id)
-      {
-        contig_bank.seekg(contig_bank.getIDMap().lookupBID(id));
-        contig_bank >> contig;
-        printContig(contig, read_bank);
-      }
+      ids = &file;
     }
     else if (!OPT_IIDFile.empty())
     {
@@ -507,28 +574,27 @@ int main (int argc, char ** argv)
         throw Exception_t("Couldn't open IID File", __LINE__, __FILE__);
       }
 
-      while (file >> id)
-      {
-        contig_bank.seekg(contig_bank.getIDMap().lookupBID(atoi(id.c_str())));
-        contig_bank >> contig;
-        printContig(contig, read_bank);
-      }
-    }
-    else
-    {
-      while (contig_bank >> contig)
-      {
-        printContig(contig, read_bank);
-      }
+      ids = &file;
     }
 
+    Export_Stream_t out;
+    ContigExporter_t exporter(contig_bank, read_bank, ids, !OPT_EIDFile.empty());
+
+    out.open("", OPT_Compression);
+    exporter.setStream(0, &out);
+    exporter.run();
+
     read_bank.close();
     contig_bank.close();
 
     if (OPT_Trapper && !firstContig)
     {
-      printf("</TRAPPER>\n");
+      string text = "</TRAPPER>\n", data;
+      out.compress(text, data);
+      out.write(data);
     }
+
+    out.close();
   }
   catch (Exception_t & e)
   {
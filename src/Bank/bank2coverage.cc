@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <map>
 
 #include "foundation_AMOS.hh"
 #include "amp.hh"
@@ -155,6 +156,15 @@ int main (int argc, char ** argv)
     read_bank.open(bank_name);
     contig_bank.open(bank_name);
 
+    // A current contig range index finds the reads under each column
+    // without scanning the whole tiling
+    ContigRangeIndex_t cindex;
+    if (ContigRangeIndex_t::isCurrent(bank_name))
+    {
+      cindex.open(bank_name);
+      cerr << "Using contig range index" << endl;
+    }
+
     Contig_t contig;
     int contig_count = 1;
     int vectoroffset = 0;
@@ -192,9 +202,24 @@ int main (int argc, char ** argv)
         renderedSeqs.push_back(rendered);
       }
 
+      // Tiles that wrap around the origin are only found by the scan
+      bool useindex = cindex.isOpen() && cindex.getNumTiles(iid) == (Size_t) tiling.size();
+      map<ID_t, int> readpos;
+      for (vi =  tiling.begin(), vectorpos = 0;
+           vi != tiling.end();
+           vi++, vectorpos++)
+      {
+        readpos[vi->source] = vectorpos;
+        if (vi->offset < 0) { useindex = false; }
+      }
+
       vector<int> reads;
       reads.reserve(tiling.size());
 
+      vector<int> cover;
+      vector<ContigRangeIndex_t::Entry_t> hits;
+      vector<ContigRangeIndex_t::Entry_t>::const_iterator hi;
+
       libSlice_Slice s;
       int dcov;
       dcov = tiling.size(); // trivially, this is the greatest dcov in the contig
@@ -209,26 +234,45 @@ int main (int argc, char ** argv)
       {
         // Figure out which reads tile this position
         vector<Render_t>::const_iterator ri;
-        dcov = 0;
+        vector<int>::const_iterator ci;
+        cover.clear();
 
-        for (ri =  renderedSeqs.begin(), vectorpos = 0; 
-             ri != renderedSeqs.end(); 
-             ri++, vectorpos++)
+        if (useindex)
         {
-          if (hasOverlap(gindex, gindex, 
-                         ri->m_offset, ri->m_nucs.size(), 
-                         clen))
+          hits.clear();
+          cindex.getTiles(iid, Range_t(gindex, gindex+1), hits);
+          for (hi = hits.begin(); hi != hits.end(); hi++)
           {
-            s.rc[dcov]  = ri->m_rc;
-            s.bc[dcov]  = ri->m_nucs[gindex - ri->m_offset];
+            cover.push_back(readpos[hi->iid]);
+          }
+          sort(cover.begin(), cover.end());
+        }
+        else
+        {
+          for (ri =  renderedSeqs.begin(), vectorpos = 0; 
+               ri != renderedSeqs.end(); 
+               ri++, vectorpos++)
+          {
+            if (hasOverlap(gindex, gindex, 
+                           ri->m_offset, ri->m_nucs.size(), 
+                           clen))
+            {
+              cover.push_back(vectorpos);
+            }
+          }
+        }
+
+        for (ci = cover.begin(), dcov = 0; ci != cover.end(); ci++, dcov++)
+        {
+          ri = renderedSeqs.begin() + *ci;
 
-            s.qv[dcov]  = ri->m_qual[gindex - ri->m_offset]-AMOS::MIN_QUALITY;
-            if (s.qv[dcov] < MIN_QUAL) { s.qv[dcov] = MIN_QUAL; }
+          s.rc[dcov]  = ri->m_rc;
+          s.bc[dcov]  = ri->m_nucs[gindex - ri->m_offset];
 
-            reads[dcov] = vectorpos+vectoroffset;
+          s.qv[dcov]  = ri->m_qual[gindex - ri->m_offset]-AMOS::MIN_QUALITY;
+          if (s.qv[dcov] < MIN_QUAL) { s.qv[dcov] = MIN_QUAL; }
 
-            dcov++;
-          }
+          reads[dcov] = *ci+vectoroffset;
         }
 
         // Compute consensus qv
@@ -16,7 +16,9 @@
 #include <math.h>
 #include <functional>
 #include "foundation_AMOS.hh"
+#include "exporter.hh"
 #include <fstream>
+#include <sstream>
 #include <ctype.h>
 
 using namespace std;
@@ -43,6 +45,8 @@ void printHelpText()
        << "  -I file       Dump just the contig iids listed in file\n"
        << "  -q file       Report qualities in file\n"
        << "  -d            Show contig details (num reads, coverage) on fasta header line\n"
+       << "  -t n          Number of threads formatting and compressing the output\n"
+       << "  -z type       Compress the output as none, gzip or bgzf (default none)\n"
        << "\n.KEYWORDS.\n"
        << "  AMOS bank, Converters\n"
        << endl;
@@ -62,6 +66,8 @@ bool GetOptions(int argc, char ** argv)
     {"E",         1, 0, 'E'},
     {"I",         1, 0, 'I'},
     {"q",         1, 0, 'q'},
+    {"t",         1, 0, 't'},
+    {"z",         1, 0, 'z'},
     {0, 0, 0, 0}
   };
   
@@ -95,6 +101,12 @@ bool GetOptions(int argc, char ** argv)
     case 'q':
       globals["qualfile"] = string(optarg);
       break;
+    case 't':
+      globals["threads"] = string(optarg);
+      break;
+    case 'z':
+      globals["compress"] = string(optarg);
+      break;
     case '?':
       return false;
     }
@@ -103,21 +115,22 @@ bool GetOptions(int argc, char ** argv)
   return true;
 } // GetOptions
 
-void printFasta(const Contig_t & ctg, ofstream & qual)
+void printFasta(const Contig_t & ctg, string & out, string & qual)
 {
   string seq = ctg.getSeqString();
   string quals = ctg.getQualString();
+  bool doqual = globals.find("qualfile") != globals.end();
+  ostringstream hdr;
 
-  if (globals["eid"] == "true") { 
-    cout << ">" << ctg.getEID(); 
-    if (globals.find("qualfile") != globals.end())
-      qual << ">" << ctg.getEID();
+  if (globals.find("eid")->second == "true") { 
+    hdr << ">" << ctg.getEID(); 
   } else { 
-    cout << ">" << ctg.getIID(); 
-    if (globals.find("qualfile") != globals.end())
-      qual << ">" << ctg.getIID();
+    hdr << ">" << ctg.getIID(); 
   }
 
+  if (doqual)
+    qual += hdr.str();
+
   if (globals.find("details") != globals.end())
   {
     int len = ctg.getUngappedLength();
@@ -137,36 +150,76 @@ void printFasta(const Contig_t & ctg, ofstream & qual)
 
     double cov = len ? covsum / len : 0.0;
 
-    cout << " len=" << len
-         << " nreads=" << nreads
-         << " cov=" << cov;
+    hdr << " len=" << len
+        << " nreads=" << nreads
+        << " cov=" << cov;
   }
 
+  out += hdr.str();
+
   int nout = 0;
   for (int i = 0; i < seq.length(); i++)
   {
     if (seq[i] == '-') { continue; }
     if (nout % 60 == 0) 
-      cout << endl; 
+      out += '\n'; 
 
-    if (nout % 20 == 0 && globals.find("qualfile") != globals.end())
-      qual << endl;
+    if (nout % 20 == 0 && doqual)
+      qual += '\n';
     
     nout++;
-    cout << seq[i];
-    if (globals.find("qualfile") != globals.end())
-      qual << (int) (toascii(quals[i]) - toascii('0')) << " ";
+    out += seq[i];
+    if (doqual)
+      Export_Printf(qual, "%d ", (int) (toascii(quals[i]) - toascii('0')));
   }
-  cout << endl;
-  if (globals.find("qualfile") != globals.end())
-    qual << endl;
+  out += '\n';
+  if (doqual)
+    qual += '\n';
   
 } // printFasta
 
+
+// Streams the selected contigs from the bank, formats them in parallel
+class FastaExporter_t : public Exporter_t<Contig_t>
+{
+public:
+  FastaExporter_t(BankStream_t & contigs, istream * ids, bool eids)
+    : Exporter_t<Contig_t>(2), contig_stream(contigs), idfile(ids), ideids(eids)
+  { }
+
+  bool read(Contig_t & ctg)
+  {
+    string id;
+
+    if (idfile == NULL)
+      return contig_stream >> ctg;
+
+    if (!(*idfile >> id))
+      return false;
+
+    if (ideids)
+      contig_stream.seekg(contig_stream.getIDMap().lookupBID(id));
+    else
+      contig_stream.seekg(contig_stream.getIDMap().lookupBID(atoi(id.c_str())));
+    contig_stream >> ctg;
+
+    return true;
+  }
+
+  void format(Contig_t & ctg, string * out)
+  {
+    printFasta(ctg, out[0], out[1]);
+  }
+
+private:
+  BankStream_t & contig_stream;
+  istream * idfile;
+  bool ideids;
+};
+
 //----------------------------------------------
 int main(int argc, char **argv)
 {
-  ofstream outqual;
   globals["iid"] = "true";
   globals["eid"] = "false";
 
@@ -176,13 +229,10 @@ int main(int argc, char **argv)
     exit(1);
   }
 
-  if (globals.find("qualfile") != globals.end()){ // have qual file will travel
-    outqual.open(globals["qualfile"].c_str(), ofstream::out | ofstream::trunc);
-    if (! outqual.is_open()){
-      cerr << "Could not open " << globals["qualfile"] << endl;
-      exit(1);
-    }
-  }
+#ifdef AMOS_HAVE_OPENMP
+  if (globals.find("threads") != globals.end())
+    omp_set_num_threads(atoi(globals["threads"].c_str()));
+#endif
 
   // open necessary files
   if (globals.find("bank") == globals.end()){ // no bank was specified
@@ -212,9 +262,15 @@ int main(int argc, char **argv)
 
   try
   {
-    Contig_t ctg;
     ifstream file;
-    string id;
+    istream * ids = NULL;
+    ExportCompression compression = EXPORT_PLAIN;
+
+    if (globals.find("compress") != globals.end() &&
+        !Export_Parse_Compression(globals["compress"].c_str(), compression))
+    {
+      throw Exception_t("Unknown compression " + globals["compress"], __LINE__, __FILE__);
+    }
 
     if (!globals["eidfile"].empty())
     {
@@ -225,12 +281,7 @@ int main(int argc, char **argv)
         throw Exception_t("Couldn't open EID File", __LINE__, __FILE__);
       }
 
-      while (file >> id)
-      {
-        contig_stream.seekg(contig_stream.getIDMap().lookupBID(id));
-        contig_stream >> ctg;
-        printFasta(ctg, outqual);
-      }
+      ids = &file;
     }
     else if (!globals["iidfile"].empty())
     {
@@ -241,24 +292,25 @@ int main(int argc, char **argv)
         throw Exception_t("Couldn't open IID File", __LINE__, __FILE__);
       }
 
-      while (file >> id)
-      {
-        contig_stream.seekg(contig_stream.getIDMap().lookupBID(atoi(id.c_str())));
-        contig_stream >> ctg;
-        printFasta(ctg, outqual);
-      }
+      ids = &file;
     }
-    else
+
+    Export_Stream_t outfasta, outqual;
+    FastaExporter_t exporter(contig_stream, ids, !globals["eidfile"].empty());
+
+    outfasta.open("", compression);
+    exporter.setStream(0, &outfasta);
+    if (globals.find("qualfile") != globals.end())
     {
-      while (contig_stream >> ctg) 
-      {
-        printFasta(ctg, outqual);
-      }
+      outqual.open(globals["qualfile"], compression);
+      exporter.setStream(1, &outqual);
     }
 
+    exporter.run();
+
+    outfasta.close();
+    outqual.close();
     contig_stream.close();
-    if (globals.find("qualfile") != globals.end())
-      outqual.close();
   }
   catch (Exception_t & e)
   {
@@ -100,16 +100,15 @@ bool GetOptions(int argc, char ** argv)
 
 void printLens(const Contig_t & ctg)
 {
-  string seq = ctg.getSeqString();
-
   if (globals["eid"] == "true") { 
     cout << ctg.getEID(); 
   } else { 
     cout << ctg.getIID(); 
   }
 
-  size_t len = seq.length();
+  size_t len = ctg.getLength();
   if (globals["gapped"] != "true") { // get rid of gaps...
+    string seq = ctg.getSeqString();
     size_t found = seq.find_first_of('-'); // find gap
     while (found != string::npos){
       len--;
@@ -164,6 +163,11 @@ int main(int argc, char **argv)
     ifstream file;
     string id;
 
+    // gapped lengths are in the fixed store, no need for the consensus
+    if (globals["gapped"] == "true") {
+      contig_stream.setProjection(P_LENGTH | P_EID);
+    }
+
     if (!globals["eidfile"].empty())
     {
       file.open(globals["eidfile"].c_str());
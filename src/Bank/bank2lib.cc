@@ -137,6 +137,8 @@ int main(int argc, char **argv)
     libs.open(string(globals["prefix"] + ".libList").c_str(), ios::out);
     map<ID_t, int> printedLibs;
 
+     read_stream.setProjection(P_FRAGMENT | P_EID);
+
      while (read_stream >> read) 
      {
         ID_t fragID = read.getFragment();
@@ -4,8 +4,8 @@
 //
 //  Last Modified:  10 May 2012
 //
-//  This program takes an AMOS bank directory and dumps its reads 
-//  as SAM formatted text to stdout.
+//  This program takes an AMOS bank directory and dumps its reads
+//  as SAM formatted text or BAM to stdout.
 
 extern "C" {
 #include <getopt.h>
@@ -14,10 +14,20 @@ extern "C" {
 #include "foundation_AMOS.hh"
 #include "amp.hh"
 #include "fasta.hh"
+#include "exporter.hh"
 #include <map>
 #include <sstream>
+#include <cstdio>
 //#include <Contig_AMOS.hh>
 
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef AMOS_HAVE_OPENMP
+#include <omp.h>
+#endif
+
 
 
 using namespace AMOS;
@@ -27,74 +37,148 @@ struct config {
   string        bank;
   bool			scaffolds;
   bool			use_eids;
+  bool			bam;
+  int			threads;
 };
 config globals;
 
+
+//Where a read sits on its reference. Kept between the two passes for reads
+//whose mate is in another contig, so the mates can point at each other.
+struct Placement_t
+{
+	int ref;		//Index of the reference, a contig or a scaffold
+	int pos;		//1-based first reference position
+	int end;		//1-based last reference position
+	bool rc;		//Reversed compared to the reference
+};
+
+typedef HASHMAP::hash_map<ID_t, Placement_t> PlacementMap_t;
+
+
+//Finds the mate of a read, through the read index of the bank when it is
+//present and current, otherwise through a table of the fragment mate pairs.
+//The index is left to bank-read-index, which writes it under the bank lock.
+class MateTable_t
+{
+	private:
+		ReadIndex_t index;
+		vector< pair<ID_t, ID_t> > mates;
+
+	public:
+		void load(const string & bank)
+		{
+			try
+			{
+				index.open(bank);
+				return;
+			}
+			catch (Exception_t & e)
+			{
+				cerr << "Read index missing or stale, indexing mates" << endl;
+			}
+
+			BankStream_t frag_bank(Fragment_t::NCODE);
+			if (!frag_bank.exists(bank))
+				return;
+
+			Fragment_t fragment;
+			frag_bank.open(bank, B_READ);
+			frag_bank.setFixedStoreOnly(true);
+			while (frag_bank >> fragment)
+			{
+				pair<ID_t, ID_t> mp = fragment.getMatePair();
+				if (mp.first && mp.second)
+				{
+					mates.push_back(mp);
+					mates.push_back(make_pair(mp.second, mp.first));
+				}
+			}
+			frag_bank.close();
+			sort(mates.begin(), mates.end());
+		}
+
+		ID_t find(ID_t read) const
+		{
+			if (index.isOpen())
+				return index.getMate(read);
+
+			vector< pair<ID_t, ID_t> >::const_iterator mi =
+				lower_bound(mates.begin(), mates.end(), make_pair(read, (ID_t) 0));
+			return (mi != mates.end() && mi->first == read) ? mi->second : NULL_ID;
+		}
+};
+
+MateTable_t mate_table;
+
+//Placements of the reads whose mate is placed in another contig, from the
+//first pass. Unlike the pending SAM entries it replaces, it holds no
+//sequence and is bounded by the number of such reads.
+PlacementMap_t placements;
+
+//The references in output order, name and length
+vector< pair<string, int> > refs;
+
+
 class Sam_entry
 {
 	private:
 		string read_id; //QNAME
 		int flag; //FLAG
-		string r_name; //RNAME
+		int ref; //RNAME, as a reference index
 		int pos_1; 		//POS 1-based, first position that map to the reference
 		int mapqual; //MAPQ
-		string cigar; //CIGAR
-		string r_next; //RNEXT
+		vector< pair<int, char> > cigar; //CIGAR
+		int r_next; //RNEXT, as a reference index, -1 for none
 		int p_next;  //PNEXT
 		int t_len;  //TLEN
 		string seq; //SEQ
-		string qual; //QUAL
-		
-		bool rc; //If true, this read is reversed compared to contig direction, and 
-				 //I presume it is the second read of a fragment
-				
+		string qual; //QUAL, without the SAM offset
+
+		bool rc; //If true, this read is reversed compared to contig direction
+
 		int end_pos; // The last position that map to the reference
-		
+
 	public:
 		Sam_entry()
 		{
 		}
-		
-		
-		void setSam(int ctgoffset, Read_t read, Tile_t tile, Contig_t contig, string contigeid, string cons, string rnext, int pnext, int tlen)
+
+
+		void setSam(int ctgoffset, const Read_t & read, const Tile_t & tile, Contig_t & contig, int refidx, const string & cons)
 		{
-		
-			// Set the entries we can 
-			r_name = contigeid;
-			//pos_1 = contig.gap2ungap(tile.offset);
-			r_next = rnext;
-			p_next = pnext;
-			//Tlen goes from the start of the first read, to the end of the second.
-			t_len = tlen;
-			
-			
-			if (!globals.scaffolds) 
-			{
-				pos_1 = contig.gap2ungap(tile.offset);
-				end_pos = tile.getRightOffset();
-			}
-			else
-			{
-				pos_1 = contig.gap2ungap(tile.offset) + ctgoffset;
-				end_pos = tile.getRightOffset() + ctgoffset;
-			}
-			stringstream cigarstream;
+
+			// Set the entries we can
+			ref = refidx;
+			r_next = -1;
+			p_next = 0;
+			t_len = 0;
+
 			Range_t range = tile.range;
 			rc = (range.begin > range.end);
-		
+
+			// A read starting on a consensus gap maps from the next base
+			pos_1 = contig.gap2ungap(tile.offset);
+			if (tile.offset >= 0 && tile.offset < (Pos_t) cons.length() && cons[tile.offset] == '-')
+				pos_1++;
+			end_pos = contig.gap2ungap(tile.getRightOffset());
+			if (globals.scaffolds)
+			{
+				pos_1 += ctgoffset;
+				end_pos += ctgoffset;
+			}
+
 			// render the sequence
-			  
-			//read_bank.fetch(read_id, read);
-		
+
 			string fullseq = read.getSeqString();
 			string qualstr = read.getQualString();
-		
+
 			if (rc) { range.swap(); }
 			string sequence = read.getSeqString(range);
 			if (rc) { Reverse_Complement(sequence); }
-		
+
 			Pos_t gapcount = 0;
-		
+
 			vector<Pos_t>::const_iterator g;
 			for (g  = tile.gaps.begin();
 				g != tile.gaps.end();
@@ -103,60 +187,60 @@ class Sam_entry
 				sequence.insert(*g+gapcount, "-", 1);
 				gapcount++;
 			}
-		
-			if (globals.use_eids) 
+
+			if (globals.use_eids)
 				read_id = read.getEID();
 			//This uses IID as query template name
 			else
 			{
 				stringstream out;
 				out << tile.source;
-				read_id = out.str();				
+				read_id = out.str();
 		    }
-		
+
 			flag = 0;
 			// I'm not sure how I would set it to something else. Based on CIGAR?
 			mapqual = 255;
-		
+
 			if (rc)
 			{
 				flag = 0x0010;
 			}
 
-		
+
 			// now generate cigar string
-		  
+
 			int leftclip = range.begin;
 			int rightclip = fullseq.length() - range.end;
-		  
+
 			if (rc)
 			{
 				int t = leftclip;
 				leftclip = rightclip;
 				rightclip = t;
 			}
-		
+
+			cigar.clear();
 			if (leftclip)
 			{
-				cigarstream << leftclip << 'S';
+				cigar.push_back(make_pair(leftclip, 'S'));
 			}
-		  
+
 			int pos = 0;
 			int end = sequence.length();
-		
+
 			while (pos < end)
 			{
 				bool seqgap  = (sequence[pos] == '-');
-				//bool consgap = (cons[pos+tile->offset] == '-');
 				bool consgap = (cons[pos+tile.offset] == '-');
-		
+
 				int  len = 1;
 				pos++;
-		
+
 				char type    = 'M'; // match
-		
-				if (seqgap && consgap) { type = 'P'; } // pad 
-				else if (seqgap)       { type = 'D'; } // deletion 
+
+				if (seqgap && consgap) { type = 'P'; } // pad
+				else if (seqgap)       { type = 'D'; } // deletion
 				else if (consgap)      { type = 'I'; } // insertion
 
 				while ((pos < end) &&
@@ -166,53 +250,131 @@ class Sam_entry
 					pos++;
 					len++;
 				}
-				cigarstream << len << type;
+				cigar.push_back(make_pair(len, type));
 			}
-		
+
 			if (rightclip)
 			{
-				cigarstream << rightclip << 'S';
+				cigar.push_back(make_pair(rightclip, 'S'));
 			}
-		  
-		  	cigar = cigarstream.str();
-		  
+
 			// now sequence and qual
-		
-			if (rc) 
-			{ 
-				Reverse_Complement(fullseq); 
+
+			if (rc)
+			{
+				Reverse_Complement(fullseq);
 				reverse(qualstr.begin(), qualstr.end());
 			}
-		
-			const int SAM_QUAL_BASE = 33;
-		
+
 			for (int i = 0; i < qualstr.length(); i++)
 			{
-				qualstr[i] = Char2Qual(qualstr[i]) + SAM_QUAL_BASE;
+				qualstr[i] = Char2Qual(qualstr[i]);
 			}
-			
+
 			seq = fullseq;
 			qual = qualstr;
 		}
 
-		
+
 		//Default destructor.
 		~Sam_entry()
 		{
 		}
-		
-		//Prints the content of the SAM entry to stdout
-		void printSam()
+
+		//Appends the SAM text line of the entry
+		void appendSam(string & out) const
 		{
-			cout << read_id << "\t" << flag << "\t" << r_name << "\t" << pos_1 << "\t" 
-				 << mapqual << "\t" << cigar << "\t" << r_next << "\t" << p_next
-				 << "\t" << t_len << "\t" << seq << "\t" << qual << endl;
-				 
+			const int SAM_QUAL_BASE = 33;
+			stringstream line;
+
+			line << read_id << "\t" << flag << "\t" << refs[ref].first << "\t" << pos_1 << "\t"
+				 << mapqual << "\t";
+			for (size_t i = 0; i < cigar.size(); i++)
+				line << cigar[i].first << cigar[i].second;
+			line << "\t" << (r_next < 0 ? "*" : r_next == ref ? "=" : refs[r_next].first)
+				 << "\t" << p_next << "\t" << t_len << "\t" << seq << "\t";
+
+			out += line.str();
+			for (size_t i = 0; i < qual.length(); i++)
+				out += (char) (qual[i] + SAM_QUAL_BASE);
+			out += '\n';
 		}
-		
-		//If this read has a mate, this information might not be available at construction
-		//This is used to update these fields. The read_id (QNAME) is set equal to the mate.
-		void updateMate(int f, string qname, string rnext, int pnext, int tlen)
+
+		//Appends the BAM record of the entry
+		void appendBam(string & out) const
+		{
+			static const string CIGAR_OPS = "MIDNSHP=X";
+			static const string SEQ_CODES = "=ACMGRSVTWYHKDBN";
+
+			int refspan = 0;
+			for (size_t i = 0; i < cigar.size(); i++)
+				if (strchr("MDN=X", cigar[i].second))
+					refspan += cigar[i].first;
+
+			int beg = max(pos_1 - 1, 0);
+			int end = beg + max(refspan, 1);
+			size_t start = out.size();
+
+			appendInt(out, 0); // block_size, set below
+			appendInt(out, ref);
+			appendInt(out, beg);
+			out += (char) (read_id.length() + 1);
+			out += (char) mapqual;
+			appendShort(out, reg2bin(beg, end));
+			appendShort(out, cigar.size());
+			appendShort(out, flag);
+			appendInt(out, seq.length());
+			appendInt(out, r_next);
+			appendInt(out, r_next < 0 ? -1 : p_next - 1);
+			appendInt(out, t_len);
+			out += read_id;
+			out += '\0';
+
+			for (size_t i = 0; i < cigar.size(); i++)
+				appendInt(out, (cigar[i].first << 4) | CIGAR_OPS.find(cigar[i].second));
+
+			for (size_t i = 0; i < seq.length(); i += 2)
+			{
+				size_t hi = SEQ_CODES.find(toupper(seq[i]));
+				size_t lo = (i + 1 < seq.length()) ? SEQ_CODES.find(toupper(seq[i+1])) : 0;
+				if (hi == string::npos) hi = 15;
+				if (lo == string::npos) lo = 15;
+				out += (char) ((hi << 4) | lo);
+			}
+			if (qual.length() == seq.length())
+				out += qual;
+			else
+				out.append(seq.length(), (char) 0xff);
+
+			int size = out.size() - start - 4;
+			memcpy(&out[start], &size, 4);
+		}
+
+		static void appendInt(string & out, int32_t x)
+		{
+			out.append((const char *) &x, 4);
+		}
+
+		static void appendShort(string & out, uint16_t x)
+		{
+			out.append((const char *) &x, 2);
+		}
+
+		//The UCSC bin of [beg, end), as in the SAM specification
+		static int reg2bin(int beg, int end)
+		{
+			--end;
+			if (beg>>14 == end>>14) return ((1<<15)-1)/7 + (beg>>14);
+			if (beg>>17 == end>>17) return ((1<<12)-1)/7 + (beg>>17);
+			if (beg>>20 == end>>20) return ((1<<9)-1)/7 + (beg>>20);
+			if (beg>>23 == end>>23) return ((1<<6)-1)/7 + (beg>>23);
+			if (beg>>26 == end>>26) return ((1<<3)-1)/7 + (beg>>26);
+			return 0;
+		}
+
+		//If this read has a mate, this information is not available when the
+		//entry is set. The read_id (QNAME) is set to the same for both mates.
+		void updateMate(int f, const string & qname, int rnext, int pnext, int tlen)
 		{
 			flag = f;
 			read_id = qname;
@@ -220,43 +382,128 @@ class Sam_entry
 			p_next = pnext;
 			t_len = tlen;
 		}
-		
-		bool getRC()
+
+		bool getRC() const
 		{
 			return rc;
 		}
-		
-		string getRNAME()
-		{
-			return r_name;
-		}
-		
-		string getQNAME()
+
+		int getRef() const
 		{
-			//To be able to visualize in Tablet for example, the pairs need
-			//to be named the same. 
-			return read_id;
+			return ref;
 		}
-		
-		int getPos()
+
+		int getPos() const
 		{
 			return pos_1;
 		}
-		
-		int getEndPos()
+
+		int getEndPos() const
 		{
 			return end_pos;
 		}
+};
+
+
+//Writes SAM text, or BAM as BGZF blocks that are compressed in parallel
+class SamWriter_t
+{
+	private:
+		string buffer;
+
+
+		//Writes out the whole BGZF blocks of the buffer, or all of it
+		void flush(bool all)
+		{
+			if (!globals.bam)
+			{
+				fwrite(buffer.data(), 1, buffer.size(), stdout);
+				buffer.clear();
+				return;
+			}
+
+#ifdef HAVE_LIBZ
+			int nblocks = buffer.size() / BGZF_BLOCK_SIZE;
+			if (all && buffer.size() % BGZF_BLOCK_SIZE)
+				nblocks++;
+
+			vector<string> blocks(nblocks);
+
+#ifdef AMOS_HAVE_OPENMP
+			#pragma omp parallel for schedule(dynamic)
+#endif
+			for (int i = 0; i < nblocks; i++)
+			{
+				size_t off = (size_t) i * BGZF_BLOCK_SIZE;
+				Bgzf_Deflate_Block(buffer.data() + off,
+				                   min((size_t) BGZF_BLOCK_SIZE, buffer.size() - off),
+				                   blocks[i]);
+			}
+
+			for (int i = 0; i < nblocks; i++)
+				fwrite(blocks[i].data(), 1, blocks[i].size(), stdout);
+
+			buffer.erase(0, min(buffer.size(), (size_t) nblocks * BGZF_BLOCK_SIZE));
+#endif
+		}
 
-		
-		
+	public:
+		//Writes the header, which names the references
+		void writeHeader()
+		{
+			stringstream text;
+			text << "@HD\tVN:1.4\tSO:unsorted\n";
+			for (size_t i = 0; i < refs.size(); i++)
+				text << "@SQ\tSN:" << refs[i].first << "\tLN:" << refs[i].second << "\n";
+
+			if (!globals.bam)
+			{
+				buffer += text.str();
+				return;
+			}
+
+			buffer += "BAM\1";
+			Sam_entry::appendInt(buffer, text.str().length());
+			buffer += text.str();
+			Sam_entry::appendInt(buffer, refs.size());
+			for (size_t i = 0; i < refs.size(); i++)
+			{
+				Sam_entry::appendInt(buffer, refs[i].first.length() + 1);
+				buffer += refs[i].first;
+				buffer += '\0';
+				Sam_entry::appendInt(buffer, refs[i].second);
+			}
+		}
+
+		//Takes the records of a contig, writes them out when there are enough
+		//to keep the threads busy
+		void write(const string & records)
+		{
+			buffer += records;
+			if (buffer.size() >= (size_t) 4 * BGZF_BUFFER_BLOCKS * BGZF_BLOCK_SIZE)
+				flush(false);
+		}
+
+		//Writes what is left and, for BAM, the empty end of file block
+		void close()
+		{
+			flush(true);
+#ifdef HAVE_LIBZ
+			if (globals.bam)
+			{
+				string eof;
+				Bgzf_Deflate_Block("", 0, eof);
+				fwrite(eof.data(), 1, eof.size(), stdout);
+			}
+#endif
+			fflush(stdout);
+		}
+
+		static const int BGZF_BUFFER_BLOCKS = 64;
 };
 
-//Reads that have a mate, but where some of the information from the
-//mate is missing (like PNEXT, RNEXT), will be saved in this map
-//until the mate is found and that information found.
-map<ID_t, Sam_entry> mated_reads;
-		
+SamWriter_t writer;
+
 //Index_t read2contig;
 
 //==============================================================================//
@@ -265,20 +512,24 @@ map<ID_t, Sam_entry> mated_reads;
 void PrintHelp ()
 {
 
-          
+
   cerr << ".DESCRIPTION.\n"
        << "  This program takes an AMOS bank directory and dumps its reads \n"
-       << "  as SAM formatted text to stdout.\n\n"
+       << "  as SAM formatted text, or BAM with -B, to stdout.\n\n"
+       << "  Mates are resolved in two passes over the contigs, with the read\n"
+       << "  index of the bank if bank-read-index has brought it up to date.\n\n"
        << ".OPTIONS.\n"
        << "  -h          Display help information\n"
        << "  -b <bank>   The bank to be operated on. \n"
        << "  -c          Use contigs as reference\n"
        << "  -s          Use scaffolds as reference\n"
        << "  -i          Use IIDs as query template name (EIDs is default.) \n"
+       << "  -B          Write BAM instead of SAM\n"
+       << "  -t <n>      Number of threads for formatting and compression\n"
        << ".KEYWORDS.\n"
        << "  converters, bank, contigs\n\n"
        << endl;
-  
+
 }
 
 //----------------------------------------------------- GetOptions -----------//
@@ -295,7 +546,9 @@ bool GetOptions (int argc, char ** argv)
 {
 	globals.scaffolds = false;
 	globals.use_eids = true;
-	
+	globals.bam = false;
+	globals.threads = 0;
+
   while (1)
     {
       int ch, option_index = 0;
@@ -306,15 +559,17 @@ bool GetOptions (int argc, char ** argv)
         {"scaffold", no_argument,       0, 'c'},
         {"iids", 	no_argument,      	 0, 'i'},
         {"contigs",   no_argument,         0, 's'},
+        {"bam",       no_argument,         0, 'B'},
+        {"threads",   required_argument,   0, 't'},
         {0,           0,                         0, 0}
       };
-      
-      ch = getopt_long(argc, argv, "hb:cis", long_options, &option_index);
+
+      ch = getopt_long(argc, argv, "hb:cisBt:", long_options, &option_index);
       if (ch == -1)
         break;
 
       string qualName;
-      
+
 
       switch (ch)
         {
@@ -334,6 +589,12 @@ bool GetOptions (int argc, char ** argv)
         case 's':
           globals.scaffolds = true;
           break;
+        case 'B':
+          globals.bam = true;
+          break;
+        case 't':
+          globals.threads = atoi(optarg);
+          break;
         case 'h':
           PrintHelp();
           return (EXIT_SUCCESS);
@@ -344,184 +605,219 @@ bool GetOptions (int argc, char ** argv)
   if (help_flag){
     PrintHelp();
     return (EXIT_SUCCESS);
-  } 
+  }
   return true;
 }
 
+//The name of a contig or scaffold, its IID if it has no EID
+string refName(const string & eid, ID_t iid)
+{
+	if (!eid.empty())
+		return eid;
+
+	stringstream out;
+	out << iid;
+	return out.str();
+}
+
+//First pass: records where the reads with a mate in another contig are
 //c_offset is the contig's offset on a scaffold, if we want scaffolds as RNAME
-void printContig(int c_offset, string scaffeid, Contig_t & contig, Bank_t & read_bank, Bank_t & frag_bank)
+void placeContig(int c_offset, int refidx, Contig_t & contig)
 {
-  Read_t read;
-  ID_t read_id, mate_id = 0;
-  string mate_rname, mate_qname;
-  Fragment_t fragment;
-  //bool mate_rc;
-  int mate_pos;
-  int tlen = 0;
-  int r_flag = 0, m_flag = 0;
-  map<ID_t, Sam_entry>::iterator mate_it;
-  std::vector<Tile_t> & tiling = contig.getReadTiling();
-  sort(tiling.begin(), tiling.end(), TileOrderCmp());
+	const vector<Tile_t> & tiling = contig.getReadTiling();
+	vector<Tile_t>::const_iterator ti;
+	HASHMAP::hash_map<ID_t, int> local;
+
+	for (ti = tiling.begin(); ti != tiling.end(); ti++)
+		local[ti->source] = 1;
 
-	string contigeid;
-	//If using scaffolds as RNAME
-	if (globals.scaffolds)
-		contigeid = scaffeid;
-	else
+	const string cons = contig.getSeqString();
+
+	for (ti = tiling.begin(); ti != tiling.end(); ti++)
 	{
-		// get the contig name
-		contigeid = contig.getEID();
-		if (contigeid.empty())
+		ID_t mate_id = mate_table.find(ti->source);
+		if (mate_id == NULL_ID || local.find(mate_id) != local.end())
+			continue;
+
+		Placement_t & p = placements[ti->source];
+		p.ref = refidx;
+		p.rc = ti->range.isReverse();
+		p.pos = contig.gap2ungap(ti->offset);
+		if (ti->offset >= 0 && ti->offset < (Pos_t) cons.length() && cons[ti->offset] == '-')
+			p.pos++;
+		p.end = contig.gap2ungap(ti->getRightOffset());
+		if (globals.scaffolds)
 		{
-			stringstream out;
-			out << contig.getIID();
-			contigeid = out.str();
+			p.pos += c_offset;
+			p.end += c_offset;
 		}
 	}
+}
+
+//Second pass: writes the records of a contig in tiling order
+//c_offset is the contig's offset on a scaffold, if we want scaffolds as RNAME
+void printContig(int c_offset, int refidx, Contig_t & contig, BankStream_t & read_bank)
+{
+  std::vector<Tile_t> & tiling = contig.getReadTiling();
+  sort(tiling.begin(), tiling.end(), TileOrderCmp());
+  int ntiles = tiling.size();
+
+  // fetch the reads in a batch, in bank order
+  vector<Read_t> reads(ntiles);
+  vector< pair<ID_t, int> > order(ntiles);
+  HASHMAP::hash_map<ID_t, int> local;
+
+  for (int i = 0; i < ntiles; i++)
+  {
+    order[i] = make_pair(read_bank.lookupBID(tiling[i].source), i);
+    local[tiling[i].source] = i;
+  }
+  sort(order.begin(), order.end());
+  for (int i = 0; i < ntiles; i++)
+  {
+    read_bank.seekg(order[i].first);
+    read_bank >> reads[order[i].second];
+  }
 
+  const string cons = contig.getSeqString();
+  vector<Sam_entry> entries(ntiles);
+  vector<string> records(ntiles);
 
-    const string cons = contig.getSeqString();
+  // build the gap index before the threads share the contig
+  contig.gap2ungap(0);
 
-    // convert each read in the contig
-    vector<Tile_t>::const_iterator ti;
-    for (ti =  tiling.begin();
-         ti != tiling.end();
-         ti++)
+#ifdef AMOS_HAVE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 64)
+#endif
+  for (int i = 0; i < ntiles; i++)
+  {
+    entries[i].setSam(c_offset, reads[i], tiling[i], contig, refidx, cons);
+  }
+
+#ifdef AMOS_HAVE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 64)
+#endif
+  for (int i = 0; i < ntiles; i++)
+  {
+    Sam_entry & sam_e = entries[i];
+    ID_t read_id = tiling[i].source;
+    ID_t mate_id = mate_table.find(read_id);
+
+    if (mate_id != NULL_ID)
     {
-		read_id = ti->source;
-	  	Sam_entry sam_e;
-      
-    	read_bank.fetch(read_id, read);
-    	//If a read has a fragment IID == 0, it's a unitig.
-		if (read.getFragment() != 0) 
-		{
-      			
-			frag_bank.fetch(read.getFragment(), fragment);
-			if (fragment.getMatePair().first == read_id)
-			{
-				mate_id = fragment.getMatePair().second;
-			}
-			else if (fragment.getMatePair().second == read_id)
-			{
-				mate_id = fragment.getMatePair().first; 
-			}
-					
-			// Not paired read, create SAM entry and print
-			if (mate_id == 0)
-			{
-				sam_e.setSam(c_offset, read, *ti, contig, contigeid, cons, "*", 0, 0);
-				sam_e.printSam();
-			}
-			// Mated read
-			else 
-			{
-				// See if the mate of the read has already been found
-				mate_it = mated_reads.find(mate_id);
-			
-				// Found the mate, create SAM entry and update and print both
-				if (mate_it != mated_reads.end()) 
-				{
-					sam_e.setSam(c_offset, read, *ti, contig, contigeid, cons, "*", 0, 0);
-					
-					//need contigeid, if the mate is reversed or not and pos
-					//to calculate tlen if contigeid is the same
-					mate_rname = (*mate_it).second.getRNAME();
-					mate_pos = (*mate_it).second.getPos();
-					mate_qname = (*mate_it).second.getQNAME();
-					// on the same reference
-					if (mate_rname == contigeid) 
-					{
-						// If mate is reversed, I assume it's the second read
-						// of a template, and the furthest from the start
-						// of the contig
-						if ((*mate_it).second.getRC()) 
-						{
-							tlen = (*mate_it).second.getEndPos() - sam_e.getPos();
-							m_flag = 0x1 + 0x2 + 0x10 + 0x80;
-							r_flag = 0x1 + 0x2 + 0x20 + 0x40;
-							//Update the read with the query template name of mate
-							sam_e.updateMate(r_flag, mate_qname, "=", mate_pos, tlen);
-							(*mate_it).second.updateMate(m_flag, mate_qname, "=", sam_e.getPos(), -tlen);
-							sam_e.printSam();
-							(*mate_it).second.printSam();
-						}
-						else 
-						{	
-							//sam_e is the furthest from the start of the contig
-							tlen = sam_e.getEndPos() - mate_pos;
-							r_flag = 0x1 + 0x2 + 0x10 + 0x80;
-							m_flag = 0x1 + 0x2 + 0x20 + 0x40;
-							//Update the read with the query template name of mate
-							sam_e.updateMate(r_flag, mate_qname, "=", mate_pos, -tlen);
-							(*mate_it).second.updateMate(m_flag, mate_qname, "=", sam_e.getPos(), tlen);
-							(*mate_it).second.printSam();
-							sam_e.printSam();
-						}	
-						mated_reads.erase(mate_it);
-					}
-					// not on same reference
-					else
-					{
-						if ((*mate_it).second.getRC()) 
-						{
-							m_flag = 0x1 + 0x2 + 0x10 + 0x80;
-							r_flag = 0x1 + 0x2 + 0x20 + 0x40;
-						}
-						else 
-						{
-							r_flag = 0x1 + 0x2 + 0x10 + 0x80;
-							m_flag = 0x1 + 0x2 + 0x20 + 0x40;
-						}
-						sam_e.updateMate(r_flag, mate_qname, mate_rname, mate_pos, 0);
-						(*mate_it).second.updateMate(m_flag, mate_qname, contigeid, sam_e.getPos(), 0);
-						sam_e.printSam();
-						(*mate_it).second.printSam();
-						mated_reads.erase(mate_it);
-					}
-				}
-				// Paired read, create SAM entry and save
-				else
-				{
-					sam_e.setSam(c_offset, read, *ti, contig, contigeid, cons, "*", 0, 0);
-					mated_reads[read_id] = sam_e;
-				}
-			}
-		}
-		// Adding unitig as read.
-        else
+      Placement_t mate;
+      bool placed = true;
+      HASHMAP::hash_map<ID_t, int>::const_iterator li = local.find(mate_id);
+      PlacementMap_t::const_iterator pi;
+
+      if (li != local.end())
+      {
+        const Sam_entry & m = entries[li->second];
+        mate.ref = m.getRef();
+        mate.pos = m.getPos();
+        mate.end = m.getEndPos();
+        mate.rc = m.getRC();
+      }
+      else if ((pi = placements.find(mate_id)) != placements.end())
+      {
+        mate = pi->second;
+      }
+      else
+      {
+        placed = false;
+      }
+
+      // Both mates are named after the read with the lower IID
+      ID_t first = min(read_id, mate_id);
+      string qname = globals.use_eids ? read_bank.lookupEID(first) : refName("", first);
+
+      int flag = 0x1 + (read_id == first ? 0x40 : 0x80);
+      if (sam_e.getRC()) { flag += 0x10; }
+
+      if (!placed)
+      {
+        sam_e.updateMate(flag + 0x8, qname, -1, 0, 0);
+      }
+      else
+      {
+        int tlen = 0;
+        flag += 0x2;
+        if (mate.rc) { flag += 0x20; }
+
+        // on the same reference, positive for the leftmost mate
+        if (mate.ref == refidx)
         {
-        	sam_e.setSam(c_offset, read, *ti, contig, contigeid, cons, "*", 0, 0);
-			sam_e.printSam();
+          tlen = max(sam_e.getEndPos(), mate.end) - min(sam_e.getPos(), mate.pos) + 1;
+          if (sam_e.getPos() > mate.pos ||
+              (sam_e.getPos() == mate.pos && read_id != first))
+            tlen = -tlen;
         }
-    }	
+        sam_e.updateMate(flag, qname, mate.ref, mate.pos, tlen);
+      }
+    }
+
+    if (globals.bam)
+      sam_e.appendBam(records[i]);
+    else
+      sam_e.appendSam(records[i]);
+  }
+
+  string out;
+  for (int i = 0; i < ntiles; i++)
+    out += records[i];
+  writer.write(out);
 }
 
 int main (int argc, char ** argv)
 {
 
 //TODO:
-//First, get insert sizes and mates out. Done, works mostly at least.	
+//First, get insert sizes and mates out. Done, works mostly at least.
 //Then also get scaffolds as reference. Done.
 	GetOptions (argc, argv);
-  
+
+#ifndef HAVE_LIBZ
+	if (globals.bam)
+	{
+		cerr << "ERROR: BAM output needs zlib, which was not found at configure time" << endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
+#ifdef AMOS_HAVE_OPENMP
+	if (globals.threads > 0)
+		omp_set_num_threads(globals.threads);
+#endif
+
 	if (globals.bank.length() > 0) {
+	  try
+	  {
 		cerr << "Processing " << globals.bank << " at " << Date() << endl;
-  
-		Bank_t read_bank(Read_t::NCODE);
-		Bank_t frag_bank(Fragment_t::NCODE);
+
+		BankStream_t read_bank(Read_t::NCODE);
 		read_bank.open(globals.bank, B_READ);
-		frag_bank.open(globals.bank, B_READ);
+		mate_table.load(globals.bank);
     	Contig_t contig;
-    	
+
     	//Use contigs as reference (RNAME)
-    	if(!globals.scaffolds) 
+    	if(!globals.scaffolds)
     	{
     		BankStream_t contig_bank(Contig_t::NCODE);
     		contig_bank.open(globals.bank, B_READ);
-			
+
 			while (contig_bank >> contig)
     		{
-    			printContig(0, "", contig, read_bank, frag_bank);
+    			placeContig(0, refs.size(), contig);
+    			refs.push_back(make_pair(refName(contig.getEID(), contig.getIID()),
+    			                         contig.getUngappedLength()));
+    		}
+
+			writer.writeHeader();
+			contig_bank.seekg(1);
+			int refidx = 0;
+			while (contig_bank >> contig)
+    		{
+    			printContig(0, refidx++, contig, read_bank);
     		}
     	}
     	// Use scaffolds as reference (RNAME)
@@ -529,48 +825,61 @@ int main (int argc, char ** argv)
 		{
 			BankStream_t scaffold_bank(Scaffold_t::NCODE);
 			Bank_t contig_bank(Contig_t::NCODE);
-	
+
 			// Opens the scaffold and contig banks
 			scaffold_bank.open(globals.bank, B_READ);
 			contig_bank.open(globals.bank, B_READ);
-			
+
 			Scaffold_t scaffold;
-			
-			while (scaffold_bank >> scaffold)
+
+			for (int pass = 0; pass < 2; pass++)
 			{
-				string scaffeid = scaffold.getEID();
-				if (scaffeid.empty())
+				if (pass == 1)
+					writer.writeHeader();
+
+				scaffold_bank.seekg(1);
+				int refidx = 0;
+				while (scaffold_bank >> scaffold)
 				{
-					stringstream out;
-					out << scaffold.getIID();
-					scaffeid = out.str();
-				}
-				// Might run into problems with negative gaps...
-				vector<Tile_t> & contigs = scaffold.getContigTiling();
-  				vector<Tile_t>::const_iterator ci;
-  				sort(contigs.begin(), contigs.end(), TileOrderCmp());
-
-  				for (ci = contigs.begin(); ci != contigs.end(); ci++)
-  				{
-  					contig_bank.fetch(ci->source, contig);
-  					printContig(ci->offset, scaffeid, contig, read_bank, frag_bank);
+					// Might run into problems with negative gaps...
+					vector<Tile_t> & contigs = scaffold.getContigTiling();
+  					vector<Tile_t>::const_iterator ci;
+  					sort(contigs.begin(), contigs.end(), TileOrderCmp());
+					int length = 0;
+
+  					for (ci = contigs.begin(); ci != contigs.end(); ci++)
+  					{
+  						contig_bank.fetch(ci->source, contig);
+						if (pass == 0)
+						{
+							placeContig(ci->offset, refidx, contig);
+							length = max(length, ci->offset + (int) contig.getUngappedLength());
+						}
+						else
+						{
+  							printContig(ci->offset, refidx, contig, read_bank);
+						}
+  					}
+
+					if (pass == 0)
+						refs.push_back(make_pair(refName(scaffold.getEID(), scaffold.getIID()), length));
+					refidx++;
   				}
-  			}
+			}
   			scaffold_bank.close();
   			contig_bank.close();
 		}
-		// Need to check whether all reads have been printed or not
-		while (!mated_reads.empty())
-		{
-			mated_reads.begin()->second.printSam();
-			mated_reads.erase(mated_reads.begin());
-		}
 
+		writer.close();
     	read_bank.close();
-    	
-    	frag_bank.close();
+	  }
+	  catch (Exception_t & e)
+	  {
+		cerr << "ERROR: -- Fatal AMOS Exception --\n" << e;
+		return EXIT_FAILURE;
+	  }
     }
-	
+
 	cerr << "End: " << Date() << endl;
   	return EXIT_SUCCESS;
 }
@@ -16,6 +16,8 @@
 #include <math.h>
 #include <functional>
 #include "foundation_AMOS.hh"
+#include "exporter.hh"
+#include <sstream>
 
 using namespace std;
 using namespace AMOS;
@@ -38,6 +40,8 @@ void printHelpText()
     "  -b, -bank     bank where assembly is stored\n"
     "  -E file       Dump just the contig eids listed in file\n"
     "  -I file       Dump just the contig iids listed in file\n"
+    "  -t n          Number of threads formatting and compressing the output\n"
+    "  -z type       Compress the output as none, gzip or bgzf (default none)\n"
     "\n.KEYWORDS.\n"
     "  AMOS bank, Converters, contigs\n"
        << endl;
@@ -53,6 +57,8 @@ bool GetOptions(int argc, char ** argv)
     {"bank",      1, 0, 'b'},
     {"E",         1, 0, 'E'},
     {"I",         1, 0, 'I'},
+    {"t",         1, 0, 't'},
+    {"z",         1, 0, 'z'},
     {0, 0, 0, 0}
   };
   
@@ -72,6 +78,12 @@ bool GetOptions(int argc, char ** argv)
     case 'I':
       globals["iidfile"] = string(optarg);
       break;
+    case 't':
+      globals["threads"] = string(optarg);
+      break;
+    case 'z':
+      globals["compress"] = string(optarg);
+      break;
     case '?':
       return false;
     }
@@ -80,10 +92,11 @@ bool GetOptions(int argc, char ** argv)
   return true;
 } // GetOptions
 
-void printContigAsRead(const Contig_t & ctg)
+void printContigAsRead(const Contig_t & ctg, string & out)
 {
   Read_t nrd;
   Message_t message;
+  ostringstream text;
 
   string seq = ctg.getSeqString();
   string quals = ctg.getQualString();
@@ -104,8 +117,48 @@ void printContigAsRead(const Contig_t & ctg)
   nrd.setClearRange(Range_t(0,nrd.getLength() - 1));
   
   nrd.writeMessage(message);
-  message.write(cout);
-} // printFasta
+  message.write(text);
+  out += text.str();
+} // printContigAsRead
+
+
+// Streams the selected contigs from the bank, converts them in parallel
+class ReadExporter_t : public Exporter_t<Contig_t>
+{
+public:
+  ReadExporter_t(BankStream_t & contigs, istream * ids, bool eids)
+    : contig_stream(contigs), idfile(ids), ideids(eids)
+  { }
+
+  bool read(Contig_t & ctg)
+  {
+    string id;
+
+    if (idfile == NULL)
+      return contig_stream >> ctg;
+
+    if (!(*idfile >> id))
+      return false;
+
+    if (ideids)
+      contig_stream.seekg(contig_stream.getIDMap().lookupBID(id));
+    else
+      contig_stream.seekg(contig_stream.getIDMap().lookupBID(atoi(id.c_str())));
+    contig_stream >> ctg;
+
+    return true;
+  }
+
+  void format(Contig_t & ctg, string * out)
+  {
+    printContigAsRead(ctg, out[0]);
+  }
+
+private:
+  BankStream_t & contig_stream;
+  istream * idfile;
+  bool ideids;
+};
 
 //----------------------------------------------
 int main(int argc, char **argv)
@@ -116,6 +169,11 @@ int main(int argc, char **argv)
     exit(1);
   }
   
+#ifdef AMOS_HAVE_OPENMP
+  if (globals.find("threads") != globals.end())
+    omp_set_num_threads(atoi(globals["threads"].c_str()));
+#endif
+
   // open necessary files
   if (globals.find("bank") == globals.end()){ // no bank was specified
     cerr << "A bank must be specified" << endl;
@@ -144,9 +202,15 @@ int main(int argc, char **argv)
 
   try
   {
-    Contig_t ctg;
     ifstream file;
-    string id;
+    istream * ids = NULL;
+    ExportCompression compression = EXPORT_PLAIN;
+
+    if (globals.find("compress") != globals.end() &&
+        !Export_Parse_Compression(globals["compress"].c_str(), compression))
+    {
+      throw Exception_t("Unknown compression " + globals["compress"], __LINE__, __FILE__);
+    }
 
     if (!globals["eidfile"].empty())
     {
@@ -157,12 +221,7 @@ int main(int argc, char **argv)
         throw Exception_t("Couldn't open EID File", __LINE__, __FILE__);
       }
 
-      while (file >> id)
-      {
-        contig_stream.seekg(contig_stream.getIDMap().lookupBID(id));
-        contig_stream >> ctg;
-        printContigAsRead(ctg);
-      }
+      ids = &file;
     }
     else if (!globals["iidfile"].empty())
     {
@@ -173,21 +232,17 @@ int main(int argc, char **argv)
         throw Exception_t("Couldn't open IID File", __LINE__, __FILE__);
       }
 
-      while (file >> id)
-      {
-        contig_stream.seekg(contig_stream.getIDMap().lookupBID(atoi(id.c_str())));
-        contig_stream >> ctg;
-        printContigAsRead(ctg);
-      }
-    }
-    else
-    {
-      while (contig_stream >> ctg) 
-      {
-        printContigAsRead(ctg);
-      }
+      ids = &file;
     }
 
+    Export_Stream_t out;
+    ReadExporter_t exporter(contig_stream, ids, !globals["eidfile"].empty());
+
+    out.open("", compression);
+    exporter.setStream(0, &out);
+    exporter.run();
+    out.close();
+
     contig_stream.close();
   }
   catch (Exception_t & e)
@@ -8,6 +8,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "foundation_AMOS.hh"
+#include "exporter.hh"
 #include <iostream>
 #include <unistd.h>
 using namespace std;
@@ -31,6 +32,8 @@ long int cnts = 0;             // seen object count
 long int cntw = 0;             // written object count
 
 int OPT_basesperline = 70;
+int OPT_Threads = 0;                          // 0 for the OpenMP default
+ExportCompression OPT_Compression = EXPORT_PLAIN;
 
 // Daniela Puiu: May 7th 2008
 int    OPT_minIID=0;
@@ -63,7 +66,7 @@ void PrintHelp (const char * s);
 void PrintUsage (const char * s);
 
 
-void DumpQuals(ostream & out, const string & quals, int lineLen)
+void DumpQuals(string & out, const string & quals, int lineLen)
 {
   int len = quals.length();
   char buffer[16];
@@ -77,82 +80,137 @@ void DumpQuals(ostream & out, const string & quals, int lineLen)
     sprintf (buffer, "%.2d%c", quals[i] - AMOS::MIN_QUALITY,
              ( ( ( i % ( lineLen ) == ( lineLen - 1 ) ) ) || ( i == len - 1 ) ) ? '\n' : ' ' );
 
-    out << buffer;
+    out += buffer;
   }
 }
 
 
-void dumpRead(Read_t & red)
+//========================================================= ReadExporter_t ====//
+//! \brief Streams the selected reads from the bank and formats them in
+//! parallel as FASTA, FASTQ or qualities
+//!
+class ReadExporter_t : public Exporter_t<Read_t>
 {
-  cnts++;
+public:
 
-  if ( red . getLength( ) <= 0 )
-    {
-      cerr << "WARNING: read with IID " << red . getIID( )
-           << " has no sequence, skipped\n";
-      return;
-    }
-  if ( ! OPT_UseRaw && red . getClearRange( ) . getLength( ) <= 0 )
-    {
-      cerr << "WARNING: read with IID " << red . getIID( )
-           << " has no clear range sequence, skipped\n";
-      return;
-    }
+  ReadExporter_t (BankStream_t & bank, istream * ids, bool eids)
+    : red_bank (bank), idfile (ids), ideids (eids)
+  { }
 
-  // Daniela Puiu
-  if(!OPT_UseEIDs)
+  //-- Returns the next read that should be written, skips the others
+  bool read (Read_t & red)
   {
-	if(OPT_minIID && red.getIID()<=OPT_minIID || OPT_maxIID && red.getIID()>OPT_maxIID) return;
-  } 
+    while ( next (red) )
+      {
+        cnts++;
+
+        if ( red . getLength( ) <= 0 )
+          {
+            cerr << "WARNING: read with IID " << red . getIID( )
+                 << " has no sequence, skipped\n";
+            continue;
+          }
+        if ( ! OPT_UseRaw && red . getClearRange( ) . getLength( ) <= 0 )
+          {
+            cerr << "WARNING: read with IID " << red . getIID( )
+                 << " has no clear range sequence, skipped\n";
+            continue;
+          }
+
+        // Daniela Puiu
+        if(!OPT_UseEIDs)
+        {
+          if(OPT_minIID && red.getIID()<=OPT_minIID || OPT_maxIID && red.getIID()>OPT_maxIID) continue;
+        }
+
+        cntw++;
+        return true;
+      }
 
-  if (OPT_DumpFastq)
+    return false;
+  }
+
+  //-- Called by several threads at once
+  void format (Read_t & red, string * out)
   {
-    if ( OPT_UseEIDs ) { cout << "@" << red.getEID() << endl; }
-    else               { cout << "@" << red.getIID() << endl; }
+    string & text = out[0];
+    string hdr;
 
-    if (OPT_UseRaw) { cout << red.getSeqString() << endl; }
-    else            { cout << red.getSeqString(red.getClearRange()) << endl; }
+    if ( OPT_UseEIDs ) { hdr = red.getEID(); }
+    else               { Export_Printf(hdr, "%u", red.getIID()); }
 
-    cout << "+" << endl;
+    if (OPT_DumpFastq)
+    {
+      text += "@" + hdr + "\n";
 
-    string quals;
+      if (OPT_UseRaw) { text += red.getSeqString(); }
+      else            { text += red.getSeqString(red.getClearRange()); }
 
-    if (OPT_UseRaw) { quals = red.getQualString(); }
-    else            { quals = red.getQualString(red.getClearRange()); }
+      text += "\n+\n";
 
-    for (int i = 0; i < quals.length(); i++)
-    {
-      quals[i] = quals[i] - AMOS::MIN_QUALITY + OPT_FastqOffset;
+      string quals;
+
+      if (OPT_UseRaw) { quals = red.getQualString(); }
+      else            { quals = red.getQualString(red.getClearRange()); }
+
+      for (int i = 0; i < quals.length(); i++)
+      {
+        quals[i] = quals[i] - AMOS::MIN_QUALITY + OPT_FastqOffset;
+      }
+
+      text += quals + "\n";
     }
+    else
+    {
+      text += ">" + hdr;
+
+      if (OPT_ShowClear)
+      {
+        Export_Printf(text, " 0 0 0 %d %d",
+                      red.getClearRange().getLo() + 1, red.getClearRange().getHi());
+      }
 
-    cout << quals << endl;
+      text += "\n";
+
+      if (OPT_DumpQual)
+      {
+        if (OPT_UseRaw) { DumpQuals(text, red.getQualString(), OPT_basesperline); }
+        else            { DumpQuals(text, red.getQualString(red.getClearRange()), OPT_basesperline); }
+      }
+      else
+      {
+        if (OPT_UseRaw) { Fasta_Append(text, red.getSeqString(), "", OPT_basesperline); }
+        else            { Fasta_Append(text, red.getSeqString(red.getClearRange()), "", OPT_basesperline); }
+      }
+    }
   }
-  else
+
+private:
+
+  //-- Fetches the next read of the bank or of the id file
+  bool next (Read_t & red)
   {
-    if ( OPT_UseEIDs ) { cout << ">" << red.getEID(); }
-    else               { cout << ">" << red.getIID(); }
+    string id;
 
-    if (OPT_ShowClear)
-    {
-      cout << " 0 0 0 " << red.getClearRange().getLo() + 1 << " " << red.getClearRange().getHi();
-    }
+    if ( idfile == NULL )
+      return red_bank >> red;
 
-    cout << endl;
+    if ( ! (*idfile >> id) )
+      return false;
 
-    if (OPT_DumpQual)
-    {
-      if (OPT_UseRaw) { DumpQuals(cout, red.getQualString(), OPT_basesperline); }
-      else            { DumpQuals(cout, red.getQualString(red.getClearRange()), OPT_basesperline); }
-    }
+    if ( ideids )
+      red_bank.seekg(red_bank.getIDMap().lookupBID(id));
     else
-    {
-      if (OPT_UseRaw) { WrapString (cout, red . getSeqString( ), OPT_basesperline); }
-      else            { WrapString (cout, red . getSeqString(red . getClearRange( )), OPT_basesperline); }
-    }
+      red_bank.seekg(red_bank.getIDMap().lookupBID(atoi(id.c_str())));
+    red_bank >> red;
+
+    return true;
   }
 
-  cntw++;
-}
+  BankStream_t & red_bank;
+  istream * idfile;
+  bool ideids;
+};
 
 
 
@@ -161,11 +219,15 @@ int main (int argc, char ** argv)
 {
   int exitcode = EXIT_SUCCESS;
   BankStream_t red_bank (Read_t::NCODE);
-  Read_t red;
 
   //-- Parse the command line arguments
   ParseArgs (argc, argv);
 
+#ifdef AMOS_HAVE_OPENMP
+  if ( OPT_Threads > 0 )
+    omp_set_num_threads (OPT_Threads);
+#endif
+
   //-- BEGIN: MAIN EXCEPTION CATCH
   try {
 
@@ -175,7 +237,7 @@ int main (int argc, char ** argv)
       red_bank . open (OPT_BankName, B_READ);
 
     ifstream file;
-    string id;
+    istream * ids = NULL;
 
     if (!OPT_EIDFile.empty())
     {
@@ -188,13 +250,7 @@ int main (int argc, char ** argv)
                           __LINE__, __FILE__);
       }
 
-      while (file >> id)
-      {
-        red_bank.seekg(red_bank.getIDMap().lookupBID(id));
-        red_bank >> red;
-
-        dumpRead(red);
-      }
+      ids = &file;
     }
     else if (!OPT_IIDFile.empty())
     {
@@ -207,26 +263,21 @@ int main (int argc, char ** argv)
                           __LINE__, __FILE__);
       }
 
-      while (file >> id)
-      {
-        red_bank.seekg(red_bank.getIDMap().lookupBID(atoi(id.c_str())));
-        red_bank >> red;
-        dumpRead(red);
-      }
-    }
-    else
-    {
-      //-- Iterate through each object in the bank
-      while ( red_bank >> red )
-      {
-        dumpRead(red);
-      }
+      ids = &file;
     }
+
+    //-- Iterate through each object in the bank or in the id file
+    Export_Stream_t out;
+    ReadExporter_t exporter (red_bank, ids, !OPT_EIDFile.empty());
+
+    out . open ("", OPT_Compression);
+    exporter . setStream (0, &out);
+    exporter . run( );
+    out . close( );
   }
   catch (const Exception_t & e) {
     cerr << "FATAL: " << e . what( ) << endl
          << "  there has been a fatal error, abort" << endl;
-    cerr << "iid: " << red.getIID() << " eid: " << red.getEID() << endl;
     exitcode = EXIT_FAILURE;
   }
   //-- END: MAIN EXCEPTION CATCH
@@ -247,7 +298,7 @@ void ParseArgs (int argc, char ** argv)
   int ch, errflg = 0;
   optarg = NULL;
 
-  while ( !errflg && ((ch = getopt (argc, argv, "cehrsvqE:I:L:m:M:fQ:")) != EOF) )
+  while ( !errflg && ((ch = getopt (argc, argv, "cehrsvqE:I:L:m:M:fQ:t:z:")) != EOF) )
     switch (ch)
       {
         case 'c': OPT_ShowClear = true; break;
@@ -266,6 +317,15 @@ void ParseArgs (int argc, char ** argv)
         case 'f': OPT_DumpFastq = true; break;
         case 'Q': OPT_FastqOffset = atoi(optarg); break;
 
+        case 't': OPT_Threads = atoi(optarg); break;
+        case 'z':
+          if ( ! Export_Parse_Compression (optarg, OPT_Compression) )
+            {
+              cerr << "ERROR: unknown compression " << optarg << endl;
+              errflg ++;
+            }
+          break;
+
         case 'h':
           PrintHelp (argv[0]);
           exit (EXIT_SUCCESS);
@@ -312,6 +372,9 @@ void PrintHelp (const char * s)
   	     << "  -M num        Maximum IID to display (included) (Default all; not compatible with -e,-E,-I options)\n"
          << "  -h            Display help information\n"
          << "  -s            Disregard bank locks and write permissions (spy mode)\n"
+         << "  -t num        Number of threads formatting and compressing the output\n"
+         << "                (Default: all processors)\n"
+         << "  -z type       Compress the output as none, gzip or bgzf (Default: none)\n"
          << "  -v            Display the compatible bank version\n"
          << "\n.KEYWORDS.\n"
          << "  amos bank, reads, converters"
@@ -115,6 +115,7 @@ int main (int argc, char ** argv)
   BankStream_t ctg_bank (Contig_t::NCODE);
   BankStream_t scf_bank (Scaffold_t::NCODE);
   BankStream_t red_bank (Read_t::NCODE);
+  ReadIndex_t rindex;
 
   //-- Parse the command line arguments
   ParseArgs (argc, argv);
@@ -142,35 +143,45 @@ int main (int argc, char ** argv)
     cerr << "Indexed " << libmap.size() << " libraries" << endl;
 
 
-    cerr << "Indexing frgs... ";
-    while (frg_bank >> frg)
+    //-- A current read index saves indexing every fragment and read
+    if (ReadIndex_t::isCurrent(OPT_BankName))
     {
-      frgliblookup[frg.getIID()] = frg.getLibrary();
-
-      std::pair<ID_t, ID_t> mtp = frg.getMatePair();
-
-      mates[mtp.first] = mtp.second;
-      mates[mtp.second] = mtp.first;
+      rindex.open(OPT_BankName);
+      cerr << "Using read index of " << rindex.getSize() << " reads" << endl;
     }
-    cerr << frgliblookup.size() << " fragments" << endl;
-    cerr << mates.size() << " mates" << endl;
-
-    cerr << "Indexing reds... ";
-    while (red_bank >> red)
+    else
     {
-      IDMap::const_iterator fi = frgliblookup.find(red.getFragment());
-
-      if (fi != frgliblookup.end())
+      cerr << "Indexing frgs... ";
+      while (frg_bank >> frg)
       {
-        readliblookup[red.getIID()] = fi->second;
+        frgliblookup[frg.getIID()] = frg.getLibrary();
+
+        std::pair<ID_t, ID_t> mtp = frg.getMatePair();
+
+        mates[mtp.first] = mtp.second;
+        mates[mtp.second] = mtp.first;
       }
+      cerr << frgliblookup.size() << " fragments" << endl;
+      cerr << mates.size() << " mates" << endl;
 
-      readlens[red.getIID()] = red.getClearRange().getLength();
+      cerr << "Indexing reds... ";
+      red_bank.setProjection(P_FRAGMENT | P_CLEAR);
+      while (red_bank >> red)
+      {
+        IDMap::const_iterator fi = frgliblookup.find(red.getFragment());
+
+        if (fi != frgliblookup.end())
+        {
+          readliblookup[red.getIID()] = fi->second;
+        }
+
+        readlens[red.getIID()] = red.getClearRange().getLength();
+      }
+      cerr << readliblookup.size() << " reads in fragments" << endl;
     }
-    cerr << readliblookup.size() << " reads in fragments" << endl;
 
 
-    if (OPT_UseScaffolds)
+    if (OPT_UseScaffolds && !rindex.isOpen())
     {
       cerr << "Indexing scaffolds... ";
       int scaffcount = 0;
@@ -203,6 +214,19 @@ int main (int argc, char ** argv)
       exit (1);
     }
 
+    if (OPT_UseScaffolds && rindex.isOpen())
+    {
+      ctg_bank.fetch(contigiid, contig);
+      if (!contig.getReadTiling().empty())
+      {
+        ID_t scaffiid = rindex.getScaffold(contig.getReadTiling()[0].source);
+        if (scaffiid != AMOS::NULL_ID)
+        {
+          contigscafflookup[contigiid] = scaffiid;
+        }
+      }
+    }
+
     vector <Tile_t> rtiling;
     map<ID_t, Tile_t *> tilelookup;
     map<ID_t, Tile_t *>::iterator tli;
@@ -282,6 +306,25 @@ int main (int argc, char ** argv)
       tilelookup.insert(make_pair(ri->source, &(*ri)));
     }
 
+    if (rindex.isOpen() && OPT_USEMATES)
+    {
+      // only the tiled reads and their mates are needed
+      for (ri = rtiling.begin(); ri != rtiling.end(); ri++)
+      {
+        const ReadIndex_t::Record_t * rec = rindex.find(ri->source);
+        if (rec == NULL || rec->mate == AMOS::NULL_ID) { continue; }
+
+        mates[rec->read] = rec->mate;
+        if (rec->library != AMOS::NULL_ID)
+        {
+          readliblookup[rec->read] = rec->library;
+        }
+
+        red_bank.fetchFix(rec->mate, red);
+        readlens[rec->mate] = red.getClearRange().getLength();
+      }
+    }
+
     if (rangeEnd < rangeStart)
     {
       int t = rangeEnd;
@@ -1,5 +1,6 @@
 #include "foundation_AMOS.hh"
 #include <iostream>
+#include <algorithm>
 #include <cassert>
 #include <unistd.h>
 using namespace std;
@@ -45,24 +46,76 @@ int main (int argc, char ** argv)
     ctg_bank.open (OPT_BankName, bm);
     red_bank.open(OPT_BankName, bm);
 
-    while (ctg_bank >> contig)
+    //-- A current contig range index lists the reads of each contig
+    //   without fetching the contigs, if every contig has an IID
+    vector< pair<ID_t, ID_t> > contigs;   // BID, IID in stream order
+    ContigRangeIndex_t cindex;
+
+    if (ContigRangeIndex_t::isCurrent(OPT_BankName))
     {
-      ID_t ciid = contig.getIID();
-      vector<Tile_t> & rtiling = contig.getReadTiling();
-      vector<Tile_t>::const_iterator ti;
+      AMOS::IDMap_t::const_iterator ci;
+      for (ci = ctg_bank.getIDMap().begin(); ci; ci++)
+      {
+        if (ci->iid != NULL_ID)
+          contigs.push_back (make_pair(ci->bid, ci->iid));
+      }
+
+      if ((Size_t) contigs.size() == ctg_bank.getSize())
+      {
+        sort (contigs.begin(), contigs.end());
+        cindex.open (OPT_BankName);
+      }
+    }
+
+    if (cindex.isOpen())
+    {
+      vector<ContigRangeIndex_t::Entry_t> tiles;
+      vector<ContigRangeIndex_t::Entry_t>::const_iterator ti;
+
+      for (size_t c = 0; c < contigs.size(); c++)
+      {
+        ID_t ciid = contigs[c].second;
+
+        if ( cindex.getNumTiles(ciid) > 1 ) // only count non-singleton contigs
+        {
+          tiles.clear();
+          cindex.getTiles(ciid, Range_t(-MAX_POS, MAX_POS), tiles);
 
-      if ( rtiling.size() > 1 ) // only count non-singleton contigs
-        for (ti = rtiling.begin(); ti != rtiling.end(); ti++)
+          for (ti = tiles.begin(); ti != tiles.end(); ti++)
           {
-            rdi = readdups.find(ti->source);
+            rdi = readdups.find(ti->iid);
             if (rdi == readdups.end())
-              {
-                rdi = readdups.insert
-                  (make_pair(ti->source, vector<ID_t>())).first;
-              }
-            
+            {
+              rdi = readdups.insert
+                (make_pair(ti->iid, vector<ID_t>())).first;
+            }
+
             rdi->second.push_back(ciid);
           }
+        }
+      }
+    }
+    else
+    {
+      while (ctg_bank >> contig)
+      {
+        ID_t ciid = contig.getIID();
+        vector<Tile_t> & rtiling = contig.getReadTiling();
+        vector<Tile_t>::const_iterator ti;
+
+        if ( rtiling.size() > 1 ) // only count non-singleton contigs
+          for (ti = rtiling.begin(); ti != rtiling.end(); ti++)
+            {
+              rdi = readdups.find(ti->source);
+              if (rdi == readdups.end())
+                {
+                  rdi = readdups.insert
+                    (make_pair(ti->source, vector<ID_t>())).first;
+                }
+
+              rdi->second.push_back(ciid);
+            }
+      }
     }
 
     AMOS::IDMap_t::const_iterator ri;
@@ -188,6 +241,9 @@ void PrintHelp (const char * s)
         << "  S: Singleton read\n"
         << "  P: Placed in a single contig\n"
         << "  D: Placed in multiple contigs\n"
+        << "\n"
+        << "  The contig tilings are read from the contig range index when\n"
+        << "  bank-range-index has made a current one\n"
         << "\n.OPTIONS.\n"
         << "  -h  Display help information\n"
         << "  -s  Disregard bank locks and write permissions (spy mode)\n"
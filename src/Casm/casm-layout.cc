@@ -24,7 +24,11 @@
 #include <sstream>
 #include <iostream>
 #include <cassert>
+#include <new>
 #include <unistd.h>
+#ifdef AMOS_HAVE_OPENMP
+#include <omp.h>
+#endif
 using namespace std;
 
 
@@ -65,6 +69,40 @@ const int FUZZY      =  10;     // fuzzy equals tolerance
 struct ReadMap_t;
 struct Contig_t;
 
+template <class T> class Pool_t
+//!< Block allocator, objects live until the pool is destroyed
+{
+  static const long int BLOCK = 4096;   // objects per block
+
+  vector<T *> blocks;                   // allocated blocks
+  long int used;                        // objects used in the last block
+
+public:
+
+  Pool_t ( ) { used = BLOCK; }
+  ~Pool_t ( )
+  {
+    long int i, n;
+    for ( i = 0; i < (long int)blocks . size( ); ++ i )
+      {
+        n = i + 1 == (long int)blocks . size( ) ? used : BLOCK;
+        while ( n -- > 0 )
+          blocks[i][n] . ~T( );
+        ::operator delete (blocks[i]);
+      }
+  }
+
+  T * alloc ( )
+  {
+    if ( used == BLOCK )
+      {
+        blocks . push_back ((T *) ::operator new (sizeof (T) * BLOCK));
+        used = 0;
+      }
+    return new (blocks . back( ) + used ++) T( );
+  }
+};
+
 struct Conflict_t
 {
   // don't swap order, sorts depend on values
@@ -154,7 +192,7 @@ struct ReadMap_t
   AMOS::ID_t id;                        // ID of read
   long int len;                         // len of read
 
-  vector<ReadAlign_t *> all;            // all alignments for this read
+  vector<ReadAlign_t *> all;            // all alignments, owned by mapping
   list<ReadAlignChain_t *> best;        // list of best alignment chains
   ReadAlignChain_t * place;             // read placement chain
 
@@ -165,9 +203,6 @@ struct ReadMap_t
   ReadMap_t ( ) { place = NULL; exclude = false; }
   ~ReadMap_t ( )
   {
-    vector<ReadAlign_t *>::iterator rapi;
-    for ( rapi = all . begin( ); rapi != all . end( ); ++ rapi )
-      delete (*rapi);
     list<ReadAlignChain_t *>::iterator rcpi;
     for ( rcpi = best . begin( ); rcpi != best . end( ); ++ rcpi )
       delete (*rcpi);
@@ -176,15 +211,18 @@ struct ReadMap_t
 
 struct Mapping_t
 {
+  Pool_t<ReadAlign_t> alignpool;        // storage for all read alignments
+  Pool_t<ReadMap_t> readpool;           // storage for all reads
+
   map<string, Reference_t> references;  // map of references
   vector<ReadMap_t *> reads;            // vector of reads
+};
 
-  ~Mapping_t ( )
-  {
-    vector<ReadMap_t *>::iterator rmpi;
-    for ( rmpi = reads . begin( ); rmpi != reads . end( ); ++ rmpi )
-      delete (*rmpi);
-  }
+struct ReadRange_t
+{
+  Reference_t * ref;                    // the reference
+  vector<ReadMap_t *>::iterator beg;    // first read placed on ref
+  vector<ReadMap_t *>::iterator end;    // one past the last read on ref
 };
 
 struct Tile_t
@@ -348,6 +386,16 @@ struct ConflictExcludePredicate_t
 void Assemble (Mapping_t & mapping, Assembly_t & assembly);
 
 
+//----------------------------------------------------- AssembleReference ----//
+//! \brief Construct the contigs for a single reference
+//!
+//! \param range The reads placed on the reference
+//! \param contigs Append the new contigs here
+//! \return void
+//!
+void AssembleReference (ReadRange_t & range, vector<Contig_t *> & contigs);
+
+
 //----------------------------------------------------------- ChainAligns ----//
 //! \brief Run LAS and store the best alignment chains for each read
 //!
@@ -378,6 +426,15 @@ void CleanContigs (Assembly_t & assembly);
 void FindConflicts (Mapping_t & mapping);
 
 
+//------------------------------------------------ FindReferenceConflicts ----//
+//! \brief Find and store conflicts for the reads placed on one reference
+//!
+//! \param range The reads placed on the reference
+//! \return void
+//!
+void FindReferenceConflicts (ReadRange_t & range);
+
+
 //------------------------------------------------------------ ParseAlign ----//
 //! \brief Parse, sort and store the alignment input
 //!
@@ -401,6 +458,20 @@ void ParseAlign (Mapping_t & mapping);
 void ParseMates (Mapping_t & mapping);
 
 
+//-------------------------------------------------------- PartitionReads ----//
+//! \brief Find the range of placed reads for each reference
+//!
+//! Ranges are listed in reference map order, which is the order all the
+//! per-reference passes merge their results in.
+//!
+//! \param mapping The read mapping
+//! \param ranges Store the read ranges here
+//! \pre read list is sorted by place
+//! \return void
+//!
+void PartitionReads (Mapping_t & mapping, vector<ReadRange_t> & ranges);
+
+
 //------------------------------------------------------- PlaceHappyMates ----//
 //! \brief Place all unplaced read matepairs while keeping them 'happy'
 //!
@@ -490,6 +561,16 @@ void OutputUMD (const Assembly_t & assembly);
 void RefineConflicts (Mapping_t & mapping);
 
 
+//---------------------------------------------- RefineReferenceConflicts ----//
+//! \brief Refine the conflicts of a single reference
+//!
+//! \param range The reads placed on the reference
+//! \pre FindConflicts has been called
+//! \return void
+//!
+void RefineReferenceConflicts (ReadRange_t & range);
+
+
 //------------------------------------------------------------- ParseArgs ----//
 //! \brief Sets the global OPT_% values from the command line arguments
 //!
@@ -702,174 +783,173 @@ int main (int argc, char ** argv)
 //-------------------------------------------------------------- Assemble ----//
 void Assemble (Mapping_t & mapping, Assembly_t & assembly)
 {
-  ReadMap_t temprm;
-  temprm . place = new ReadAlignChain_t( );
-  temprm . place -> head = new ReadAlign_t( );
+  vector<ReadRange_t> ranges;
+  long int i, n;
+
+  PartitionReads (mapping, ranges);
+  n = ranges . size( );
+  vector< vector<Contig_t *> > contigs (n);
+
+  //-- Assemble each reference in parallel
+#pragma omp parallel for schedule(dynamic)
+  for ( i = 0; i < n; ++ i )
+    AssembleReference (ranges[i], contigs[i]);
+
+  //-- Collect the contigs in reference order
+  for ( i = 0; i < n; ++ i )
+    assembly . contigs . insert
+      (assembly . contigs . end( ), contigs[i] . begin( ), contigs[i] . end( ));
+}
 
-  Reference_t * rp;
+
+
+
+//----------------------------------------------------- AssembleReference ----//
+void AssembleReference (ReadRange_t & range, vector<Contig_t *> & contigs)
+{
+  Reference_t * rp = range . ref;
   Contig_t * cp;
   Tile_t * tp;
 
-  map<string, Reference_t>::iterator rmi;
   list<ReadMap_t *>::iterator rmpi, rmpic;
   list<Conflict_t *>::iterator cpi;
 
-  pair<
-    vector<ReadMap_t *>::iterator,
-    vector<ReadMap_t *>::iterator
-    > rmpip;
-
   long int confbeg, confend;
 
 
-  //-- For each reference
-  for ( rmi  = mapping . references . begin( );
-	rmi != mapping . references . end( ); ++ rmi )
-    {
-      rp = &(rmi -> second);
-
-      //-- Find the read mapping range
-      temprm . place -> head -> ref = rp;
-      rmpip = equal_range (mapping . reads . begin( ), mapping . reads . end( ),
-			   &temprm, ReadReferenceCmp_t( ));
-
-      //-- For all reads mapping to the reference
-      list<ReadMap_t *> reads (rmpip.first, rmpip.second);
-      reads . remove_if (ReadExcludePredicate_t( ));
+  //-- For all reads mapping to the reference
+  list<ReadMap_t *> reads (range . beg, range . end);
+  reads . remove_if (ReadExcludePredicate_t( ));
 
-      //-- For all non-excluded conflicts to this reference
-      list<Conflict_t *> confs (rp->conflicts.begin( ), rp->conflicts.end( ));
-      confs . remove_if (ConflictExcludePredicate_t( ));
+  //-- For all non-excluded conflicts to this reference
+  list<Conflict_t *> confs (rp->conflicts.begin( ), rp->conflicts.end( ));
+  confs . remove_if (ConflictExcludePredicate_t( ));
 
 
-      //-- Keep going until all reads have been assembled
-      cp = NULL;
-      rmpi = reads . end( );
-      while ( ! reads . empty( ) )
+  //-- Keep going until all reads have been assembled
+  cp = NULL;
+  rmpi = reads . end( );
+  while ( ! reads . empty( ) )
+    {
+      //-- If end of list reached, push a new contig and start over
+      if ( rmpi == reads . end( ) )
 	{
-	  //-- If end of list reached, push a new contig and start over
-	  if ( rmpi == reads . end( ) )
+	  if ( cp == NULL  ||  !cp -> tiles . empty( ) )
 	    {
-	      if ( cp == NULL  ||  !cp -> tiles . empty( ) )
-		{
-		  cp = new Contig_t( );
-		  assembly . contigs . push_back (cp);
-		}
-	      rmpi = reads . begin( );
+	      cp = new Contig_t( );
+	      contigs . push_back (cp);
 	    }
+	  rmpi = reads . begin( );
+	}
 
 
-	  //-- Jump to the next conflict
-	  for ( cpi  = confs . begin( ); cpi != confs . end( ); ++ cpi )
-	    if ( (*cpi) -> pos + FUZZY > (*rmpi) -> place -> tbeg )
-	      {
-		confbeg = (*cpi) -> pos;
-		confend = (*cpi) -> gapR == 0
-		  ? confbeg : confbeg + (*cpi) -> gapR + 1;
-		break;
-	      }
+      //-- Jump to the next conflict
+      for ( cpi  = confs . begin( ); cpi != confs . end( ); ++ cpi )
+	if ( (*cpi) -> pos + FUZZY > (*rmpi) -> place -> tbeg )
+	  {
+	    confbeg = (*cpi) -> pos;
+	    confend = (*cpi) -> gapR == 0
+	      ? confbeg : confbeg + (*cpi) -> gapR + 1;
+	    break;
+	  }
 
 
-	  //-- Assemble reads not involved in the conflict
-	  while ( rmpi != reads . end( )  &&
-		  (cpi == confs . end( )  ||
-		   (*rmpi) -> place -> beg < lmax (confbeg, confend)) )
+      //-- Assemble reads not involved in the conflict
+      while ( rmpi != reads . end( )  &&
+	      (cpi == confs . end( )  ||
+	       (*rmpi) -> place -> beg < lmax (confbeg, confend)) )
+	{
+	  //-- Assemble pre-conflict reads
+	  if ( cpi == confs . end( )  ||
+	       (*rmpi) -> place -> end <= confbeg + OPT_MaxTrimLen )
 	    {
-	      //-- Assemble pre-conflict reads
-	      if ( cpi == confs . end( )  ||
-		   (*rmpi) -> place -> end <= confbeg + OPT_MaxTrimLen )
-		{
-		  tp = new Tile_t (*rmpi, cp);
-		  
-		  //-- ASSEMBLE the read
-		  cp -> tiles . push_back (tp);
-		  rmpi = reads . erase (rmpi);
-		}
-	      //-- Skip involved reads
-	      else
-		++ rmpi;
+	      tp = new Tile_t (*rmpi, cp);
+
+	      //-- ASSEMBLE the read
+	      cp -> tiles . push_back (tp);
+	      rmpi = reads . erase (rmpi);
 	    }
+	  //-- Skip involved reads
+	  else
+	    ++ rmpi;
+	}
 
 
-	  //-- If no conflict to process, continue
-	  if ( cpi == confs . end( ) )
-	    continue;
+      //-- If no conflict to process, continue
+      if ( cpi == confs . end( ) )
+	continue;
 
 
-	  //-- If SUPPORTED, process the conflict
-	  if ( (*cpi) -> status == Conflict_t::SUPPORTED )
+      //-- If SUPPORTED, process the conflict
+      if ( (*cpi) -> status == Conflict_t::SUPPORTED )
+	{
+	  //-- If LOBREAK, push a new contig
+	  if ( (*cpi) -> type == Conflict_t::LOBREAK  &&
+	       !cp -> tiles . empty( ) )
 	    {
-	      //-- If LOBREAK, push a new contig
-	      if ( (*cpi) -> type == Conflict_t::LOBREAK  &&
-		   !cp -> tiles . empty( ) )
-		{
-		  cp = new Contig_t( );
-		  assembly . contigs . push_back (cp);
-		}
+	      cp = new Contig_t( );
+	      contigs . push_back (cp);
+	    }
 
-	      //-- Assemble reads overlapping the conflict
-	      for ( rmpic = reads . begin( ); rmpic != rmpi; ) 
+	  //-- Assemble reads overlapping the conflict
+	  for ( rmpic = reads . begin( ); rmpic != rmpi; ) 
+	    {
+	      //-- If a supporting read
+	      if ( (*cpi)->support.find(*rmpic) != (*cpi)->support.end( ) )
 		{
-		  //-- If a supporting read
-		  if ( (*cpi)->support.find(*rmpic) != (*cpi)->support.end( ) )
-		    {
-		      tp = new Tile_t (*rmpic, cp);
-
-		      //-- If LOBREAK on an INDEL, need to adjust the offset
-		      if ( (*cpi) -> type == Conflict_t::INDEL  &&
-			   (*rmpic) -> place -> tbeg >= confend - FUZZY  &&
-			   (*rmpic) -> place -> tbeg -
-			   (*rmpic) -> place -> beg > OPT_MaxTrimLen )
-			tp -> off += (*cpi) -> gapQ - (*cpi) -> gapR;
-
-		      //-- ASSEMBLE the read
-		      cp -> tiles . push_back (tp);
-		      rmpic = reads . erase (rmpic);
-		    }
-		  else
-		    ++ rmpic;
-		}
+		  tp = new Tile_t (*rmpic, cp);
 
-	      //-- Conflict post-processing
-	      switch ( (*cpi) -> type )
-		{
-		case Conflict_t::LOBREAK:       // do nothing
-		  break;
-		case Conflict_t::HIBREAK:       // new contig
-		  rmpi = reads . end( );
-		  break;
-		case Conflict_t::INDEL:         // adjust for reference gap
-		  cp -> adjust += (*cpi) -> gapQ - (*cpi) -> gapR;
-		  break;
+		  //-- If LOBREAK on an INDEL, need to adjust the offset
+		  if ( (*cpi) -> type == Conflict_t::INDEL  &&
+		       (*rmpic) -> place -> tbeg >= confend - FUZZY  &&
+		       (*rmpic) -> place -> tbeg -
+		       (*rmpic) -> place -> beg > OPT_MaxTrimLen )
+		    tp -> off += (*cpi) -> gapQ - (*cpi) -> gapR;
+
+		  //-- ASSEMBLE the read
+		  cp -> tiles . push_back (tp);
+		  rmpic = reads . erase (rmpic);
 		}
+	      else
+		++ rmpic;
 	    }
-	  //-- If AMBIGUOUS, push a new contig if necessary
-	  else if ( !cp -> tiles . empty( ) )
+
+	  //-- Conflict post-processing
+	  switch ( (*cpi) -> type )
 	    {
-	      cp = new Contig_t( );
-	      assembly . contigs . push_back (cp);
+	    case Conflict_t::LOBREAK:       // do nothing
+	      break;
+	    case Conflict_t::HIBREAK:       // new contig
+	      rmpi = reads . end( );
+	      break;
+	    case Conflict_t::INDEL:         // adjust for reference gap
+	      cp -> adjust += (*cpi) -> gapQ - (*cpi) -> gapR;
+	      break;
 	    }
+	}
+      //-- If AMBIGUOUS, push a new contig if necessary
+      else if ( !cp -> tiles . empty( ) )
+	{
+	  cp = new Contig_t( );
+	  contigs . push_back (cp);
+	}
 
 
-	  //-- Back up to end of resovled conflict
-	  while ( rmpi != reads . begin( ) )
+      //-- Back up to end of resovled conflict
+      while ( rmpi != reads . begin( ) )
+	{
+	  -- rmpi;
+	  if ( (*rmpi) -> place -> beg < confend - OPT_MaxTrimLen )
 	    {
-	      -- rmpi;
-	      if ( (*rmpi) -> place -> beg < confend - OPT_MaxTrimLen )
-		{
-		  ++ rmpi;
-		  break;
-		}
+	      ++ rmpi;
+	      break;
 	    }
+	}
 
 
-	  //-- Resovled the conflict, remove it
-	  cpi = confs . erase (cpi);
-	}
+      //-- Resovled the conflict, remove it
+      cpi = confs . erase (cpi);
     }
-
-  delete temprm . place -> head;
-  delete temprm . place;
 }
 
 
@@ -885,108 +965,116 @@ void ChainAligns (Mapping_t & mapping)
     long int from;
   };
 
-  ScoreLAS * las = NULL;
+  long int k, nreads = mapping . reads . size( );
 
-  bool olapflag;
-  long int i, j, n, best;
-  long int olap1, olap2, olap, len;
+  //-- Reads are independent, chain them in parallel
+#pragma omp parallel
+  {
+    ScoreLAS * las = NULL;
 
-  vector<ReadMap_t *>::iterator rmpi;
-  list<ReadAlignChain_t *>::iterator rcpi;
-  ReadAlignChain_t * bestchain, * currchain;
+    bool olapflag;
+    long int i, j, n, best;
+    long int olap1, olap2, olap, len;
 
-  //-- For each read in the mapping
-  for ( rmpi  = mapping . reads . begin( );
-	rmpi != mapping . reads . end( ); ++ rmpi )
-    {
-      //-- Initialize the dynamic programming matrix
-      n = (*rmpi) -> all . size( );
-      las = (ScoreLAS *) AMOS::SafeRealloc (las, sizeof (ScoreLAS) * n);
-      for ( i = 0; i < n; i ++ )
-	{
-	  las [i] . a = (*rmpi) -> all[i];
-	  las [i] . score = las [i] . a -> hi - las [i] . a -> lo + 1;
-	  las [i] . from = -1;
-	}
+    ReadMap_t * rmp;
+    list<ReadAlignChain_t *>::iterator rcpi;
+    ReadAlignChain_t * bestchain, * currchain;
 
-      //-- Isn't it dynamic?
-      for ( i = 0; i < n; i ++ )
-	for ( j = 0; j < i; j ++ )
+    //-- For each read in the mapping
+#pragma omp for schedule(dynamic, 256)
+    for ( k = 0; k < nreads; ++ k )
+      {
+	rmp = mapping . reads[k];
+
+	//-- Initialize the dynamic programming matrix
+	n = rmp -> all . size( );
+	las = (ScoreLAS *) AMOS::SafeRealloc (las, sizeof (ScoreLAS) * n);
+	for ( i = 0; i < n; i ++ )
 	  {
-	    if ( las [i] . a -> ref != las [j] . a -> ref  ||
-		 las [i] . a -> ori != las [j] . a -> ori )
-	      continue;
-
-	    olap1 = las [j] . a -> hiR - las [i] . a -> loR + 1;
-	    if ( OPT_MaxGap >= 0  &&  olap1 < -(OPT_MaxGap) )
-	      continue;
-	    olap = olap1 > 0 ? olap1 : 0;
-
-	    olap2 = las [j] . a -> hi - las [i] . a -> lo + 1;
-	    if ( OPT_MaxGap >= 0  &&  olap2 < -(OPT_MaxGap) )
-	      continue;
-	    olap = olap > olap2 ? olap : olap2;
-
-	    len = las [i] . a -> hi - las [i] . a -> lo + 1;
-	    if ( las [j] . score + len - olap > las [i] . score )
-	      {
-		las [i] . from = j;
-		las [i] . score = las [j] . score + len - olap;
-	      }
+	    las [i] . a = rmp -> all[i];
+	    las [i] . score = las [i] . a -> hi - las [i] . a -> lo + 1;
+	    las [i] . from = -1;
 	  }
 
-      //-- Store all the non-redundant chains and store sorted by score
-      bestchain = NULL;
-      while (true)
-	{
-	  best = 0;
-	  for ( i = 1; i < n; i ++ )
-	    if ( las [i] . score > las [best] . score )
-	      best = i;
-	  if ( las [best] . score <= 0 )
-	    break;
-
-	  olapflag = false;
-	  for ( i = best; las [i] . from >= 0; i = las [i] . from )
+	//-- Isn't it dynamic?
+	for ( i = 0; i < n; i ++ )
+	  for ( j = 0; j < i; j ++ )
 	    {
-	      if ( las [i] . score == 0 )
-		olapflag = true;
-	      las [i] . score = 0;
-	      las [i] . a -> from = las [las [i] . from] . a;
-	    }
-	  if ( las [i] . score == 0 )
-	    olapflag = true;
-	  las [i] . score = 0;
-	  las [i] . a -> from = NULL;
+	      if ( las [i] . a -> ref != las [j] . a -> ref  ||
+		   las [i] . a -> ori != las [j] . a -> ori )
+		continue;
 
-	  if ( !olapflag )
-	    {
-	      currchain = new ReadAlignChain_t (*rmpi, las [best] . a);
-	      (*rmpi) -> best . push_back (currchain);
-	      if ( bestchain == NULL )
-		bestchain = currchain;
-	      else if ( IsBetterChain (currchain, bestchain, *rmpi) )
-		bestchain = currchain;
-	    }
-	}
+	      olap1 = las [j] . a -> hiR - las [i] . a -> loR + 1;
+	      if ( OPT_MaxGap >= 0  &&  olap1 < -(OPT_MaxGap) )
+		continue;
+	      olap = olap1 > 0 ? olap1 : 0;
 
-      //-- Keep only the 'best' chains, thus best . size > 0 == ambiguity
-      //   i.e. within OPT_MaxCoverageDiff of the longest and within
-      //   OPT_MaxIdentityDiff of the longest (with the higest idy)
-      rcpi = (*rmpi) -> best . begin( );
-      while ( rcpi != (*rmpi) -> best . end( ) )
-	{
-	  if ( IsEqualChain (*rcpi, bestchain, *rmpi) )
-	    ++ rcpi;
-	  else
-	    {
-	      delete (*rcpi);
-	      rcpi = (*rmpi) -> best . erase (rcpi);
+	      olap2 = las [j] . a -> hi - las [i] . a -> lo + 1;
+	      if ( OPT_MaxGap >= 0  &&  olap2 < -(OPT_MaxGap) )
+		continue;
+	      olap = olap > olap2 ? olap : olap2;
+
+	      len = las [i] . a -> hi - las [i] . a -> lo + 1;
+	      if ( las [j] . score + len - olap > las [i] . score )
+		{
+		  las [i] . from = j;
+		  las [i] . score = las [j] . score + len - olap;
+		}
 	    }
-	}
-    }
 
-  free (las);
+	//-- Store all the non-redundant chains and store sorted by score
+	bestchain = NULL;
+	while (true)
+	  {
+	    best = 0;
+	    for ( i = 1; i < n; i ++ )
+	      if ( las [i] . score > las [best] . score )
+		best = i;
+	    if ( las [best] . score <= 0 )
+	      break;
+
+	    olapflag = false;
+	    for ( i = best; las [i] . from >= 0; i = las [i] . from )
+	      {
+		if ( las [i] . score == 0 )
+		  olapflag = true;
+		las [i] . score = 0;
+		las [i] . a -> from = las [las [i] . from] . a;
+	      }
+	    if ( las [i] . score == 0 )
+	      olapflag = true;
+	    las [i] . score = 0;
+	    las [i] . a -> from = NULL;
+
+	    if ( !olapflag )
+	      {
+		currchain = new ReadAlignChain_t (rmp, las [best] . a);
+		rmp -> best . push_back (currchain);
+		if ( bestchain == NULL )
+		  bestchain = currchain;
+		else if ( IsBetterChain (currchain, bestchain, rmp) )
+		  bestchain = currchain;
+	      }
+	  }
+
+	//-- Keep only the 'best' chains, thus best . size > 0 == ambiguity
+	//   i.e. within OPT_MaxCoverageDiff of the longest and within
+	//   OPT_MaxIdentityDiff of the longest (with the higest idy)
+	rcpi = rmp -> best . begin( );
+	while ( rcpi != rmp -> best . end( ) )
+	  {
+	    if ( IsEqualChain (*rcpi, bestchain, rmp) )
+	      ++ rcpi;
+	    else
+	      {
+		delete (*rcpi);
+		rcpi = rmp -> best . erase (rcpi);
+	      }
+	  }
+      }
+
+    free (las);
+  }
 }
 
 
@@ -1046,17 +1134,36 @@ void CleanContigs (Assembly_t & assembly)
 
 //--------------------------------------------------------- FindConflicts ----//
 void FindConflicts (Mapping_t & mapping)
+{
+  vector<ReadRange_t> ranges;
+  long int i, n;
+
+  PartitionReads (mapping, ranges);
+  n = ranges . size( );
+
+  //-- Conflicts are local to a reference, find them in parallel
+#pragma omp parallel for schedule(dynamic)
+  for ( i = 0; i < n; ++ i )
+    FindReferenceConflicts (ranges[i]);
+}
+
+
+
+
+//------------------------------------------------ FindReferenceConflicts ----//
+void FindReferenceConflicts (ReadRange_t & range)
 {
   ReadAlign_t * curraln;
   ReadMap_t * currmap;
   pair<long int, long int> gap;
   vector<ReadMap_t *>::iterator rmpi;
   set<ReadMap_t *> yay;
+  list<Conflict_t *> & conflicts = range . ref -> conflicts;
+  list<Conflict_t *>::iterator first, last, next, nxtf;
 
 
-  //-- For each read
-  for ( rmpi  = mapping . reads . begin( );
-	rmpi != mapping . reads . end( ); ++ rmpi )
+  //-- For each read placed on the reference
+  for ( rmpi = range . beg; rmpi != range . end; ++ rmpi )
     {
       if ( (*rmpi) -> place == NULL )
 	continue;
@@ -1096,53 +1203,47 @@ void FindConflicts (Mapping_t & mapping)
 	  (new Conflict_t (Conflict_t::LOBREAK, curraln -> loR, 0, 0, currmap));
     }
 
-  //-- For each reference, sort and remove redundant conflicts
-  map<string, Reference_t>::iterator rmi;
-  list<Conflict_t *>::iterator first, last, next, nxtf;
-  for ( rmi  = mapping . references . begin( );
-	rmi != mapping . references . end( ); ++ rmi )
-    {
-      if ( rmi -> second . conflicts . empty( ) )
-	continue;
+  //-- Sort and remove redundant conflicts
+  if ( conflicts . empty( ) )
+    return;
 
-      rmi -> second . conflicts . sort (ConflictCmp_t( ));
+  conflicts . sort (ConflictCmp_t( ));
 
-      //-- Do my own 'unique' method instead of STL, needed for fuzzy equals
-      first = next = rmi -> second . conflicts . begin( );
-      last  = nxtf = rmi -> second . conflicts . end( );
-      while ( ++ next != last )
+  //-- Do my own 'unique' method instead of STL, needed for fuzzy equals
+  first = next = conflicts . begin( );
+  last  = nxtf = conflicts . end( );
+  while ( ++ next != last )
+    {
+      if ( IsEqualConflict (*first, *next) )
+	{
+	  //-- Merge the two support sets
+	  set_union
+	    ((*first) -> support . begin( ), (*first) -> support . end( ),
+	     (*next)  -> support . begin( ), (*next)  -> support . end( ),
+	     insert_iterator<set<ReadMap_t *> > (yay, yay . begin( )));
+	  (*first) -> support . swap (yay);
+	  yay . clear( );
+
+	  delete (*next);
+	  conflicts . erase (next);
+	  next = first;
+	}
+      else
 	{
-	  if ( IsEqualConflict (*first, *next) )
+	  if ( labs ((*first) -> pos - (*next) -> pos) <= FUZZY )
 	    {
-	      //-- Merge the two support sets
-	      set_union
-		((*first) -> support . begin( ), (*first) -> support . end( ),
-		 (*next)  -> support . begin( ), (*next)  -> support . end( ),
-		 insert_iterator<set<ReadMap_t *> > (yay, yay . begin( )));
-	      (*first) -> support . swap (yay);
-	      yay . clear( );
-
-	      delete (*next);
-	      rmi -> second . conflicts . erase (next);
-	      next = first;
+	      if ( nxtf == last )
+		nxtf = next;
 	    }
 	  else
 	    {
-	      if ( labs ((*first) -> pos - (*next) -> pos) <= FUZZY )
+	      if ( nxtf != last )
 		{
-		  if ( nxtf == last )
-		    nxtf = next;
+		  next = nxtf;
+		  nxtf = last;
 		}
-	      else
-		{
-		  if ( nxtf != last )
-		    {
-		      next = nxtf;
-		      nxtf = last;
-		    }
 
-		  first = next;
-		}
+	      first = next;
 	    }
 	}
     }
@@ -1494,6 +1595,43 @@ void OutputUMD (const Assembly_t & assembly)
 
 
 
+//-------------------------------------------------------- PartitionReads ----//
+void PartitionReads (Mapping_t & mapping, vector<ReadRange_t> & ranges)
+{
+  ReadMap_t temprm;
+  temprm . place = new ReadAlignChain_t( );
+  temprm . place -> head = new ReadAlign_t( );
+
+  ReadRange_t range;
+  map<string, Reference_t>::iterator rmi;
+  pair<
+    vector<ReadMap_t *>::iterator,
+    vector<ReadMap_t *>::iterator
+    > rmpip;
+
+  ranges . clear( );
+
+  //-- For each reference
+  for ( rmi  = mapping . references . begin( );
+	rmi != mapping . references . end( ); ++ rmi )
+    {
+      //-- Find the read mapping range
+      range . ref = &(rmi -> second);
+      temprm . place -> head -> ref = range . ref;
+      rmpip = equal_range (mapping . reads . begin( ), mapping . reads . end( ),
+			   &temprm, ReadReferenceCmp_t( ));
+      range . beg = rmpip . first;
+      range . end = rmpip . second;
+      ranges . push_back (range);
+    }
+
+  delete temprm . place -> head;
+  delete temprm . place;
+}
+
+
+
+
 //------------------------------------------------------------ ParseAlign ----//
 void ParseAlign (Mapping_t & mapping)
 {
@@ -1507,108 +1645,111 @@ void ParseAlign (Mapping_t & mapping)
   pair<map<string, Reference_t>::iterator, bool> insret;
   map<AMOS::ID_t,ReadMap_t *> id2read;
   map<AMOS::ID_t,ReadMap_t *>::iterator idm;
+  vector<DeltaRecord_t> records;
+  vector<DeltaRecord_t>::const_iterator reci;
 
   dr . open (OPT_AlignName);
 
   currmp = NULL;
 
-  //-- Process the delta input
-  while ( dr . readNextHeadersOnly( ) )
-    {
-      insret = mapping . references . insert
-	(map<string, Reference_t>::value_type
-	 (dr . getRecord( ) . idR, Reference_t( )));
-      refp = &((insret . first) -> second);
+  //-- Process the delta input, parsed in parallel blocks
+  while ( dr . readNextChunk (records, false) )
+    for ( reci = records . begin( ); reci != records . end( ); ++ reci )
+      {
+	insret = mapping . references . insert
+	  (map<string, Reference_t>::value_type
+	   (reci -> idR, Reference_t( )));
+	refp = &((insret . first) -> second);
 
-      //-- If a new reference ID
-      if ( insret . second )
-	{
-	  refp -> id  = &((insret . first) -> first);
-	  refp -> len = dr . getRecord( ) . lenR;
-	}
-      else
-	assert (refp -> len == (long int)dr . getRecord( ) . lenR);
+	//-- If a new reference ID
+	if ( insret . second )
+	  {
+	    refp -> id  = &((insret . first) -> first);
+	    refp -> len = reci -> lenR;
+	  }
+	else
+	  assert (refp -> len == (long int)reci -> lenR);
 
-      ss . str (dr . getRecord( ) . idQ);
-      ss >> id;
-      assert (!ss . fail( ));
-      ss . clear( );
+	ss . str (reci -> idQ);
+	ss >> id;
+	assert (!ss . fail( ));
+	ss . clear( );
 
-      //-- Find read struct
-      idm = id2read.find(id);
+	//-- Find read struct
+	idm = id2read.find(id);
 
-      //-- If a new read, create it
-      if ( idm == id2read.end() )
-	{
-	  mapping . reads . push_back (new ReadMap_t( ));
-	  currmp = mapping . reads . back( );
-	  currmp -> id = id;
-	  currmp -> len = dr . getRecord( ) . lenQ;
-	  currmp -> place = NULL;
-	  currmp -> mate . read = NULL;
-          id2read.insert(make_pair(id,currmp));
-	}
-      else
-        {
-          currmp = idm->second;
-        }
+	//-- If a new read, create it
+	if ( idm == id2read.end() )
+	  {
+	    currmp = mapping . readpool . alloc( );
+	    mapping . reads . push_back (currmp);
+	    currmp -> id = id;
+	    currmp -> len = reci -> lenQ;
+	    currmp -> place = NULL;
+	    currmp -> mate . read = NULL;
+	    id2read.insert(make_pair(id,currmp));
+	  }
+	else
+	  {
+	    currmp = idm->second;
+	  }
 
-      //-- For all the alignments in this record
-      for ( dai  = dr . getRecord( ) . aligns . begin( );
-	    dai != dr . getRecord( ) . aligns . end( ); ++ dai )
-	{
-	  currmp -> all . push_back (new ReadAlign_t ( ));
-	  currap = currmp -> all . back( );
+	//-- For all the alignments in this record
+	for ( dai  = reci -> aligns . begin( );
+	      dai != reci -> aligns . end( ); ++ dai )
+	  {
+	    currap = mapping . alignpool . alloc( );
+	    currmp -> all . push_back (currap);
 
-	  currap -> ref = refp;
-	  currap -> idy = dai -> idy;
+	    currap -> ref = refp;
+	    currap -> idy = dai -> idy;
 
-	  //-- Force ascending coordinates
-	  if ( dai -> sR < dai -> eR )
-	    {
-	      currap -> loR = dai -> sR;
-	      currap -> hiR = dai -> eR;
-	    }
-	  else
-	    {
-	      currap -> loR = dai -> eR;
-	      currap -> hiR = dai -> sR;
-	    }
+	    //-- Force ascending coordinates
+	    if ( dai -> sR < dai -> eR )
+	      {
+		currap -> loR = dai -> sR;
+		currap -> hiR = dai -> eR;
+	      }
+	    else
+	      {
+		currap -> loR = dai -> eR;
+		currap -> hiR = dai -> sR;
+	      }
 
-	  if ( (dai -> sR < dai -> eR  &&  dai -> sQ < dai -> eQ)  ||
-	       (dai -> sR > dai -> eR  &&  dai -> sQ > dai -> eQ) )
-	    {
-	      currap -> ori = FORWARD_CHAR;
-	      if ( dai -> sQ < dai -> eQ )
-		{
-		  currap -> lo = dai -> sQ;
-		  currap -> hi = dai -> eQ;
-		}
-	      else
-		{
-		  currap -> lo = dai -> eQ;
-		  currap -> hi = dai -> sQ;
-		}
-	    }
-	  else
-	    {
-	      currap -> ori = REVERSE_CHAR;
-	      if ( dai -> sQ < dai -> eQ )
-		{
-		  currap -> lo = RevComp1 (dai -> eQ, currmp -> len);
-		  currap -> hi = RevComp1 (dai -> sQ, currmp -> len);
-		}
-	      else
-		{
-		  currap -> lo = RevComp1 (dai -> sQ, currmp -> len);
-		  currap -> hi = RevComp1 (dai -> eQ, currmp -> len);
-		}
-	    }
-	}
+	    if ( (dai -> sR < dai -> eR  &&  dai -> sQ < dai -> eQ)  ||
+		 (dai -> sR > dai -> eR  &&  dai -> sQ > dai -> eQ) )
+	      {
+		currap -> ori = FORWARD_CHAR;
+		if ( dai -> sQ < dai -> eQ )
+		  {
+		    currap -> lo = dai -> sQ;
+		    currap -> hi = dai -> eQ;
+		  }
+		else
+		  {
+		    currap -> lo = dai -> eQ;
+		    currap -> hi = dai -> sQ;
+		  }
+	      }
+	    else
+	      {
+		currap -> ori = REVERSE_CHAR;
+		if ( dai -> sQ < dai -> eQ )
+		  {
+		    currap -> lo = RevComp1 (dai -> eQ, currmp -> len);
+		    currap -> hi = RevComp1 (dai -> sQ, currmp -> len);
+		  }
+		else
+		  {
+		    currap -> lo = RevComp1 (dai -> sQ, currmp -> len);
+		    currap -> hi = RevComp1 (dai -> eQ, currmp -> len);
+		  }
+	      }
+	  }
 
-      //-- Sort the alignments by lo read coordinate
-      sort (currmp -> all.begin( ), currmp -> all.end( ), ReadAlignCmp_t( ));
-    }
+	//-- Sort the alignments by lo read coordinate
+	sort (currmp -> all.begin( ), currmp -> all.end( ), ReadAlignCmp_t( ));
+      }
 
   dr . close( );
 
@@ -1849,13 +1990,13 @@ void PlaceRandom (Mapping_t & mapping)
 void PlaceUnambiguous (Mapping_t & mapping)
 {
   ReadMap_t * rmp;
-  vector<ReadMap_t *>::iterator rmpi;
+  long int i, n = mapping . reads . size( );
 
   //-- For each read in the mapping
-  for ( rmpi  = mapping . reads . begin( );
-	rmpi != mapping . reads . end( ); ++ rmpi )
+#pragma omp parallel for private(rmp) schedule(static)
+  for ( i = 0; i < n; ++ i )
     {
-      rmp = *rmpi;
+      rmp = mapping . reads[i];
 
       //-- If not placed, unambiguous, and valid, place the read
       if ( rmp -> place == NULL
@@ -1873,22 +2014,32 @@ void PlaceUnambiguous (Mapping_t & mapping)
 //------------------------------------------------------- RefineConflicts ----//
 void RefineConflicts (Mapping_t & mapping)
 {
-  ReadMap_t temprm;
-  temprm . place = new ReadAlignChain_t( );
-  temprm . place -> head = new ReadAlign_t( );
+  vector<ReadRange_t> ranges;
+  long int i, n;
+
+  PartitionReads (mapping, ranges);
+  n = ranges . size( );
+
+  //-- Conflicts only involve reads placed on their reference, so each
+  //   reference can be refined in parallel
+#pragma omp parallel for schedule(dynamic)
+  for ( i = 0; i < n; ++ i )
+    RefineReferenceConflicts (ranges[i]);
+}
 
-  long int cpos, beg, end, tot;
+
+
+
+//---------------------------------------------- RefineReferenceConflicts ----//
+void RefineReferenceConflicts (ReadRange_t & range)
+{
+  long int cpos, beg, end;
   Reference_t * rp;
   ReadAlign_t * rap;
 
   list<Conflict_t *>::iterator cpi, locpi, hicpi, bcpi, ecpi;
-  map<string, Reference_t>::iterator rmi;
-  vector<ReadMap_t *>::iterator rmpi, rmpie, ri, rj;
+  vector<ReadMap_t *>::iterator rmpi, rmpie, ri;
   set<ReadMap_t *>::iterator si;
-  pair<
-    vector<ReadMap_t *>::iterator,
-    vector<ReadMap_t *>::iterator
-    > rmpip;
 
   vector<ReadMap_t *> heap;
   vector<Conflict_t *> breaks;
@@ -1897,240 +2048,229 @@ void RefineConflicts (Mapping_t & mapping)
   set<ReadMap_t *> readsetB;
 
 
-  //-- For each reference and its conflicts
-  for ( rmi  = mapping . references . begin( );
-	rmi != mapping . references . end( ); ++ rmi )
-    {
-      rp = &(rmi -> second);
-      bcpi = rp -> conflicts . begin( );
-      ecpi = rp -> conflicts . end( );
+  rp = range . ref;
+  bcpi = rp -> conflicts . begin( );
+  ecpi = rp -> conflicts . end( );
 
-      //-- Find the read mapping range
-      temprm . place -> head -> ref = rp;
-      rmpip = equal_range (mapping . reads . begin( ), mapping . reads . end( ),
-			   &temprm, ReadReferenceCmp_t( ));
-      rmpi = rmpip . first;
-      rmpie = rmpip . second;
+  //-- The read mapping range
+  rmpi = range . beg;
+  rmpie = range . end;
 
 
-      //-- For each *BREAK*, collect nay counts
-      for ( cpi = bcpi; cpi != ecpi; ++ cpi )
-	{
-	  if ( (*cpi) -> type == Conflict_t::INDEL )
-	    continue;
+  //-- For each *BREAK*, collect nay counts
+  for ( cpi = bcpi; cpi != ecpi; ++ cpi )
+    {
+      if ( (*cpi) -> type == Conflict_t::INDEL )
+	continue;
 
-	  cpos = (*cpi) -> pos;
+      cpos = (*cpi) -> pos;
 
-	  //-- Update the heap to current conflict pos
-	  while ( !heap . empty( )  &&  heap . front( ) -> place -> end < cpos )
-	    PopHeap (heap);
+      //-- Update the heap to current conflict pos
+      while ( !heap . empty( )  &&  heap . front( ) -> place -> end < cpos )
+	PopHeap (heap);
 
-	  //-- Load up the heap with reads that overlap the conflict
-	  for ( ; rmpi != rmpie  &&  (*rmpi) -> place -> beg <= cpos; ++ rmpi )
-	    if ( (*rmpi) -> place -> end >= cpos )
-	      PushHeap (heap, *rmpi);
+      //-- Load up the heap with reads that overlap the conflict
+      for ( ; rmpi != rmpie  &&  (*rmpi) -> place -> beg <= cpos; ++ rmpi )
+	if ( (*rmpi) -> place -> end >= cpos )
+	  PushHeap (heap, *rmpi);
 
-	  //-- Collect the nay counts, i.e. reads that do not agree on break
-	  for ( ri = heap . begin( ); ri != heap . end( ); ++ ri )
-	    for ( rap = (*ri)->place->head; rap != NULL; rap = rap->from )
-	      if ( rap -> loR < cpos - FUZZY  &&  rap -> hiR > cpos + FUZZY )
-		{
-		  (*cpi) -> discount . insert (*ri);
-		  break;
-		}
+      //-- Collect the nay counts, i.e. reads that do not agree on break
+      for ( ri = heap . begin( ); ri != heap . end( ); ++ ri )
+	for ( rap = (*ri)->place->head; rap != NULL; rap = rap->from )
+	  if ( rap -> loR < cpos - FUZZY  &&  rap -> hiR > cpos + FUZZY )
+	    {
+	      (*cpi) -> discount . insert (*ri);
+	      break;
+	    }
 
-	  //-- Can't discount break if supporting it
-	  set_difference
-	    ((*cpi) -> discount . begin( ), (*cpi) -> discount . end( ),
-	     (*cpi) -> support  . begin( ), (*cpi) -> support  . end( ),
-	     insert_iterator<set<ReadMap_t *> >
-	     (readsetA, readsetA . begin( )));
-	  (*cpi) -> discount . swap (readsetA);
-	  readsetA . clear( );
-
-	  //-- Call the break SUPPORTED, UNSUPPORTED, AMBIGUOUS
-	  CallConflict (*cpi);
-
-	  //-- We don't want to accept breaks, so call them ambiguous
-	  if ( (*cpi) -> status == Conflict_t::SUPPORTED )
-	    (*cpi) -> status = Conflict_t::AMBIGUOUS;
-	}
-      heap . clear( );
+      //-- Can't discount break if supporting it
+      set_difference
+	((*cpi) -> discount . begin( ), (*cpi) -> discount . end( ),
+	 (*cpi) -> support  . begin( ), (*cpi) -> support  . end( ),
+	 insert_iterator<set<ReadMap_t *> >
+	 (readsetA, readsetA . begin( )));
+      (*cpi) -> discount . swap (readsetA);
+      readsetA . clear( );
+
+      //-- Call the break SUPPORTED, UNSUPPORTED, AMBIGUOUS
+      CallConflict (*cpi);
+
+      //-- We don't want to accept breaks, so call them ambiguous
+      if ( (*cpi) -> status == Conflict_t::SUPPORTED )
+	(*cpi) -> status = Conflict_t::AMBIGUOUS;
+    }
+  heap . clear( );
 
 
-      //-- For each *INDEL*, sum yay/nay counts from its break counts
-      for ( cpi = bcpi; cpi != ecpi; ++ cpi )
-	{
-	  if ( (*cpi)->type != Conflict_t::INDEL )
-	    continue;
+  //-- For each *INDEL*, sum yay/nay counts from its break counts
+  for ( cpi = bcpi; cpi != ecpi; ++ cpi )
+    {
+      if ( (*cpi)->type != Conflict_t::INDEL )
+	continue;
 
-	  //-- The reference breaks for the gap
-	  beg = (*cpi) -> pos;
-	  end = (*cpi) -> pos + (*cpi) -> gapR + 1;
+      //-- The reference breaks for the gap
+      beg = (*cpi) -> pos;
+      end = (*cpi) -> pos + (*cpi) -> gapR + 1;
 
-	  //-- Find conflicts corresponding to the reference HIBREAK
-	  for ( hicpi = bcpi; hicpi != ecpi; ++ hicpi )
-	    if ( hicpi != cpi  &&
-		 labs ((*hicpi)->pos - beg) <= FUZZY )
-	      {
-		breaks . push_back (*hicpi);
+      //-- Find conflicts corresponding to the reference HIBREAK
+      for ( hicpi = bcpi; hicpi != ecpi; ++ hicpi )
+	if ( hicpi != cpi  &&
+	     labs ((*hicpi)->pos - beg) <= FUZZY )
+	  {
+	    breaks . push_back (*hicpi);
 
-		if ( (*hicpi) -> type == Conflict_t::HIBREAK )
-		  {
+	    if ( (*hicpi) -> type == Conflict_t::HIBREAK )
+	      {
 
-		    //-- Add to INDEL support if hang isn't too large
-		    for ( si  = (*hicpi) -> support . begin( );
-			  si != (*hicpi) -> support . end( ); ++ si )
-		      if ( (*si) -> place -> end - beg <
-			   (*cpi) -> gapQ + OPT_MaxTrimLen )
-			(*cpi) -> support . insert (*si);
-
-		    //-- Add to hibreak discount
-		    for ( si  = (*hicpi) -> discount . begin( );
-			  si != (*hicpi) -> discount . end( ); ++ si )
-		      readsetA . insert (*si);
-		  }
+		//-- Add to INDEL support if hang isn't too large
+		for ( si  = (*hicpi) -> support . begin( );
+		      si != (*hicpi) -> support . end( ); ++ si )
+		  if ( (*si) -> place -> end - beg <
+		       (*cpi) -> gapQ + OPT_MaxTrimLen )
+		    (*cpi) -> support . insert (*si);
+
+		//-- Add to hibreak discount
+		for ( si  = (*hicpi) -> discount . begin( );
+		      si != (*hicpi) -> discount . end( ); ++ si )
+		  readsetA . insert (*si);
 	      }
+	  }
 
-	  //-- Find conflicts corresponding to the reference LOBREAK
-	  for ( locpi = bcpi; locpi != ecpi; ++ locpi )
-	    if ( locpi != cpi  &&
-		 labs ((*locpi)->pos + (*locpi)->gapR + 1 - end) <= FUZZY )
-	      {
-		breaks . push_back (*locpi);
+      //-- Find conflicts corresponding to the reference LOBREAK
+      for ( locpi = bcpi; locpi != ecpi; ++ locpi )
+	if ( locpi != cpi  &&
+	     labs ((*locpi)->pos + (*locpi)->gapR + 1 - end) <= FUZZY )
+	  {
+	    breaks . push_back (*locpi);
 
-		if ( (*locpi) -> type == Conflict_t::LOBREAK )
-		  {
-		    //-- Add to INDEL support if hang isn't too large
-		    for ( si  = (*locpi) -> support . begin( );
-			  si != (*locpi) -> support . end( ); ++ si )
-		      if ( end - (*si) -> place -> beg <
-			   (*cpi) -> gapQ + OPT_MaxTrimLen )
-			(*cpi) -> support . insert (*si);
-
-		    //-- Add to lobreak discount
-		    for ( si  = (*locpi) -> discount . begin( );
-			  si != (*locpi) -> discount . end( ); ++ si )
-		      readsetB . insert (*si);
-		  }
+	    if ( (*locpi) -> type == Conflict_t::LOBREAK )
+	      {
+		//-- Add to INDEL support if hang isn't too large
+		for ( si  = (*locpi) -> support . begin( );
+		      si != (*locpi) -> support . end( ); ++ si )
+		  if ( end - (*si) -> place -> beg <
+		       (*cpi) -> gapQ + OPT_MaxTrimLen )
+		    (*cpi) -> support . insert (*si);
+
+		//-- Add to lobreak discount
+		for ( si  = (*locpi) -> discount . begin( );
+		      si != (*locpi) -> discount . end( ); ++ si )
+		  readsetB . insert (*si);
 	      }
+	  }
 
-	  //-- One break discounted good enough for regular gap
-	  if ( (*cpi) -> gapR > 0 )
-	    set_union
-	      (readsetA . begin( ), readsetA . end( ),
-	       readsetB . begin( ), readsetB . end( ),
-	       insert_iterator<set<ReadMap_t *> >
-	       ((*cpi) -> discount, (*cpi) -> discount . begin( )));
-	  //-- Tandems with reference overlap need both breaks discounted
-	  else
-	    set_intersection
-	      (readsetA . begin( ), readsetA . end( ),
-	       readsetB . begin( ), readsetB . end( ),
-	       insert_iterator<set<ReadMap_t *> >
-	       ((*cpi) -> discount, (*cpi) -> discount . begin( )));
-	  readsetA . clear( );
-	  readsetB . clear( );
-
-	  //-- Can't support indel if discounting it
-	  set_difference
-	    ((*cpi) -> support  . begin( ), (*cpi) -> support  . end( ),
-	     (*cpi) -> discount . begin( ), (*cpi) -> discount . end( ),
-	     insert_iterator<set<ReadMap_t *> >
-	     (readsetA, readsetA . begin( )));
-	  (*cpi) -> support . swap (readsetA);
-	  readsetA . clear( );
-
-	  //-- Call the indel SUPPORTED, UNSUPPORTED, AMBIGUOUS
-	  CallConflict (*cpi);
-
-	  //-- Flag indel breaks as artifacts
-	  if ( (*cpi) -> status != Conflict_t::UNSUPPORTED )
-	    for ( bi = breaks . begin( ); bi != breaks . end( ); ++ bi )
+      //-- One break discounted good enough for regular gap
+      if ( (*cpi) -> gapR > 0 )
+	set_union
+	  (readsetA . begin( ), readsetA . end( ),
+	   readsetB . begin( ), readsetB . end( ),
+	   insert_iterator<set<ReadMap_t *> >
+	   ((*cpi) -> discount, (*cpi) -> discount . begin( )));
+      //-- Tandems with reference overlap need both breaks discounted
+      else
+	set_intersection
+	  (readsetA . begin( ), readsetA . end( ),
+	   readsetB . begin( ), readsetB . end( ),
+	   insert_iterator<set<ReadMap_t *> >
+	   ((*cpi) -> discount, (*cpi) -> discount . begin( )));
+      readsetA . clear( );
+      readsetB . clear( );
+
+      //-- Can't support indel if discounting it
+      set_difference
+	((*cpi) -> support  . begin( ), (*cpi) -> support  . end( ),
+	 (*cpi) -> discount . begin( ), (*cpi) -> discount . end( ),
+	 insert_iterator<set<ReadMap_t *> >
+	 (readsetA, readsetA . begin( )));
+      (*cpi) -> support . swap (readsetA);
+      readsetA . clear( );
+
+      //-- Call the indel SUPPORTED, UNSUPPORTED, AMBIGUOUS
+      CallConflict (*cpi);
+
+      //-- Flag indel breaks as artifacts
+      if ( (*cpi) -> status != Conflict_t::UNSUPPORTED )
+	for ( bi = breaks . begin( ); bi != breaks . end( ); ++ bi )
+	  {
+	    if ( (*bi) -> type != Conflict_t::INDEL )
+	      (*bi) -> status = Conflict_t::ARTIFACT;
+	    else if ( (*bi)  -> status != Conflict_t::UNSUPPORTED  &&
+		      (*cpi) -> status != Conflict_t::ARTIFACT )
 	      {
-		if ( (*bi) -> type != Conflict_t::INDEL )
+		long int byay = (*bi) -> support . size( );
+		long int cyay = (*cpi) -> support . size( );
+		float tyay = byay + cyay;
+		if ( tyay == 0 ) tyay = -1;
+
+		if ((float)byay / tyay * 100.0 >= OPT_Majority)
+		  (*cpi) -> status = Conflict_t::ARTIFACT;
+		else if ((float)cyay / tyay * 100.0 >= OPT_Majority)
 		  (*bi) -> status = Conflict_t::ARTIFACT;
-		else if ( (*bi)  -> status != Conflict_t::UNSUPPORTED  &&
-			  (*cpi) -> status != Conflict_t::ARTIFACT )
+		else
 		  {
-		    long int byay = (*bi) -> support . size( );
-		    long int cyay = (*cpi) -> support . size( );
-		    float tyay = byay + cyay;
-		    if ( tyay == 0 ) tyay = -1;
+		    long int bnay = (*bi) -> discount . size( );
+		    long int cnay = (*cpi) -> discount . size( );
+		    float tnay = bnay + cnay;
+		    if ( tnay == 0 ) tnay = -1;
 
-		    if ((float)byay / tyay * 100.0 >= OPT_Majority)
-		      (*cpi) -> status = Conflict_t::ARTIFACT;
-		    else if ((float)cyay / tyay * 100.0 >= OPT_Majority)
+		    if ((float)bnay / tnay * 100.0 >= OPT_Majority)
 		      (*bi) -> status = Conflict_t::ARTIFACT;
+		    else if ((float)cnay / tnay * 100.0 >= OPT_Majority)
+		      (*cpi) -> status = Conflict_t::ARTIFACT;
 		    else
 		      {
-			long int bnay = (*bi) -> discount . size( );
-			long int cnay = (*cpi) -> discount . size( );
-			float tnay = bnay + cnay;
-			if ( tnay == 0 ) tnay = -1;
-			
-			if ((float)bnay / tnay * 100.0 >= OPT_Majority)
-			  (*bi) -> status = Conflict_t::ARTIFACT;
-			else if ((float)cnay / tnay * 100.0 >= OPT_Majority)
-			  (*cpi) -> status = Conflict_t::ARTIFACT;
-			else
-			  {
-			    (*bi)  -> status = Conflict_t::AMBIGUOUS;
-			    (*cpi) -> status = Conflict_t::AMBIGUOUS;
-			  }
+			(*bi)  -> status = Conflict_t::AMBIGUOUS;
+			(*cpi) -> status = Conflict_t::AMBIGUOUS;
 		      }
 		  }
 	      }
-
-	  breaks . clear( );
-	}
-
-
-      //-- INCLUDE/EXCLUDE reads based on consistency
-      for ( cpi = bcpi; cpi != ecpi; ++ cpi )
-	if ( (*cpi) -> status == Conflict_t::ARTIFACT )
-	  {
-	    //-- Exclude supporting reads (will be revived later if good)
-	    for ( si  = (*cpi) -> support . begin( );
-		  si != (*cpi) -> support . end( ); ++ si )
-	      (*si) -> exclude = true;
-	  }	  
-
-      for ( cpi = bcpi; cpi != ecpi; ++ cpi )
-	if ( (*cpi) -> status == Conflict_t::SUPPORTED )
-	  {
-	    //-- Include supporting reads (revives supporting artifacts)
-	    for ( si  = (*cpi) -> discount . begin( );
-		  si != (*cpi) -> discount . end( ); ++ si )
-	      (*si) -> exclude = true;
-	    //-- Exclude discounting reads
-	    for ( si  = (*cpi) -> support . begin( );
-		  si != (*cpi) -> support . end( ); ++ si )
-	      (*si) -> exclude = false;
 	  }
 
-      for ( cpi = bcpi; cpi != ecpi; ++ cpi )
-	if ( (*cpi) -> status == Conflict_t::UNSUPPORTED )
-	  {
-	    //-- Exclude supporting reads
-	    for ( si  = (*cpi) -> support . begin( );
-		  si != (*cpi) -> support . end( ); ++ si )
-	      (*si) -> exclude = true;
-	  }
-	else if ( (*cpi) -> status == Conflict_t::AMBIGUOUS )
-	  {
-	    //-- Exclude everything ambiguous
-	    for ( si  = (*cpi) -> discount . begin( );
-		  si != (*cpi) -> discount . end( ); ++ si )
-	      (*si) -> exclude = true;
-	    for ( si  = (*cpi) -> support . begin( );
-		  si != (*cpi) -> support . end( ); ++ si )
-	      (*si) -> exclude = true;
-	  }
+      breaks . clear( );
     }
 
-  delete temprm . place -> head;
-  delete temprm . place;
+
+  //-- INCLUDE/EXCLUDE reads based on consistency
+  for ( cpi = bcpi; cpi != ecpi; ++ cpi )
+    if ( (*cpi) -> status == Conflict_t::ARTIFACT )
+      {
+	//-- Exclude supporting reads (will be revived later if good)
+	for ( si  = (*cpi) -> support . begin( );
+	      si != (*cpi) -> support . end( ); ++ si )
+	  (*si) -> exclude = true;
+      }       
+
+  for ( cpi = bcpi; cpi != ecpi; ++ cpi )
+    if ( (*cpi) -> status == Conflict_t::SUPPORTED )
+      {
+	//-- Include supporting reads (revives supporting artifacts)
+	for ( si  = (*cpi) -> discount . begin( );
+	      si != (*cpi) -> discount . end( ); ++ si )
+	  (*si) -> exclude = true;
+	//-- Exclude discounting reads
+	for ( si  = (*cpi) -> support . begin( );
+	      si != (*cpi) -> support . end( ); ++ si )
+	  (*si) -> exclude = false;
+      }
+
+  for ( cpi = bcpi; cpi != ecpi; ++ cpi )
+    if ( (*cpi) -> status == Conflict_t::UNSUPPORTED )
+      {
+	//-- Exclude supporting reads
+	for ( si  = (*cpi) -> support . begin( );
+	      si != (*cpi) -> support . end( ); ++ si )
+	  (*si) -> exclude = true;
+      }
+    else if ( (*cpi) -> status == Conflict_t::AMBIGUOUS )
+      {
+	//-- Exclude everything ambiguous
+	for ( si  = (*cpi) -> discount . begin( );
+	      si != (*cpi) -> discount . end( ); ++ si )
+	  (*si) -> exclude = true;
+	for ( si  = (*cpi) -> support . begin( );
+	      si != (*cpi) -> support . end( ); ++ si )
+	  (*si) -> exclude = true;
+      }
 }
 
 
@@ -2350,7 +2490,8 @@ void PrintHelp (const char * s)
     << "information to place repetitive sequences, or random placement\n"
     << "to simulate even coverage. If an AMOS bank is provided by the -b\n"
     << "option, mate-pair info will be retrieved from and final layouts\n"
-    << "will be written to the bank.\n"
+    << "will be written to the bank. Alignment chaining, conflict detection\n"
+    << "and assembly run in parallel, set OMP_NUM_THREADS to limit threads.\n"
     << endl;
 
   return;
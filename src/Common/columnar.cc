@@ -0,0 +1,766 @@
+//  File:  columnar.cc
+//
+//  Routines to write tables of bank data as Apache Arrow IPC files.
+//  The file metadata are FlatBuffers following the Arrow  Schema.fbs ,
+//  Message.fbs  and  File.fbs  definitions, built by hand here so no
+//  Arrow or FlatBuffers library is needed.
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include  "columnar.hh"
+#include  <cstring>
+#include  <cerrno>
+
+using namespace std;
+using namespace AMOS;
+
+
+static const char  ARROW_MAGIC [8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+
+//  Arrow metadata constants
+static const int  METADATA_V5 = 4;
+static const int  HEADER_DICTIONARY_BATCH = 2;
+static const int  HEADER_RECORD_BATCH = 3;
+static const int  TYPE_INT = 2;
+static const int  TYPE_FLOATING_POINT = 3;
+static const int  TYPE_UTF8 = 5;
+static const int  PRECISION_DOUBLE = 2;
+
+
+
+static void  Append_LE
+    (string & s, uint64_t v, int size)
+
+//  Append the low  size  bytes of  v  to  s , least significant first.
+
+  {
+   for  (int i = 0;  i < size;  i ++)
+     s += char ((v >> (8 * i)) & 0xff);
+  }
+
+
+
+static bool  Big_Endian
+    (void)
+
+//  Return  true  if this machine stores numbers most significant byte
+//  first.  Column data are written as they are in memory, and the
+//  schema says which order that is.
+
+  {
+   uint16_t  x = 1;
+
+   return  * ((const char *) & x) == 0;
+  }
+
+
+
+class  Flat_Builder_t
+  {
+   //  Builds a FlatBuffers buffer front to back.  Every table, vector and
+   //  string is put after whatever refers to it, so offsets, which must
+   //  point forward, are patched in once their target is put.
+
+  public:
+
+   string  buf;
+
+   Flat_Builder_t  ()
+     : buf (4, '\0')
+     {}
+
+   void  Align  (size_t a)
+     {
+      while  (buf . size () % a != 0)
+        buf += '\0';
+     }
+   void  Put  (uint64_t v, int size)
+     { Append_LE (buf, v, size); }
+   void  Set  (size_t at, uint64_t v, int size)
+     {
+      for  (int i = 0;  i < size;  i ++)
+        buf [at + i] = char ((v >> (8 * i)) & 0xff);
+     }
+   void  Patch  (size_t at, size_t target)
+     { Set (at, target - at, 4); }
+   void  Finish  (size_t root)
+     { Patch (0, root); }
+
+   size_t  String  (const string & s)
+     {
+      Align (4);
+      size_t  p = buf . size ();
+      Put (s . size (), 4);
+      buf += s;
+      buf += '\0';
+      return  p;
+     }
+
+   size_t  Offsets  (int n)
+     {
+      //  A vector of  n  offsets, the  i th to patch at  p + 4 + 4 * i
+
+      Align (4);
+      size_t  p = buf . size ();
+      Put (n, 4);
+      buf . append (4 * n, '\0');
+      return  p;
+     }
+
+   size_t  Structs  (const string & bytes, int n)
+     {
+      //  A vector of  n  structs of 8 byte alignment
+
+      while  ((buf . size () + 4) % 8 != 0)
+        buf += '\0';
+      size_t  p = buf . size ();
+      Put (n, 4);
+      buf += bytes;
+      return  p;
+     }
+  };
+
+
+
+class  Flat_Table_t
+  {
+   //  The fields of a table about to be put, each a scalar of  size
+   //  bytes or, for  size  0, an offset to patch once its target is put.
+
+  public:
+
+   vector <int>  ids, sizes;
+   vector <int64_t>  values;
+
+   void  Scalar  (int id, int size, int64_t v)
+     {
+      ids . push_back (id);
+      sizes . push_back (size);
+      values . push_back (v);
+     }
+   void  Offset  (int id)
+     { Scalar (id, 0, 0); }
+
+   size_t  End  (Flat_Builder_t & b, vector <size_t> & slots);
+  };
+
+
+
+size_t  Flat_Table_t::End
+    (Flat_Builder_t & b, vector <size_t> & slots)
+
+//  Put the vtable and then the table in  b  and return where the table
+//  is.  Set  slots [id]  to where the offset field  id  is to be patched.
+
+  {
+   static const int  ORDER [4] = {8, 4, 2, 1};
+   int  nslots = 0;
+
+   for  (size_t i = 0;  i < ids . size ();  i ++)
+     nslots = max (nslots, ids [i] + 1);
+
+   b . Align (2);
+   size_t  vtable = b . buf . size ();
+   b . Put (4 + 2 * nslots, 2);
+   b . Put (0, 2);
+   for  (int i = 0;  i < nslots;  i ++)
+     b . Put (0, 2);
+
+   //  Largest fields first keeps them aligned with little padding
+   b . Align (8);
+   size_t  table = b . buf . size ();
+   b . Put (table - vtable, 4);
+   size_t  cur = 4;
+
+   slots . assign (nslots, 0);
+   for  (int k = 0;  k < 4;  k ++)
+     for  (size_t i = 0;  i < ids . size ();  i ++)
+       {
+        int  width = (sizes [i] == 0 ? 4 : sizes [i]);
+        if  (width != ORDER [k])
+            continue;
+
+        while  (cur % width != 0)
+          {
+           b . buf += '\0';
+           cur ++;
+          }
+        b . Set (vtable + 4 + 2 * ids [i], cur, 2);
+        if  (sizes [i] == 0)
+            slots [ids [i]] = table + cur;
+        b . Put (values [i], width);
+        cur += width;
+       }
+   b . Set (vtable + 2, cur, 2);
+
+   return  table;
+  }
+
+
+
+static size_t  Put_Int_Type
+    (Flat_Builder_t & b, int bit_width, bool is_signed)
+  {
+   Flat_Table_t  t;
+   vector <size_t>  slots;
+
+   t . Scalar (0, 4, bit_width);
+   t . Scalar (1, 1, is_signed);
+   return  t . End (b, slots);
+  }
+
+
+
+static size_t  Put_Schema
+    (Flat_Builder_t & b, const vector <Column_Field_t> & fields)
+
+//  Put an Arrow  Schema  table for  fields  in  b  and return where it
+//  is.  The field of a  COLUMN_DICTIONARY  column has the string type of
+//  its values and dictionary id its position in  fields .
+
+  {
+   Flat_Table_t  schema;
+   vector <size_t>  slots;
+   int  n = fields . size ();
+
+   schema . Scalar (0, 2, Big_Endian () ? 1 : 0);
+   schema . Offset (1);
+   size_t  table = schema . End (b, slots);
+
+   size_t  vec = b . Offsets (n);
+   b . Patch (slots [1], vec);
+
+   for  (int i = 0;  i < n;  i ++)
+     {
+      Column_Type  type = fields [i] . type;
+      bool  is_dict = (type == COLUMN_DICTIONARY);
+      Flat_Table_t  field;
+      vector <size_t>  fs;
+      int  type_type;
+
+      if  (type == COLUMN_DOUBLE)
+          type_type = TYPE_FLOATING_POINT;
+      else if  (type == COLUMN_STRING || is_dict)
+          type_type = TYPE_UTF8;
+      else
+          type_type = TYPE_INT;
+
+      field . Offset (0);
+      field . Scalar (1, 1, 0);
+      field . Scalar (2, 1, type_type);
+      field . Offset (3);
+      if  (is_dict)
+          field . Offset (4);
+      field . Offset (5);
+      size_t  ft = field . End (b, fs);
+      b . Patch (vec + 4 + 4 * i, ft);
+
+      b . Patch (fs [0], b . String (fields [i] . name));
+
+      Flat_Table_t  t;
+      vector <size_t>  ts;
+      switch  (type)
+        {
+         case  COLUMN_INT32 :
+           b . Patch (fs [3], Put_Int_Type (b, 32, true));
+           break;
+         case  COLUMN_UINT32 :
+           b . Patch (fs [3], Put_Int_Type (b, 32, false));
+           break;
+         case  COLUMN_INT64 :
+           b . Patch (fs [3], Put_Int_Type (b, 64, true));
+           break;
+         case  COLUMN_DOUBLE :
+           t . Scalar (0, 2, PRECISION_DOUBLE);
+           b . Patch (fs [3], t . End (b, ts));
+           break;
+         default :
+           b . Patch (fs [3], t . End (b, ts));
+        }
+
+      if  (is_dict)
+          {
+           Flat_Table_t  dict;
+           vector <size_t>  ds;
+
+           dict . Scalar (0, 8, i);
+           dict . Offset (1);
+           dict . Scalar (2, 1, 0);
+           b . Patch (fs [4], dict . End (b, ds));
+           b . Patch (ds [1], Put_Int_Type (b, 32, true));
+          }
+
+      b . Patch (fs [5], b . Offsets (0));
+     }
+
+   return  table;
+  }
+
+
+
+static size_t  Put_Record_Batch
+    (Flat_Builder_t & b, int64_t length, const vector <int64_t> & nodes,
+     const vector <pair <int64_t, int64_t> > & buffers)
+
+//  Put an Arrow  RecordBatch  table in  b  and return where it is.
+//  nodes  has the length of each column, none of which have nulls, and
+//  buffers  the offset and length of each buffer in the message body.
+
+  {
+   Flat_Table_t  batch;
+   vector <size_t>  slots;
+   string  bytes;
+
+   batch . Scalar (0, 8, length);
+   batch . Offset (1);
+   batch . Offset (2);
+   size_t  table = batch . End (b, slots);
+
+   for  (size_t i = 0;  i < nodes . size ();  i ++)
+     {
+      Append_LE (bytes, nodes [i], 8);
+      Append_LE (bytes, 0, 8);
+     }
+   b . Patch (slots [1], b . Structs (bytes, nodes . size ()));
+
+   bytes . clear ();
+   for  (size_t i = 0;  i < buffers . size ();  i ++)
+     {
+      Append_LE (bytes, buffers [i] . first, 8);
+      Append_LE (bytes, buffers [i] . second, 8);
+     }
+   b . Patch (slots [2], b . Structs (bytes, buffers . size ()));
+
+   return  table;
+  }
+
+
+
+static string  Block_Bytes
+    (const vector <Arrow_Block_t> & blocks)
+
+//  Return  blocks  as a vector of the  File.fbs  struct  Block .
+
+  {
+   string  bytes;
+
+   for  (size_t i = 0;  i < blocks . size ();  i ++)
+     {
+      Append_LE (bytes, blocks [i] . offset, 8);
+      Append_LE (bytes, blocks [i] . meta_length, 4);
+      Append_LE (bytes, 0, 4);
+      Append_LE (bytes, blocks [i] . body_length, 8);
+     }
+
+   return  bytes;
+  }
+
+
+
+void  Column_t::clear
+    (void)
+
+//  Remove all values, keeping the type.
+
+  {
+   data . clear ();
+   offsets . assign (1, 0);
+   chars . clear ();
+  }
+
+
+
+int  Column_t::size
+    (void) const
+
+//  Return the number of values in this column.
+
+  {
+   switch  (type)
+     {
+      case  COLUMN_INT32 :
+      case  COLUMN_UINT32 :
+        return  data . size () / 4;
+      case  COLUMN_INT64 :
+      case  COLUMN_DOUBLE :
+        return  data . size () / 8;
+      default :
+        return  offsets . size () - 1;
+     }
+  }
+
+
+
+void  Arrow_Dictionary_t::Grow
+    (void)
+
+//  Double the hash table and rehash the values into it.
+
+  {
+   vector <int32_t>  old;
+
+   old . swap (slots);
+   slots . assign (old . size () * 2, -1);
+   size_t  mask = slots . size () - 1;
+
+   for  (size_t i = 0;  i < old . size ();  i ++)
+     if  (old [i] >= 0)
+         {
+          int32_t  v = old [i];
+          uint32_t  h = 2166136261u;
+          for  (int32_t k = offsets [v];  k < offsets [v + 1];  k ++)
+            h = (h ^ (unsigned char) chars [k]) * 16777619u;
+          size_t  j = h & mask;
+          while  (slots [j] >= 0)
+            j = (j + 1) & mask;
+          slots [j] = v;
+         }
+  }
+
+
+
+int32_t  Arrow_Dictionary_t::lookup
+    (const char * s, size_t len)
+
+//  Return the index of the  len  characters at  s  in this dictionary,
+//  adding them if they are new.
+
+  {
+   uint32_t  h = 2166136261u;
+   for  (size_t k = 0;  k < len;  k ++)
+     h = (h ^ (unsigned char) s [k]) * 16777619u;
+
+   size_t  mask = slots . size () - 1;
+   size_t  j = h & mask;
+   while  (slots [j] >= 0)
+     {
+      int32_t  v = slots [j];
+      if  ((size_t) (offsets [v + 1] - offsets [v]) == len
+             && memcmp (chars . data () + offsets [v], s, len) == 0)
+          return  v;
+      j = (j + 1) & mask;
+     }
+
+   if  (chars . size () + len > 0x7fffffff)
+       AMOS_THROW_ARGUMENT ("Arrow dictionary holds more than 2 GB of strings");
+
+   chars . append (s, len);
+   offsets . push_back (chars . size ());
+   slots [j] = count;
+
+   if  (++ count * 2 > (int64_t) slots . size ())
+       Grow ();
+
+   return  count - 1;
+  }
+
+
+
+Arrow_Writer_t::~ Arrow_Writer_t
+    ()
+  {
+   try
+     {
+      close ();
+     }
+   catch  (const Exception_t & e)
+     {
+     }
+   for  (size_t i = 0;  i < dictionaries . size ();  i ++)
+     delete dictionaries [i];
+  }
+
+
+
+void  Arrow_Writer_t::Write
+    (const void * p, size_t len)
+
+//  Write  len  bytes at  p  to the file.
+
+  {
+   if  (len > 0 && fwrite (p, 1, len, fp) != len)
+       AMOS_THROW_IO ("Could not write " + path + ", " + strerror (errno));
+   pos += len;
+  }
+
+
+
+void  Arrow_Writer_t::Write_Message
+    (const string & meta, int64_t body_length, Arrow_Block_t & block)
+
+//  Write the flatbuffer  meta  as an encapsulated message, padded to 8
+//  bytes, and set  block  to where it is.  The body of  body_length
+//  bytes must be written next.
+
+  {
+   static const char  ZEROS [8] = {0};
+   string  prefix;
+   size_t  pad = (8 - meta . size () % 8) % 8;
+
+   Append_LE (prefix, 0xffffffff, 4);
+   Append_LE (prefix, meta . size () + pad, 4);
+
+   block . offset = pos;
+   block . meta_length = prefix . size () + meta . size () + pad;
+   block . body_length = body_length;
+
+   Write (prefix . data (), prefix . size ());
+   Write (meta . data (), meta . size ());
+   Write (ZEROS, pad);
+  }
+
+
+
+void  Arrow_Writer_t::Write_Batch
+    (int header_type, int64_t id, int64_t length,
+     const vector <int64_t> & nodes,
+     const vector <pair <const char *, int64_t> > & buffers,
+     Arrow_Block_t & block)
+
+//  Write a record batch, or for  HEADER_DICTIONARY_BATCH  the dictionary
+//  id , of  length  rows.  Each column has a node of its length and its
+//  buffers in  buffers , which are laid out 8 byte aligned in the body.
+
+  {
+   static const char  ZEROS [8] = {0};
+   vector <pair <int64_t, int64_t> >  layout;
+   int64_t  body = 0;
+
+   for  (size_t i = 0;  i < buffers . size ();  i ++)
+     {
+      layout . push_back (make_pair (body, buffers [i] . second));
+      body += (buffers [i] . second + 7) / 8 * 8;
+     }
+
+   Flat_Builder_t  b;
+   Flat_Table_t  message;
+   vector <size_t>  slots;
+
+   message . Scalar (0, 2, METADATA_V5);
+   message . Scalar (1, 1, header_type);
+   message . Offset (2);
+   message . Scalar (3, 8, body);
+   b . Finish (message . End (b, slots));
+
+   if  (header_type == HEADER_DICTIONARY_BATCH)
+       {
+        Flat_Table_t  dict;
+        vector <size_t>  ds;
+
+        dict . Scalar (0, 8, id);
+        dict . Offset (1);
+        b . Patch (slots [2], dict . End (b, ds));
+        b . Patch (ds [1], Put_Record_Batch (b, length, nodes, layout));
+       }
+   else
+       b . Patch (slots [2], Put_Record_Batch (b, length, nodes, layout));
+
+   Write_Message (b . buf, body, block);
+   for  (size_t i = 0;  i < buffers . size ();  i ++)
+     {
+      Write (buffers [i] . first, buffers [i] . second);
+      Write (ZEROS, (8 - buffers [i] . second % 8) % 8);
+     }
+  }
+
+
+
+void  Arrow_Writer_t::open
+    (const string & p, const vector <Column_Field_t> & f)
+
+//  Create the Arrow file  p  for a table of the columns  f , and write
+//  its schema.
+
+  {
+   close ();
+
+   path = p;
+   fields = f;
+   pos = 0;
+   rows = 0;
+   for  (size_t i = 0;  i < dictionaries . size ();  i ++)
+     delete dictionaries [i];
+   dictionaries . assign (fields . size (), (Arrow_Dictionary_t *) NULL);
+   for  (size_t i = 0;  i < fields . size ();  i ++)
+     if  (fields [i] . type == COLUMN_DICTIONARY)
+         dictionaries [i] = new Arrow_Dictionary_t;
+   dictionary_blocks . clear ();
+   record_blocks . clear ();
+
+   fp = fopen (path . c_str (), "wb");
+   if  (fp == NULL)
+       AMOS_THROW_IO ("Could not open " + path + ", " + strerror (errno));
+
+   Write (ARROW_MAGIC, sizeof (ARROW_MAGIC));
+
+   Flat_Builder_t  b;
+   Flat_Table_t  message;
+   vector <size_t>  slots;
+   Arrow_Block_t  block;
+
+   message . Scalar (0, 2, METADATA_V5);
+   message . Scalar (1, 1, 1);
+   message . Offset (2);
+   message . Scalar (3, 8, 0);
+   b . Finish (message . End (b, slots));
+   b . Patch (slots [2], Put_Schema (b, fields));
+
+   Write_Message (b . buf, 0, block);
+  }
+
+
+
+void  Arrow_Writer_t::init
+    (Column_Batch_t & batch) const
+
+//  Give  batch  an empty column of the right type for each field.
+
+  {
+   batch . columns . resize (fields . size ());
+   for  (size_t i = 0;  i < fields . size ();  i ++)
+     {
+      batch [i] . type = fields [i] . type;
+      batch [i] . clear ();
+     }
+  }
+
+
+
+void  Arrow_Writer_t::write
+    (Column_Batch_t & batch)
+
+//  Write the rows of  batch  as the next record batch, adding the values
+//  of its dictionary columns to the dictionaries.  Write nothing if
+//  batch  is empty.
+
+  {
+   int  n = batch . size ();
+   vector <int64_t>  nodes;
+   vector <pair <const char *, int64_t> >  buffers;
+   vector <vector <int32_t> >  indices (fields . size ());
+   Arrow_Block_t  block;
+
+   if  (fp == NULL)
+       AMOS_THROW_IO ("Cannot write, Arrow file not open");
+   if  (batch . columns . size () != fields . size ())
+       AMOS_THROW_ARGUMENT ("Cannot write, batch does not match the schema");
+   if  (n == 0)
+       return;
+
+   for  (size_t i = 0;  i < fields . size ();  i ++)
+     {
+      Column_t  & col = batch [i];
+
+      if  (col . size () != n)
+          AMOS_THROW_ARGUMENT ("Cannot write, columns of different lengths");
+
+      nodes . push_back (n);
+      buffers . push_back (make_pair ((const char *) NULL, (int64_t) 0));
+
+      switch  (fields [i] . type)
+        {
+         case  COLUMN_STRING :
+           buffers . push_back (make_pair ((const char *) & col . offsets [0],
+                                           (int64_t) 4 * (n + 1)));
+           buffers . push_back (make_pair (col . chars . data (),
+                                           (int64_t) col . chars . size ()));
+           break;
+
+         case  COLUMN_DICTIONARY :
+           indices [i] . resize (n);
+           for  (int j = 0;  j < n;  j ++)
+             indices [i] [j] = dictionaries [i] -> lookup
+                 (col . chars . data () + col . offsets [j],
+                  col . offsets [j + 1] - col . offsets [j]);
+           buffers . push_back (make_pair ((const char *) & indices [i] [0],
+                                           (int64_t) 4 * n));
+           break;
+
+         default :
+           buffers . push_back (make_pair (col . data . data (),
+                                           (int64_t) col . data . size ()));
+        }
+     }
+
+   Write_Batch (HEADER_RECORD_BATCH, 0, n, nodes, buffers, block);
+   record_blocks . push_back (block);
+   rows += n;
+  }
+
+
+
+void  Arrow_Writer_t::close
+    (void)
+
+//  Write the dictionaries and the footer and close the file.  Does
+//  nothing if it is not open.
+
+  {
+   if  (fp == NULL)
+       return;
+
+   try
+     {
+      for  (size_t i = 0;  i < fields . size ();  i ++)
+        {
+         Arrow_Dictionary_t  * dict = dictionaries [i];
+         vector <int64_t>  nodes (1, dict == NULL ? 0 : dict -> size ());
+         vector <pair <const char *, int64_t> >  buffers;
+         Arrow_Block_t  block;
+
+         if  (dict == NULL)
+             continue;
+
+         buffers . push_back (make_pair ((const char *) NULL, (int64_t) 0));
+         buffers . push_back (make_pair ((const char *) & dict -> offsets [0],
+                                         (int64_t) 4 * (dict -> size () + 1)));
+         buffers . push_back (make_pair (dict -> chars . data (),
+                                         (int64_t) dict -> chars . size ()));
+         Write_Batch (HEADER_DICTIONARY_BATCH, i, dict -> size (), nodes,
+                      buffers, block);
+         dictionary_blocks . push_back (block);
+        }
+
+      //  End of stream marker, then the footer
+      string  tail;
+      Append_LE (tail, 0xffffffff, 4);
+      Append_LE (tail, 0, 4);
+      Write (tail . data (), tail . size ());
+
+      Flat_Builder_t  b;
+      Flat_Table_t  footer;
+      vector <size_t>  slots;
+
+      footer . Scalar (0, 2, METADATA_V5);
+      footer . Offset (1);
+      footer . Offset (2);
+      footer . Offset (3);
+      b . Finish (footer . End (b, slots));
+      b . Patch (slots [1], Put_Schema (b, fields));
+      b . Patch (slots [2], b . Structs (Block_Bytes (dictionary_blocks),
+                                         dictionary_blocks . size ()));
+      b . Patch (slots [3], b . Structs (Block_Bytes (record_blocks),
+                                         record_blocks . size ()));
+
+      tail . clear ();
+      Append_LE (tail, b . buf . size (), 4);
+      tail . append (ARROW_MAGIC, 6);
+      Write (b . buf . data (), b . buf . size ());
+      Write (tail . data (), tail . size ());
+     }
+   catch  (const Exception_t & e)
+     {
+      fclose (fp);
+      fp = NULL;
+      throw;
+     }
+
+   if  (fclose (fp) != 0)
+       {
+        fp = NULL;
+        AMOS_THROW_IO ("Could not write " + path + ", " + strerror (errno));
+       }
+   fp = NULL;
+  }
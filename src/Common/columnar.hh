@@ -0,0 +1,198 @@
+//  File:  columnar.hh
+//
+//  Routines to write tables of bank data as Apache Arrow IPC files,
+//  the columnar binary format read directly by pyarrow, R arrow,
+//  DuckDB, Polars and Spark.  Rows are added to a  Column_Batch_t ,
+//  each thread filling its own, and  Arrow_Writer_t  writes the
+//  batches in order as record batches, dictionary encoding the string
+//  columns that repeat, such as EIDs and type codes.
+
+
+#ifndef  __COLUMNAR_HH
+#define  __COLUMNAR_HH
+
+
+#include  "exceptions_AMOS.hh"
+#include  "inttypes_AMOS.hh"
+#include  <string>
+#include  <vector>
+#include  <cstdio>
+
+
+enum  Column_Type {COLUMN_INT32, COLUMN_UINT32, COLUMN_INT64, COLUMN_DOUBLE,
+                   COLUMN_STRING, COLUMN_DICTIONARY};
+  // COLUMN_DICTIONARY  is a string column stored as indices into one
+  // dictionary of its distinct values for the whole file
+
+const int  DEFAULT_COLUMNAR_BATCH = 16384;
+  // Objects read from a bank per record batch
+
+
+
+struct  Column_Field_t
+  {
+   std::string  name;
+   Column_Type  type;
+
+   Column_Field_t  (const std::string & n, Column_Type t)
+     : name (n), type (t)
+     {}
+  };
+
+
+
+class  Column_t
+  {
+   //  The values of one column of a batch.  Numbers are kept as their
+   //  bytes in  data ; strings as  chars  with the end of each value in
+   //  offsets .
+
+  public:
+
+   Column_Type  type;
+   std::string  data;
+   std::vector <int32_t>  offsets;
+   std::string  chars;
+
+   Column_t  ()
+     : type (COLUMN_INT32), offsets (1, 0)
+     {}
+
+   void  add_int32  (int32_t v)
+     { data . append ((const char *) & v, sizeof (v)); }
+   void  add_uint32  (uint32_t v)
+     { data . append ((const char *) & v, sizeof (v)); }
+   void  add_int64  (int64_t v)
+     { data . append ((const char *) & v, sizeof (v)); }
+   void  add_double  (double v)
+     { data . append ((const char *) & v, sizeof (v)); }
+   void  add_string  (const std::string & s)
+     {
+      chars += s;
+      offsets . push_back (chars . size ());
+     }
+
+   void  clear  ();
+   int  size  () const;
+  };
+
+
+
+class  Column_Batch_t
+  {
+   //  A batch of rows, one  Column_t  per field of the table.
+
+  public:
+
+   std::vector <Column_t>  columns;
+
+   Column_t &  operator []  (int i)
+     { return  columns [i]; }
+
+   void  clear  ()
+     {
+      for  (size_t i = 0;  i < columns . size ();  i ++)
+        columns [i] . clear ();
+     }
+   int  size  () const
+     { return  columns . empty () ? 0 : columns [0] . size (); }
+  };
+
+
+
+class  Arrow_Dictionary_t
+  {
+   //  The distinct values of a  COLUMN_DICTIONARY  column, in the order
+   //  they were first seen, with an open addressing hash of them.
+
+  private:
+
+   std::vector <int32_t>  slots;
+   int32_t  count;
+
+   void  Grow  ();
+
+  public:
+
+   std::vector <int32_t>  offsets;
+   std::string  chars;
+
+   Arrow_Dictionary_t  ()
+     : slots (1024, -1), count (0), offsets (1, 0)
+     {}
+
+   int32_t  lookup
+       (const char * s, size_t len);
+   int32_t  size  () const
+     { return  count; }
+  };
+
+
+
+struct  Arrow_Block_t
+  {
+   //  Where an encapsulated message is in the file, as listed in the
+   //  footer.
+
+   int64_t  offset;
+   int32_t  meta_length;
+   int64_t  body_length;
+  };
+
+
+
+class  Arrow_Writer_t
+  {
+   //  Writes one table to an Arrow IPC file:  the schema, a record batch
+   //  for each call of  write , then the dictionaries and the footer.
+   //  Readers find the dictionaries through the footer, so they can be
+   //  completed while the batches stream out.  Only one thread may call
+   //  write  at a time.
+
+  private:
+
+   FILE  * fp;
+   std::string  path;
+   int64_t  pos;
+   std::vector <Column_Field_t>  fields;
+   std::vector <Arrow_Dictionary_t *>  dictionaries;
+   std::vector <Arrow_Block_t>  dictionary_blocks, record_blocks;
+   int64_t  rows;
+
+   Arrow_Writer_t (const Arrow_Writer_t &);
+   Arrow_Writer_t & operator = (const Arrow_Writer_t &);
+
+   void  Write
+       (const void * p, size_t len);
+   void  Write_Message
+       (const std::string & meta, int64_t body_length, Arrow_Block_t & block);
+   void  Write_Batch
+       (int header_type, int64_t id, int64_t length,
+        const std::vector <int64_t> & nodes,
+        const std::vector <std::pair <const char *, int64_t> > & buffers,
+        Arrow_Block_t & block);
+
+  public:
+
+   Arrow_Writer_t  ()
+     : fp (NULL), pos (0), rows (0)
+     {}
+   ~ Arrow_Writer_t  ();
+
+   void  open
+       (const std::string & path, const std::vector <Column_Field_t> & fields);
+   void  init
+       (Column_Batch_t & batch) const;
+   void  write
+       (Column_Batch_t & batch);
+   void  close
+       (void);
+
+   bool  isOpen  () const
+     { return fp != NULL; }
+   int64_t  getRows  () const
+     { return rows; }
+  };
+
+
+#endif // #ifndef __COLUMNAR_HH
@@ -12,6 +12,9 @@
 #include "fasta.hh"
 #include "delcher.hh"
 #include <cmath>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
 #include <sstream>
 #include <algorithm>
 using namespace std;
@@ -35,6 +38,24 @@ struct LIS_t
 };
 
 
+struct LISJob_t
+//!< The LIS state for a single node or edge, kept so the dynamic step can be
+//!< run in parallel and the random pick of the best chain serially
+{
+  DeltaNode_t * node;                  //!< node being chained, RLIS/QLIS
+  DeltaEdge_t * edge;                  //!< edge being chained, GLIS
+  vector<DeltaEdgelet_t *> edgelets;   //!< the good edgelets, sorted
+  vector<LIS_t> lis;                   //!< the dynamic programming table
+  vector<long int> allbest;            //!< equivalent best chain ends
+
+  LISJob_t ( )
+  {
+    node = NULL;
+    edge = NULL;
+  }
+};
+
+
 struct EdgeletQCmp_t
 //!< Compares query lo coord
 {
@@ -311,11 +332,169 @@ bool DeltaReader_t::readNextRecord (const bool read_deltas)
 }
 
 
+//----------------------------------------------------- parseRecord ------------
+bool DeltaReader_t::parseRecord
+     (const char * p, const char * end,
+      DeltaRecord_t & rec, const bool read_deltas) const
+{
+  const char * q;
+  char * e;
+  long int delta;
+  float total;
+
+  rec.clear ( );
+
+  //-- Read the record header
+  if ( p >= end  ||  *p != '>' )
+    return false;
+  ++ p;
+  while ( p < end  &&  isspace (*p) ) ++ p;
+  for ( q = p; q < end  &&  ! isspace (*q); ++ q );
+  rec.idR.assign (p, q - p);
+  for ( p = q; p < end  &&  isspace (*p); ++ p );
+  for ( q = p; q < end  &&  ! isspace (*q); ++ q );
+  rec.idQ.assign (p, q - p);
+  rec.lenR = strtoul (q, &e, 10); p = e;
+  rec.lenQ = strtoul (p, &e, 10);
+  if ( e == p  ||  e > end  ||  rec.lenR <= 0  ||  rec.lenQ <= 0 )
+    return false;
+
+  //-- Flush the remaining whitespace
+  for ( p = e; p < end  &&  *p != '\n'; ++ p );
+
+  //-- For each alignment...
+  DeltaAlignment_t align;
+  while ( true )
+    {
+      while ( p < end  &&  isspace (*p) ) ++ p;
+      if ( p >= end )
+        break;
+
+      //-- Read the alignment header
+      align.clear ( );
+      align.sR = strtoul (p, &e, 10); p = e;
+      align.eR = strtoul (p, &e, 10); p = e;
+      align.sQ = strtoul (p, &e, 10); p = e;
+      align.eQ = strtoul (p, &e, 10); p = e;
+      align.idyc = strtoul (p, &e, 10); p = e;
+      align.simc = strtoul (p, &e, 10); p = e;
+      align.stpc = strtoul (p, &e, 10);
+      if ( e == p  ||  e > end  ||
+           align.sR <= 0  ||  align.eR <= 0  ||
+           align.sQ <= 0  ||  align.eQ <= 0 )
+        return false;
+      p = e;
+
+      total = labs(align.eR - align.sR) + 1.0;
+      if ( data_type_m == PROMER_STRING )
+        total /= 3.0;
+
+      //-- Get all the deltas
+      do
+        {
+          delta = strtol (p, &e, 10);
+          if ( e == p  ||  e > end )
+            return false;
+          p = e;
+
+          if ( delta < 0 )
+            total ++;
+          if ( read_deltas )
+            align.deltas.push_back (delta);
+        } while ( delta != 0 );
+
+      //-- Flush the remaining whitespace
+      while ( p < end  &&  *p ++ != '\n' );
+
+      //-- Calculate the identity, similarity and stopity
+      align.idy = (total - (float)align.idyc) / total * 100.0;
+      align.sim = (total - (float)align.simc) / total * 100.0;
+      align.stp = (float)align.stpc / (total * 2.0) * 100.0;
+
+      rec.aligns.push_back (align);
+    }
+
+  return true;
+}
+
+
+//----------------------------------------------------- readNextChunk ----------
+bool DeltaReader_t::readNextChunk
+     (vector<DeltaRecord_t> & records, bool read_deltas,
+      streamsize chunk_size)
+{
+  vector<string::size_type> starts;
+  string::size_type pos, old;
+
+  records.clear ( );
+  is_record_m = false;
+
+  //-- Read blocks until at least one complete record is in memory
+  while ( true )
+    {
+      if ( delta_stream_m.good ( ) )
+        {
+          old = chunk_m.size ( );
+          chunk_m.resize (old + chunk_size);
+          delta_stream_m.read (&chunk_m[old], chunk_size);
+          chunk_m.resize (old + delta_stream_m.gcount ( ));
+        }
+
+      //-- Find the record boundaries
+      starts.clear ( );
+      if ( ! chunk_m.empty ( )  &&  chunk_m[0] == '>' )
+        starts.push_back (0);
+      for ( pos = chunk_m.find ("\n>"); pos != string::npos;
+            pos = chunk_m.find ("\n>", pos + 1) )
+        starts.push_back (pos + 1);
+
+      //-- The last record might be cut short unless we are at EOF
+      if ( ! delta_stream_m.good ( ) )
+        {
+          starts.push_back (chunk_m.size ( ));
+          break;
+        }
+      if ( starts.size ( ) > 1 )
+        break;
+    }
+
+  if ( starts.size ( ) < 2 )
+    {
+      chunk_m.erase ( );
+      return false;
+    }
+
+  //-- Parse the complete records in parallel
+  long int i, n = starts.size ( ) - 1;
+  const char * buf = chunk_m.c_str ( );
+  bool good = true;
+  records.resize (n);
+
+#pragma omp parallel for schedule(dynamic, 64)
+  for ( i = 0; i < n; ++ i )
+    if ( ! parseRecord (buf + starts[i], buf + starts[i + 1],
+                        records[i], read_deltas) )
+      good = false;
+
+  if ( ! good )
+    {
+      std::cerr << "ERROR: Could not parse delta file, "
+                << delta_path_m << std::endl;
+      exit (-1);
+    }
+
+  //-- Hold on to the unparsed remainder
+  chunk_m.erase (0, starts.back ( ));
+
+  return true;
+}
+
+
 //===================================================== DeltaEdge_t ============
 //------------------------------------------------------build ------------------
 void DeltaEdge_t::build (const DeltaRecord_t & rec)
 {
-  stringstream ss;
+  char buff[32];
   vector<long int>::const_iterator di;
   DeltaEdgelet_t * p;
 
@@ -346,9 +525,8 @@ void DeltaEdge_t::build (const DeltaRecord_t & rec)
       //-- Get the delta information
       for ( di = i -> deltas . begin( ); di != i -> deltas . end( ); ++ di )
         {
-          ss << *di << '\n';
-          p -> delta . append (ss . str( ));
-          ss . str ("");
+          sprintf (buff, "%ld\n", *di);
+          p -> delta . append (buff);
         }
 
       //-- Force loR < hiR && loQ < hiQ
@@ -369,6 +547,9 @@ void DeltaGraph_t::build (const string & deltapath, bool getdeltas)
   DeltaReader_t dr;
   DeltaEdge_t * dep;
   pair<map<string, DeltaNode_t>::iterator, bool> insret;
+  vector<DeltaRecord_t> records;
+  vector<DeltaEdge_t *> edges;
+  long int i, n;
 
 
   //-- Open the delta file and read in the alignment information
@@ -384,44 +565,54 @@ void DeltaGraph_t::build (const string & deltapath, bool getdeltas)
   else
     datatype = NULL_DATA;
 
-  //-- Read in the next graph edge, i.e. a new delta record
-  while ( dr . readNext (getdeltas) )
+  //-- Read in the next block of graph edges, i.e. new delta records
+  while ( dr . readNextChunk (records, getdeltas) )
     {
-      dep = new DeltaEdge_t( );
+      n = records . size( );
+      edges . resize (n);
 
-
-      //-- Find the reference node in the graph, add a new one if necessary
-      insret = refnodes . insert
-        (map<string, DeltaNode_t>::value_type
-         (dr.getRecord( ).idR, DeltaNode_t( )));
-      dep -> refnode = &((insret . first) -> second);
-
-      //-- If a new reference node
-      if ( insret . second )
+      //-- Build the edges in parallel
+#pragma omp parallel for schedule(dynamic, 64)
+      for ( i = 0; i < n; ++ i )
         {
-          dep -> refnode -> id  = &((insret . first) -> first);
-          dep -> refnode -> len = dr . getRecord( ) . lenR;
+          edges[i] = new DeltaEdge_t( );
+          edges[i] -> build (records[i]);
         }
 
+      //-- Link the edges to their nodes in file order
+      for ( i = 0; i < n; ++ i )
+        {
+          dep = edges[i];
+          const DeltaRecord_t & rec = records[i];
 
-      //-- Find the query node in the graph, add a new one if necessary
-      insret = qrynodes . insert
-        (map<string, DeltaNode_t>::value_type
-         (dr.getRecord( ).idQ, DeltaNode_t( )));
-      dep -> qrynode = &((insret . first) -> second);
+          //-- Find the reference node in the graph, add a new one if necessary
+          insret = refnodes . insert
+            (map<string, DeltaNode_t>::value_type (rec.idR, DeltaNode_t( )));
+          dep -> refnode = &((insret . first) -> second);
 
-      //-- If a new query node
-      if ( insret . second )
-        {
-          dep -> qrynode -> id  = &((insret . first) -> first);
-          dep -> qrynode -> len = dr . getRecord( ) . lenQ;
-        }
+          //-- If a new reference node
+          if ( insret . second )
+            {
+              dep -> refnode -> id  = &((insret . first) -> first);
+              dep -> refnode -> len = rec . lenR;
+            }
 
 
-      //-- Build the edge
-      dep -> build (dr . getRecord( ));
-      dep -> refnode -> edges . push_back (dep);
-      dep -> qrynode -> edges . push_back (dep);
+          //-- Find the query node in the graph, add a new one if necessary
+          insret = qrynodes . insert
+            (map<string, DeltaNode_t>::value_type (rec.idQ, DeltaNode_t( )));
+          dep -> qrynode = &((insret . first) -> second);
+
+          //-- If a new query node
+          if ( insret . second )
+            {
+              dep -> qrynode -> id  = &((insret . first) -> first);
+              dep -> qrynode -> len = rec . lenQ;
+            }
+
+          dep -> refnode -> edges . push_back (dep);
+          dep -> qrynode -> edges . push_back (dep);
+        }
     }
   dr . close ( );
 }
@@ -546,12 +737,10 @@ long int DeltaGraph_t::getEdgeletCount( )
 //-------------------------------------------------------------- flagGLIS ------
 void DeltaGraph_t::flagGLIS (float epsilon)
 {
-  LIS_t * lis = NULL;
-  long int lis_size = 0;
-  long int i, j, n;
+  long int i, j, n, k, nj;
   long int olap, olapQ, olapR, len, lenQ, lenR, score, diff;
 
-  vector<DeltaEdgelet_t *> edgelets;
+  vector<LISJob_t> jobs;
 
   map<string, DeltaNode_t>::iterator mi;
   vector<DeltaEdge_t *>::iterator ei;
@@ -565,11 +754,14 @@ void DeltaGraph_t::flagGLIS (float epsilon)
       for ( ei  = (mi -> second) . edges . begin( );
             ei != (mi -> second) . edges . end( ); ++ ei )
         {
+          jobs . push_back (LISJob_t( ));
+          LISJob_t & job = jobs . back( );
+          job . edge = *ei;
+
           //-- Clear any previous chains
           (*ei) -> chains . clear( );
 
           //-- Collect all the good edgelets
-          edgelets . clear( );
           for ( eli  = (*ei) -> edgelets . begin( );
                 eli != (*ei) -> edgelets . end( ); ++ eli )
             {
@@ -578,7 +770,7 @@ void DeltaGraph_t::flagGLIS (float epsilon)
 
               if ( (*eli) -> isGOOD )
                 {
-                  edgelets . push_back (*eli);
+                  job . edgelets . push_back (*eli);
                   
                   //-- Fix the coordinates to make global LIS work
                   if ( (*eli) -> dirR == (*eli) -> dirQ )
@@ -595,116 +787,132 @@ void DeltaGraph_t::flagGLIS (float epsilon)
                     }
                 }
             }
+        }
+    }
 
-          //-- Resize and initialize
-          n = edgelets . size( );
-          if ( n > lis_size )
-            {
-              lis = (LIS_t *) Safe_realloc (lis, sizeof (LIS_t) * n);
-              lis_size = n;
-            }
-          for ( i = 0; i < n; ++ i )
-            lis[i] . used = false;
+  //-- Run the dynamic step for each edge in parallel
+  nj = jobs . size( );
+#pragma omp parallel for private(i, j, n, olap, olapQ, olapR, len, lenQ, lenR, score, diff) schedule(dynamic)
+  for ( k = 0; k < nj; ++ k )
+    {
+      vector<DeltaEdgelet_t *> & edgelets = jobs[k] . edgelets;
+      vector<long int> & allbest = jobs[k] . allbest;
 
-          //-- Sort by lo query coord
-          sort (edgelets . begin( ), edgelets . end( ), EdgeletQCmp_t( ));
+      //-- Resize and initialize
+      n = edgelets . size( );
+      jobs[k] . lis . resize (n);
+      LIS_t * lis = n ? &(jobs[k] . lis[0]) : NULL;
+      for ( i = 0; i < n; ++ i )
+        lis[i] . used = false;
 
-          //-- Continue until all equivalent repeats are extracted
-          vector<long int> allbest;
-          do
+      //-- Sort by lo query coord
+      sort (edgelets . begin( ), edgelets . end( ), EdgeletQCmp_t( ));
+
+      //-- Continue until all equivalent repeats are extracted
+      do
+        {
+          //-- Dynamic
+          for ( i = 0; i < n; ++ i )
             {
-              //-- Dynamic
-              for ( i = 0; i < n; ++ i )
+              if ( lis[i] . used ) continue;
+
+              lis[i] . a = edgelets[i];
+                  
+              lenR = lis[i] . a -> hiR - lis[i] . a -> loR + 1;
+              lenQ = lis[i] . a -> hiQ - lis[i] . a -> loQ + 1;
+              len = lenR > lenQ ? lenQ : lenR;
+              lis[i] . score = ScoreGlobal (0, len, 0, lis[i] . a -> idy);
+
+              lis[i] . from = -1;
+              lis[i] . diff = 0;
+                  
+              for ( j = 0; j < i; ++ j )
                 {
-                  if ( lis[i] . used ) continue;
+                  if ( lis[j] . used ) continue;
 
-                  lis[i] . a = edgelets[i];
+                  if ( lis[i] . a -> dirQ != lis[j] . a -> dirQ )
+                    continue;
                   
                   lenR = lis[i] . a -> hiR - lis[i] . a -> loR + 1;
                   lenQ = lis[i] . a -> hiQ - lis[i] . a -> loQ + 1;
                   len = lenR > lenQ ? lenQ : lenR;
-                  lis[i] . score = ScoreGlobal (0, len, 0, lis[i] . a -> idy);
-
-                  lis[i] . from = -1;
-                  lis[i] . diff = 0;
                   
-                  for ( j = 0; j < i; ++ j )
-                    {
-                      if ( lis[j] . used ) continue;
+                  olapR = lis[j] . a -> hiR - lis[i] . a -> loR + 1;
+                  olapQ = lis[j] . a -> hiQ - lis[i] . a -> loQ + 1;
+                  olap = olapR > olapQ ? olapR : olapQ;
+                  if ( olap < 0 )
+                    olap = 0;
 
-                      if ( lis[i] . a -> dirQ != lis[j] . a -> dirQ )
-                        continue;
-                  
-                      lenR = lis[i] . a -> hiR - lis[i] . a -> loR + 1;
-                      lenQ = lis[i] . a -> hiQ - lis[i] . a -> loQ + 1;
-                      len = lenR > lenQ ? lenQ : lenR;
-                  
-                      olapR = lis[j] . a -> hiR - lis[i] . a -> loR + 1;
-                      olapQ = lis[j] . a -> hiQ - lis[i] . a -> loQ + 1;
-                      olap = olapR > olapQ ? olapR : olapQ;
-                      if ( olap < 0 )
-                        olap = 0;
-
-                      diff = lis[j] . diff + DiffAligns (lis[i].a, lis[j].a);
-
-                      score = ScoreGlobal
-                        (lis[j] . score, len, olap, lis[i] . a -> idy);
-
-                      if ( score > lis[i] . score
-                           ||
-                           (score == lis[i] . score && diff < lis[i] . diff) )
-                        {
-                          lis[i] . from = j;
-                          lis[i] . score = score;
-                          lis[i] . diff = diff;
-                        }
+                  diff = lis[j] . diff + DiffAligns (lis[i].a, lis[j].a);
+
+                  score = ScoreGlobal
+                    (lis[j] . score, len, olap, lis[i] . a -> idy);
+
+                  if ( score > lis[i] . score
+                       ||
+                       (score == lis[i] . score && diff < lis[i] . diff) )
+                    {
+                      lis[i] . from = j;
+                      lis[i] . score = score;
+                      lis[i] . diff = diff;
                     }
                 }
-            } while ( UpdateBest (lis, n, allbest, epsilon) );
+            }
+        } while ( UpdateBest (lis, n, allbest, epsilon) );
+    }
+
+  //-- Pick and flag the best chains in order, PickBest consumes rand( )
+  for ( k = 0; k < nj; ++ k )
+    {
+      vector<DeltaEdgelet_t *> & edgelets = jobs[k] . edgelets;
+      vector<long int> & allbest = jobs[k] . allbest;
+      DeltaEdge_t * edge = jobs[k] . edge;
+      LIS_t * lis = jobs[k] . lis . empty( ) ? NULL : &(jobs[k] . lis[0]);
+      n = edgelets . size( );
 
-          long int beg = PickBest (lis, allbest, epsilon);
-          long int end = allbest . size( );
-          if ( beg == end ) beg = 0;
-          else end = beg + 1;
+      long int beg = PickBest (lis, allbest, epsilon);
+      long int end = allbest . size( );
+      if ( beg == end ) beg = 0;
+      else end = beg + 1;
 
-          //-- Flag the edgelets
-          DeltaEdgelet_t * last;
-          for ( ; beg < end; ++ beg )
+      //-- Flag the edgelets
+      DeltaEdgelet_t * last;
+      for ( ; beg < end; ++ beg )
+        {
+          last = NULL;
+          for ( i = allbest[beg]; i >= 0  &&  i < n; i = lis[i] . from )
             {
-              last = NULL;
-              for ( i = allbest[beg]; i >= 0  &&  i < n; i = lis[i] . from )
-                {
-                  lis[i] . a -> isGLIS = true;
-                  lis[i] . a -> next = last;
-                  last = lis[i] . a;
-                }
-              (*ei) -> chains . push_back (last);
+              lis[i] . a -> isGLIS = true;
+              lis[i] . a -> next = last;
+              last = lis[i] . a;
             }
+          edge -> chains . push_back (last);
+        }
 
-          //-- Repair the coordinates
-          for ( eli = edgelets . begin( ); eli != edgelets . end( ); ++ eli )
-            {
-              if ( ! (*eli) -> isGLIS )
-                (*eli) -> isGOOD = false;
+      //-- Repair the coordinates
+      for ( eli = edgelets . begin( ); eli != edgelets . end( ); ++ eli )
+        {
+          if ( ! (*eli) -> isGLIS )
+            (*eli) -> isGOOD = false;
 
-              if ( (*eli) -> dirQ == FORWARD_DIR )
-                {
-                  (*eli) -> dirQ = (*eli) -> dirR;
-                }
-              else
-                {
-                  if ( (*eli) -> dirR == FORWARD_DIR )
-                    Swap ((*eli) -> loQ, (*eli) -> hiQ);
-                  (*eli) -> loQ = RevC ((*eli) -> loQ, (*ei)->qrynode->len);
-                  (*eli) -> hiQ = RevC ((*eli) -> hiQ, (*ei)->qrynode->len);
-                  (*eli) -> dirQ =
-                    (*eli) -> dirR == FORWARD_DIR ? REVERSE_DIR : FORWARD_DIR;
-                }
+          if ( (*eli) -> dirQ == FORWARD_DIR )
+            {
+              (*eli) -> dirQ = (*eli) -> dirR;
+            }
+          else
+            {
+              if ( (*eli) -> dirR == FORWARD_DIR )
+                Swap ((*eli) -> loQ, (*eli) -> hiQ);
+              (*eli) -> loQ = RevC ((*eli) -> loQ, edge->qrynode->len);
+              (*eli) -> hiQ = RevC ((*eli) -> hiQ, edge->qrynode->len);
+              (*eli) -> dirQ =
+                (*eli) -> dirR == FORWARD_DIR ? REVERSE_DIR : FORWARD_DIR;
             }
         }
-    }
 
-  free (lis);
+      //-- Release the table as we go
+      vector<LIS_t>( ) . swap (jobs[k] . lis);
+    }
 }
 
 
@@ -737,12 +945,10 @@ void DeltaGraph_t::flagScore (long int minlen, float minidy)
 //-------------------------------------------------------------- flagQLIS ------
 void DeltaGraph_t::flagQLIS (float epsilon, float maxolap)
 {
-  LIS_t * lis = NULL;
-  long int lis_size = 0;
-  long int i, j, n;
+  long int i, j, n, k, nj;
   long int olap, leni, lenj, score, diff;
 
-  vector<DeltaEdgelet_t *> edgelets;
+  vector<LISJob_t> jobs;
 
   map<string, DeltaNode_t>::iterator mi;
   vector<DeltaEdge_t *>::iterator ei;
@@ -750,13 +956,17 @@ void DeltaGraph_t::flagQLIS (float epsilon, float maxolap)
 
 
   //-- For each query sequence
+  jobs . reserve (qrynodes . size( ));
   for ( mi = qrynodes . begin( ); mi != qrynodes . end( ); ++ mi )
     {
+      jobs . push_back (LISJob_t( ));
+      LISJob_t & job = jobs . back( );
+      job . node = &(mi -> second);
+
       //-- Clean any previous chains
       (mi -> second) . chains . clear( );
 
       //-- For each reference aligning to this query
-      edgelets . clear( );
       for ( ei  = (mi -> second) . edges . begin( );
             ei != (mi -> second) . edges . end( ); ++ ei )
         {
@@ -766,19 +976,25 @@ void DeltaGraph_t::flagQLIS (float epsilon, float maxolap)
             {
               //-- Clean any previous chain info
               (*eli) -> next = NULL;
-              
+
               if ( (*eli) -> isGOOD )
-                edgelets . push_back (*eli);
+                job . edgelets . push_back (*eli);
             }
         }
+    }
+
+  //-- Run the dynamic step for each query in parallel
+  nj = jobs . size( );
+#pragma omp parallel for private(i, j, n, olap, leni, lenj, score, diff) schedule(dynamic)
+  for ( k = 0; k < nj; ++ k )
+    {
+      vector<DeltaEdgelet_t *> & edgelets = jobs[k] . edgelets;
+      vector<long int> & allbest = jobs[k] . allbest;
 
       //-- Resize and initialize
       n = edgelets . size( );
-      if ( n > lis_size )
-        {
-          lis = (LIS_t *) Safe_realloc (lis, sizeof (LIS_t) * n);
-          lis_size = n;
-        }
+      jobs[k] . lis . resize (n);
+      LIS_t * lis = n ? &(jobs[k] . lis[0]) : NULL;
       for ( i = 0; i < n; ++ i )
         lis[i] . used = false;
 
@@ -786,7 +1002,6 @@ void DeltaGraph_t::flagQLIS (float epsilon, float maxolap)
       sort (edgelets . begin( ), edgelets . end( ), EdgeletQCmp_t( ));
 
       //-- Continue until all equivalent repeats are extracted
-      vector<long int> allbest;
       do
         {
           //-- Dynamic
@@ -829,6 +1044,15 @@ void DeltaGraph_t::flagQLIS (float epsilon, float maxolap)
                 }
             }
         } while ( UpdateBest (lis, n, allbest, epsilon) );
+    }
+
+  //-- Pick and flag the best chains in order, PickBest consumes rand( )
+  for ( k = 0; k < nj; ++ k )
+    {
+      vector<DeltaEdgelet_t *> & edgelets = jobs[k] . edgelets;
+      vector<long int> & allbest = jobs[k] . allbest;
+      LIS_t * lis = jobs[k] . lis . empty( ) ? NULL : &(jobs[k] . lis[0]);
+      n = edgelets . size( );
 
       long int beg = PickBest (lis, allbest, epsilon);
       long int end = allbest . size( );
@@ -846,27 +1070,26 @@ void DeltaGraph_t::flagQLIS (float epsilon, float maxolap)
               lis[i] . a -> next = last;
               last = lis[i] . a;
             }
-          (mi -> second) . chains . push_back (last);
+          jobs[k] . node -> chains . push_back (last);
         }
 
       for ( eli = edgelets . begin( ); eli != edgelets . end( ); ++ eli )
         if ( ! (*eli) -> isQLIS )
           (*eli) -> isGOOD = false;
-    }
 
-  free (lis);
+      //-- Release the table as we go
+      vector<LIS_t>( ) . swap (jobs[k] . lis);
+    }
 }
 
 
 //-------------------------------------------------------------- flagRLIS ------
 void DeltaGraph_t::flagRLIS (float epsilon, float maxolap)
 {
-  LIS_t * lis = NULL;
-  long int lis_size = 0;
-  long int i, j, n;
+  long int i, j, n, k, nj;
   long int olap, leni, lenj, score, diff;
 
-  vector<DeltaEdgelet_t *> edgelets;
+  vector<LISJob_t> jobs;
 
   map<string, DeltaNode_t>::iterator mi;
   vector<DeltaEdge_t *>::iterator ei;
@@ -874,13 +1097,17 @@ void DeltaGraph_t::flagRLIS (float epsilon, float maxolap)
 
 
   //-- For each reference sequence
+  jobs . reserve (refnodes . size( ));
   for ( mi = refnodes . begin( ); mi != refnodes . end( ); ++ mi )
     {
+      jobs . push_back (LISJob_t( ));
+      LISJob_t & job = jobs . back( );
+      job . node = &(mi -> second);
+
       //-- Clean any previous chains
       (mi -> second) . chains . clear( );
 
       //-- For each query aligning to this reference
-      edgelets . clear( );
       for ( ei  = (mi -> second) . edges . begin( );
             ei != (mi -> second) . edges . end( ); ++ ei )
         {
@@ -892,17 +1119,23 @@ void DeltaGraph_t::flagRLIS (float epsilon, float maxolap)
               (*eli) -> next = NULL;
 
               if ( (*eli) -> isGOOD )
-                edgelets . push_back (*eli);
+                job . edgelets . push_back (*eli);
             }
         }
+    }
 
-      //-- Resize
+  //-- Run the dynamic step for each reference in parallel
+  nj = jobs . size( );
+#pragma omp parallel for private(i, j, n, olap, leni, lenj, score, diff) schedule(dynamic)
+  for ( k = 0; k < nj; ++ k )
+    {
+      vector<DeltaEdgelet_t *> & edgelets = jobs[k] . edgelets;
+      vector<long int> & allbest = jobs[k] . allbest;
+
+      //-- Resize and initialize
       n = edgelets . size( );
-      if ( n > lis_size )
-        {
-          lis = (LIS_t *) Safe_realloc (lis, sizeof (LIS_t) * n);
-          lis_size = n;
-        }
+      jobs[k] . lis . resize (n);
+      LIS_t * lis = n ? &(jobs[k] . lis[0]) : NULL;
       for ( i = 0; i < n; ++ i )
         lis[i] . used = false;
 
@@ -910,7 +1143,6 @@ void DeltaGraph_t::flagRLIS (float epsilon, float maxolap)
       sort (edgelets . begin( ), edgelets . end( ), EdgeletRCmp_t( ));
 
       //-- Continue until all equivalent repeats are extracted
-      vector<long int> allbest;
       do
         {
           //-- Dynamic
@@ -953,32 +1185,42 @@ void DeltaGraph_t::flagRLIS (float epsilon, float maxolap)
                 }
             }
         } while ( UpdateBest (lis, n, allbest, epsilon) );
+    }
+
+  //-- Pick and flag the best chains in order, PickBest consumes rand( )
+  for ( k = 0; k < nj; ++ k )
+    {
+      vector<DeltaEdgelet_t *> & edgelets = jobs[k] . edgelets;
+      vector<long int> & allbest = jobs[k] . allbest;
+      LIS_t * lis = jobs[k] . lis . empty( ) ? NULL : &(jobs[k] . lis[0]);
+      n = edgelets . size( );
 
       long int beg = PickBest (lis, allbest, epsilon);
       long int end = allbest . size( );
       if ( beg == end ) beg = 0;
       else end = beg + 1;
-      
+
       //-- Flag the edgelets
       DeltaEdgelet_t * last;
       for ( ; beg < end; ++ beg )
         {
           last = NULL;
           for ( i = allbest[beg]; i >= 0  &&  i < n; i = lis[i] . from )
-           {
-             lis[i] . a -> isRLIS = true;
-             lis[i] . a -> next = last;
-             last = lis[i] . a;
-           }
-          (mi -> second) . chains . push_back (last);
+            {
+              lis[i] . a -> isRLIS = true;
+              lis[i] . a -> next = last;
+              last = lis[i] . a;
+            }
+          jobs[k] . node -> chains . push_back (last);
         }
 
       for ( eli = edgelets . begin( ); eli != edgelets . end( ); ++ eli )
         if ( ! (*eli) -> isRLIS )
           (*eli) -> isGOOD = false;
-    }
 
-  free (lis);
+      //-- Release the table as we go
+      vector<LIS_t>( ) . swap (jobs[k] . lis);
+    }
 }
 
 
@@ -32,6 +32,8 @@ typedef unsigned char Dir_t;                //!< directional type
 const Dir_t FORWARD_DIR = 0;                //!< forward direction
 const Dir_t REVERSE_DIR = 1;                //!< reverse direction
 
+const std::streamsize DELTA_CHUNK_SIZE = 16777216; //!< bytes per delta block
+
 
 
 //===================================================== DeltaAlignment_t =======
@@ -112,6 +114,7 @@ private:
   std::string reference_path_m;  //!< the name of the reference file
   std::string query_path_m;      //!< the name of the query file
   DeltaRecord_t record_m;        //!< the current delta information record
+  std::string chunk_m;           //!< partial record left over from last block
   bool is_record_m;              //!< there is a valid record in record_m
   bool is_open_m;                //!< delta stream is open
 
@@ -137,6 +140,21 @@ private:
   bool readNextRecord (const bool read_deltas);
 
 
+  //--------------------------------------------------- parseRecord ------------
+  //! \brief Parses a single delta record from an in-memory block
+  //!
+  //! Thread safe, does not touch the delta stream or record_m.
+  //!
+  //! \param p pointer to the '>' starting the record
+  //! \param end pointer one past the end of the record
+  //! \param rec parse the record into this structure
+  //! \param read_deltas read delta information yes/no
+  //! \return true on success, false on a parse error
+  //!
+  bool parseRecord (const char * p, const char * end,
+                    DeltaRecord_t & rec, const bool read_deltas) const;
+
+
   //--------------------------------------------------- checkStream ------------
   //! \brief Check stream status and abort program if an error has occured
   //!
@@ -199,6 +217,7 @@ public:
     reference_path_m.erase ( );
     query_path_m.erase ( );
     record_m.clear ( );
+    chunk_m.erase ( );
     is_record_m = false;
     is_open_m = false;
   }
@@ -233,6 +252,25 @@ public:
   }
 
 
+  //--------------------------------------------------- readNextChunk ----------
+  //! \brief Reads in the next block of delta records from the delta file
+  //!
+  //! Reads roughly chunk_size bytes from the delta file, splits them on record
+  //! boundaries and parses the complete records in parallel. Any trailing
+  //! partial record is held over until the next call. Do not mix with calls
+  //! to readNext on the same reader.
+  //!
+  //! \param records read the records into this vector, old contents cleared
+  //! \param read_deltas read delta information yes/no
+  //! \param chunk_size approximate number of bytes to read per block
+  //! \pre delta file must be open
+  //! \return true if any records were read, false on EOF
+  //!
+  bool readNextChunk (std::vector<DeltaRecord_t> & records,
+                      bool read_deltas = true,
+                      std::streamsize chunk_size = DELTA_CHUNK_SIZE);
+
+
   //--------------------------------------------------- getRecord --------------
   //! \brief Returns a reference to the current delta record
   //!
@@ -463,6 +501,10 @@ public:
   //! edgelet->frmR/frmQ
   //! edgelet->snps
   //!
+  //! The delta file is read in blocks and the records of each block are
+  //! parsed and built into edges in parallel, nodes are then linked in file
+  //! order so the resulting graph is identical to a serial build.
+  //!
   //! \param deltapath The path of the deltafile to read
   //! \param getdeltas Read the delta-encoded gap positions? yes/no
   //! \return void
@@ -535,7 +577,9 @@ public:
   //! consistent set of alignments between all pairs of sequences. This
   //! essentially constructs the global alignment between all sequence pairs.
   //!
-  //! Sets isGLIS flag for good and unsets isGOOD flag for bad.
+  //! Sets isGLIS flag for good and unsets isGOOD flag for bad. Edges are
+  //! processed in parallel, the random choice between equivalent repeats is
+  //! made serially so results for a given srand seed do not change.
   //!
   //! \param epsilon Keep repeat alignments within epsilon % of the best align
   //! \return void
@@ -550,7 +594,8 @@ public:
   //! consistent set of alignments for all query sequences. This effectively
   //! identifies the "best" alignments for all positions of each query.
   //!
-  //! Sets isQLIS flag for good and unsets isGOOD flag for bad.
+  //! Sets isQLIS flag for good and unsets isGOOD flag for bad. Query
+  //! sequences are processed in parallel.
   //!
   //! \param epsilon Keep repeat alignments within epsilon % of the best align
   //! \param maxolap Only allow alignments to overlap by maxolap percent [0-100]
@@ -566,7 +611,8 @@ public:
   //! consistent set of alignments for all reference sequences. This effectively
   //! identifies the "best" alignments for all positions of each reference.
   //!
-  //! Sets isRLIS flag for good and unsets isGOOD flag for bad.
+  //! Sets isRLIS flag for good and unsets isGOOD flag for bad. Reference
+  //! sequences are processed in parallel.
   //!
   //! \param epsilon Keep repeat alignments within epsilon % of the best align
   //! \param maxolap Only allow alignments to overlap by maxolap percent [0-100]
@@ -0,0 +1,162 @@
+// Checks DeltaReader_t::readNextChunk against readNext on a random delta file
+// read in blocks from one byte to the whole file, so records are cut at every
+// kind of place, including records spanning several blocks.
+
+#include "delta.hh"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+const string DELTA_FILE = "_deltatest_.delta";
+const int NRECORDS = 300;
+
+
+static bool SameRecord (const DeltaRecord_t & a, const DeltaRecord_t & b)
+{
+  if ( a.idR != b.idR  ||  a.idQ != b.idQ  ||
+       a.lenR != b.lenR  ||  a.lenQ != b.lenQ  ||
+       a.aligns.size ( ) != b.aligns.size ( ) )
+    return false;
+
+  for ( unsigned int i = 0; i < a.aligns.size ( ); i ++ )
+    {
+      const DeltaAlignment_t & x = a.aligns[i];
+      const DeltaAlignment_t & y = b.aligns[i];
+      if ( x.sR != y.sR  ||  x.eR != y.eR  ||  x.sQ != y.sQ  ||  x.eQ != y.eQ  ||
+           x.idyc != y.idyc  ||  x.simc != y.simc  ||  x.stpc != y.stpc  ||
+           x.idy != y.idy  ||  x.sim != y.sim  ||  x.stp != y.stp  ||
+           x.deltas != y.deltas )
+        return false;
+    }
+
+  return true;
+}
+
+
+//-- Writes the test file, returning the file offsets of the records and of
+//   its end, measured from the first record
+static vector<long> WriteDelta ( )
+{
+  ostringstream ss;
+  vector<long> starts;
+
+  ss << "/tmp/ref.fasta /tmp/qry.fasta\nNUCMER\n";
+  long head = ss.str ( ).size ( );
+
+  for ( int r = 0; r < NRECORDS; r ++ )
+    {
+      starts.push_back ((long) ss.str ( ).size ( ) - head);
+
+      long lenR = 1000 + rand ( ) % 100000;
+      long lenQ = 1000 + rand ( ) % 100000;
+      ss << ">ref" << r % 17 << " qry" << r << ' ' << lenR << ' ' << lenQ << '\n';
+
+      //-- Some records have no alignments, a few have many
+      int naligns = (r % 10 == 0) ? 40 : rand ( ) % 4;
+      for ( int a = 0; a < naligns; a ++ )
+        {
+          long sR = 1 + rand ( ) % (lenR - 500);
+          long eR = sR + 100 + rand ( ) % 400;
+          long sQ = 1 + rand ( ) % (lenQ - 500);
+          long eQ = sQ + 100 + rand ( ) % 400;
+          if ( rand ( ) % 2 )
+            swap (sQ, eQ);
+
+          ss << sR << ' ' << eR << ' ' << sQ << ' ' << eQ << ' '
+             << rand ( ) % 20 << ' ' << rand ( ) % 20 << " 0\n";
+
+          int ndeltas = rand ( ) % 6;
+          for ( int d = 0; d < ndeltas; d ++ )
+            ss << (rand ( ) % 2 ? 1 : -1) * (1 + rand ( ) % 50) << '\n';
+          ss << "0\n";
+        }
+    }
+
+  starts.push_back ((long) ss.str ( ).size ( ) - head);
+
+  ofstream out (DELTA_FILE.c_str ( ));
+  out << ss.str ( );
+  return starts;
+}
+
+
+int main (int argc, char ** argv)
+{
+  vector<DeltaRecord_t> whole, chunk;
+  int fails = 0;
+
+  srand (1);
+  vector<long> starts = WriteDelta ( );
+
+  for ( int getdeltas = 0; getdeltas <= 1; getdeltas ++ )
+    {
+      //-- The whole file, one record at a time from the stream
+      DeltaReader_t dr;
+      whole.clear ( );
+      dr.open (DELTA_FILE);
+      while ( dr.readNext (getdeltas) )
+        whole.push_back (dr.getRecord ( ));
+      dr.close ( );
+
+      if ( (int) whole.size ( ) != NRECORDS )
+        {
+          cerr << "FAIL: readNext gave " << whole.size ( ) << " of "
+               << NRECORDS << " records" << endl;
+          fails ++;
+        }
+
+      long sizes[] = { 1, 2, 7, 64, 333, 4096, DELTA_CHUNK_SIZE };
+      for ( unsigned int s = 0; s < sizeof (sizes) / sizeof (sizes[0]); s ++ )
+        {
+          long size = sizes[s];
+
+          //-- Make sure a record spans a block boundary, or that there is only
+          //   one block
+          bool spans = false;
+          for ( int r = 0; r < NRECORDS; r ++ )
+            if ( starts[r] / size != (starts[r + 1] - 1) / size )
+              spans = true;
+          if ( ! spans  &&  size < starts.back ( ) )
+            {
+              cerr << "FAIL: no record spans a " << size << " byte block" << endl;
+              fails ++;
+            }
+
+          vector<DeltaRecord_t> all;
+          dr.open (DELTA_FILE);
+          while ( dr.readNextChunk (chunk, getdeltas, size) )
+            {
+              if ( chunk.empty ( ) )
+                {
+                  cerr << "FAIL: readNextChunk returned no records" << endl;
+                  fails ++;
+                  break;
+                }
+              all.insert (all.end ( ), chunk.begin ( ), chunk.end ( ));
+            }
+          dr.close ( );
+
+          bool same = all.size ( ) == whole.size ( );
+          for ( unsigned int i = 0; same  &&  i < all.size ( ); i ++ )
+            same = SameRecord (all[i], whole[i]);
+
+          if ( ! same )
+            {
+              cerr << "FAIL: " << size << " byte blocks"
+                   << (getdeltas ? " with deltas" : "") << " gave "
+                   << all.size ( ) << " records that differ from readNext"
+                   << endl;
+              fails ++;
+            }
+        }
+    }
+
+  remove (DELTA_FILE.c_str ( ));
+
+  cerr << (fails ? "FAILED" : "PASSED") << endl;
+  return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
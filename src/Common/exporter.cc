@@ -0,0 +1,315 @@
+//  File:  exporter.cc
+//
+//  Routines to export bank objects as text, such as FASTA or FASTQ,
+//  plain or gzip or BGZF compressed.
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include  "inttypes_AMOS.hh"
+#include  "exporter.hh"
+#include  <cstdarg>
+#include  <cstring>
+#include  <cerrno>
+
+#ifdef HAVE_LIBZ
+#include  <zlib.h>
+#endif
+
+using namespace std;
+using namespace AMOS;
+
+
+bool  Export_Compression_Available
+    (void)
+
+//  Return  true  if the program was built with zlib, i.e., if
+//  gzip and BGZF output can be written.
+
+  {
+#ifdef HAVE_LIBZ
+   return  true;
+#else
+   return  false;
+#endif
+  }
+
+
+
+bool  Export_Parse_Compression
+    (const char * s, ExportCompression & c)
+
+//  Set  c  to the compression named by  s , one of  "none" ,
+//  "gzip"  or  "bgzf" .  Return  false  if  s  names none of them.
+
+  {
+   if  (strcmp (s, "none") == 0)
+       c = EXPORT_PLAIN;
+   else if  (strcmp (s, "gzip") == 0)
+       c = EXPORT_GZIP;
+   else if  (strcmp (s, "bgzf") == 0)
+       c = EXPORT_BGZF;
+   else
+       return  false;
+
+   return  true;
+  }
+
+
+
+void  Bgzf_Deflate_Block
+    (const char * s, int len, string & out)
+
+//  Compress the  len  bytes at  s , at most  BGZF_BLOCK_SIZE , into
+//  one BGZF block and append it to  out .  Data that does not shrink
+//  is stored instead.  An empty block marks the end of a BGZF file.
+
+  {
+#ifdef HAVE_LIBZ
+   static const unsigned char  HEADER [18] =
+       {31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0, 0, 0};
+   const int  MAX_BLOCK = 0x10000;
+   char  block [MAX_BLOCK];
+   int  level = Z_DEFAULT_COMPRESSION;
+   uLong  size = 0;
+
+   while  (true)
+     {
+      z_stream  zs;
+
+      memset (& zs, 0, sizeof (zs));
+      deflateInit2 (& zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+      zs . next_in = (Bytef *) s;
+      zs . avail_in = len;
+      zs . next_out = (Bytef *) block + 18;
+      zs . avail_out = MAX_BLOCK - 18 - 8;
+      int  status = deflate (& zs, Z_FINISH);
+      size = zs . total_out;
+      deflateEnd (& zs);
+
+      if  (status == Z_STREAM_END)
+          break;
+      if  (level == 0)
+          AMOS_THROW ("Could not compress BGZF block");
+      level = 0;
+     }
+
+   memcpy (block, HEADER, 18);
+   uint16_t  bsize = size + 18 + 8 - 1;
+   memcpy (block + 16, & bsize, 2);
+
+   uint32_t  crc = crc32 (crc32 (0L, Z_NULL, 0), (const Bytef *) s, len);
+   uint32_t  isize = len;
+   memcpy (block + 18 + size, & crc, 4);
+   memcpy (block + 18 + size + 4, & isize, 4);
+
+   out . append (block, size + 18 + 8);
+#else
+   AMOS_THROW ("BGZF output needs zlib, which was not found at configure time");
+#endif
+  }
+
+
+
+void  Gzip_Deflate_Member
+    (const char * s, size_t len, string & out)
+
+//  Compress the  len  bytes at  s  into one gzip member and append it
+//  to  out .  gzip readers take a file of several members as the
+//  concatenation of their data.
+
+  {
+#ifdef HAVE_LIBZ
+   z_stream  zs;
+   size_t  start = out . size ();
+
+   memset (& zs, 0, sizeof (zs));
+   if  (deflateInit2 (& zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                      Z_DEFAULT_STRATEGY) != Z_OK)
+       AMOS_THROW ("Could not start gzip compression");
+
+   out . resize (start + deflateBound (& zs, len) + 32);
+   zs . next_in = (Bytef *) s;
+   zs . avail_in = len;
+   zs . next_out = (Bytef *) & out [start];
+   zs . avail_out = out . size () - start;
+   int  status = deflate (& zs, Z_FINISH);
+   out . resize (start + zs . total_out);
+   deflateEnd (& zs);
+
+   if  (status != Z_STREAM_END)
+       AMOS_THROW ("Could not compress gzip member");
+#else
+   AMOS_THROW ("gzip output needs zlib, which was not found at configure time");
+#endif
+  }
+
+
+
+void  Fasta_Append
+    (string & out, const string & s, const string & hdr, int fasta_width)
+
+//  Append string  s  in fasta format to  out , like  Fasta_Print .
+//  Put string  hdr  on the header line, unless it's empty in which
+//  case do not add a header line at all.  Put at most  fasta_width
+//  characters on each line.
+
+  {
+   if  (! hdr . empty ())
+       {
+        out += '>';
+        out += hdr;
+        out += '\n';
+       }
+
+   for  (size_t i = 0;  i < s . length ();  i += fasta_width)
+     {
+      out . append (s, i, fasta_width);
+      out += '\n';
+     }
+
+   if  (s . empty ())
+       out += '\n';
+
+   return;
+  }
+
+
+
+void  Export_Printf
+    (string & out, const char * fmt, ...)
+
+//  Append the  printf -style formatted  fmt  to  out .
+
+  {
+   char  buffer [1024];
+   va_list  args;
+   int  n;
+
+   va_start (args, fmt);
+   n = vsnprintf (buffer, sizeof (buffer), fmt, args);
+   va_end (args);
+
+   if  (n < (int) sizeof (buffer))
+       {
+        out . append (buffer, n);
+        return;
+       }
+
+   vector <char>  big (n + 1);
+
+   va_start (args, fmt);
+   vsnprintf (& big [0], n + 1, fmt, args);
+   va_end (args);
+   out . append (& big [0], n);
+  }
+
+
+
+void  Export_Stream_t::open
+    (const string & path, ExportCompression c)
+
+//  Open  path  for writing, or use stdout if  path  is empty or  "-" .
+//  Compress what is written with  c .
+
+  {
+   close ();
+
+   if  (c != EXPORT_PLAIN && ! Export_Compression_Available ())
+       AMOS_THROW_ARGUMENT ("Compressed output needs zlib, which was not "
+                            "found at configure time");
+
+   if  (path . empty () || path == "-")
+       {
+        fp = stdout;
+        owned = false;
+       }
+   else
+       {
+        fp = fopen (path . c_str (), "w");
+        if  (fp == NULL)
+            AMOS_THROW_IO ("Could not open " + path + ", " + strerror (errno));
+        owned = true;
+       }
+
+   compression = c;
+  }
+
+
+
+void  Export_Stream_t::compress
+    (string & text, string & out) const
+
+//  Set  out  to  text  compressed for this stream, leaving  text
+//  empty.  Each call makes output that can be written on its own, a
+//  gzip member or whole BGZF blocks.
+
+  {
+   out . clear ();
+
+   switch  (compression)
+     {
+      case  EXPORT_PLAIN :
+        out . swap (text);
+        break;
+
+      case  EXPORT_GZIP :
+        if  (! text . empty ())
+            Gzip_Deflate_Member (text . data (), text . size (), out);
+        break;
+
+      case  EXPORT_BGZF :
+        for  (size_t i = 0;  i < text . size ();  i += BGZF_BLOCK_SIZE)
+          Bgzf_Deflate_Block (text . data () + i,
+                              min ((size_t) BGZF_BLOCK_SIZE, text . size () - i),
+                              out);
+        break;
+     }
+
+   text . clear ();
+  }
+
+
+
+void  Export_Stream_t::write
+    (const string & data)
+
+//  Write the compressed  data  to the file.
+
+  {
+   if  (fp == NULL)
+       AMOS_THROW_IO ("Export stream is not open");
+
+   if  (! data . empty ()
+          && fwrite (data . data (), 1, data . size (), fp) != data . size ())
+       AMOS_THROW_IO (string ("Could not write output, ") + strerror (errno));
+  }
+
+
+
+void  Export_Stream_t::close
+    (void)
+
+//  Finish the file, with the empty end block for BGZF, and close it
+//  unless it is stdout.
+
+  {
+   if  (fp == NULL)
+       return;
+
+   if  (compression == EXPORT_BGZF)
+       {
+        string  eof;
+
+        Bgzf_Deflate_Block ("", 0, eof);
+        fwrite (eof . data (), 1, eof . size (), fp);
+       }
+
+   if  (owned)
+       fclose (fp);
+   else
+       fflush (fp);
+
+   fp = NULL;
+  }
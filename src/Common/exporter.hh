@@ -0,0 +1,236 @@
+//  File:  exporter.hh
+//
+//  Routines to export bank objects as text, such as FASTA or FASTQ,
+//  plain or gzip or BGZF compressed.  Exporter_t reads objects from a
+//  bank in batches while other threads format and compress the
+//  previous batch, and writes the results in the original order.
+
+
+#ifndef  __EXPORTER_HH
+#define  __EXPORTER_HH
+
+
+#include  "exceptions_AMOS.hh"
+#include  <string>
+#include  <vector>
+#include  <cstdio>
+#include  <algorithm>
+
+#ifdef AMOS_HAVE_OPENMP
+#include  <omp.h>
+#endif
+
+
+enum  ExportCompression {EXPORT_PLAIN, EXPORT_GZIP, EXPORT_BGZF};
+
+const int  BGZF_BLOCK_SIZE = 0xff00;
+  // Most uncompressed bytes put in one BGZF block
+
+const int  DEFAULT_EXPORT_BATCH = 4096;
+  // Objects read from a bank per batch
+
+const int  EXPORT_CHUNK = 256;
+  // Objects formatted and compressed together by one thread
+
+
+bool  Export_Compression_Available
+    (void);
+bool  Export_Parse_Compression
+    (const char * s, ExportCompression & c);
+void  Bgzf_Deflate_Block
+    (const char * s, int len, std::string & out);
+void  Gzip_Deflate_Member
+    (const char * s, size_t len, std::string & out);
+void  Fasta_Append
+    (std::string & out, const std::string & s, const std::string & hdr,
+     int fasta_width);
+void  Export_Printf
+    (std::string & out, const char * fmt, ...);
+
+
+
+class  Export_Stream_t
+  {
+   //  An output file, stdout if no name is given, with its compression.
+   //  compress  may be called by several threads at once,  write  must
+   //  be called by one thread with the compressed chunks in order.
+
+  private:
+
+   FILE  * fp;
+   bool  owned;
+   ExportCompression  compression;
+
+   Export_Stream_t (const Export_Stream_t &);
+   Export_Stream_t & operator = (const Export_Stream_t &);
+
+  public:
+
+   Export_Stream_t  ()
+     : fp (NULL), owned (false), compression (EXPORT_PLAIN)
+     {}
+   ~ Export_Stream_t  ()
+     { close (); }
+
+   void  open
+       (const std::string & path, ExportCompression c);
+   void  compress
+       (std::string & text, std::string & out) const;
+   void  write
+       (const std::string & data);
+   void  close
+       (void);
+
+   bool  isOpen  () const
+     { return fp != NULL; }
+  };
+
+
+
+template <class T>
+class  Exporter_t
+  {
+   //  Exports the objects returned by  read  to one or more streams.
+   //  read  is called by one thread at a time and is the only place the
+   //  bank may be used;  format  appends the text of one object for each
+   //  stream to  out [0 .. streams - 1]  and must be safe to call from
+   //  several threads at once.
+
+  private:
+
+   std::vector <Export_Stream_t *>  streams;
+   int  batch_size;
+   bool  at_end;
+
+   int  Fill  (std::vector <T> & batch)
+     {
+      int  n = 0;
+
+      if  (batch . size () < (size_t) batch_size)
+          batch . resize (batch_size);
+      while  (n < batch_size && ! at_end)
+        {
+         if  (read (batch [n]))
+             n ++;
+         else
+             at_end = true;
+        }
+
+      return  n;
+     }
+
+   void  Write  (const std::vector <std::string> & chunks)
+     {
+      int  ns = streams . size ();
+
+      for  (size_t i = 0;  i < chunks . size ();  i ++)
+        if  (streams [i % ns] != NULL)
+            streams [i % ns] -> write (chunks [i]);
+     }
+
+  public:
+
+   Exporter_t  (int num_streams = 1)
+     : streams (num_streams, (Export_Stream_t *) NULL),
+       batch_size (DEFAULT_EXPORT_BATCH), at_end (false)
+     {}
+   virtual ~ Exporter_t  ()
+     {}
+
+   virtual bool  read  (T & obj) = 0;
+   virtual void  format  (T & obj, std::string * out) = 0;
+
+   void  setStream  (int i, Export_Stream_t * s)
+     { streams [i] = s; }
+   void  setBatchSize  (int n)
+     { batch_size = (n > 0 ? n : DEFAULT_EXPORT_BATCH); }
+
+   void  run  ()
+     {
+      //  Reads batch  b + 1  and writes the chunks of batch  b - 1  on one
+      //  thread while the others format and compress batch  b .
+
+      std::vector <T>  batch [2];
+      std::vector <std::string>  done, chunks;
+      int  ns = streams . size ();
+      int  n [2], cur = 0;
+      AMOS::Exception_t  * error = NULL;
+
+      at_end = false;
+      n [cur] = Fill (batch [cur]);
+
+      while  (n [cur] > 0)
+        {
+         int  nchunks = (n [cur] + EXPORT_CHUNK - 1) / EXPORT_CHUNK;
+
+         chunks . clear ();
+         chunks . resize (nchunks * ns);
+         n [1 - cur] = 0;
+
+#ifdef AMOS_HAVE_OPENMP
+         #pragma omp parallel
+#endif
+           {
+#ifdef AMOS_HAVE_OPENMP
+            #pragma omp single nowait
+#endif
+              {
+               try
+                 {
+                  Write (done);
+                  n [1 - cur] = Fill (batch [1 - cur]);
+                 }
+               catch  (const AMOS::Exception_t & e)
+                 {
+#ifdef AMOS_HAVE_OPENMP
+                  #pragma omp critical (Exporter_Error)
+#endif
+                  if  (error == NULL)
+                      error = new AMOS::Exception_t (e);
+                 }
+              }
+
+#ifdef AMOS_HAVE_OPENMP
+            #pragma omp for schedule(dynamic) nowait
+#endif
+            for  (int c = 0;  c < nchunks;  c ++)
+              {
+               std::vector <std::string>  text (ns);
+               int  hi = std::min ((c + 1) * EXPORT_CHUNK, n [cur]);
+
+               try
+                 {
+                  for  (int i = c * EXPORT_CHUNK;  i < hi;  i ++)
+                    format (batch [cur] [i], & text [0]);
+                  for  (int k = 0;  k < ns;  k ++)
+                    if  (streams [k] != NULL)
+                        streams [k] -> compress (text [k], chunks [c * ns + k]);
+                 }
+               catch  (const AMOS::Exception_t & e)
+                 {
+#ifdef AMOS_HAVE_OPENMP
+                  #pragma omp critical (Exporter_Error)
+#endif
+                  if  (error == NULL)
+                      error = new AMOS::Exception_t (e);
+                 }
+              }
+           }
+
+         if  (error != NULL)
+             {
+              AMOS::Exception_t  e (* error);
+              delete error;
+              throw e;
+             }
+
+         done . swap (chunks);
+         cur = 1 - cur;
+        }
+
+      Write (done);
+     }
+  };
+
+
+#endif // #ifndef __EXPORTER_HH
@@ -62,8 +62,19 @@ int DataStore::openBank(const string & bankname)
     m_readfraglookup.clear();
     m_contigscafflookup.clear();
     m_libdistributionlookup.clear();
+    m_readindex.close();
+    m_rangeindex.close();
 
-    indexContigs();
+    // A current read index replaces the read, fragment and contig indexing
+    if (ReadIndex_t::isCurrent(bankname))
+    {
+      m_readindex.open(bankname);
+      cerr << "Using read index of " << m_readindex.getSize() << " reads" << endl;
+    }
+    else
+    {
+      indexContigs();
+    }
     m_scaffoldId = AMOS::NULL_ID;
     retval = 0;
   }
@@ -93,7 +104,7 @@ int DataStore::openBank(const string & bankname)
 
       int BIGMEM = 1;
 
-      if (BIGMEM)
+      if (BIGMEM && !m_readindex.isOpen())
       {
         indexFrags();
         indexReads();
@@ -125,6 +136,21 @@ int DataStore::openBank(const string & bankname)
     {
       cerr << "Features not available" << endl;
     }
+
+    // A current contig range index finds the features of a contig without
+    // scanning the feature bank
+    try
+    {
+      if (feat_bank.isOpen() && ContigRangeIndex_t::isCurrent(bankname))
+      {
+        m_rangeindex.open(bankname);
+        cerr << "Using contig range index" << endl;
+      }
+    }
+    catch (const Exception_t & e)
+    {
+      cerr << "Contig range index not available" << endl;
+    }
   }
 
   return retval;
@@ -145,7 +171,7 @@ void DataStore::indexReads()
   Read_t red;
 
   read_bank.seekg(1);
-  read_bank.setFixedStoreOnly(true);
+  read_bank.setProjection(P_FRAGMENT);
 
   while (read_bank >> red)
   {
@@ -155,7 +181,7 @@ void DataStore::indexReads()
     m_readfraglookup[read_bank.lookupBID(red.getIID())] = red.getFragment();
   }
 
-  read_bank.setFixedStoreOnly(false);
+  read_bank.setProjection(P_ALL);
 
   cerr << " " << timer.str() << " "
        << m_readfraglookup.size() << " reads" << endl;
@@ -212,7 +238,15 @@ void DataStore::indexFrags()
 
 DataStore::MateInfo_t DataStore::getMatePair(ID_t readid)
 {
-  if (!m_readmatelookup.empty())
+  if (m_readindex.isOpen())
+  {
+    const ReadIndex_t::Record_t * rec = m_readindex.find(readid);
+    if (rec != NULL && rec->mate != AMOS::NULL_ID)
+    {
+      return make_pair(rec->mate, (FragmentType_t) rec->type);
+    }
+  }
+  else if (!m_readmatelookup.empty())
   {
     return m_readmatelookup[read_bank.lookupBID(readid)];
   }
@@ -452,7 +486,11 @@ void DataStore::fetchFragIID(ID_t fragid, Fragment_t & frag)
 
 ID_t DataStore::lookupFragId(ID_t readid)
 {
-  if (!m_readfraglookup.empty())
+  if (m_readindex.isOpen())
+  {
+    return m_readindex.getFragment(readid);
+  }
+  else if (!m_readfraglookup.empty())
   {
     return m_readfraglookup[read_bank.lookupBID(readid)];
   }
@@ -466,7 +504,11 @@ ID_t DataStore::lookupFragId(ID_t readid)
 
 AMOS::ID_t DataStore::getLibrary(ID_t readid)
 {
-  if (!m_libdistributionlookup.empty())
+  if (m_readindex.isOpen())
+  {
+    return m_readindex.getLibrary(readid);
+  }
+  else if (!m_libdistributionlookup.empty())
   {
     try
     {
@@ -498,6 +540,36 @@ AMOS::ID_t DataStore::getLibrary(ID_t readid)
 }
 
 
+int DataStore::countFragments(ID_t libid)
+{
+  int count = 0;
+
+  if (m_readindex.isOpen())
+  {
+    // one read per fragment, the lower of a mated pair
+    const ReadIndex_t::Record_t * ri;
+    for (ri = m_readindex.begin(); ri != m_readindex.end(); ri++)
+    {
+      if (ri->library == libid && (ri->mate == AMOS::NULL_ID || ri->read < ri->mate))
+      {
+        count++;
+      }
+    }
+  }
+  else
+  {
+    for (size_t i = 0; i < m_fragliblookup.size(); i++)
+    {
+      if (m_fragliblookup[i] == libid)
+      {
+        count++;
+      }
+    }
+  }
+
+  return count;
+}
+
 Distribution_t DataStore::getLibrarySize(ID_t libid)
 {
   if (libid)
@@ -510,6 +582,12 @@ Distribution_t DataStore::getLibrarySize(ID_t libid)
 
 ID_t DataStore::lookupContigId(ID_t readid)
 {
+  if (m_readindex.isOpen())
+  {
+    ID_t contigiid = m_readindex.getContig(readid);
+    return contigiid ? contig_bank.lookupBID(contigiid) : 0;
+  }
+
   return m_readcontiglookup[read_bank.lookupBID(readid)];
 }
 
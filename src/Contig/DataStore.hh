@@ -58,6 +58,7 @@ public:
   typedef pair<AMOS::ID_t, AMOS::FragmentType_t> MateInfo_t;
 
   MateInfo_t getMatePair(AMOS::ID_t readid);
+  int countFragments(AMOS::ID_t libid);
 
   AMOS::BankStream_t contig_bank;
   AMOS::BankStream_t read_bank;
@@ -87,6 +88,9 @@ public:
   IdLookup_t m_readcontiglookup;
   IdLookup_t m_readfraglookup;      
 
+  AMOS::ReadIndex_t m_readindex;
+  AMOS::ContigRangeIndex_t m_rangeindex;
+
   typedef HASHMAP::hash_map<AMOS::ID_t, AMOS::Distribution_t> LibLookup_t;
   LibLookup_t m_libdistributionlookup;
 
@@ -0,0 +1,294 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Packs per-read chromatogram files into a single trace archive
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#include "foundation_AMOS.hh"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <set>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+using namespace AMOS;
+
+extern "C"
+{
+  #include "Read.h"
+#ifdef IOLIB_ZTR
+  #include "ztr.h"
+#endif
+}
+
+
+//=============================================================== Globals ====//
+string OPT_ArchiveName;              // archive to create
+vector<string> OPT_TraceDirs;        // directories of trace files
+string OPT_EIDFile;                  // only pack the eids listed here
+bool   OPT_ZTR = false;              // convert traces to ZTR
+
+
+//========================================================== Fuction Decs ====//
+//----------------------------------------------------- ParseArgs --------------
+//! \brief Sets the global OPT_% values from the command line arguments
+//!
+//! \return void
+//!
+void ParseArgs (int argc, char ** argv);
+
+
+//----------------------------------------------------- PrintHelp --------------
+//! \brief Prints help information to cerr
+//!
+//! \param s The program name, i.e. argv[0]
+//! \return void
+//!
+void PrintHelp (const char * s);
+
+
+//----------------------------------------------------- PrintUsage -------------
+//! \brief Prints usage information to cerr
+//!
+//! \param s The program name, i.e. argv[0]
+//! \return void
+//!
+void PrintUsage (const char * s);
+
+
+//----------------------------------------------------- FindTraces -------------
+//! \brief Adds the path of every file below dir to traces, by file name
+//!
+void FindTraces (const string & dir, map<string, string> & traces)
+{
+  DIR * dp = opendir (dir . c_str( ));
+  if ( dp == NULL )
+    {
+      cerr << "WARNING: could not read directory " << dir << endl;
+      return;
+    }
+
+  struct dirent * de;
+  while ( (de = readdir (dp)) != NULL )
+    {
+      string name = de -> d_name;
+      if ( name . empty( )  ||  name[0] == '.' )
+        continue;
+
+      string path = dir + '/' + name;
+      struct stat st;
+      if ( stat (path . c_str( ), &st) != 0 )
+        continue;
+
+      if ( S_ISDIR (st . st_mode) )
+        FindTraces (path, traces);
+      else if ( S_ISREG (st . st_mode) )
+        {
+          if ( traces . find (name) != traces . end( ) )
+            cerr << "WARNING: " << path << " shadows "
+                 << traces [name] << ", using the first" << endl;
+          else
+            traces [name] = path;
+        }
+    }
+
+  closedir (dp);
+}
+
+
+//----------------------------------------------------- LoadTrace --------------
+//! \brief Reads a trace file, converted to ZTR with -z
+//!
+bool LoadTrace (const string & path, string & data)
+{
+#ifdef IOLIB_ZTR
+  if ( OPT_ZTR )
+    {
+      Read * read = read_reading ((char *) path . c_str( ), TT_ANY);
+      if ( read == NULLRead )
+        return false;
+
+      ztr_t * ztr = read2ztr (read);
+      FILE * fp = tmpfile( );
+      bool ok = ztr != NULL  &&  fp != NULL  &&
+        compress_ztr (ztr, 2) == 0  &&  fwrite_ztr (fp, ztr) == 0;
+
+      if ( ok )
+        {
+          data . resize (ftell (fp));
+          rewind (fp);
+          ok = data . empty( )  ||  fread (&data[0], data . size( ), 1, fp) == 1;
+        }
+
+      if ( fp != NULL )
+        fclose (fp);
+      if ( ztr != NULL )
+        delete_ztr (ztr);
+      read_deallocate (read);
+
+      return ok;
+    }
+#endif
+
+  ifstream in (path . c_str( ), ios::in | ios::binary);
+  if ( ! in )
+    return false;
+
+  ostringstream buf;
+  buf << in . rdbuf( );
+  data = buf . str( );
+
+  return true;
+}
+
+
+//========================================================= Function Defs ====//
+int main (int argc, char ** argv)
+{
+  int exitcode = EXIT_SUCCESS;
+  map<string, string> traces;
+  set<string> eids;
+  long int cntw = 0, cntf = 0;
+
+  //-- Parse the command line arguments
+  ParseArgs (argc, argv);
+
+  //-- BEGIN: MAIN EXCEPTION CATCH
+  try {
+
+    if ( ! OPT_EIDFile . empty( ) )
+      {
+        ifstream file (OPT_EIDFile . c_str( ));
+        string eid;
+
+        if ( ! file )
+          AMOS_THROW_IO ("Couldn't open EID File " + OPT_EIDFile);
+
+        while ( file >> eid )
+          eids . insert (eid);
+      }
+
+    for ( vector<string>::const_iterator
+            di = OPT_TraceDirs . begin( ); di != OPT_TraceDirs . end( ); ++ di )
+      FindTraces (*di, traces);
+
+    TraceArchive_t archive;
+    string data;
+
+    archive . create (OPT_ArchiveName);
+
+    for ( map<string, string>::const_iterator
+            ti = traces . begin( ); ti != traces . end( ); ++ ti )
+      {
+        if ( ! eids . empty( )  &&  eids . find (ti -> first) == eids . end( ) )
+          continue;
+
+        if ( ! LoadTrace (ti -> second, data) )
+          {
+            cerr << "WARNING: could not read trace " << ti -> second
+                 << ", skipped" << endl;
+            cntf ++;
+            continue;
+          }
+
+        archive . append (ti -> first, data . data( ), data . size( ));
+        cntw ++;
+      }
+
+    archive . close( );
+  }
+  catch (const Exception_t & e) {
+    cerr << "FATAL: " << e . what( ) << endl
+         << "  there has been a fatal error, abort" << endl;
+    exitcode = EXIT_FAILURE;
+  }
+  //-- END: MAIN EXCEPTION CATCH
+
+  cerr << "Traces found: " << traces . size( ) << endl
+       << "Traces written: " << cntw << endl
+       << "Traces unreadable: " << cntf << endl;
+
+  return exitcode;
+}
+
+
+
+
+//------------------------------------------------------------- ParseArgs ----//
+void ParseArgs (int argc, char ** argv)
+{
+  int ch, errflg = 0;
+  optarg = NULL;
+
+  while ( !errflg && ((ch = getopt (argc, argv, "hE:z")) != EOF) )
+    switch (ch)
+      {
+        case 'E': OPT_EIDFile = optarg; break;
+
+        case 'z':
+#ifdef IOLIB_ZTR
+          OPT_ZTR = true;
+#else
+          cerr << "ERROR: ZTR conversion needs zlib, which was not found at configure time" << endl;
+          errflg ++;
+#endif
+          break;
+
+        case 'h':
+          PrintHelp (argv[0]);
+          exit (EXIT_SUCCESS);
+          break;
+
+        default:
+          errflg ++;
+      }
+
+  if ( errflg > 0 || argc - optind < 2 )
+    {
+      PrintUsage (argv[0]);
+      cerr << "Try '" << argv[0] << " -h' for more information.\n";
+      exit (EXIT_FAILURE);
+    }
+
+  OPT_ArchiveName = argv [optind ++];
+  while ( optind < argc )
+    OPT_TraceDirs . push_back (argv [optind ++]);
+}
+
+
+
+
+//------------------------------------------------------------- PrintHelp ----//
+void PrintHelp (const char * s)
+{
+  PrintUsage (s);
+
+    cerr << "\n.DESCRIPTION.\n"
+         << "  Packs the chromatogram files found below the trace directories,\n"
+         << "  one per read and named by read EID, into a single indexed trace\n"
+         << "  archive. hawkeye reads traces from an archive named in its trace\n"
+         << "  path list without searching the directories for every read.\n"
+         << "\n.OPTIONS.\n"
+         << "  -E file       Pack just the traces of the eids listed in file\n"
+         << "  -z            Convert the traces to compressed ZTR\n"
+         << "  -h            Display help information\n"
+         << "\n.KEYWORDS.\n"
+         << "  converters, traces, hawkeye"
+         << endl;
+
+  return;
+}
+
+
+
+
+//------------------------------------------------------------ PrintUsage ----//
+void PrintUsage (const char * s)
+{
+  cerr << "\n.USAGE.\n" << "  " <<  s << "  [options] <archive> <trace dir>...\n";
+  return;
+}
@@ -1,6 +1,7 @@
 #include "ContigFattener.hh"
 #include "ContigUtils.hh"
 #include "AMOS_Foundation.hh"
+#include "align.hh"
 
 using namespace std;
 using namespace AMOS;
@@ -68,7 +69,8 @@ void ContigFattener::extend3Read(ContigSequence * read, int distance)
     }
   }
 
-  recallCons();
+  // Only the extended read's neighbourhood needs new consensus
+  Update_Contig_Reads(m_contig, m_read_bank, vector<ID_t>(1, read->getIID()));
   
   recordExtension(read, distanceExtended, trimLength, 
                   0.0, 0.0, origUContigWidth);
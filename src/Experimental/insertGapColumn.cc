@@ -11,9 +11,13 @@ bool USE_EID = 1;
 
 int main (int argc, char ** argv)
 {
+  bool byiid = (argc == 5 && string(argv[1]) == "-i");
+  if (byiid) { argc--; argv++; }
+
   if (argc != 4)
   {
-    cerr << "Usage: insertgapcontig bankname eid gindex" << endl;
+    cerr << "Usage: insertgapcontig [-i] bankname eid gindex" << endl
+         << "  -i  contig is given by IID instead of EID" << endl;
     return EXIT_FAILURE;
   }
 
@@ -29,7 +33,8 @@ int main (int argc, char ** argv)
   try
   {
     contig_bank.open(bank_name, B_READ|B_WRITE);
-    contig_bank.fetch(contigid, contig);
+    if (byiid) { contig_bank.fetch(ID_t(atoi(contigid.c_str())), contig); }
+    else       { contig_bank.fetch(contigid, contig); }
 
     contig.insertGapColumn(gindex);
 
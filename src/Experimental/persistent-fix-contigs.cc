@@ -4,6 +4,7 @@
 #include "AMOS_Foundation.hh"
 #include "ContigUtils.hh"
 #include "PersistentUtils.hh"
+#include "align.hh"
 #include <sstream>
 
 using namespace AMOS;
@@ -17,6 +18,7 @@ int SCANALL(0);
 int GAPSCLOSED(0);
 int COLLAPSEFIX(0);
 int MARKLOCATIONS(0);
+int UPDATECONS(0);
 
 int VERBOSE(0);
 
@@ -32,6 +34,23 @@ BankStream_t patch_feat(Feature_t::NCODE);
 
 ReadPosLookup read2contigpos;
 
+
+// Realign the reads across the joins of a stitched master contig and
+// recompute consensus there, right join first so the left one keeps
+// its position
+void updateStitchedConsensus(ID_t contigiid, const Range_t & stitchRegion)
+{
+  Contig_t contig;
+  master_contig.fetch(contigiid, contig);
+
+  Update_Contig_Window(contig, master_reads,
+                       stitchRegion.end, stitchRegion.end + 1);
+  Update_Contig_Window(contig, master_reads,
+                       stitchRegion.begin, stitchRegion.begin + 1);
+
+  master_contig.replace(contigiid, contig);
+}
+
 int main (int argc, char ** argv)
 {
   int retval = 0;
@@ -55,6 +74,7 @@ int main (int argc, char ** argv)
 "   -G        Close gaps between contigs\n"
 "   -s        Save results to bank\n"
 "   -S        Do full scan, not just adjacent reads\n"
+"   -u        Recompute consensus across stitched regions (with -s)\n"
 "   -m        Just mark locations of potential events\n";
 "   -v        Be Verbose\n";
 "\n";
@@ -68,6 +88,7 @@ int main (int argc, char ** argv)
     tf->getOptions()->addOptionResult("G",   &CLOSEGAPS);
     tf->getOptions()->addOptionResult("S",   &SCANALL);
     tf->getOptions()->addOptionResult("m",   &MARKLOCATIONS);
+    tf->getOptions()->addOptionResult("u",   &UPDATECONS);
     tf->getOptions()->addOptionResult("v",   &VERBOSE);
     tf->handleStandardOptions();
 
@@ -326,6 +347,8 @@ int main (int argc, char ** argv)
                               masterreads, patchreads, stitchRegion,
                               contig.getIID(), 0, patch1->second.m_contigiid,
                               false, PERFECT_OVL);
+
+                if (UPDATECONS) { updateStitchedConsensus(contig.getIID(), stitchRegion); }
               }
               else if (MARKLOCATIONS)
               {
@@ -530,6 +553,8 @@ int main (int argc, char ** argv)
                                   c1.getIID(), c2.getIID(), patch1->second.m_contigiid,
                                   false, PERFECT_OVL);
 
+                    if (UPDATECONS) { updateStitchedConsensus(c1.getIID(), stitchRegion); }
+
                     master_contig.fetch(c1.getIID(), c1);
                     madestitch = true;
                   }
@@ -4,6 +4,7 @@
 #include "fasta.hh"
 #include "AMOS_Foundation.hh"
 #include "ContigUtils.hh"
+#include "align.hh"
 
 using namespace AMOS;
 using namespace std;
@@ -19,6 +20,7 @@ int main (int argc, char ** argv)
   int patchiid = 0;
   int breakcontig = 0;
   int savetonew = 0;
+  int updatecons = 0;
 
   int retval = 0;
   AMOS_Foundation * tf = NULL;
@@ -44,7 +46,8 @@ int main (int argc, char ** argv)
 "\n"
 "   Usage: stitchContigs [options] master.bnk patch.bnk\n"
 "   -b            Break master contig with patch\n"
-"   -n            Save results to a new contig\n\n"
+"   -n            Save results to a new contig\n"
+"   -u            Recompute consensus across the stitch points\n\n"
 "   -L <seqname>  Leftmost read to start patch\n"
 "   -R <seqname>  Rightmost read to end patch\n\n"
 "   -M <iid>      IID of master contig\n"
@@ -70,6 +73,7 @@ int main (int argc, char ** argv)
 
     tf->getOptions()->addOptionResult("b",   &breakcontig, "BreakContig");
     tf->getOptions()->addOptionResult("n",   &savetonew,   "BreakContig");
+    tf->getOptions()->addOptionResult("u",   &updatecons,  "Update Consensus");
 
     tf->handleStandardOptions();
 
@@ -125,6 +129,20 @@ int main (int argc, char ** argv)
                   masteriid, master2iid, patchiid,
                   savetonew, true);
 
+    if (updatecons)
+    {
+      // Realign the reads across each join, right one first so the
+      // left one keeps its position
+      Contig_t contig;
+      ID_t iid = savetonew ? master_contig.getMaxIID() : masteriid;
+
+      master_contig.fetch(iid, contig);
+      Update_Contig_Window(contig, master_reads,
+                           stitchRegion.end, stitchRegion.end + 1);
+      Update_Contig_Window(contig, master_reads,
+                           stitchRegion.begin, stitchRegion.begin + 1);
+      master_contig.replace(iid, contig);
+    }
 
 
     cout << endl;
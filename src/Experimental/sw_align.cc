@@ -1,5 +1,13 @@
 #include "sw_align.hh"
 
+//-- The SIMD kernel needs x86-64 and a compiler that can build AVX2 code
+//   for single functions, the processor is checked at run time
+#if defined(__x86_64__)  &&  ( defined(__clang__)  ||  __GNUC__ > 4  || \
+    ( __GNUC__ == 4  &&  __GNUC_MINOR__ >= 9 ) )
+#define SW_ALIGN_AVX2
+#include <immintrin.h>
+#endif
+
 
 
 
@@ -8,37 +16,63 @@
 static const int DEFAULT_BREAK_LEN = 200;
 
 //-- Characters used in creating the alignment edit matrix, DO NOT ALTER!
-static const char DELETE = 0;
-static const char INSERT = 1;
-static const char MATCH  = 2;
-static const char START  = 3;
-static const char NONE   = 4;
+static const int DELETE = 0;
+static const int INSERT = 1;
+static const int MATCH  = 2;
+static const int START  = 3;
+static const int NONE   = 4;
+
+//-- Bytes of diagonal storage per node, see allocDiagonal
+static const long int NODE_SIZE = 4 * sizeof(long int) + 4 * sizeof(char);
 
 
 int _break_len = DEFAULT_BREAK_LEN;
 int _matrix_type = NUCLEOTIDE;
+int _kernel_type = _simdAvailable( ) ? SIMD_KERNEL : SCALAR_KERNEL;
 
 
 
 
 
 //----------------------------------------- Private Function Declarations ----//
+static void allocDiagonal
+     (Diagonal & Diag, long int Ds);
+
+
 static void generateDelta
      (const Diagonal * Diag, long int FinishCt, long int FinishCDi,
       long int N, vector<long int> & Delta);
 
 
-static inline Score * maxScore
-     (Score S[3]);
+static inline void maxScore
+     (Diagonal & Diag, long int Di);
 
 
-static inline long int scoreMatch
-     (const Diagonal Diag, long int Dct, long int CDi, 
+static void scoreDiagonal
+     (Diagonal * Diag, long int Dct, long int PDi, long int PPDi,
       const char * A, const char * B, long int N, unsigned int m_o);
 
 
+#ifdef SW_ALIGN_AVX2
+static void scoreDiagonalSIMD
+     (Diagonal * Diag, long int Dct, long int PDi, long int PPDi,
+      const char * A, const char * B, long int N, unsigned int m_o);
+#endif
+
+
 static inline void scoreEdit
-     (Score & curr, const long int del, const long int ins, const long int mat);
+     (long int & value, char & used,
+      const long int del, const long int ins, const long int mat);
+
+
+static inline long int scoreMatch
+     (long int Dct, long int CDi,
+      const char * A, const char * B, long int N, unsigned int m_o);
+
+
+static inline void scoreNode
+     (Diagonal * Diag, long int Dct, long int Di, long int PDi, long int PPDi,
+      const char * A, const char * B, long int N, unsigned int m_o);
 
 
 
@@ -75,12 +109,10 @@ bool _alignEngine
                                                   // max score difference
   long int max_diff = GOOD_SCORE [getMatrixType( )] * _break_len;
 
-  long int CDi;              // conceptual diagonal index (not relating to mem)
   long int Dct, Di;          // diagonal counter, actual diagonal index
   long int PDct, PPDct;      // previous diagonal and prev prev diagonal
   long int PDi, PPDi;        // previous diagonal index and prev prev diag index
-  long int Ds, PDs, PPDs;    // diagonal size, prev, prev prev diagonal size
-                             //     where 'size' = rbound - lbound + 1
+  long int Ds;               // diagonal size, where 'size' = rbound - lbound + 1
   long int Ll = 100;         // capacity of the diagonal list
   long int Dl = 2;           // current conceptual diagonal length
   long int lbound = 0;       // current diagonal left(lower) node bound index
@@ -93,6 +125,10 @@ bool _alignEngine
 
   int Iadj, Dadj, Madj;      // insert, delete and match adjust values
 
+                             // node scoring kernel for this alignment
+  void (* scoreKernel) (Diagonal *, long int, long int, long int,
+			const char *, const char *, long int, unsigned int);
+
 #ifdef _DEBUG_VERBOSE
   long int MaxL = 0;             // biggest diagonal seen
   long int TrimCt = 0;           // counter of nodes trimmed
@@ -115,6 +151,13 @@ bool _alignEngine
       M = Bstart - Bend + 1;
     }
 
+  //-- Pick the node scoring kernel, both give identical results
+  scoreKernel = scoreDiagonal;
+#ifdef SW_ALIGN_AVX2
+  if ( _kernel_type == SIMD_KERNEL )
+    scoreKernel = scoreDiagonalSIMD;
+#endif
+
   //-- Initialize the diagonals list
   Diag = (Diagonal *) Safe_malloc ( Ll * sizeof(Diagonal) );
 
@@ -122,15 +165,16 @@ bool _alignEngine
   Diag[0] . lbound = lbound;
   Diag[0] . rbound = rbound ++;
 
-  Diag[0] . I = (Node *) Safe_malloc ( 1 * sizeof(Node) );
-  Diag[0] . I[0] . S[DELETE] . value = min_score;
-  Diag[0] . I[0] . S[INSERT] . value = min_score;
-  Diag[0] . I[0] . S[MATCH] . value = 0;
-  Diag[0] . I[0] . max = Diag[0] . I[0] . S + MATCH;
+  allocDiagonal (Diag[0], 1);
+  Diag[0] . value[DELETE][0] = min_score;
+  Diag[0] . value[INSERT][0] = min_score;
+  Diag[0] . value[MATCH][0] = 0;
+  Diag[0] . best[0] = 0;
+  Diag[0] . max[0] = MATCH;
 
-  Diag[0] . I[0] . S[DELETE] . used = NONE;
-  Diag[0] . I[0] . S[INSERT] . used = NONE;
-  Diag[0] . I[0] . S[MATCH] . used = START;
+  Diag[0] . used[DELETE][0] = NONE;
+  Diag[0] . used[INSERT][0] = NONE;
+  Diag[0] . used[MATCH][0] = START;
 
   L = N < M ? N : M;
 
@@ -153,8 +197,7 @@ bool _alignEngine
 
       //-- malloc space for the edit char and score nodes
       Ds = rbound - lbound + 1;
-      Diag[Dct] . I = (Node *) Safe_malloc
-	( Ds * sizeof(Node) );
+      allocDiagonal (Diag[Dct], Ds);
 
 #ifdef _DEBUG_VERBOSE
       //-- Keep count of trimmed and calculated nodes
@@ -179,7 +222,6 @@ bool _alignEngine
       
       //-- Set parent diagonal values
       PDct = Dct - 1;
-      PDs = Diag[PDct] . rbound - Diag[PDct] . lbound + 1;
       PDi = lbound + Dadj;
       PDi = PDi - Diag[PDct] . lbound;
 
@@ -187,100 +229,27 @@ bool _alignEngine
       PPDct = Dct - 2;
       if ( PPDct >= 0 )
 	{
-	  PPDs = Diag[PPDct] . rbound - Diag[PPDct] . lbound + 1;
 	  PPDi = lbound + Madj;
 	  PPDi = PPDi - Diag[PPDct] . lbound;
 	}
       else
-	PPDi = PPDs = 0;
+	PPDi = 0;
 
       //-- If forced alignment, don't keep track of global max
       if ( m_o & FORCED_BIT )
 	high_score = min_score;
 
-      //-- **START** of internal node scoring loop
       //-- Calculate scores for every node (within bounds) for diagonal Dct
-      for ( CDi = lbound; CDi <= rbound; CDi ++ )
-	{
-	  //-- Set the index (in memory) of current node and clear score
-	  Di = CDi - Diag[Dct] . lbound;
-
-	  //-- Calculate DELETE score
-	  if ( PDi >= 0  &&  PDi < PDs )
-	    scoreEdit
-	      (Diag[Dct] . I[Di] . S[DELETE],
-	       Diag[PDct] . I[PDi] . S[DELETE] . used == NONE ?
-	       Diag[PDct] . I[PDi] . S[DELETE] . value :
-	       Diag[PDct] . I[PDi] . S[DELETE] . value +
-	       CONT_GAP_SCORE [_matrix_type],
-	       Diag[PDct] . I[PDi] . S[INSERT] . used == NONE ?
-	       Diag[PDct] . I[PDi] . S[INSERT] . value :
-	       Diag[PDct] . I[PDi] . S[INSERT] . value +
-	       OPEN_GAP_SCORE [_matrix_type],
-	       Diag[PDct] . I[PDi] . S[MATCH]  . used == NONE ?
-	       Diag[PDct] . I[PDi] . S[MATCH]  . value :
-	       Diag[PDct] . I[PDi] . S[MATCH]  . value +
-	       OPEN_GAP_SCORE [_matrix_type]);
-	  else
-	    {
-	      Diag[Dct] . I[Di] . S[DELETE] . value = min_score;
-	      Diag[Dct] . I[Di] . S[DELETE] . used = NONE;
-	    }
+      scoreKernel (Diag, Dct, PDi, PPDi, A, B, N, m_o);
 
-	  PDi ++;
-
-	  //-- Calculate INSERT score
-	  if ( PDi >= 0  &&  PDi < PDs )
-	    scoreEdit
-	      (Diag[Dct] . I[Di] . S[INSERT],
-	       Diag[PDct] . I[PDi] . S[DELETE] . used == NONE ?
-	       Diag[PDct] . I[PDi] . S[DELETE] . value :
-	       Diag[PDct] . I[PDi] . S[DELETE] . value +
-	       OPEN_GAP_SCORE [_matrix_type],
-	       Diag[PDct] . I[PDi] . S[INSERT] . used == NONE ?
-	       Diag[PDct] . I[PDi] . S[INSERT] . value :
-	       Diag[PDct] . I[PDi] . S[INSERT] . value +
-	       CONT_GAP_SCORE [_matrix_type],
-	       Diag[PDct] . I[PDi] . S[MATCH]  . used == NONE ?
-	       Diag[PDct] . I[PDi] . S[MATCH]  . value :
-	       Diag[PDct] . I[PDi] . S[MATCH]  . value +
-	       OPEN_GAP_SCORE [_matrix_type]);
-	  else
-	    {
-	      Diag[Dct] . I[Di] . S[INSERT] . value = min_score;
-	      Diag[Dct] . I[Di] . S[INSERT] . used = NONE;
-	    }
-
-	  //-- Calculate MATCH/MIS-MATCH score
-	  if ( PPDi >= 0  &&  PPDi < PPDs )
-	    {
-	      scoreEdit
-		(Diag[Dct] . I[Di] . S[MATCH],
-		 Diag[PPDct] . I[PPDi] . S[DELETE] . value,
-		 Diag[PPDct] . I[PPDi] . S[INSERT] . value,
-		 Diag[PPDct] . I[PPDi] . S[MATCH]  . value);
-	      Diag[Dct] . I[Di] . S[MATCH] . value +=
-		scoreMatch (Diag[Dct], Dct, CDi, A, B, N, m_o);
-	    }
-	  else
-	    {
-	      Diag[Dct] . I[Di] . S[MATCH] . value = min_score;
-	      Diag[Dct] . I[Di] . S[MATCH] . used = NONE;
-	    }
-
-	  PPDi ++;
-
-	  Diag[Dct] . I[Di] . max = maxScore (Diag[Dct] . I[Di] . S);
-
-	  //-- Reset high_score if new global max was found
-	  if ( Diag[Dct] . I[Di] . max->value >= high_score )
-	    {
-	      high_score = Diag[Dct] . I[Di] . max->value;
-	      FinishCt = Dct;
-	      FinishCDi = CDi;
-	    }
-	}
-      //-- **END** of internal node scoring loop
+      //-- Reset high_score if new global max was found
+      for ( Di = 0; Di < Ds; Di ++ )
+	if ( Diag[Dct] . best[Di] >= high_score )
+	  {
+	    high_score = Diag[Dct] . best[Di];
+	    FinishCt = Dct;
+	    FinishCDi = lbound + Di;
+	  }
 
 
       //-- Calculate max non-optimal score
@@ -290,9 +259,9 @@ bool _alignEngine
 	    {
 	      if ( lbound == 0 )
 		{
-		  if ( Diag[Dct] . I[0] . max->value >= xhigh_score )
+		  if ( Diag[Dct] . best[0] >= xhigh_score )
 		    {
-		      xhigh_score = Diag[Dct] . I[0] . max->value;
+		      xhigh_score = Diag[Dct] . best[0];
 		      xFinishCt = Dct;
 		      xFinishCDi = 0;
 		    }
@@ -302,11 +271,9 @@ bool _alignEngine
 	    {
 	      if ( rbound == M )
 		{
-		  if ( Diag[Dct] . I[M-Diag[Dct].lbound] .
-		       max->value >= xhigh_score )
+		  if ( Diag[Dct] . best[M-Diag[Dct].lbound] >= xhigh_score )
 		    {
-		      xhigh_score = Diag[Dct] . I[M-Diag[Dct].lbound] .
-			max->value;
+		      xhigh_score = Diag[Dct] . best[M-Diag[Dct].lbound];
 		      xFinishCt = Dct;
 		      xFinishCDi = M;
 		    }
@@ -317,20 +284,20 @@ bool _alignEngine
 
       //-- If in extender modus operandi, free soon to be greatgrandparent diag
       if ( m_o & SEARCH_BIT  &&  Dct > 1 )
-	free ( Diag[PPDct] . I );
+	free ( Diag[PPDct] . value[DELETE] );
 
 
       //-- Trim hopeless diagonal nodes
       for ( Di = 0; Di < Ds; Di ++ )
 	{
-	  if ( high_score - Diag[Dct] . I[Di] . max->value > max_diff )
+	  if ( high_score - Diag[Dct] . best[Di] > max_diff )
 	    lbound ++;
 	  else
 	    break;
 	}
       for ( Di = Ds - 1; Di >= 0; Di -- )
 	{
-	  if ( high_score - Diag[Dct] . I[Di] . max->value > max_diff )
+	  if ( high_score - Diag[Dct] . best[Di] > max_diff )
 	    rbound --;
 	  else
 	    break;
@@ -393,17 +360,17 @@ bool _alignEngine
   //-- Ouput calculation statistics
   if ( TargetReached )
     fprintf(stderr,"Finish score = %ld : %ld,%ld\n",
-	    Diag[FinishCt] . I[0] . max->value, N, M);
+	    Diag[FinishCt] . best[0], N, M);
   else
     fprintf(stderr,"High score = %ld : %ld,%ld\n", high_score,
 	    labs(Aadj) + 1, labs(Badj) + 1);
   fprintf(stderr, "%ld nodes calculated, %ld nodes trimmed\n", CalcCt, TrimCt);
   if ( m_o & DIRECTION_BIT )
     fprintf(stderr, "%ld bytes used\n",
-	    (long int)sizeof(Diagonal) * Dct + (long int)sizeof(Node) * CalcCt);
+	    (long int)sizeof(Diagonal) * Dct + NODE_SIZE * CalcCt);
   else
     fprintf(stderr, "%ld bytes used\n",
-	    ((long int)sizeof(Diagonal) + (long int)sizeof(Node) * MaxL) * 2);
+	    ((long int)sizeof(Diagonal) + NODE_SIZE * MaxL) * 2);
 #endif
 
 
@@ -413,7 +380,7 @@ bool _alignEngine
 
   //-- Free the scoring and edit spaces remaining
   for ( Di = m_o & SEARCH_BIT ? Dct - 1 : 0; Di <= Dct; Di ++ )
-    free ( Diag[Di] . I );
+    free ( Diag[Di] . value[DELETE] );
   free ( Diag );
 
   return TargetReached;
@@ -422,6 +389,51 @@ bool _alignEngine
 
 
 
+bool _simdAvailable
+     ( )
+
+     //  Returns true if the SIMD kernel was compiled in and the processor
+     //  supports it
+
+{
+#ifdef SW_ALIGN_AVX2
+  __builtin_cpu_init ( );
+  return __builtin_cpu_supports ("avx2");
+#else
+  return false;
+#endif
+}
+
+
+
+
+static void allocDiagonal
+     (Diagonal & Diag, long int Ds)
+
+     //  Diag is the diagonal to allocate node storage for
+     //  Ds is the number of nodes on Diag
+     //  Every array of Diag is carved from a single block of memory, so
+     //  freeing Diag . value[DELETE] releases them all
+
+{
+  long int * Lp = (long int *) Safe_malloc ( Ds * NODE_SIZE );
+  char * Cp = (char *) (Lp + 4 * Ds);
+
+  Diag . value[DELETE] = Lp;
+  Diag . value[INSERT] = Lp + Ds;
+  Diag . value[MATCH]  = Lp + 2 * Ds;
+  Diag . best = Lp + 3 * Ds;
+  Diag . used[DELETE] = Cp;
+  Diag . used[INSERT] = Cp + Ds;
+  Diag . used[MATCH]  = Cp + 2 * Ds;
+  Diag . max = Cp + 3 * Ds;
+
+  return;
+}
+
+
+
+
 static void generateDelta
      (const Diagonal * Diag, long int FinishCt, long int FinishCDi,
       long int N, vector<long int> & Delta)
@@ -451,7 +463,7 @@ static void generateDelta
   long int PSize = 100;     // capacity of the path space
   char * Reverse_Path;       // path space
 
-  Score curr_score;
+  char curr_used;
   char edit;
 
   //-- malloc space for the edit path
@@ -459,7 +471,7 @@ static void generateDelta
 
   //-- Which Score index is the maximum value in? Store in edit
   Di = CDi - Diag[Dct] . lbound;
-  edit = Diag[Dct] . I[Di] . max - Diag[Dct] . I[Di] . S;
+  edit = Diag[Dct] . max[Di];
 
   //-- Walk the path backwards through the edit space
   while ( Dct >= 0 )
@@ -473,7 +485,7 @@ static void generateDelta
 	}
 
       Di = CDi - Diag[Dct] . lbound;
-      curr_score = Diag[Dct] . I[Di] . S[edit];
+      curr_used = Diag[Dct] . used[(int) edit][Di];
 
       Reverse_Path[Pi ++] = edit;
       switch ( edit )
@@ -497,7 +509,7 @@ static void generateDelta
 	  exit ( EXIT_FAILURE );
 	}
 
-      edit = curr_score . used;
+      edit = curr_used;
     }
 
   //-- Generate the delta information
@@ -534,30 +546,230 @@ static void generateDelta
 
 
 
-static inline Score * maxScore
-     (Score S[3])
+static inline void maxScore
+     (Diagonal & Diag, long int Di)
 
-     //  Return a pointer to the maximum score in the score array
+     //  Record which of the three scores of node Di is the maximum, and
+     //  its value
 
 {
-  if ( S[DELETE] . value > S[INSERT] . value )
+  const long int del = Diag . value[DELETE][Di];
+  const long int ins = Diag . value[INSERT][Di];
+  const long int mat = Diag . value[MATCH][Di];
+
+  if ( del > ins )
     {
-      if ( S[DELETE] . value > S[MATCH] . value )
-	return S + DELETE;
+      if ( del > mat )
+	Diag . max[Di] = DELETE;
       else
-	return S + MATCH;
+	Diag . max[Di] = MATCH;
     }
-  else if ( S[INSERT] . value > S[MATCH] . value )
-    return S + INSERT;
+  else if ( ins > mat )
+    Diag . max[Di] = INSERT;
   else
-    return S + MATCH;
+    Diag . max[Di] = MATCH;
+
+  Diag . best[Di] = Diag . value[(int) Diag . max[Di]][Di];
+
+  return;
 }
 
 
 
 
+static void scoreDiagonal
+     (Diagonal * Diag, long int Dct, long int PDi, long int PPDi,
+      const char * A, const char * B, long int N, unsigned int m_o)
+
+     //  Diag is the list of diagonals that compose the edit matrix
+     //  Dct is the diagonal to score, its bounds already set
+     //  PDi and PPDi are the indices on the parent and grandparent
+     //      diagonals of the first node's DELETE and MATCH parents
+     //  A, B, N and m_o are as for scoreMatch
+     //  Scores every node of Diag[Dct] one at a time
+
+{
+  long int Di;
+  long int Ds = Diag[Dct] . rbound - Diag[Dct] . lbound + 1;
+
+  for ( Di = 0; Di < Ds; Di ++ )
+    scoreNode (Diag, Dct, Di, PDi + Di, PPDi + Di, A, B, N, m_o);
+
+  return;
+}
+
+
+
+
+#ifdef SW_ALIGN_AVX2
+__attribute__ ((target ("avx2")))
+static inline __m256i loadScore4
+     (const Diagonal & Diag, int edit, long int Di, __m256i gap)
+
+     //  Load four consecutive scores of edit type 'edit' starting at node
+     //  Di, adding 'gap' to those that were extended from a valid edit
+
+{
+  int used;
+  __m256i value, none;
+
+  value = _mm256_loadu_si256 ((const __m256i *) (Diag . value[edit] + Di));
+  memcpy (&used, Diag . used[edit] + Di, sizeof(used));
+  none = _mm256_cmpeq_epi64
+    (_mm256_cvtepu8_epi64 (_mm_cvtsi32_si128 (used)),
+     _mm256_set1_epi64x (NONE));
+
+  return _mm256_add_epi64 (value, _mm256_andnot_si256 (none, gap));
+}
+
+
+
+
+__attribute__ ((target ("avx2")))
+static inline __m256i scoreEdit4
+     (__m256i & used, __m256i del, __m256i ins, __m256i mat)
+
+     //  Four lane version of scoreEdit, returns the maximal scores and sets
+     //  'used' to the edit each came from, with the same tie breaking
+
+{
+  __m256i dgi = _mm256_cmpgt_epi64 (del, ins);
+  __m256i dgm = _mm256_cmpgt_epi64 (del, mat);
+  __m256i igm = _mm256_cmpgt_epi64 (ins, mat);
+  __m256i isd = _mm256_and_si256 (dgi, dgm);
+  __m256i isi = _mm256_andnot_si256 (dgi, igm);
+
+  //-- Lanes are all ones when true, so MATCH - 1 = INSERT, MATCH - 2 = DELETE
+  used = _mm256_add_epi64
+    (_mm256_set1_epi64x (MATCH),
+     _mm256_add_epi64 (isi, _mm256_add_epi64 (isd, isd)));
+
+  return _mm256_blendv_epi8 (_mm256_blendv_epi8 (mat, ins, isi), del, isd);
+}
+
+
+
+
+__attribute__ ((target ("avx2")))
+static inline void storeEdit4
+     (char * dst, __m256i used)
+
+     //  Store the four edit characters held in the lanes of 'used'
+
+{
+  long int lanes [4];
+
+  _mm256_storeu_si256 ((__m256i *) lanes, used);
+  dst[0] = lanes[0];
+  dst[1] = lanes[1];
+  dst[2] = lanes[2];
+  dst[3] = lanes[3];
+
+  return;
+}
+
+
+
+
+__attribute__ ((target ("avx2")))
+static void scoreDiagonalSIMD
+     (Diagonal * Diag, long int Dct, long int PDi, long int PPDi,
+      const char * A, const char * B, long int N, unsigned int m_o)
+
+     //  Same as scoreDiagonal, but scores four nodes at a time with AVX2.
+     //  Nodes of an anti-diagonal only depend on the two previous
+     //  diagonals, so they are independent of each other. Nodes near the
+     //  diagonal bounds, missing one of their parents, are scored singly
+
+{
+  Diagonal & Curr = Diag[Dct];
+  const Diagonal & Prev = Diag[Dct - 1];
+  const Diagonal * Gran = Dct >= 2 ? Diag + Dct - 2 : NULL;
+
+  long int Ds = Curr . rbound - Curr . lbound + 1;
+  long int PDs = Prev . rbound - Prev . lbound + 1;
+  long int PPDs = Gran ? Gran -> rbound - Gran -> lbound + 1 : 0;
+  long int Di, lo, hi, p, pp;
+  long int match [4];
+
+  __m256i open = _mm256_set1_epi64x (OPEN_GAP_SCORE [_matrix_type]);
+  __m256i cont = _mm256_set1_epi64x (CONT_GAP_SCORE [_matrix_type]);
+  __m256i del, ins, mat, used;
+
+  //-- Nodes [lo, hi) have their DELETE, INSERT and MATCH parents in bounds
+  lo = 0;
+  if ( -PDi > lo )
+    lo = -PDi;
+  if ( -PPDi > lo )
+    lo = -PPDi;
+  hi = Ds;
+  if ( PDs - 1 - PDi < hi )
+    hi = PDs - 1 - PDi;
+  if ( PPDs - PPDi < hi )
+    hi = PPDs - PPDi;
+  if ( hi < lo )
+    hi = lo;
+
+  for ( Di = 0; Di < lo; Di ++ )
+    scoreNode (Diag, Dct, Di, PDi + Di, PPDi + Di, A, B, N, m_o);
+
+  for ( ; Di + 4 <= hi; Di += 4 )
+    {
+      p = PDi + Di;
+      pp = PPDi + Di;
+
+      //-- Calculate DELETE score
+      del = scoreEdit4 (used,
+			loadScore4 (Prev, DELETE, p, cont),
+			loadScore4 (Prev, INSERT, p, open),
+			loadScore4 (Prev, MATCH, p, open));
+      _mm256_storeu_si256 ((__m256i *) (Curr . value[DELETE] + Di), del);
+      storeEdit4 (Curr . used[DELETE] + Di, used);
+
+      //-- Calculate INSERT score
+      ins = scoreEdit4 (used,
+			loadScore4 (Prev, DELETE, p + 1, open),
+			loadScore4 (Prev, INSERT, p + 1, cont),
+			loadScore4 (Prev, MATCH, p + 1, open));
+      _mm256_storeu_si256 ((__m256i *) (Curr . value[INSERT] + Di), ins);
+      storeEdit4 (Curr . used[INSERT] + Di, used);
+
+      //-- Calculate MATCH/MIS-MATCH score
+      match[0] = scoreMatch (Dct, Curr . lbound + Di, A, B, N, m_o);
+      match[1] = scoreMatch (Dct, Curr . lbound + Di + 1, A, B, N, m_o);
+      match[2] = scoreMatch (Dct, Curr . lbound + Di + 2, A, B, N, m_o);
+      match[3] = scoreMatch (Dct, Curr . lbound + Di + 3, A, B, N, m_o);
+      mat = scoreEdit4 (used,
+			_mm256_loadu_si256
+			((const __m256i *) (Gran -> value[DELETE] + pp)),
+			_mm256_loadu_si256
+			((const __m256i *) (Gran -> value[INSERT] + pp)),
+			_mm256_loadu_si256
+			((const __m256i *) (Gran -> value[MATCH] + pp)));
+      mat = _mm256_add_epi64
+	(mat, _mm256_loadu_si256 ((const __m256i *) match));
+      _mm256_storeu_si256 ((__m256i *) (Curr . value[MATCH] + Di), mat);
+      storeEdit4 (Curr . used[MATCH] + Di, used);
+
+      //-- maxScore has the same tie breaking as scoreEdit
+      _mm256_storeu_si256 ((__m256i *) (Curr . best + Di),
+			   scoreEdit4 (used, del, ins, mat));
+      storeEdit4 (Curr . max + Di, used);
+    }
+
+  for ( ; Di < Ds; Di ++ )
+    scoreNode (Diag, Dct, Di, PDi + Di, PPDi + Di, A, B, N, m_o);
+
+  return;
+}
+#endif
+
+
+
+
 static inline void scoreEdit
-     (Score & curr, const long int del, const long int ins, const long int mat)
+     (long int & value, char & used,
+      const long int del, const long int ins, const long int mat)
 
      //  Assign current edit a maximal score using either del, ins or mat
 
@@ -566,24 +778,24 @@ static inline void scoreEdit
     {
       if ( del > mat )
 	{
-	  curr.value = del;
-	  curr.used = DELETE;
+	  value = del;
+	  used = DELETE;
 	}
       else
 	{
-	  curr.value = mat;
-	  curr.used = MATCH;
+	  value = mat;
+	  used = MATCH;
 	}
     }
   else if ( ins > mat )
     {
-      curr.value = ins;
-      curr.used = INSERT;
+      value = ins;
+      used = INSERT;
     }
   else
     {
-      curr.value = mat;
-      curr.used = MATCH;
+      value = mat;
+      used = MATCH;
     }
 
   return;
@@ -593,20 +805,19 @@ static inline void scoreEdit
 
 
 static inline long int scoreMatch
-     (const Diagonal Diag, long int Dct, long int CDi, 
+     (long int Dct, long int CDi,
       const char * A, const char * B, long int N, unsigned int m_o)
 
-     //  Diag is the single diagonal that contains the node to be scored
-     //  Dct is Diag's diagonal index in the edit matrix
-     //  CDi is the conceptual node to be scored in Diag
+     //  Dct is the diagonal index in the edit matrix of the node to be scored
+     //  CDi is the conceptual node to be scored in diagonal Dct
      //  A and B are the alignment sequences
      //  N is the alignment target index in A
      //  m_o is the modus operandi of the alignment:
      //      FORWARD_ALIGN, FORWARD_SEARCH, BACKWARD_SEARCH
 
 {
-  static int Dir;
-  static char Ac, Bc;
+  int Dir;
+  char Ac, Bc;
 
   //-- 1 for forward, -1 for reverse
   Dir = m_o & DIRECTION_BIT ? 1 : -1;
@@ -630,3 +841,87 @@ static inline long int scoreMatch
 
   return MATCH_SCORE [_matrix_type] [toupper(Ac) - 'A'] [toupper(Bc) - 'A'];
 }
+
+
+
+
+static inline void scoreNode
+     (Diagonal * Diag, long int Dct, long int Di, long int PDi, long int PPDi,
+      const char * A, const char * B, long int N, unsigned int m_o)
+
+     //  Diag is the list of diagonals that compose the edit matrix
+     //  Dct is the diagonal containing the node to be scored
+     //  Di is the (in memory) index of the node on Dct
+     //  PDi and PPDi are the indices of its DELETE parent on Dct - 1 and
+     //      MATCH parent on Dct - 2, its INSERT parent is PDi + 1
+     //  A, B, N and m_o are as for scoreMatch
+
+{
+  Diagonal & Curr = Diag[Dct];
+  const Diagonal & Prev = Diag[Dct - 1];
+  long int PDs = Prev . rbound - Prev . lbound + 1;
+  long int PPDs = Dct >= 2 ? Diag[Dct - 2] . rbound - Diag[Dct - 2] . lbound + 1 : 0;
+
+  //-- Calculate DELETE score
+  if ( PDi >= 0  &&  PDi < PDs )
+    scoreEdit
+      (Curr . value[DELETE][Di], Curr . used[DELETE][Di],
+       Prev . used[DELETE][PDi] == NONE ?
+       Prev . value[DELETE][PDi] :
+       Prev . value[DELETE][PDi] + CONT_GAP_SCORE [_matrix_type],
+       Prev . used[INSERT][PDi] == NONE ?
+       Prev . value[INSERT][PDi] :
+       Prev . value[INSERT][PDi] + OPEN_GAP_SCORE [_matrix_type],
+       Prev . used[MATCH][PDi]  == NONE ?
+       Prev . value[MATCH][PDi] :
+       Prev . value[MATCH][PDi] + OPEN_GAP_SCORE [_matrix_type]);
+  else
+    {
+      Curr . value[DELETE][Di] = -1 * LONG_MAX;
+      Curr . used[DELETE][Di] = NONE;
+    }
+
+  PDi ++;
+
+  //-- Calculate INSERT score
+  if ( PDi >= 0  &&  PDi < PDs )
+    scoreEdit
+      (Curr . value[INSERT][Di], Curr . used[INSERT][Di],
+       Prev . used[DELETE][PDi] == NONE ?
+       Prev . value[DELETE][PDi] :
+       Prev . value[DELETE][PDi] + OPEN_GAP_SCORE [_matrix_type],
+       Prev . used[INSERT][PDi] == NONE ?
+       Prev . value[INSERT][PDi] :
+       Prev . value[INSERT][PDi] + CONT_GAP_SCORE [_matrix_type],
+       Prev . used[MATCH][PDi]  == NONE ?
+       Prev . value[MATCH][PDi] :
+       Prev . value[MATCH][PDi] + OPEN_GAP_SCORE [_matrix_type]);
+  else
+    {
+      Curr . value[INSERT][Di] = -1 * LONG_MAX;
+      Curr . used[INSERT][Di] = NONE;
+    }
+
+  //-- Calculate MATCH/MIS-MATCH score
+  if ( PPDi >= 0  &&  PPDi < PPDs )
+    {
+      const Diagonal & Gran = Diag[Dct - 2];
+
+      scoreEdit
+	(Curr . value[MATCH][Di], Curr . used[MATCH][Di],
+	 Gran . value[DELETE][PPDi],
+	 Gran . value[INSERT][PPDi],
+	 Gran . value[MATCH][PPDi]);
+      Curr . value[MATCH][Di] +=
+	scoreMatch (Dct, Curr . lbound + Di, A, B, N, m_o);
+    }
+  else
+    {
+      Curr . value[MATCH][Di] = -1 * LONG_MAX;
+      Curr . used[MATCH][Di] = NONE;
+    }
+
+  maxScore (Curr, Di);
+
+  return;
+}
@@ -71,23 +71,21 @@ static const long int MAX_ALIGNMENT_LENGTH = 10000;
 
 
 
-//------------------------------------------------------ Type Definitions ----//
-struct Score
-{
-  long int value;
-  char used;
-};
+//-- Node scoring kernels, see setKernelType
+static const int SCALAR_KERNEL = 0;
+static const int SIMD_KERNEL = 1;
+
 
-struct Node
-{
-  Score S[3];
-  Score * max;
-};
 
+//------------------------------------------------------ Type Definitions ----//
 struct Diagonal
 {
   long int lbound, rbound;   // left(lower) and right(upper) bounds
-  Node * I;          // the matrix nodes
+  long int * value[3];       // DELETE, INSERT and MATCH score of each node
+  long int * best;           // the maximum of the three scores of each node
+  char * used[3];            // the edit each score was extended from
+  char * max;                // which of the three scores is the maximum
+                             //   all share one block starting at value[0]
 };
 
 
@@ -96,6 +94,7 @@ struct Diagonal
 //--------------------------------------------------------------- Externs ----//
 extern int _break_len;
 extern int _matrix_type;
+extern int _kernel_type;
 
 
 
@@ -108,6 +107,10 @@ bool _alignEngine
       vector<long int> & Delta, unsigned int m_o);
 
 
+bool _simdAvailable
+     ( );
+
+
 
 
 
@@ -292,6 +295,18 @@ inline int getBreakLen
 
 
 
+inline int getKernelType
+     ( )
+
+     //  Returns the current value of _kernel_type
+
+{
+  return _kernel_type;
+}
+
+
+
+
 inline int getMatrixType
      ( )
 
@@ -320,6 +335,27 @@ inline void setBreakLen
 
 
 
+inline void setKernelType
+     (const int Kernel_Type)
+
+     //  Resets the _kernel_type. Both kernels give identical alignments,
+     //  SIMD_KERNEL (the default where supported) is only faster
+
+{
+  if ( Kernel_Type != SCALAR_KERNEL  &&  Kernel_Type != SIMD_KERNEL )
+    fprintf (stderr,
+	     "WARNING: Invalid kernel type %d, ignoring\n", Kernel_Type);
+  else if ( Kernel_Type == SIMD_KERNEL  &&  ! _simdAvailable( ) )
+    fprintf (stderr,
+	     "WARNING: SIMD kernel not supported on this processor, ignoring\n");
+  else
+    _kernel_type = Kernel_Type;
+  return;
+}
+
+
+
+
 inline void setMatrixType
      (const int Matrix_Type)
 
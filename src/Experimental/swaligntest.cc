@@ -0,0 +1,276 @@
+//------------------------------------------------------------------------------
+//         File: swaligntest.cc
+//
+//   Description: Checks that the SIMD and scalar node scoring kernels of
+//               sw_align both give the results of the engine they replaced,
+//              kept in swalignref.cc, on random sequence pairs, and with -b
+//             times all three on long extensions.
+//
+//------------------------------------------------------------------------------
+
+#include "sw_align.hh"
+#include <ctime>
+#include <string>
+using namespace std;
+
+
+
+
+//------------------------------------------------------------- Constants ----//
+static const unsigned int MODES [] =
+  {
+    FORWARD_ALIGN, OPTIMAL_FORWARD_ALIGN, FORCED_FORWARD_ALIGN,
+    FORWARD_SEARCH, OPTIMAL_FORWARD_SEARCH, FORCED_FORWARD_SEARCH,
+    BACKWARD_SEARCH, OPTIMAL_BACKWARD_SEARCH, FORCED_BACKWARD_SEARCH
+  };
+static const int NUM_MODES = sizeof(MODES) / sizeof(MODES[0]);
+
+//-- Passed as the kernel to RunAlign to run the pre-kernel engine
+static const int REFERENCE = -1;
+
+
+
+
+//=============================================================== Globals ====//
+int  OPT_Trials = 2000;           // number of random equivalence trials
+long OPT_Seed = 1;                // random seed
+bool OPT_Bench = false;           // time the kernels instead
+
+
+
+
+//========================================================== Fuction Decs ====//
+struct Result
+{
+  bool rv;
+  long int Aend, Bend;
+  vector<long int> Delta;
+};
+
+static void ParseArgs (int argc, char ** argv);
+static void PrintUsage (const char * s);
+static string RandomSeq (long int len);
+static string Mutate (const string & S, double rate);
+static Result RunAlign
+     (int kernel, const string & A, long int Astart, long int Aend,
+      const string & B, long int Bstart, long int Bend, unsigned int m_o);
+static bool SameResult (const Result & X, const Result & Y);
+
+namespace SWRef {
+bool alignEngine
+     (const char * A0, long int Astart, long int & Aend,
+      const char * B0, long int Bstart, long int & Bend,
+      vector<long int> & Delta, unsigned int m_o);
+}
+
+
+
+
+//========================================================= Function Defs ====//
+int main (int argc, char ** argv)
+{
+  ParseArgs (argc, argv);
+  srand48 (OPT_Seed);
+
+  if ( OPT_Bench )
+    {
+      //-- Time long forced alignments and optimal searches with the
+      //   reference engine and each kernel
+      string A = RandomSeq (MAX_ALIGNMENT_LENGTH);
+      string B = Mutate (A, 0.05);
+      long int Alen = A . length( ) - 1;
+      long int Blen = B . length( ) - 1;
+      int kernel, k;
+      clock_t t;
+
+      setBreakLen (MAX_ALIGNMENT_LENGTH);
+      for ( kernel = REFERENCE; kernel <= SIMD_KERNEL; kernel ++ )
+	{
+	  if ( kernel == SIMD_KERNEL  &&  ! _simdAvailable( ) )
+	    break;
+	  t = clock( );
+	  for ( k = 0; k < 2; k ++ )
+	    {
+	      RunAlign (kernel, A, 1, Alen, B, 1, Blen, FORCED_FORWARD_ALIGN);
+	      RunAlign (kernel, A, 1, Alen, B, 1, Blen, OPTIMAL_FORWARD_SEARCH);
+	    }
+	  printf ("%s: %.2f seconds\n",
+		  kernel == SIMD_KERNEL ? "SIMD kernel" :
+		  kernel == SCALAR_KERNEL ? "scalar kernel" : "reference",
+		  (double) (clock( ) - t) / CLOCKS_PER_SEC);
+	}
+      return EXIT_SUCCESS;
+    }
+
+  int trial, fails = 0;
+  for ( trial = 0; trial < OPT_Trials; trial ++ )
+    {
+      //-- Random pair, divergence, break length, matrix and mode
+      string A = RandomSeq (1 + lrand48( ) % 600);
+      string B = Mutate (A, drand48( ) * 0.3);
+      long int Alen = A . length( ) - 1;
+      long int Blen = B . length( ) - 1;
+      long int Astart, Aend, Bstart, Bend;
+      unsigned int m_o = MODES [lrand48( ) % NUM_MODES];
+
+      if ( lrand48( ) % 4 == 0 )
+	m_o |= SEQEND_BIT;
+      setBreakLen (1 + lrand48( ) % 300);
+      setMatrixType (lrand48( ) % 4);
+
+      if ( Alen < 2  ||  Blen < 2 )
+	continue;
+      if ( m_o & DIRECTION_BIT )
+	{
+	  Astart = 1 + lrand48( ) % (Alen / 2);
+	  Bstart = 1 + lrand48( ) % (Blen / 2);
+	  Aend = Astart + 1 + lrand48( ) % (Alen - Astart);
+	  Bend = Bstart + 1 + lrand48( ) % (Blen - Bstart);
+	}
+      else
+	{
+	  Astart = Alen - lrand48( ) % (Alen / 2);
+	  Bstart = Blen - lrand48( ) % (Blen / 2);
+	  Aend = 1 + lrand48( ) % (Astart - 1);
+	  Bend = 1 + lrand48( ) % (Bstart - 1);
+	}
+
+      Result R = RunAlign (REFERENCE, A, Astart, Aend, B, Bstart, Bend, m_o);
+      Result S = RunAlign (SCALAR_KERNEL, A, Astart, Aend, B, Bstart, Bend, m_o);
+      Result V = S;
+      if ( _simdAvailable( ) )
+	V = RunAlign (SIMD_KERNEL, A, Astart, Aend, B, Bstart, Bend, m_o);
+
+      if ( ! SameResult (R, S)  ||  ! SameResult (R, V) )
+	{
+	  fprintf (stderr, "FAIL: trial %d mode %#x break %d matrix %d"
+		   " A %ld-%ld B %ld-%ld: reference %d %ld %ld,"
+		   " scalar %d %ld %ld, SIMD %d %ld %ld\n",
+		   trial, m_o, getBreakLen( ), getMatrixType( ),
+		   Astart, Aend, Bstart, Bend, R . rv, R . Aend, R . Bend,
+		   S . rv, S . Aend, S . Bend, V . rv, V . Aend, V . Bend);
+	  fails ++;
+	}
+    }
+
+  if ( ! _simdAvailable( ) )
+    printf ("SIMD kernel not available, only the scalar kernel checked\n");
+
+  printf ("%d of %d trials differ from the reference\n", fails, OPT_Trials);
+  return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+
+
+//------------------------------------------------------------- ParseArgs ----//
+static void ParseArgs (int argc, char ** argv)
+{
+  int ch, errflg = 0;
+  optarg = NULL;
+
+  while ( !errflg && ((ch = getopt (argc, argv, "bhn:s:")) != EOF) )
+    switch (ch)
+      {
+      case 'b': OPT_Bench = true; break;
+      case 'n': OPT_Trials = atoi (optarg); break;
+      case 's': OPT_Seed = atol (optarg); break;
+      default: errflg ++;
+      }
+
+  if ( errflg > 0 || optind != argc )
+    {
+      PrintUsage (argv[0]);
+      exit (EXIT_FAILURE);
+    }
+}
+
+
+
+
+//------------------------------------------------------------ PrintUsage ----//
+static void PrintUsage (const char * s)
+{
+  fprintf (stderr,
+	   "\nUSAGE: %s  [options]\n\n"
+	   "-b       Time the reference and kernels instead of comparing them\n"
+	   "-n int   Number of random trials (default %d)\n"
+	   "-s int   Random seed (default %ld)\n\n",
+	   s, OPT_Trials, OPT_Seed);
+}
+
+
+
+
+//------------------------------------------------------------- RandomSeq ----//
+static string RandomSeq (long int len)
+{
+  //-- Sequences are indexed from 1, so pad position 0
+  string S (1, '\0');
+  for ( long int i = 0; i < len; i ++ )
+    S += "ACGT" [lrand48( ) % 4];
+  return S;
+}
+
+
+
+
+//---------------------------------------------------------------- Mutate ----//
+static string Mutate (const string & S, double rate)
+{
+  string T (1, '\0');
+  for ( string::size_type i = 1; i < S . length( ); i ++ )
+    {
+      if ( drand48( ) >= rate )
+	T += S[i];
+      else
+	switch ( lrand48( ) % 3 )
+	  {
+	  case 0: T += "ACGT" [lrand48( ) % 4]; break;
+	  case 1: T += S[i]; T += "ACGT" [lrand48( ) % 4]; break;
+	  case 2: break;
+	  }
+    }
+  return T;
+}
+
+
+
+
+//-------------------------------------------------------------- RunAlign ----//
+static Result RunAlign
+     (int kernel, const string & A, long int Astart, long int Aend,
+      const string & B, long int Bstart, long int Bend, unsigned int m_o)
+{
+  Result R;
+
+  R . Aend = Aend;
+  R . Bend = Bend;
+  if ( kernel == REFERENCE )
+    {
+      vector<long int> n_v;
+      R . rv = SWRef::alignEngine (A . c_str( ), Astart, R . Aend,
+				   B . c_str( ), Bstart, R . Bend,
+				   (m_o & SEARCH_BIT) ? n_v : R . Delta, m_o);
+      return R;
+    }
+
+  setKernelType (kernel);
+  if ( m_o & SEARCH_BIT )
+    R . rv = alignSearch (A . c_str( ), Astart, R . Aend,
+			  B . c_str( ), Bstart, R . Bend, m_o);
+  else
+    R . rv = alignTarget (A . c_str( ), Astart, R . Aend,
+			  B . c_str( ), Bstart, R . Bend, R . Delta, m_o);
+  return R;
+}
+
+
+
+
+//------------------------------------------------------------ SameResult ----//
+static bool SameResult (const Result & X, const Result & Y)
+{
+  return X . rv == Y . rv  &&  X . Aend == Y . Aend  &&
+    X . Bend == Y . Bend  &&  X . Delta == Y . Delta;
+}
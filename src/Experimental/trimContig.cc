@@ -4,6 +4,7 @@
 #include "fasta.hh"
 #include "AMOS_Foundation.hh"
 #include "ContigUtils.hh"
+#include "align.hh"
 
 using namespace AMOS;
 using namespace std;
@@ -53,6 +54,17 @@ bool trimContig(int cleancontig, int lengthtrim, int lefttrim, int righttrim, Co
 }
 
 
+// Realign the reads at both ends of a trimmed contig and recompute
+// consensus there
+void updateTrimmedEnds(Contig_t & contig, Bank_t & read_bank)
+{
+  int len = contig.getLength();
+
+  Update_Contig_Window(contig, read_bank, len - 1, len);
+  Update_Contig_Window(contig, read_bank, 0, 1);
+}
+
+
 int main (int argc, char ** argv)
 {
   int lefttrim(0);
@@ -61,6 +73,7 @@ int main (int argc, char ** argv)
   int contigiid(0);
   int cleancontig(0);
   int cleanall(0);
+  int updatecons(0);
   string contigeid;
 
   int retval = 0;
@@ -84,7 +97,8 @@ int main (int argc, char ** argv)
 "   -c       Clean contigs by trimming 1x coverage at ends\n"
 "   -E id    EID of contig to trim\n"
 "   -I id    IID of contig to trim\n"
-"   -C       Clean all contigs\n";
+"   -C       Clean all contigs\n"
+"   -u       Recompute consensus at the new ends from the reads\n";
 
     // Instantiate a new TIGR_Foundation object
     tf = new AMOS_Foundation (version, helptext, dependencies, argc, argv);
@@ -94,6 +108,7 @@ int main (int argc, char ** argv)
     tf->getOptions()->addOptionResult("N=i", &lengthtrim,  "New Contig Length");
     tf->getOptions()->addOptionResult("c",   &cleancontig, "Clean Contig");
     tf->getOptions()->addOptionResult("C",   &cleanall,    "Clean All");
+    tf->getOptions()->addOptionResult("u",   &updatecons,  "Update Consensus");
 
     tf->getOptions()->addOptionResult("I=i", &contigiid, "Contig IID");
     tf->getOptions()->addOptionResult("E=s", &contigeid, "Contig EID");
@@ -109,10 +124,12 @@ int main (int argc, char ** argv)
 
     string bankname = argvv.front(); argvv.pop_front();
     Bank_t contig_bank(Contig_t::NCODE);
+    Bank_t read_bank(Read_t::NCODE);
 
     cerr << "Processing " << bankname << " at " << Date() << endl;
 
     contig_bank.open(bankname, B_READ|B_WRITE);
+    if (updatecons) { read_bank.open(bankname, B_READ); }
     Contig_t contig;
 
     if (cleanall)
@@ -124,6 +141,7 @@ int main (int argc, char ** argv)
         contig_bank.fetch(ci->iid, contig);
         if (trimContig(1,0,0,0,contig))
         {
+          if (updatecons) { updateTrimmedEnds(contig, read_bank); }
           contig_bank.replace(ci->iid, contig);
         }
       }
@@ -135,11 +153,13 @@ int main (int argc, char ** argv)
 
       if (trimContig(cleancontig, lengthtrim, lefttrim, righttrim, contig))
       {
+        if (updatecons) { updateTrimmedEnds(contig, read_bank); }
         contig_bank.replace(contig.getIID(), contig);
       }
     }
 
     contig_bank.close();
+    if (updatecons) { read_bank.close(); }
   }
   catch (Exception_t & e)
   {
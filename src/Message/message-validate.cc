@@ -67,8 +67,9 @@ int main (int argc, char ** argv)
     AMOS_THROW_IO ("Could not open message file " + OPT_MessageName);
 
   //-- Parse the message file
-  while ( msgfile . good( ) )
-    msg . read (msgfile);
+  MessageReader_t reader (msgfile);
+  while ( reader . read (msg) )
+    ;
   }
   catch (Exception_t & e) {
 
@@ -0,0 +1,657 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//! \brief Simulates a shotgun sequencing project straight into an AMOS bank
+//!
+//! Takes the library configuration of shotgunSim and writes the reads,
+//! fragments and libraries to a bank. Every fragment draws from its own
+//! counter based random stream, keyed by the seed, its library and its index
+//! in the library, so fragments are simulated in parallel and the bank is
+//! the same for a given seed whatever the number of threads.
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#include "foundation_AMOS.hh"
+#include "fasta.hh"
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#ifdef AMOS_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace AMOS;
+
+
+//=============================================================== Options ====//
+string   OPT_ConfName;              // library configuration file
+string   OPT_FastaName;             // genome sequence file
+string   OPT_BankName;              // bank to create
+uint64_t OPT_Seed         = 0;      // random seed
+bool     OPT_SeedSet      = false;  // seed given on the command line
+bool     OPT_Circular     = false;  // let fragments span the ends of molecules
+int      OPT_Threads      = 0;      // number of threads, 0 for default
+
+
+//============================================================= Constants ====//
+const Size_t BLOCK_FRAGMENTS = 1024;  // fragments simulated per task
+const int BLOCKS_PER_THREAD = 4;      // tasks per thread between bank writes
+const int MAX_TRIES = 10000;          // draws before giving up on a fragment
+const char QUAL_CHAR = 'l';           // quality of every base
+
+
+struct SimLibrary_t
+{
+  string name;
+  int mean, stdev;                    // insert size, 0 for unmated reads
+  int readmean, readstdev;            // read length distribution
+  int readmin, readmax;
+  float coverage;
+  float permates;                     // fraction of fragments with both reads
+
+  SimLibrary_t ( )
+    : mean (0), stdev (0), readmean (0), readstdev (0), readmin (0),
+      readmax (0), coverage (0), permates (0)
+  { }
+};
+
+struct SimFragment_t
+{
+  uint32_t mol;                       // molecule index
+  uint64_t left;                      // molecule offset of the fragment
+  Size_t len;                         // fragment length
+  Size_t forwlen, revlen;             // read lengths, revlen 0 if unmated
+  bool rc;                            // fragment is on the reverse strand
+  char reads;                         // 'F' 'R' or 'B'oth reads sequenced
+};
+
+
+vector<SimLibrary_t> Libraries;
+vector<int> ReadSizes;               // read lengths to draw from instead
+vector<string> Molecules;
+vector<uint64_t> MolStarts;          // genome offset of each molecule + total
+
+
+//----------------------------------------------------- Mix --------------------
+//! \brief The splitmix64 finalizer, a bijective 64 bit hash
+//!
+static inline uint64_t Mix (uint64_t z)
+{
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+
+//================================================ Random_t ====================
+//! \brief A counter based random stream
+//!
+//! Draw i of the stream (seed, lib, frg) is a hash of the four values, so
+//! any fragment can be simulated without simulating the ones before it.
+//!
+struct Random_t
+{
+  uint64_t key, ctr;
+
+  Random_t (uint64_t seed, uint64_t lib, uint64_t frg)
+    : key (Mix (Mix (seed ^ Mix (lib + 1)) + frg)), ctr (0)
+  { }
+
+  uint64_t next ( )
+  {
+    return Mix (key + (++ ctr) * 0x9E3779B97F4A7C15ull);
+  }
+
+  //-- Uniform in [0,1)
+  double uniform ( )
+  {
+    return (next( ) >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  //-- Uniform in [0,n)
+  uint64_t below (uint64_t n)
+  {
+    return (uint64_t) (uniform( ) * n);
+  }
+
+  //-- Gaussian with mean 0, by Box-Muller
+  double gaussian (double sd)
+  {
+    double u = 1.0 - uniform( );
+    double v = uniform( );
+    return sd * sqrt (-2.0 * log (u)) * cos (2.0 * M_PI * v);
+  }
+};
+
+
+//========================================================== Fuction Decs ====//
+//----------------------------------------------------- ParseArgs --------------
+//! \brief Sets the global OPT_% values from the command line arguments
+//!
+//! \return void
+//!
+void ParseArgs (int argc, char ** argv);
+
+
+//----------------------------------------------------- PrintHelp --------------
+//! \brief Prints help information to cerr
+//!
+//! \param s The program name, i.e. argv[0]
+//! \return void
+//!
+void PrintHelp (const char * s);
+
+
+//----------------------------------------------------- PrintUsage -------------
+//! \brief Prints usage information to cerr
+//!
+//! \param s The program name, i.e. argv[0]
+//! \return void
+//!
+void PrintUsage (const char * s);
+
+
+//----------------------------------------------------- ParseConfig ------------
+//! \brief Reads the shotgunSim library configuration
+//!
+void ParseConfig (const string & path)
+{
+  ifstream conf (path . c_str( ));
+  if ( ! conf )
+    AMOS_THROW_IO ("Could not open config file " + path);
+
+  SimLibrary_t lib;
+
+  string line;
+  char name [256];
+  int a, b, c, d;
+  float f;
+  bool first = true;
+
+  while ( getline (conf, line) )
+    {
+      if ( line . length( ) > 1  &&  line[0] == '#' )
+        continue;
+
+      if ( strncmp (line . c_str( ), "library", 7) == 0 )
+        {
+          if ( ! first )
+            Libraries . push_back (lib);
+          first = false;
+          lib = SimLibrary_t( );
+        }
+
+      if ( sscanf (line . c_str( ), "library %255s %d %d %f",
+                   name, &a, &b, &f) == 4 )
+        {
+          lib . name = name;
+          lib . mean = a;
+          lib . stdev = b;
+          lib . permates = f;
+        }
+      else if ( sscanf (line . c_str( ), "library %255s", name) == 1 )
+        lib . name = name;
+
+      if ( sscanf (line . c_str( ), "reads %d %d %d %d", &a, &b, &c, &d) == 4 )
+        {
+          lib . readmean = a;
+          lib . readstdev = b;
+          lib . readmin = c;
+          lib . readmax = d;
+        }
+      if ( sscanf (line . c_str( ), "read %d", &a) == 1 )
+        ReadSizes . push_back (a);
+      if ( sscanf (line . c_str( ), "coverage %f", &f) == 1 )
+        lib . coverage = f;
+    }
+
+  if ( first )
+    AMOS_THROW_ARGUMENT ("Config file seems empty, " + path);
+  Libraries . push_back (lib);
+
+  for ( vector<SimLibrary_t>::const_iterator
+          li = Libraries . begin( ); li != Libraries . end( ); ++ li )
+    if ( li -> coverage > 0  &&  ReadSizes . empty( )  &&
+         (li -> readmax < li -> readmin  ||  li -> readmax <= 0) )
+      AMOS_THROW_ARGUMENT ("Library " + li -> name + " has no valid reads line");
+}
+
+
+//----------------------------------------------------- Substring --------------
+//! \brief Returns len bases of molecule mol from pos, wrapping if circular
+//!
+string Substring (uint32_t mol, uint64_t pos, Size_t len)
+{
+  const string & seq = Molecules [mol];
+  pos %= seq . size( );
+
+  if ( pos + len <= seq . size( ) )
+    return seq . substr (pos, len);
+
+  string s = seq . substr (pos);
+  while ( (Size_t) s . size( ) < len )
+    s . append (seq, 0, len - s . size( ));
+  return s;
+}
+
+
+//----------------------------------------------------- DrawReadLength ---------
+Size_t DrawReadLength (const SimLibrary_t & lib, Random_t & rng)
+{
+  if ( ! ReadSizes . empty( ) )
+    return ReadSizes [rng . below (ReadSizes . size( ))];
+
+  for ( int i = 0; i < MAX_TRIES; i ++ )
+    {
+      int len = (int) (lib . readmean + rng . gaussian (lib . readstdev));
+      if ( len >= lib . readmin  &&  len <= lib . readmax )
+        return len;
+    }
+  return lib . readmean;
+}
+
+
+//----------------------------------------------------- SimulateFragment -------
+//! \brief Draws fragment number k of library l
+//!
+//! Returns false if no valid fragment was found in MAX_TRIES draws, which
+//! means the library does not fit the genome.
+//!
+bool SimulateFragment (Size_t l, uint64_t k, SimFragment_t & frg)
+{
+  const SimLibrary_t & lib = Libraries [l];
+  const uint64_t genome = MolStarts . back( );
+  Random_t rng (OPT_Seed, l, k);
+
+  for ( int i = 0; i < MAX_TRIES; i ++ )
+    {
+      uint64_t start = rng . below (genome);
+
+      if ( lib . mean == 0 )
+        {
+          frg . len = DrawReadLength (lib, rng);
+          frg . forwlen = frg . len;
+          frg . revlen = 0;
+        }
+      else
+        {
+          frg . len = lib . mean + (Size_t) floor (rng . gaussian (lib . stdev) + 0.5);
+          frg . forwlen = min (DrawReadLength (lib, rng), frg . len);
+          frg . revlen = min (DrawReadLength (lib, rng), frg . len);
+        }
+
+      if ( frg . len <= 0  ||  frg . len < lib . readmin )
+        continue;
+
+      frg . mol = upper_bound (MolStarts . begin( ), MolStarts . end( ), start)
+        - MolStarts . begin( ) - 1;
+      frg . left = start - MolStarts [frg . mol];
+
+      uint64_t mollen = Molecules [frg . mol] . size( );
+      if ( (uint64_t) frg . len > mollen )
+        continue;
+      if ( ! OPT_Circular  &&  frg . left + frg . len > mollen )
+        continue;
+
+      frg . rc = rng . uniform( ) < 0.5;
+      if ( frg . revlen == 0 )
+        frg . reads = 'F';
+      else if ( rng . uniform( ) < lib . permates )
+        frg . reads = 'B';
+      else
+        frg . reads = rng . uniform( ) < 0.5 ? 'F' : 'R';
+
+      return true;
+    }
+
+  return false;
+}
+
+
+//----------------------------------------------------- FragmentReads ----------
+//! \brief Sequences the reads of a fragment, forward read first
+//!
+void FragmentReads (const SimFragment_t & frg, vector<string> & seqs)
+{
+  seqs . clear( );
+
+  //-- The forward read starts at the 5' end of the fragment's strand
+  if ( frg . reads != 'R' )
+    {
+      if ( frg . rc )
+        {
+          seqs . push_back
+            (Substring (frg . mol, frg . left + frg . len - frg . forwlen,
+                        frg . forwlen));
+          Reverse_Complement (seqs . back( ));
+        }
+      else
+        seqs . push_back (Substring (frg . mol, frg . left, frg . forwlen));
+    }
+
+  if ( frg . reads != 'F' )
+    {
+      if ( frg . rc )
+        seqs . push_back (Substring (frg . mol, frg . left, frg . revlen));
+      else
+        {
+          seqs . push_back
+            (Substring (frg . mol, frg . left + frg . len - frg . revlen,
+                        frg . revlen));
+          Reverse_Complement (seqs . back( ));
+        }
+    }
+}
+
+
+//----------------------------------------------------- SimulateBlock ----------
+//! \brief Simulates fragments [first, first+n) of library l and their reads
+//!
+//! Returns false if a fragment could not be placed, and frgs and reds then
+//! hold just the fragments before it.
+//!
+bool SimulateBlock (Size_t l, uint64_t first, Size_t n,
+                    vector<SimFragment_t> & frgs, vector<Read_t> & reds)
+{
+  vector<string> seqs;
+  Read_t red;
+
+  frgs . resize (n);
+  reds . clear( );
+
+  for ( Size_t i = 0; i < n; i ++ )
+    {
+      if ( ! SimulateFragment (l, first + i, frgs [i]) )
+        {
+          frgs . resize (i);
+          return false;
+        }
+
+      FragmentReads (frgs [i], seqs);
+      for ( vector<string>::iterator
+              si = seqs . begin( ); si != seqs . end( ); ++ si )
+        {
+          red . clear( );
+          red . setSequence (*si, string (si -> size( ), QUAL_CHAR));
+          red . setClearRange (Range_t (0, si -> size( )));
+          red . setType (Libraries [l] . mean ? Read_t::END : Read_t::OTHER);
+          reds . push_back (red);
+        }
+    }
+
+  return true;
+}
+
+
+//----------------------------------------------------- LoadGenome -------------
+void LoadGenome (const string & path)
+{
+  FILE * fp = fopen (path . c_str( ), "r");
+  if ( fp == NULL )
+    AMOS_THROW_IO ("Could not open fasta file " + path);
+
+  string seq, hdr;
+  MolStarts . push_back (0);
+  while ( Fasta_Read (fp, seq, hdr) )
+    {
+      if ( seq . empty( ) )
+        continue;
+      for ( string::iterator si = seq . begin( ); si != seq . end( ); ++ si )
+        *si = toupper (*si);
+      Molecules . push_back (seq);
+      MolStarts . push_back (MolStarts . back( ) + seq . size( ));
+    }
+  fclose (fp);
+
+  if ( Molecules . empty( ) )
+    AMOS_THROW_ARGUMENT ("No sequence in fasta file " + path);
+}
+
+
+//========================================================= Function Defs ====//
+int main (int argc, char ** argv)
+{
+  int exitcode = EXIT_SUCCESS;
+  ID_t riid = 0, fiid = 0;
+  uint64_t nbases = 0;
+
+  //-- Parse the command line arguments
+  ParseArgs (argc, argv);
+
+#ifdef AMOS_HAVE_OPENMP
+  if ( OPT_Threads > 0 )
+    omp_set_num_threads (OPT_Threads);
+  int nthreads = omp_get_max_threads( );
+#else
+  int nthreads = 1;
+#endif
+
+  //-- BEGIN: MAIN EXCEPTION CATCH
+  try {
+
+    ParseConfig (OPT_ConfName);
+    LoadGenome (OPT_FastaName);
+
+    BankStream_t red_bank (Read_t::NCODE);
+    BankStream_t frg_bank (Fragment_t::NCODE);
+    BankStream_t lib_bank (Library_t::NCODE);
+
+    red_bank . create (OPT_BankName, B_WRITE);
+    frg_bank . create (OPT_BankName, B_WRITE);
+    lib_bank . create (OPT_BankName, B_WRITE);
+
+    cerr << "Simulating from " << Molecules . size( ) << " sequences, "
+         << MolStarts . back( ) << " bp, seed " << OPT_Seed << endl;
+
+    Size_t nblocks = nthreads * BLOCKS_PER_THREAD;
+    vector< vector<SimFragment_t> > frgs (nblocks);
+    vector< vector<Read_t> > reds (nblocks);
+
+    for ( Size_t l = 0; l < (Size_t) Libraries . size( ); l ++ )
+      {
+        const SimLibrary_t & slib = Libraries [l];
+        if ( slib . coverage <= 0 )
+          continue;
+
+        ID_t liid = l + 1;
+        bool mated = slib . mean != 0;
+        if ( mated )
+          {
+            Library_t lib;
+            Distribution_t dist;
+            dist . mean = slib . mean;
+            dist . sd = slib . stdev;
+            lib . setIID (liid);
+            lib . setEID (slib . name);
+            lib . setDistribution (dist);
+            lib_bank << lib;
+          }
+
+        //-- Simulate rounds of blocks in parallel, and write them in order
+        //   until the library's coverage is reached
+        uint64_t target = (uint64_t) (slib . coverage * MolStarts . back( ));
+        uint64_t covered = 0;
+        uint64_t nextfrg = 0;
+        vector<char> failed (nblocks);
+
+        while ( covered < target )
+          {
+#pragma omp parallel for schedule(dynamic)
+            for ( Size_t b = 0; b < nblocks; b ++ )
+              failed [b] = ! SimulateBlock (l, nextfrg + b * BLOCK_FRAGMENTS,
+                                            BLOCK_FRAGMENTS, frgs [b], reds [b]);
+
+            //-- A fragment that could not be placed only matters if the
+            //   coverage is not reached before it, whatever the thread count
+            for ( Size_t b = 0; b < nblocks  &&  covered < target; b ++ )
+              {
+                vector<Read_t>::iterator ri = reds [b] . begin( );
+                vector<SimFragment_t>::iterator fi;
+
+                for ( fi = frgs [b] . begin( );
+                      fi != frgs [b] . end( )  &&  covered < target; ++ fi )
+                  {
+                    uint64_t k = nextfrg + b * BLOCK_FRAGMENTS
+                      + (fi - frgs [b] . begin( ));
+                    ostringstream eid;
+                    eid << slib . name << '.' << k;
+
+                    if ( mated )
+                      fiid ++;
+
+                    pair<ID_t, ID_t> rds (NULL_ID, NULL_ID);
+                    for ( int r = 0; r < 2; r ++ )
+                      {
+                        char end = r ? 'R' : 'F';
+                        if ( fi -> reads != 'B'  &&  fi -> reads != end )
+                          continue;
+
+                        ri -> setIID (++ riid);
+                        ri -> setEID (eid . str( ) + '.' + end);
+                        if ( mated )
+                          ri -> setFragment (fiid);
+                        (r ? rds . second : rds . first) = riid;
+
+                        covered += ri -> getLength( );
+                        nbases += ri -> getLength( );
+                        red_bank << *ri;
+                        ++ ri;
+                      }
+
+                    if ( mated )
+                      {
+                        Fragment_t frg;
+                        frg . setIID (fiid);
+                        frg . setEID (eid . str( ));
+                        frg . setLibrary (liid);
+                        frg . setType (Fragment_t::INSERT);
+                        frg . setSize (fi -> len);
+                        if ( fi -> reads == 'B' )
+                          frg . setReads (rds);
+                        frg_bank << frg;
+                      }
+                  }
+
+                if ( failed [b]  &&  covered < target )
+                  AMOS_THROW_ARGUMENT ("Could not place fragments of library " +
+                                       slib . name + " on the genome, check its"
+                                       " insert and read sizes");
+              }
+
+            nextfrg += nblocks * BLOCK_FRAGMENTS;
+          }
+
+        cerr << "Library " << slib . name << ": " << covered << " bp" << endl;
+      }
+
+    red_bank . close( );
+    frg_bank . close( );
+    lib_bank . close( );
+  }
+  catch (const Exception_t & e) {
+    cerr << "FATAL: " << e . what( ) << endl
+         << "  there has been a fatal error, abort" << endl;
+    exitcode = EXIT_FAILURE;
+  }
+  //-- END: MAIN EXCEPTION CATCH
+
+  cerr << "Reads written: " << riid << endl
+       << "Fragments written: " << fiid << endl
+       << "Bases written: " << nbases << endl;
+
+  return exitcode;
+}
+
+
+
+
+//------------------------------------------------------------- ParseArgs ----//
+void ParseArgs (int argc, char ** argv)
+{
+  int ch, errflg = 0;
+  optarg = NULL;
+
+  while ( !errflg && ((ch = getopt (argc, argv, "hrs:t:")) != EOF) )
+    switch (ch)
+      {
+        case 'h':
+          PrintHelp (argv[0]);
+          exit (EXIT_SUCCESS);
+          break;
+
+        case 'r': OPT_Circular = true; break;
+
+        case 's':
+          OPT_Seed = strtoull (optarg, NULL, 10);
+          OPT_SeedSet = true;
+          break;
+
+        case 't': OPT_Threads = atoi (optarg); break;
+
+        default:
+          errflg ++;
+      }
+
+  if ( errflg > 0 || argc - optind != 3 )
+    {
+      PrintUsage (argv[0]);
+      cerr << "Try '" << argv[0] << " -h' for more information.\n";
+      exit (EXIT_FAILURE);
+    }
+
+  OPT_ConfName = argv [optind ++];
+  OPT_FastaName = argv [optind ++];
+  OPT_BankName = argv [optind ++];
+
+  if ( ! OPT_SeedSet )
+    OPT_Seed = time (NULL);
+}
+
+
+
+
+//------------------------------------------------------------- PrintHelp ----//
+void PrintHelp (const char * s)
+{
+  PrintUsage (s);
+
+  cerr << "\n.DESCRIPTION.\n"
+       << "  Simulates shotgun reads and mates from the sequences in fasta at\n"
+       << "  the coverage of each library of the config file, and writes the\n"
+       << "  reads, fragments and libraries into a new bank. The config file\n"
+       << "  format is that of shotgunSim:\n"
+       << "    library <name> <mean> <stdev> <fraction mated>\n"
+       << "    reads <mean> <stdev> <min> <max>\n"
+       << "    coverage <coverage>\n"
+       << "  with a mean of 0 for unmated reads. The output only depends on\n"
+       << "  the seed, not on the number of threads.\n"
+       << "\n.OPTIONS.\n"
+       << "  -h            Display help information\n"
+       << "  -r            Treat the sequences as circular\n"
+       << "  -s seed       Random seed, default the current time\n"
+       << "  -t n          Number of threads, default all processors\n"
+       << "\n.KEYWORDS.\n"
+       << "  simulation, shotgun, bank"
+       << endl;
+
+  return;
+}
+
+
+
+
+//------------------------------------------------------------ PrintUsage ----//
+void PrintUsage (const char * s)
+{
+  cerr << "\n.USAGE.\n" << "  " <<  s << "  [options] <config> <fasta> <bank>\n";
+  return;
+}
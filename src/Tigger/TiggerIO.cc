@@ -42,6 +42,9 @@ void get_amos_reads(const string p_bankdir) {
         cerr << p_bankdir << " bank is empty" << endl;
         return;
       }
+
+      //-- Only the clear range is needed, skip the sequence data
+      bank.setProjection(P_CLEAR);
       
       while(bank >> amos_read) {
         tigger.add_read(amos_read);
@@ -59,8 +62,6 @@ void get_amos_reads(const string p_bankdir) {
 }
 
 void get_amos_overlaps(const string p_bankdir) {
-  Overlap_t amos_overlap;
-  Message_t msg;
   BankStream_t bank(Overlap_t::NCODE);
   int overlapCount = 0;
 
@@ -72,16 +73,9 @@ void get_amos_overlaps(const string p_bankdir) {
         cout << " bank is empty" << endl;
         return;
       }
-      
-      while(bank >> amos_overlap) {
-//        if(VERBOSE) {
-//          amos_overlap.writeMessage(msg);
-//          msg.write(cout);
-//        }
-
-        tigger.add_overlap(amos_overlap);
-        overlapCount++;
-      }
+
+      // contained reads are dropped before any graph edges are built
+      overlapCount = tigger.add_overlaps(bank);
       
       bank.close();
       cout << "Pulled " << overlapCount << " overlaps from bank " << endl;
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <cstdlib>
 #include <stdio.h>
+#include <algorithm>
 
 using namespace std;
 using namespace AMOS;
@@ -32,7 +33,7 @@ void Unitigger::error(const char* m, const char* c) {
 }
 
 
-void Unitigger::add_overlap(Overlap* p_olap) {
+void Unitigger::classify_overlap(Overlap* p_olap) {
   // convert AMOS adjacency info (ahang, bhang, orientation) to Gene's adjacency
   // from the paper (asuffix, bsuffix, type)
 
@@ -99,6 +100,11 @@ void Unitigger::add_overlap(Overlap* p_olap) {
 
     }
   }
+}
+
+
+void Unitigger::add_overlap(Overlap* p_olap) {
+  classify_overlap(p_olap);
 
   if(VERBOSE) {
     cout << " Added overlap:" << endl;
@@ -112,9 +118,19 @@ void Unitigger::add_overlap(Overlap* p_olap) {
 }
 
 
+static void convert_overlap(const Overlap_t & p_olap, Overlap* p_ovl) {
+  pair <ID_t, ID_t>  reads = p_olap.getReads();
+
+  p_ovl->ridA = reads.first;
+  p_ovl->ridB = reads.second;
+  p_ovl->ori = p_olap.getAdjacency();
+  p_ovl->ahang = p_olap.getAhang();
+  p_ovl->bhang = p_olap.getBhang();
+}
+
+
 void Unitigger::add_overlap(Overlap_t p_olap) {
 
-  Overlap* olap = new Overlap();
   pair <ID_t, ID_t>  reads = p_olap.getReads();
 
   if(reads.first == reads.second) {
@@ -122,16 +138,183 @@ void Unitigger::add_overlap(Overlap_t p_olap) {
     return;
   }
   
-  olap->ridA = reads.first;
-  olap->ridB = reads.second;
-  olap->ori = p_olap.getAdjacency();
-  olap->ahang = p_olap.getAhang();
-  olap->bhang = p_olap.getBhang();
+  Overlap* olap = new Overlap();
+  convert_overlap(p_olap, olap);
 
   add_overlap(olap);
 }
 
 
+// overlaps are pulled from the bank and classified this many at a time
+static const int OVERLAP_BATCH = 65536;
+
+// Reads and classifies the next batch of overlaps, skipping self overlaps.
+// Returns the number of bank records consumed.
+static int read_overlap_batch(Unitigger & p_tigger, BankStream_t & p_bank,
+                              vector< Overlap > & p_batch, bool p_warn) {
+  Overlap_t amos_olap;
+  int count = 0;
+
+  p_batch.clear();
+
+  while((count < OVERLAP_BATCH) && !p_bank.eof() && (p_bank >> amos_olap)) {
+    count++;
+
+    pair <ID_t, ID_t>  reads = amos_olap.getReads();
+    if(reads.first == reads.second) {
+      if(p_warn) {
+        cerr << "WARNING: Not adding overlap between read " << reads.first << " and itself " << endl;
+      }
+      continue;
+    }
+
+    p_batch.push_back(Overlap());
+    convert_overlap(amos_olap, &p_batch.back());
+    p_tigger.classify_overlap(&p_batch.back());
+  }
+
+  return count;
+}
+
+
+// Whether an overlap with the given bank ordinal is kept: the first
+// containment of each contained read, and dovetails between reads that are
+// not contained. p_container holds the ordinal of that first containment
+// for each contained read, 0 for the others.
+static bool keep_overlap(const Overlap & p_olap, unsigned int p_ordinal,
+                         const vector< unsigned int > & p_container) {
+  unsigned int ra = p_olap.ridA;
+  unsigned int rb = p_olap.ridB;
+
+  if(p_olap.type == 'C') {
+    return p_container[rb] == p_ordinal;
+  }
+
+  return (ra >= p_container.size() || p_container[ra] == 0) &&
+         (rb >= p_container.size() || p_container[rb] == 0);
+}
+
+
+int Unitigger::add_overlaps(BankStream_t & p_bank) {
+  vector< Overlap > batch;
+  vector< unsigned int > container; // ordinal of the kept containment per read
+  unsigned int ordinal;
+  int total = 0;
+  int kept = 0;
+  int count;
+
+  p_bank.setProjection(P_READS | P_HANGS);
+
+  //
+  // Pass 1. Find the contained reads
+  // hide_containment() hides every contained read with Node::setHidden(),
+  // which hides all of its edges too, and add_containment() only brings back
+  // the first containment edge for each. So only that overlap of a contained
+  // read is kept, its others could never reach transitive reduction or the
+  // walks.
+  //
+  ordinal = 0;
+  p_bank.seekg(1);
+  while((count = read_overlap_batch(*this, p_bank, batch, true)) > 0) {
+    total += count;
+
+    for(unsigned int i = 0; i < batch.size(); i++) {
+      ordinal++;
+      if(batch[i].type == 'C') {
+        unsigned int rid = batch[i].ridB;
+        if(rid >= container.size()) {
+          container.resize(rid + 1, 0);
+        }
+        if(container[rid] == 0) {
+          container[rid] = ordinal;
+        }
+      }
+    }
+  }
+
+  //
+  // Pass 2. Count the kept overlaps of each read A
+  //
+  vector< unsigned int > first(container.size() + 1, 0);
+
+  ordinal = 0;
+  p_bank.seekg(1);
+  while(read_overlap_batch(*this, p_bank, batch, false) > 0) {
+    for(unsigned int i = 0; i < batch.size(); i++) {
+      ordinal++;
+      if(keep_overlap(batch[i], ordinal, container)) {
+        unsigned int ra = batch[i].ridA;
+        if(ra + 1 >= first.size()) {
+          first.resize(ra + 2, 0);
+        }
+        first[ra + 1]++;
+        kept++;
+      }
+    }
+  }
+
+  for(unsigned int r = 0; r + 1 < first.size(); r++) {
+    first[r + 1] += first[r];
+  }
+
+  //
+  // Pass 3. Place the kept overlaps in an array sorted by read A, in bank
+  // order for each read. Each keeps the edge key it would have had if every
+  // overlap had been added: its bank ordinal past the keys already in use.
+  //
+  int first_key = graph->keys;
+  vector< int > olap_keys(kept);
+  vector< unsigned int > next(first.begin(), first.end() - 1);
+
+  overlaps.resize(kept);
+
+  ordinal = 0;
+  p_bank.seekg(1);
+  while(read_overlap_batch(*this, p_bank, batch, false) > 0) {
+    for(unsigned int i = 0; i < batch.size(); i++) {
+      ordinal++;
+      if(keep_overlap(batch[i], ordinal, container)) {
+        unsigned int e = next[batch[i].ridA]++;
+        overlaps[e] = batch[i];
+        olap_keys[e] = first_key + ordinal - 1;
+      }
+    }
+  }
+
+  vector< unsigned int >().swap(container);
+  vector< unsigned int >().swap(next);
+  vector< Overlap >().swap(batch);
+
+  //
+  // Build the graph edges from the array, read by read. The edges point
+  // into it, so it is not touched again.
+  //
+  for(unsigned int r = 0; r + 1 < first.size(); r++) {
+    if(first[r] == first[r + 1]) continue;
+
+    INode* node = graph->get_node(r);
+    for(unsigned int e = first[r]; e < first[r + 1]; e++) {
+      Overlap* edge_olap = &overlaps[e];
+
+      if(VERBOSE) {
+        cout << " Added overlap:" << endl;
+        edge_olap->print();
+      }
+
+      graph->keys = olap_keys[e];
+      graph->new_edge(node, graph->get_node(edge_olap->ridB), edge_olap);
+    }
+  }
+  graph->keys = first_key + ordinal;
+
+  if(VERBOSE) {
+    cout << " Kept " << kept << " of " << total << " overlaps" << endl;
+  }
+
+  return total;
+}
+
+
 void Unitigger::add_read(Read_t p_read) {
 
   Range_t range = p_read.getClearRange();
@@ -37,6 +37,10 @@ public:
   std::vector<std::string> colors;
   std::vector< Contig* > contigs;
   std::queue< IEdge* > containment;
+
+  /** overlaps loaded by add_overlaps(), sorted by read A; the graph edges
+   *  point into it, so it is filled once */
+  std::vector< Overlap > overlaps;
   //  HASHMAP::hash_map< int, IEdge* > 
   bool VERBOSE;
   bool SINGLE;
@@ -46,8 +50,10 @@ public:
   void add_read(Read* p_read);
   void add_read(AMOS::Read_t p_read);
 
+  void classify_overlap(Overlap* p_olap);
   void add_overlap(Overlap* p_olap);
   void add_overlap(AMOS::Overlap_t p_olap);
+  int add_overlaps(AMOS::BankStream_t & p_bank);
 
   void layout_contig(Contig* contig);
   void layout_read(IEdge* p_edge, INode* p_node);
@@ -0,0 +1,217 @@
+// Times the stages of Unitigger::calc_contigs on a simulated overlap graph:
+// reads sampled from a random genome at a given coverage, in random
+// orientations, with every overlap an overlapper would report between
+// them, including those between reads from different copies of a few
+// long repeats (by default seven 5 kbp copies, as for the rRNA operons
+// of a bacterial genome).
+
+#include "Unitigger.hh"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace std;
+
+static int GENOME_LEN = 1000000;
+static int COVERAGE = 100;
+static int READ_LEN = 1000;
+static int MIN_OVERLAP = 40;
+static int REPEAT_COPIES = 7;
+static int REPEAT_LEN = 5000;
+static int SEED = 1;
+
+
+struct SimRead_t
+{
+  int id;
+  int start, end;
+  bool rev;
+
+  bool operator< (const SimRead_t & r) const { return start < r.start; }
+};
+
+
+// Seconds since p_start
+static double since(const struct timeval & p_start)
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - p_start.tv_sec) + (now.tv_usec - p_start.tv_usec) / 1e6;
+}
+
+
+// Adds the overlap of a and b, with b moved p_shift along the genome, if it
+// is at least MIN_OVERLAP long and lies within [p_lo, p_hi)
+static int addOverlap(Unitigger & p_tigger, const SimRead_t & a,
+                      const SimRead_t & b, int p_shift, int p_lo, int p_hi)
+{
+  int bstart = b.start + p_shift, bend = b.end + p_shift;
+  int lo = max(a.start, bstart), hi = min(a.end, bend);
+
+  if(hi - lo < MIN_OVERLAP || lo < p_lo || hi > p_hi) {
+    return 0;
+  }
+
+  Overlap* olap = new Overlap();
+  olap->ridA = a.id;
+  olap->ridB = b.id;
+  olap->ori = (a.rev == b.rev) ? 'N' : 'I';
+  if(a.rev) {
+    olap->ahang = a.end - bend;
+    olap->bhang = a.start - bstart;
+  } else {
+    olap->ahang = bstart - a.start;
+    olap->bhang = bend - a.end;
+  }
+
+  p_tigger.add_overlap(olap);
+  return 1;
+}
+
+
+static void parse_command_line(int argc, char* argv[])
+{
+  bool errflg = false;
+  int ch;
+
+  optarg = NULL;
+
+  while (!errflg && ((ch = getopt(argc, argv, "g:c:l:o:r:R:s:h")) != EOF)) {
+    switch  (ch) {
+    case 'g' : GENOME_LEN = atoi(optarg); break;
+    case 'c' : COVERAGE = atoi(optarg); break;
+    case 'l' : READ_LEN = atoi(optarg); break;
+    case 'o' : MIN_OVERLAP = atoi(optarg); break;
+    case 'r' : REPEAT_COPIES = atoi(optarg); break;
+    case 'R' : REPEAT_LEN = atoi(optarg); break;
+    case 's' : SEED = atoi(optarg); break;
+    default :
+      errflg = true;
+    }
+  }
+
+  if(GENOME_LEN < 2 * READ_LEN || READ_LEN < 2 * MIN_OVERLAP ||
+     REPEAT_COPIES * REPEAT_LEN * 2 > GENOME_LEN) {
+    errflg = true;
+  }
+
+  if(errflg || optind != argc) {
+    cerr << " Usage: tigger-bench [options] " << endl;
+    cerr << " Options: " << endl;
+    cerr << "   -g <n>   Genome length, default 1000000 " << endl;
+    cerr << "   -c <n>   Coverage, default 100 " << endl;
+    cerr << "   -l <n>   Mean read length, reads are within 20% of it, default 1000 " << endl;
+    cerr << "   -o <n>   Minimum overlap, default 40 " << endl;
+    cerr << "   -r <n>   Repeat copies, default 7 " << endl;
+    cerr << "   -R <n>   Repeat length, default 5000 " << endl;
+    cerr << "   -s <n>   Random seed, default 1 " << endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+
+int main(int argc, char** argv)
+{
+  parse_command_line(argc, argv);
+  srand(SEED);
+
+  //-- Reads
+  vector<SimRead_t> reads;
+  long long bases = 0;
+  while(bases < (long long) GENOME_LEN * COVERAGE) {
+    SimRead_t r;
+    int len = READ_LEN * 4 / 5 + rand() % (READ_LEN * 2 / 5 + 1);
+    r.start = rand() % (GENOME_LEN - len + 1);
+    r.end = r.start + len;
+    r.rev = rand() % 2;
+    reads.push_back(r);
+    bases += len;
+  }
+  sort(reads.begin(), reads.end());
+  for(unsigned int i = 0; i < reads.size(); i++) {
+    reads[i].id = i + 1;
+  }
+
+  //-- Repeat copies, apart and in order along the genome
+  vector<int> copies;
+  int slack = GENOME_LEN - REPEAT_COPIES * REPEAT_LEN * 2;
+  for(int c = 0; c < REPEAT_COPIES; c++) {
+    copies.push_back(rand() % (slack + 1));
+  }
+  sort(copies.begin(), copies.end());
+  for(int c = 0; c < REPEAT_COPIES; c++) {
+    copies[c] += c * REPEAT_LEN * 2;
+  }
+
+  struct timeval start;
+  Unitigger tigger;
+  int overlaps = 0;
+
+  gettimeofday(&start, NULL);
+
+  for(unsigned int i = 0; i < reads.size(); i++) {
+    tigger.add_read(new Read(reads[i].id, reads[i].end - reads[i].start));
+  }
+
+  for(unsigned int i = 0; i < reads.size(); i++) {
+    for(unsigned int j = i + 1;
+        j < reads.size() && reads[j].start <= reads[i].end - MIN_OVERLAP; j++) {
+      overlaps += addOverlap(tigger, reads[i], reads[j], 0, 0, GENOME_LEN);
+    }
+  }
+
+  // reads of copy c2 against reads of copy c1, projected onto c1, for
+  // the overlaps that lie within the repeat
+  vector<unsigned int> first, last;
+  for(int c = 0; c < REPEAT_COPIES; c++) {
+    unsigned int i = 0;
+    while(i < reads.size() && reads[i].start < copies[c] - READ_LEN * 2) i++;
+    first.push_back(i);
+    while(i < reads.size() && reads[i].start < copies[c] + REPEAT_LEN) i++;
+    last.push_back(i);
+  }
+
+  for(int c1 = 0; c1 < REPEAT_COPIES; c1++) {
+    for(int c2 = c1 + 1; c2 < REPEAT_COPIES; c2++) {
+      int lo = copies[c1], hi = copies[c1] + REPEAT_LEN;
+      int shift = copies[c1] - copies[c2];
+      for(unsigned int i = first[c1]; i < last[c1]; i++) {
+        for(unsigned int j = first[c2]; j < last[c2]; j++) {
+          overlaps += addOverlap(tigger, reads[i], reads[j], shift, lo, hi);
+        }
+      }
+    }
+  }
+
+  double load = since(start);
+
+  cout << reads.size() << " reads, " << overlaps << " overlaps" << endl;
+  fprintf(stdout, "  %-12s %8.3f s\n", "load", load);
+
+  gettimeofday(&start, NULL);
+  tigger.hide_containment((IGraph*) tigger.graph);
+  fprintf(stdout, "  %-12s %8.3f s\n", "containment", since(start));
+
+  gettimeofday(&start, NULL);
+  tigger.hide_transitive_overlaps((IGraph*) tigger.graph);
+  fprintf(stdout, "  %-12s %8.3f s\n", "reduction", since(start));
+
+  gettimeofday(&start, NULL);
+  tigger.find_chunks();
+  fprintf(stdout, "  %-12s %8.3f s\n", "walks", since(start));
+
+  gettimeofday(&start, NULL);
+  tigger.add_containment();
+  for(unsigned int c = 0; c < tigger.contigs.size(); c++) {
+    tigger.layout_contig(tigger.contigs[c]);
+  }
+  fprintf(stdout, "  %-12s %8.3f s\n", "layout", since(start));
+
+  cout << tigger.contigs.size() << " unitigs" << endl;
+
+  return EXIT_SUCCESS;
+}
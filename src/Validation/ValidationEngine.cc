@@ -0,0 +1,150 @@
+#include "ValidationEngine.hh"
+#include "Insert.hh"
+#include "amp.hh"
+#include <algorithm>
+
+#ifdef AMOS_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace AMOS;
+using namespace std;
+
+
+ValidationContig::~ValidationContig()
+{
+  vector<Insert *>::iterator i;
+  for (i = m_inserts.begin(); i != m_inserts.end(); i++)
+  {
+    delete *i;
+  }
+}
+
+
+ValidationEngine::ValidationEngine(DataStore & datastore)
+  : m_datastore(datastore),
+    m_needinserts(false),
+    m_batchsize(256)
+{
+}
+
+
+void ValidationEngine::addMetric(ValidationMetric * metric, ostream & out)
+{
+  m_metrics.push_back(metric);
+  m_outputs.push_back(&out);
+
+  if (metric->needsInserts()) { m_needinserts = true; }
+}
+
+
+int ValidationEngine::run(int verbose)
+{
+  int contigcount = 0;
+  vector<ValidationContig *> batch;
+
+  EventTime_t timer;
+
+  if (verbose)
+  {
+    cerr << "Streaming contigs to " << m_metrics.size() << " metrics";
+#ifdef AMOS_HAVE_OPENMP
+    cerr << " on " << omp_get_max_threads() << " threads";
+#endif
+    cerr << "... ";
+  }
+
+  m_datastore.contig_bank.seekg(1);
+
+  while (true)
+  {
+    ValidationContig * vc = new ValidationContig();
+
+    if (!(m_datastore.contig_bank >> vc->m_contig))
+    {
+      delete vc;
+      break;
+    }
+
+    vector<Tile_t> & tiling = vc->m_contig.getReadTiling();
+    sort(tiling.begin(), tiling.end(), TileOrderCmp());
+
+    //-- Insert lookups go through the DataStore banks, so resolve them here
+    if (m_needinserts)
+    {
+      m_datastore.calculateInserts(tiling, vc->m_inserts, true, 0);
+    }
+
+    batch.push_back(vc);
+    contigcount++;
+
+    if ((int)batch.size() >= m_batchsize)
+    {
+      processBatch(batch);
+    }
+  }
+
+  processBatch(batch);
+
+  for (unsigned int m = 0; m < m_metrics.size(); m++)
+  {
+    m_metrics[m]->finish(*m_outputs[m]);
+  }
+
+  if (verbose)
+  {
+    cerr << contigcount << " contigs " << timer.str() << endl;
+  }
+
+  return contigcount;
+}
+
+
+void ValidationEngine::processBatch(vector<ValidationContig *> & batch)
+{
+  int nmetrics = m_metrics.size();
+  int ntasks = batch.size() * nmetrics;
+
+  vector<ValidationRecord *> records(ntasks, (ValidationRecord *) NULL);
+  string error;
+
+  //-- Every (contig, metric) pair is independent
+#pragma omp parallel for schedule(dynamic)
+  for (int t = 0; t < ntasks; t++)
+  {
+    try
+    {
+      records[t] = m_metrics[t % nmetrics]->process(*batch[t / nmetrics]);
+    }
+    catch (const Exception_t & e)
+    {
+#pragma omp critical(ValidationEngineError)
+      if (error.empty()) { error = e.what(); }
+    }
+  }
+
+  //-- Merge in bank order
+  for (int t = 0; t < ntasks; t++)
+  {
+    if (error.empty())
+    {
+      m_metrics[t % nmetrics]->merge(*batch[t / nmetrics], records[t],
+                                      *m_outputs[t % nmetrics]);
+    }
+    else
+    {
+      delete records[t];
+    }
+  }
+
+  for (unsigned int c = 0; c < batch.size(); c++)
+  {
+    delete batch[c];
+  }
+  batch.clear();
+
+  if (!error.empty())
+  {
+    AMOS_THROW(error);
+  }
+}
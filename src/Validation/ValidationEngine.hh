@@ -0,0 +1,108 @@
+#ifndef VALIDATION_ENGINE_HH_
+#define VALIDATION_ENGINE_HH_ 1
+
+#include "foundation_AMOS.hh"
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "DataStore.hh"
+
+class Insert;
+
+
+//! \brief One contig from the bank, with its mate-pair inserts resolved
+//!
+//! The read tiling is sorted with TileOrderCmp before the inserts are
+//! computed, so metrics can walk it left to right without re-sorting.
+//! Inserts are only filled in if one of the metrics asks for them.
+//!
+struct ValidationContig
+{
+  ValidationContig() {}
+  ~ValidationContig();
+
+  AMOS::Contig_t m_contig;
+  std::vector<Insert *> m_inserts;
+
+private:
+  ValidationContig(const ValidationContig &);
+  ValidationContig & operator=(const ValidationContig &);
+};
+
+
+//! \brief Per-contig result handed from ValidationMetric::process to merge
+//!
+class ValidationRecord
+{
+public:
+  virtual ~ValidationRecord() {}
+};
+
+
+//! \brief A pluggable metric module for the ValidationEngine
+//!
+//! process() is called for every contig and may run concurrently with
+//! other contigs and other metrics, so it must only read the contig and the
+//! metric's own options. merge() is then called once per contig, serially
+//! and in bank order, to write per-contig output and accumulate any global
+//! totals. finish() is called after the last contig.
+//!
+class ValidationMetric
+{
+public:
+  ValidationMetric(const std::string & name) : m_name(name) {}
+  virtual ~ValidationMetric() {}
+
+  const std::string & getName() const { return m_name; }
+
+  //! \brief Does this metric need ValidationContig::m_inserts
+  virtual bool needsInserts() const { return false; }
+
+  virtual ValidationRecord * process(const ValidationContig & vc) const = 0;
+
+  //! \brief Consumes rec (which may be NULL) and frees it
+  virtual void merge(const ValidationContig & vc,
+                     ValidationRecord * rec,
+                     std::ostream & out) = 0;
+
+  virtual void finish(std::ostream & out) {}
+
+private:
+  std::string m_name;
+};
+
+
+//! \brief Streams a contig bank once and feeds every registered metric
+//!
+//! Contigs are read from the DataStore's contig bank in batches. For each
+//! batch the inserts are resolved once from the DataStore's cached read,
+//! fragment and library indices, then every (contig, metric) pair is
+//! processed in parallel, and the results are merged back in bank order so
+//! the output does not depend on the number of threads.
+//!
+class ValidationEngine
+{
+public:
+  ValidationEngine(DataStore & datastore);
+
+  //! \brief Registers metric, writing its output to out (neither is owned)
+  void addMetric(ValidationMetric * metric, std::ostream & out);
+
+  void setBatchSize(int size) { m_batchsize = size > 0 ? size : 1; }
+
+  //! \brief Runs all registered metrics, returns the number of contigs
+  int run(int verbose);
+
+private:
+  void processBatch(std::vector<ValidationContig *> & batch);
+
+  DataStore & m_datastore;
+  std::vector<ValidationMetric *> m_metrics;
+  std::vector<std::ostream *> m_outputs;
+  bool m_needinserts;
+  int m_batchsize;
+};
+
+
+#endif
@@ -0,0 +1,556 @@
+#include "ValidationMetrics.hh"
+#include "Feature_AMOS.hh"
+#include "Insert.hh"
+#include "InsertStats.hh"
+#include "CoverageStats.hh"
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+using namespace AMOS;
+using namespace std;
+
+
+//-- Record for metrics whose per-contig output is just text
+struct TextRecord : public ValidationRecord
+{
+  string m_text;
+};
+
+//-- Record for metrics that accumulate (library, size) pairs
+struct SizeRecord : public ValidationRecord
+{
+  vector< pair<ID_t, int> > m_sizes;
+};
+
+
+//======================================================= ReadDepthMetric ====//
+struct DepthPoint
+{
+  int m_offset;
+  int m_roffset;
+  int m_depth;
+};
+
+struct DepthRecord : public ValidationRecord
+{
+  ID_t   m_iid;
+  string m_eid;
+  int    m_clen, m_uclen;
+  double m_rl, m_url;
+  int    m_rc;
+  vector<DepthPoint> m_points;
+};
+
+
+ReadDepthMetric::ReadDepthMetric()
+  : ValidationMetric("depth"),
+    m_thresholdx(3.0), m_clusterdist(0), m_mincontiglen(0),
+    m_printiid(false), m_useungapped(false),
+    m_conslen(0), m_uconslen(0), m_readlen(0), m_ureadlen(0),
+    m_contigs(0), m_readcount(0)
+{
+}
+
+
+ReadDepthMetric::~ReadDepthMetric()
+{
+  for (unsigned int i = 0; i < m_pending.size(); i++)
+  {
+    delete m_pending[i];
+  }
+}
+
+
+ValidationRecord * ReadDepthMetric::process(const ValidationContig & vc) const
+{
+  const Contig_t & contig = vc.m_contig;
+  DepthRecord * rec = new DepthRecord();
+
+  rec->m_iid   = contig.getIID();
+  rec->m_eid   = contig.getEID();
+  rec->m_clen  = contig.getLength();
+  rec->m_uclen = contig.getUngappedLength();
+  rec->m_rl    = 0.0;
+  rec->m_url   = 0.0;
+  rec->m_rc    = 0;
+
+  multiset<int> endpoints;
+  multiset<int>::iterator ep, ep2;
+
+  const vector<Tile_t> & tiling = contig.getReadTiling();
+  vector<Tile_t>::const_iterator ti;
+
+  rec->m_points.reserve(tiling.size());
+
+  for (ti = tiling.begin(); ti != tiling.end(); ti++)
+  {
+    rec->m_rl  += ti->getGappedLength();
+    rec->m_url += ti->range.getLength();
+    rec->m_rc++;
+
+    DepthPoint p;
+    p.m_offset  = ti->offset;
+    p.m_roffset = ti->getRightOffset();
+
+    ep = endpoints.begin();
+    while ((ep != endpoints.end()) && (*ep < p.m_offset))
+    {
+      ep2 = ep;
+      ep++;
+      endpoints.erase(ep2);
+    }
+
+    endpoints.insert(p.m_roffset);
+    p.m_depth = endpoints.size();
+
+    rec->m_points.push_back(p);
+  }
+
+  return rec;
+}
+
+
+void ReadDepthMetric::merge(const ValidationContig & vc,
+                            ValidationRecord * rec,
+                            ostream & out)
+{
+  DepthRecord * drec = (DepthRecord *) rec;
+
+  int clen = m_useungapped ? drec->m_uclen : drec->m_clen;
+
+  if (clen >= m_mincontiglen)
+  {
+    m_contigs++;
+    m_conslen   += drec->m_clen;
+    m_uconslen  += drec->m_uclen;
+    m_readlen   += drec->m_rl;
+    m_ureadlen  += drec->m_url;
+    m_readcount += drec->m_rc;
+  }
+
+  m_pending.push_back(rec);
+}
+
+
+void ReadDepthMetric::finish(ostream & out)
+{
+  double avgdepth = m_readlen / m_conslen;
+  double uavgdepth = m_ureadlen / m_uconslen;
+  double threshdepth = avgdepth * m_thresholdx;
+
+  cerr << "Processed contigs >= " << m_mincontiglen << "bp." << endl;
+  cerr << "Processed reads: " << m_readcount << " contigs: " << m_contigs << endl;
+  cerr << "Global average contig depth: " << avgdepth << " [" << m_readlen << "/" << m_conslen << "]" << endl;
+  cerr << "Global ungapped average contig depth: " << uavgdepth << " [" << m_ureadlen << "/" << m_uconslen << "]" << endl;
+  cerr << "Flagging regions above: " << threshdepth << endl;
+
+  for (unsigned int i = 0; i < m_pending.size(); i++)
+  {
+    DepthRecord * drec = (DepthRecord *) m_pending[i];
+
+    bool cluster = false;
+    int start;
+    int end = -m_clusterdist - 10;
+    int maxdepth = 0;
+
+    vector<DepthPoint>::const_iterator pi;
+    for (pi = drec->m_points.begin(); pi != drec->m_points.end(); pi++)
+    {
+      if (pi->m_depth > threshdepth)
+      {
+        if (!cluster)
+        {
+          start = pi->m_offset;
+          cluster = true;
+        }
+
+        end = pi->m_roffset;
+
+        if (pi->m_depth > maxdepth) { maxdepth = pi->m_depth; }
+      }
+      else if (cluster && (pi->m_offset > end + m_clusterdist))
+      {
+        if (m_printiid) { out << drec->m_iid; }
+        else            { out << drec->m_eid; }
+
+        out << "\t" << Feature_t::COVERAGE << "\t" << start << "\t" << end << "\tHIGH_READ_COVERAGE " << maxdepth << endl;
+        maxdepth = 0;
+
+        cluster = false;
+      }
+    }
+
+    if (cluster)
+    {
+      if (m_printiid) { out << drec->m_iid; }
+      else            { out << drec->m_eid; }
+
+      out << "\t" << Feature_t::COVERAGE << "\t" << start << "\t" << drec->m_clen << "\tHIGH_READ_COVERAGE " << maxdepth << endl;
+    }
+
+    delete drec;
+  }
+
+  m_pending.clear();
+}
+
+
+
+
+//==================================================== ReadCoverageMetric ====//
+ReadCoverageMetric::ReadCoverageMetric()
+  : ValidationMetric("cov"),
+    m_stride(1)
+{
+}
+
+
+ValidationRecord * ReadCoverageMetric::process(const ValidationContig & vc) const
+{
+  const Contig_t & contig = vc.m_contig;
+  const vector<Tile_t> & tiling = contig.getReadTiling();
+  vector<Tile_t>::const_iterator ti = tiling.begin();
+
+  multiset<int> endpoints;
+  multiset<int>::iterator ep, ep2;
+
+  ostringstream oss;
+  oss << ">Contig " << contig.getIID() << "\n";
+
+  int conslen = contig.getLength();
+
+  for (int offset = 0; offset < conslen; offset++)
+  {
+    ep = endpoints.begin();
+    while ((ep != endpoints.end()) && (*ep < offset))
+    {
+      ep2 = ep;
+      ep++;
+      endpoints.erase(ep2);
+    }
+
+    while ((ti != tiling.end()) && (ti->offset == offset))
+    {
+      endpoints.insert(ti->getRightOffset());
+      ti++;
+    }
+
+    if (offset % m_stride == 0)
+    {
+      oss << offset << " " << endpoints.size() << "\n";
+    }
+  }
+
+  TextRecord * rec = new TextRecord();
+  rec->m_text = oss.str();
+  return rec;
+}
+
+
+void ReadCoverageMetric::merge(const ValidationContig & vc,
+                               ValidationRecord * rec,
+                               ostream & out)
+{
+  out << ((TextRecord *) rec)->m_text;
+  delete rec;
+}
+
+
+
+
+//========================================================== CEStatMetric ====//
+CEStatMetric::CEStatMetric(DataStore & datastore)
+  : ValidationMetric("ce"),
+    m_features(0.0), m_minlen(100), m_printiid(false),
+    m_datastore(datastore)
+{
+}
+
+
+ValidationRecord * CEStatMetric::process(const ValidationContig & vc) const
+{
+  typedef map<ID_t, CoverageStats> LibStats;
+  LibStats::iterator li;
+
+  //-- computeCEStats only reads the inserts and no DataStore state
+  vector<Insert *> inserts(vc.m_inserts);
+  LibStats libStats = m_datastore.computeCEStats(inserts);
+
+  ostringstream id;
+  if (m_printiid) { id << vc.m_contig.getIID(); }
+  else            { id << vc.m_contig.getEID(); }
+
+  ostringstream oss;
+
+  if (m_features)
+  {
+    double b = 0;
+    double e = 0;
+    double sign;
+
+    for (li = libStats.begin(); li != libStats.end(); li++)
+    {
+      // This are stored as oldvalue newvalue so skip every other one
+      for (int i = 1; i < li->second.m_curpos; i+=2)
+      {
+        if (b)
+          if (li->second.m_cestat[i] * sign < 0 ||
+              fabs(li->second.m_cestat[i]) < m_features)
+          {
+            if (e-b >= m_minlen)
+            {
+              oss << id.str() << " " << Feature_t::MATEPAIR << " " << b << " "
+                  << li->second.m_coverage[i].x() << " ";
+              if (sign < 0)
+                oss << "CE_COMPRESS ";
+              else
+                oss << "CE_STRETCH ";
+              oss << "LIB=" << li->first << "\n";
+            }
+
+            b = e = 0;
+          }
+
+        if (fabs(li->second.m_cestat[i]) >= m_features)
+        {
+          if (b)
+            e = li->second.m_coverage[i].x();
+          else
+          {
+            b = e = li->second.m_coverage[i].x();
+            sign = li->second.m_cestat[i];
+          }
+        }
+      }
+
+      if (b && e)
+      {
+        if (e-b >= m_minlen)
+        {
+          oss << id.str() << " " << Feature_t::MATEPAIR << " " << b << " " << e << " ";
+          if (sign < 0)
+            oss << "CE_COMPRESS ";
+          else
+            oss << "CE_STRETCH ";
+          oss << "LIB=" << li->first << "\n";
+        }
+        b = e = 0;
+      }
+    }
+  }
+  else
+  {
+    for (li = libStats.begin(); li != libStats.end(); li++)
+    {
+      oss << ">" << id.str() << " lib:" << li->first << "\n";
+      // This are stored as oldvalue newvalue so skip every other one
+      for (int i = 1; i < li->second.m_curpos; i+=2)
+      {
+        oss << setprecision(10) << li->second.m_coverage[i].x() << " "
+            << setprecision(6)  << li->second.m_cestat[i] << "\n";
+      }
+    }
+  }
+
+  TextRecord * rec = new TextRecord();
+  rec->m_text = oss.str();
+  return rec;
+}
+
+
+void CEStatMetric::merge(const ValidationContig & vc,
+                         ValidationRecord * rec,
+                         ostream & out)
+{
+  out << ((TextRecord *) rec)->m_text;
+  delete rec;
+}
+
+
+
+
+//================================================ LibraryHistogramMetric ====//
+LibraryHistogramMetric::LibraryHistogramMetric()
+  : ValidationMetric("libhist"),
+    m_contigs(0)
+{
+}
+
+
+LibraryHistogramMetric::~LibraryHistogramMetric()
+{
+  map<ID_t, InsertStats *>::iterator li;
+  for (li = m_libstats.begin(); li != m_libstats.end(); li++)
+  {
+    delete li->second;
+  }
+}
+
+
+ValidationRecord * LibraryHistogramMetric::process(const ValidationContig & vc) const
+{
+  SizeRecord * rec = new SizeRecord();
+
+  vector<Insert *>::const_iterator vi;
+  for (vi = vc.m_inserts.begin(); vi != vc.m_inserts.end(); vi++)
+  {
+    if ((*vi)->ceConnected())
+    {
+      rec->m_sizes.push_back(make_pair((*vi)->m_libid, (*vi)->m_actual));
+    }
+  }
+
+  return rec;
+}
+
+
+void LibraryHistogramMetric::merge(const ValidationContig & vc,
+                                   ValidationRecord * rec,
+                                   ostream & out)
+{
+  SizeRecord * srec = (SizeRecord *) rec;
+  map<ID_t, InsertStats *>::iterator li;
+
+  m_contigs++;
+
+  for (unsigned int i = 0; i < srec->m_sizes.size(); i++)
+  {
+    li = m_libstats.find(srec->m_sizes[i].first);
+
+    if (li == m_libstats.end())
+    {
+      li = m_libstats.insert(make_pair(srec->m_sizes[i].first, new InsertStats(""))).first;
+    }
+
+    li->second->addSize(srec->m_sizes[i].second);
+  }
+
+  delete srec;
+}
+
+
+void LibraryHistogramMetric::finish(ostream & out)
+{
+  map<ID_t, InsertStats *>::iterator li;
+  char buffer[64];
+
+  out << "contigs: " << m_contigs << endl;
+
+  for (li = m_libstats.begin(); li != m_libstats.end(); li++)
+  {
+    out << endl;
+    out << "library: " << li->first
+        << " count: "  << li->second->count()
+        << " mean: "   << li->second->mean()
+        << " stdev: "  << li->second->stdev() << endl;
+
+    int buckets = 50;
+    li->second->histogram(buckets, false);
+    out << "low: "         << li->second->m_low
+        << " high: "       << li->second->m_high
+        << " buckets: "    << buckets
+        << " bucketsize: " << li->second->m_bucketsize << endl;
+
+    double starsize = li->second->m_maxcount / 40.0;
+
+    for (int i = 0; i < buckets; i++)
+    {
+      sprintf(buffer, "%10.02f %6d: ", li->second->m_bucketlow[i], li->second->m_buckets[i]);
+      out << buffer;
+
+      int numstars = floor(li->second->m_buckets[i] / starsize);
+
+      if (numstars > 40) { cerr << "ERROR: numstars: " << numstars; }
+      else
+      {
+        for (int j = 0; j < numstars; j++)
+        {
+          out << "*";
+        }
+      }
+
+      out << endl;
+    }
+  }
+}
+
+
+
+
+//====================================================== InsertSizeMetric ====//
+InsertSizeMetric::InsertSizeMetric()
+  : ValidationMetric("inserts")
+{
+}
+
+
+InsertSizeMetric::~InsertSizeMetric()
+{
+  map<string, InsertStats *>::iterator fi;
+  for (fi = m_libstats.begin(); fi != m_libstats.end(); fi++)
+  {
+    delete fi->second;
+  }
+}
+
+
+ValidationRecord * InsertSizeMetric::process(const ValidationContig & vc) const
+{
+  SizeRecord * rec = new SizeRecord();
+
+  vector<Insert *>::const_iterator vi;
+  for (vi = vc.m_inserts.begin(); vi != vc.m_inserts.end(); vi++)
+  {
+    if ((*vi)->m_active == 2)
+    {
+      rec->m_sizes.push_back(make_pair((*vi)->m_libid, (*vi)->m_actual));
+    }
+  }
+
+  return rec;
+}
+
+
+void InsertSizeMetric::merge(const ValidationContig & vc,
+                             ValidationRecord * rec,
+                             ostream & out)
+{
+  SizeRecord * srec = (SizeRecord *) rec;
+  map<string, InsertStats *>::iterator fi;
+  char buffer[16];
+
+  for (unsigned int i = 0; i < srec->m_sizes.size(); i++)
+  {
+    sprintf(buffer, "%d", srec->m_sizes[i].first);
+    string fragment = buffer;
+
+    fi = m_libstats.find(fragment);
+    if (fi == m_libstats.end())
+    {
+      fi = m_libstats.insert(make_pair(fragment, new InsertStats(buffer))).first;
+    }
+
+    fi->second->addSize(srec->m_sizes[i].second);
+  }
+
+  delete srec;
+}
+
+
+void InsertSizeMetric::finish(ostream & out)
+{
+  map<string, InsertStats *>::iterator fi;
+
+  out << "SubLibrary (k=0) Summaries" << endl;
+  for (fi = m_libstats.begin(); fi != m_libstats.end(); fi++)
+  {
+    out << fi->second->m_label << "\t"
+        << fi->first << "\t"
+        << fi->second->count() << "\t"
+        << fi->second->mean() << "\t"
+        << fi->second->stdev() << endl;
+  }
+}
@@ -0,0 +1,112 @@
+#ifndef VALIDATION_METRICS_HH_
+#define VALIDATION_METRICS_HH_ 1
+
+#include "ValidationEngine.hh"
+#include <map>
+#include <string>
+#include <vector>
+
+class InsertStats;
+
+
+//! \brief Flags unusually deep regions, as analyze-read-depth -c -x
+//!
+//! The global average depth is only known after the last contig, so the
+//! per-read depth profile is kept until finish().
+//!
+class ReadDepthMetric : public ValidationMetric
+{
+public:
+  ReadDepthMetric();
+  ~ReadDepthMetric();
+
+  ValidationRecord * process(const ValidationContig & vc) const;
+  void merge(const ValidationContig & vc, ValidationRecord * rec, std::ostream & out);
+  void finish(std::ostream & out);
+
+  float m_thresholdx;
+  int   m_clusterdist;
+  int   m_mincontiglen;
+  bool  m_printiid;
+  bool  m_useungapped;
+
+private:
+  std::vector<ValidationRecord *> m_pending;
+  double m_conslen, m_uconslen;
+  double m_readlen, m_ureadlen;
+  int m_contigs, m_readcount;
+};
+
+
+//! \brief Per-base read coverage, as read-cov-plot (contig coordinates)
+//!
+class ReadCoverageMetric : public ValidationMetric
+{
+public:
+  ReadCoverageMetric();
+
+  ValidationRecord * process(const ValidationContig & vc) const;
+  void merge(const ValidationContig & vc, ValidationRecord * rec, std::ostream & out);
+
+  int m_stride;
+};
+
+
+//! \brief Compression-expansion statistic, as cestat-cov over contigs
+//!
+class CEStatMetric : public ValidationMetric
+{
+public:
+  CEStatMetric(DataStore & datastore);
+
+  bool needsInserts() const { return true; }
+  ValidationRecord * process(const ValidationContig & vc) const;
+  void merge(const ValidationContig & vc, ValidationRecord * rec, std::ostream & out);
+
+  double m_features;
+  int    m_minlen;
+  bool   m_printiid;
+
+private:
+  DataStore & m_datastore;
+};
+
+
+//! \brief Insert size histogram per library, as library-histogram
+//!
+class LibraryHistogramMetric : public ValidationMetric
+{
+public:
+  LibraryHistogramMetric();
+  ~LibraryHistogramMetric();
+
+  bool needsInserts() const { return true; }
+  ValidationRecord * process(const ValidationContig & vc) const;
+  void merge(const ValidationContig & vc, ValidationRecord * rec, std::ostream & out);
+  void finish(std::ostream & out);
+
+private:
+  std::map<AMOS::ID_t, InsertStats *> m_libstats;
+  int m_contigs;
+};
+
+
+//! \brief Insert size summary per library, as insert-sizes -c
+//!
+class InsertSizeMetric : public ValidationMetric
+{
+public:
+  InsertSizeMetric();
+  ~InsertSizeMetric();
+
+  bool needsInserts() const { return true; }
+  ValidationRecord * process(const ValidationContig & vc) const;
+  void merge(const ValidationContig & vc, ValidationRecord * rec, std::ostream & out);
+  void finish(std::ostream & out);
+
+private:
+  std::map<std::string, InsertStats *> m_libstats;
+};
+
+
+#endif
@@ -1,6 +1,15 @@
 #include "foundation_AMOS.hh"
 #include "amp.hh"
 #include "fasta.hh"
+#include <algorithm>
+#include <queue>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#ifdef AMOS_HAVE_OPENMP
+#include <omp.h>
+#endif
 
 
 using namespace AMOS;
@@ -32,21 +41,11 @@ long hashstring(const string & s)
 
 
 
-int main(int argc, char ** argv)
+// The original search: bucket the reads by a weak hash of the sequence, and
+// compare the sequences within each bucket
+int findByHash(const string & bank_name)
 {
-  if (argc != 2)
-  {
-    cerr << "Usage: find-duplicate-reads bankname" << endl;
-    return EXIT_FAILURE;
-  }
-
   Bank_t red_bank(Read_t::NCODE);
-  string bank_name = argv[1];
-
-  int verbose = 0;
-
-  cerr << "Processing " << bank_name << " at " << Date() << endl;
-
 
   try
   {
@@ -138,7 +137,434 @@ int main(int argc, char ** argv)
     return EXIT_FAILURE;
   }
 
-  cerr << "End: " << Date() << endl;
+  return EXIT_SUCCESS;
+}
+
+
+
+
+//----------------------------------------------------------------------------
+// Streaming search: scan the bank in order, fingerprint every read with a
+// 128 bit hash, sort the fingerprints in runs that fit the memory budget and
+// report the groups of equal fingerprints in one merge of the runs
+
+
+struct Options_t
+{
+  bool clearOnly;         // fingerprint the clear range only
+  bool bothStrands;       // reverse complements are duplicates too
+  int prefix;             // fingerprint the first prefix bases, 0 for all
+  size_t memory;          // bytes of fingerprints sorted in memory
+  string tmpdir;          // directory of the sorted runs
+
+  Options_t()
+    : clearOnly(false), bothStrands(false), prefix(0),
+      memory(1024 * 1024 * 1024), tmpdir("/tmp")
+  { }
+};
+
+
+struct Fingerprint_t
+{
+  uint64_t h1;
+  uint64_t h2;
+  ID_t iid;
+
+  bool operator< (const Fingerprint_t & o) const
+  {
+    if (h1 != o.h1) { return h1 < o.h1; }
+    if (h2 != o.h2) { return h2 < o.h2; }
+    return iid < o.iid;
+  }
+
+  bool sameHash(const Fingerprint_t & o) const
+  {
+    return h1 == o.h1 && h2 == o.h2;
+  }
+};
+
+
+static inline uint64_t rotl64(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+
+static inline uint64_t fmix64(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+
+// MurmurHash3_x64_128 of len bytes
+static void murmur3(const char * data, int len, uint64_t & h1, uint64_t & h2)
+{
+  const uint64_t c1 = 0x87c37b91114253d5ULL;
+  const uint64_t c2 = 0x4cf5ad432745937fULL;
+  const int nblocks = len / 16;
+
+  h1 = h2 = 0;
+
+  for (int i = 0; i < nblocks; i++)
+  {
+    uint64_t k1, k2;
+    memcpy(&k1, data + i * 16, 8);
+    memcpy(&k2, data + i * 16 + 8, 8);
+
+    k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+    k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+    h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+  }
+
+  const unsigned char * tail = (const unsigned char *)(data + nblocks * 16);
+  uint64_t k1 = 0, k2 = 0;
+
+  switch (len & 15)
+  {
+    case 15: k2 ^= (uint64_t)tail[14] << 48;
+    case 14: k2 ^= (uint64_t)tail[13] << 40;
+    case 13: k2 ^= (uint64_t)tail[12] << 32;
+    case 12: k2 ^= (uint64_t)tail[11] << 24;
+    case 11: k2 ^= (uint64_t)tail[10] << 16;
+    case 10: k2 ^= (uint64_t)tail[ 9] << 8;
+    case  9: k2 ^= (uint64_t)tail[ 8];
+             k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+    case  8: k1 ^= (uint64_t)tail[ 7] << 56;
+    case  7: k1 ^= (uint64_t)tail[ 6] << 48;
+    case  6: k1 ^= (uint64_t)tail[ 5] << 40;
+    case  5: k1 ^= (uint64_t)tail[ 4] << 32;
+    case  4: k1 ^= (uint64_t)tail[ 3] << 24;
+    case  3: k1 ^= (uint64_t)tail[ 2] << 16;
+    case  2: k1 ^= (uint64_t)tail[ 1] << 8;
+    case  1: k1 ^= (uint64_t)tail[ 0];
+             k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+  }
+
+  h1 ^= len; h2 ^= len;
+  h1 += h2; h2 += h1;
+  h1 = fmix64(h1); h2 = fmix64(h2);
+  h1 += h2; h2 += h1;
+}
+
+
+// Fingerprint of a read, with N read as A like findByHash
+static Fingerprint_t fingerprint(Read_t & red, const Options_t & options)
+{
+  string seq = options.clearOnly ? red.getSeqString(red.getClearRange())
+                                 : red.getSeqString();
+
+  for (string::iterator si = seq.begin(); si != seq.end(); si++)
+  {
+    *si = toupper(*si);
+    if (*si == 'N') { *si = 'A'; }
+  }
+
+  Fingerprint_t fp;
+  fp.iid = red.getIID();
+
+  int len = seq.length();
+  if (options.prefix > 0 && options.prefix < len) { len = options.prefix; }
+  murmur3(seq.data(), len, fp.h1, fp.h2);
+
+  if (options.bothStrands)
+  {
+    Reverse_Complement(seq);
+
+    Fingerprint_t rc;
+    murmur3(seq.data(), len, rc.h1, rc.h2);
+
+    if (rc.h1 < fp.h1 || (rc.h1 == fp.h1 && rc.h2 < fp.h2))
+    {
+      fp.h1 = rc.h1;
+      fp.h2 = rc.h2;
+    }
+  }
+
+  return fp;
+}
+
+
+// Sorts the buffer and writes it to a new unlinked run file
+static FILE * writeRun(vector<Fingerprint_t> & buffer, const Options_t & options)
+{
+  sort(buffer.begin(), buffer.end());
+
+  string path = options.tmpdir + "/find-duplicate-reads.XXXXXX";
+  vector<char> name(path.begin(), path.end());
+  name.push_back('\0');
+
+  int fd = mkstemp(&name[0]);
+  if (fd == -1)
+  {
+    AMOS_THROW_IO("Could not create sort run in " + options.tmpdir);
+  }
+  unlink(&name[0]);
+
+  FILE * fp = fdopen(fd, "w+b");
+  if (fp == NULL ||
+      fwrite(&buffer[0], sizeof(Fingerprint_t), buffer.size(), fp) != buffer.size() ||
+      fflush(fp) != 0)
+  {
+    AMOS_THROW_IO("Could not write sort run in " + options.tmpdir);
+  }
+  rewind(fp);
+
+  buffer.clear();
+  return fp;
+}
+
+
+// A sorted run being merged, read from its file a block at a time, or held
+// in memory if fp is NULL
+struct Run_t
+{
+  FILE * fp;
+  size_t blocksize;
+  vector<Fingerprint_t> block;
+  size_t next;
+
+  bool load()
+  {
+    block.resize(blocksize);
+    block.resize(fread(&block[0], sizeof(Fingerprint_t), blocksize, fp));
+    next = 0;
+
+    return !block.empty();
+  }
+
+  bool advance()
+  {
+    if (++next < block.size()) { return true; }
+    return fp && load();
+  }
+
+  const Fingerprint_t & top() const { return block[next]; }
+};
+
+
+struct RunOrder_t
+{
+  const vector<Run_t> * runs;
+
+  bool operator() (int a, int b) const
+  {
+    return (*runs)[b].top() < (*runs)[a].top();
+  }
+};
+
+
+// Prints a group of duplicate reads, as findByHash
+static void printGroup(const vector<ID_t> & group, BankStream_t & red_bank)
+{
+  cout << red_bank.lookupEID(group[0]);
+  for (size_t i = 1; i < group.size(); i++)
+  {
+    cout << "\t" << red_bank.lookupEID(group[i]);
+  }
+  cout << endl;
+}
+
+
+int findBySort(const string & bank_name, const Options_t & options)
+{
+  const Size_t BATCH = 65536;
+  BankStream_t red_bank(Read_t::NCODE);
+
+  try
+  {
+    red_bank.open(bank_name, B_READ);
+
+    size_t capacity = max(options.memory / sizeof(Fingerprint_t), (size_t)1024);
+    Size_t batch = min((size_t)BATCH, capacity);
+    vector<Fingerprint_t> buffer;
+    vector<FILE *> files;
+    vector<Read_t> reads(batch);
+    long count = 0;
+
+    buffer.reserve(capacity);
+
+    //-- Fingerprint the reads a batch at a time, spilling sorted runs
+    while (!red_bank.eof())
+    {
+      Size_t n = 0;
+      while (n < batch && !red_bank.eof() && red_bank >> reads[n]) { n++; }
+
+      if (buffer.size() + n > capacity)
+      {
+        files.push_back(writeRun(buffer, options));
+      }
+
+      size_t first = buffer.size();
+      buffer.resize(first + n);
+
+      #pragma omp parallel for schedule(dynamic, 1024)
+      for (Size_t i = 0; i < n; i++)
+      {
+        buffer[first + i] = fingerprint(reads[i], options);
+      }
+
+      count += n;
+    }
+
+    cerr << "Fingerprinted " << count << " reads in "
+         << files.size() + 1 << " sorted runs." << endl;
+
+    //-- Merge the runs. A single run is merged straight from memory, else
+    //   the last one is spilled too, so the read blocks of the runs can
+    //   share the whole memory budget
+    vector<Run_t> runs;
+
+    if (files.empty())
+    {
+      sort(buffer.begin(), buffer.end());
+      runs.resize(1);
+      runs.back().fp = NULL;
+      runs.back().block.swap(buffer);
+      runs.back().next = 0;
+    }
+    else
+    {
+      if (!buffer.empty()) { files.push_back(writeRun(buffer, options)); }
+      vector<Fingerprint_t>().swap(buffer);
+
+      size_t blocksize = max(capacity / files.size(), (size_t)1024);
+      runs.resize(files.size());
+      for (size_t i = 0; i < files.size(); i++)
+      {
+        runs[i].fp = files[i];
+        runs[i].blocksize = blocksize;
+      }
+    }
+
+    RunOrder_t order;
+    order.runs = &runs;
+    priority_queue<int, vector<int>, RunOrder_t> heap(order);
+
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+      if (runs[i].fp ? runs[i].load() : !runs[i].block.empty())
+      {
+        heap.push(i);
+      }
+    }
+
+    vector<ID_t> group;
+    Fingerprint_t last = { 0, 0, NULL_ID };
+    long groups = 0, dups = 0;
+
+    while (!heap.empty())
+    {
+      int r = heap.top();
+      heap.pop();
+
+      const Fingerprint_t & fp = runs[r].top();
+
+      if (!group.empty() && !fp.sameHash(last))
+      {
+        if (group.size() > 1)
+        {
+          printGroup(group, red_bank);
+          groups++;
+          dups += group.size() - 1;
+        }
+        group.clear();
+      }
+
+      last = fp;
+      group.push_back(fp.iid);
+
+      if (runs[r].advance()) { heap.push(r); }
+    }
+
+    if (group.size() > 1)
+    {
+      printGroup(group, red_bank);
+      groups++;
+      dups += group.size() - 1;
+    }
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+      fclose(files[i]);
+    }
+
+    cerr << "Found " << groups << " groups with " << dups
+         << " duplicate reads" << endl;
+  }
+  catch (Exception_t & e)
+  {
+    cerr << "ERROR: -- Fatal AMOS Exception --\n" << e;
+    return EXIT_FAILURE;
+  }
 
   return EXIT_SUCCESS;
 }
+
+
+void printUsage()
+{
+  cerr << "Usage: find-duplicate-reads [options] bankname" << endl
+       << endl
+       << "Prints the EIDs of each group of reads with the same sequence on a line" << endl
+       << endl
+       << "Options" << endl
+       << "  -s         Stream the bank and external sort 128 bit fingerprints," << endl
+       << "             instead of comparing the reads in buckets of a weak hash" << endl
+       << "  -c         Compare the clear ranges only (implies -s)" << endl
+       << "  -r         Also report reverse complement duplicates (implies -s)" << endl
+       << "  -p n       Report near duplicates, with the same first n bases (implies -s)" << endl
+       << "  -m mb      Memory for sorting in MB (default 1024)" << endl
+       << "  -T dir     Directory for the sorted runs (default /tmp)" << endl
+       << "  -t n       Number of threads (default all processors)" << endl;
+}
+
+
+int main(int argc, char ** argv)
+{
+  Options_t options;
+  bool streaming = false;
+  int threads = 0;
+  int ch;
+
+  while ((ch = getopt(argc, argv, "hcrsp:m:T:t:")) != EOF)
+  {
+    switch (ch)
+    {
+      case 's': streaming = true; break;
+      case 'c': streaming = true; options.clearOnly = true; break;
+      case 'r': streaming = true; options.bothStrands = true; break;
+      case 'p': streaming = true; options.prefix = atoi(optarg); break;
+      case 'm': options.memory = (size_t) atol(optarg) * 1024 * 1024; break;
+      case 'T': options.tmpdir = optarg; break;
+      case 't': threads = atoi(optarg); break;
+      case 'h': printUsage(); return EXIT_SUCCESS;
+      default: printUsage(); return EXIT_FAILURE;
+    }
+  }
+
+  if (argc - optind != 1)
+  {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+#ifdef AMOS_HAVE_OPENMP
+  if (threads > 0) { omp_set_num_threads(threads); }
+#endif
+
+  string bank_name = argv[optind];
+  cerr << "Processing " << bank_name << " at " << Date() << endl;
+
+  int retval = streaming ? findBySort(bank_name, options)
+                         : findByHash(bank_name);
+
+  cerr << "End: " << Date() << endl;
+
+  return retval;
+}
@@ -0,0 +1,261 @@
+////////////////////////////////////////////////////////////////////////////////
+//! \file
+//!
+//! \brief Computes several validation metrics in a single pass over a bank
+//!
+////////////////////////////////////////////////////////////////////////////////
+
+#include "foundation_AMOS.hh"
+#include <iostream>
+#include <fstream>
+#include <unistd.h>
+
+#include "DataStore.hh"
+#include "ValidationEngine.hh"
+#include "ValidationMetrics.hh"
+
+using namespace std;
+using namespace AMOS;
+
+
+//=============================================================== Globals ====//
+string OPT_BankName;                 // bank name parameter
+string OPT_Prefix;                   // output prefix
+string OPT_Metrics = "depth,ce";     // comma separated metrics to compute
+int    OPT_BatchSize = 256;          // contigs per parallel batch
+bool   OPT_IIDs = false;             // print contig IIDs instead of EIDs
+float  OPT_DepthX = 3.0;             // depth: flag at this x average depth
+int    OPT_DepthCluster = 0;         // depth: cluster regions within dist
+int    OPT_DepthMinLen = 0;          // depth: min contig len for average
+bool   OPT_DepthUngapped = false;    // depth: use ungapped lengths
+double OPT_CEFeatures = 0.0;         // ce: only features outside n devs
+int    OPT_CEMinLen = 100;           // ce: min feature length
+int    OPT_CovStride = 1;            // cov: only every n-th position
+
+
+//========================================================== Fuction Decs ====//
+//----------------------------------------------------- ParseArgs --------------
+//! \brief Sets the global OPT_% values from the command line arguments
+//!
+//! \return void
+//!
+void ParseArgs (int argc, char ** argv);
+
+
+//----------------------------------------------------- PrintHelp --------------
+//! \brief Prints help information to cerr
+//!
+//! \param s The program name, i.e. argv[0]
+//! \return void
+//!
+void PrintHelp (const char * s);
+
+
+//----------------------------------------------------- PrintUsage -------------
+//! \brief Prints usage information to cerr
+//!
+//! \param s The program name, i.e. argv[0]
+//! \return void
+//!
+void PrintUsage (const char * s);
+
+
+
+//========================================================= Function Defs ====//
+int main (int argc, char ** argv)
+{
+  int exitcode = EXIT_SUCCESS;
+
+  vector<ValidationMetric *> metrics;
+  vector<ofstream *> outputs;
+
+  //-- Parse the command line arguments
+  ParseArgs (argc, argv);
+
+  //-- BEGIN: MAIN EXCEPTION CATCH
+  try {
+
+    DataStore datastore;
+    if (datastore.openBank(OPT_BankName))
+    {
+      AMOS_THROW_IO("Could not open bank: " + OPT_BankName);
+    }
+
+    ValidationEngine engine(datastore);
+    engine.setBatchSize(OPT_BatchSize);
+
+    string::size_type pos = 0;
+    while (pos != string::npos)
+    {
+      string::size_type next = OPT_Metrics.find(',', pos);
+      string name = OPT_Metrics.substr(pos, next == string::npos ? next : next - pos);
+      pos = (next == string::npos) ? next : next + 1;
+
+      ValidationMetric * metric = NULL;
+      string suffix;
+
+      if (name == "depth")
+      {
+        ReadDepthMetric * m = new ReadDepthMetric();
+        m->m_thresholdx   = OPT_DepthX;
+        m->m_clusterdist  = OPT_DepthCluster;
+        m->m_mincontiglen = OPT_DepthMinLen;
+        m->m_useungapped  = OPT_DepthUngapped;
+        m->m_printiid     = OPT_IIDs;
+        metric = m; suffix = ".depth.feat";
+      }
+      else if (name == "ce")
+      {
+        CEStatMetric * m = new CEStatMetric(datastore);
+        m->m_features = OPT_CEFeatures;
+        m->m_minlen   = OPT_CEMinLen;
+        m->m_printiid = OPT_IIDs;
+        metric = m; suffix = OPT_CEFeatures ? ".ce.feat" : ".ce";
+      }
+      else if (name == "cov")
+      {
+        ReadCoverageMetric * m = new ReadCoverageMetric();
+        m->m_stride = OPT_CovStride;
+        metric = m; suffix = ".cov";
+      }
+      else if (name == "libhist")
+      {
+        metric = new LibraryHistogramMetric(); suffix = ".libhist";
+      }
+      else if (name == "inserts")
+      {
+        metric = new InsertSizeMetric(); suffix = ".inserts";
+      }
+      else
+      {
+        AMOS_THROW_ARGUMENT("Unknown metric: " + name);
+      }
+
+      string filename = OPT_Prefix + suffix;
+      ofstream * out = new ofstream(filename.c_str());
+      if (!*out)
+      {
+        AMOS_THROW_IO("Could not open output file: " + filename);
+      }
+
+      cerr << "Writing " << metric->getName() << " to " << filename << endl;
+
+      metrics.push_back(metric);
+      outputs.push_back(out);
+      engine.addMetric(metric, *out);
+    }
+
+    engine.run(1);
+  }
+  catch (const Exception_t & e) {
+    cerr << "FATAL: " << e . what( ) << endl
+         << "  there has been a fatal error, abort" << endl;
+    exitcode = EXIT_FAILURE;
+  }
+  //-- END: MAIN EXCEPTION CATCH
+
+  for (unsigned int i = 0; i < metrics.size(); i++)
+  {
+    delete metrics[i];
+    delete outputs[i];
+  }
+
+  return exitcode;
+}
+
+
+
+
+//------------------------------------------------------------- ParseArgs ----//
+void ParseArgs (int argc, char ** argv)
+{
+  int ch, errflg = 0;
+  optarg = NULL;
+
+  while ( !errflg && ((ch = getopt (argc, argv, "hivm:p:t:x:c:L:uf:l:n:")) != EOF) )
+    switch (ch)
+      {
+      case 'h': PrintHelp (argv[0]); exit (EXIT_SUCCESS); break;
+
+      case 'i': OPT_IIDs = true; break;
+
+      case 'v': PrintBankVersion (argv[0]); exit (EXIT_SUCCESS); break;
+
+      case 'm': OPT_Metrics = optarg; break;
+      case 'p': OPT_Prefix = optarg; break;
+      case 't': OPT_BatchSize = atoi(optarg); break;
+
+      case 'x': OPT_DepthX = atof(optarg); break;
+      case 'c': OPT_DepthCluster = atoi(optarg); break;
+      case 'L': OPT_DepthMinLen = atoi(optarg); break;
+      case 'u': OPT_DepthUngapped = true; break;
+
+      case 'f': OPT_CEFeatures = atof(optarg); break;
+      case 'l': OPT_CEMinLen = atoi(optarg); break;
+
+      case 'n': OPT_CovStride = atoi(optarg); break;
+
+      default:
+        errflg ++;
+      }
+
+  if (errflg > 0 || optind != argc - 1 || OPT_Prefix.empty())
+  {
+    PrintUsage (argv[0]);
+    cerr << "Try '" << argv[0] << " -h' for more information.\n";
+    exit (EXIT_FAILURE);
+  }
+
+  if (OPT_CovStride < 1) { OPT_CovStride = 1; }
+
+  OPT_BankName = argv [optind ++];
+}
+
+
+
+
+//------------------------------------------------------------- PrintHelp ----//
+void PrintHelp (const char * s)
+{
+  PrintUsage (s);
+  cerr
+    << "-h            Display help information\n"
+    << "-v            Display the compatible bank version\n"
+    << "-p prefix     Write each metric to prefix.<metric suffix> (required)\n"
+    << "-m list       Comma separated metrics to compute (default: "
+    << OPT_Metrics << ")\n"
+    << "-t n          Contigs per parallel batch (default: " << OPT_BatchSize << ")\n"
+    << "-i            Print contig IIDs instead of EIDs\n"
+    << "\n"
+    << "Metrics\n"
+    << "  depth       High read coverage features, as analyze-read-depth (.depth.feat)\n"
+    << "                -x val  Flag regions val x the global average depth (default: 3)\n"
+    << "                -c dist Cluster regions within dist bp\n"
+    << "                -L len  Only use contigs >= len for computing average\n"
+    << "                -u      Use ungapped length for the contig cutoff\n"
+    << "  ce          CE statistic, as cestat-cov (.ce, or .ce.feat with -f)\n"
+    << "                -f val  Only output CE features outside val deviations\n"
+    << "                -l len  Only output features at least this length (default: 100)\n"
+    << "  cov         Read coverage plot, as read-cov-plot (.cov)\n"
+    << "                -n val  Only print every n-th position\n"
+    << "  libhist     Insert size histograms, as library-histogram (.libhist)\n"
+    << "  inserts     Insert size summaries, as insert-sizes -c (.inserts)\n"
+    << endl;
+  cerr
+    << "Streams the contig bank once and computes every requested metric from the\n"
+    << "same contig and mate-pair data. Contigs are processed in parallel batches,\n"
+    << "set OMP_NUM_THREADS to control the number of threads. Output does not\n"
+    << "depend on the number of threads.\n\n";
+  return;
+}
+
+
+
+
+//------------------------------------------------------------ PrintUsage ----//
+void PrintUsage (const char * s)
+{
+  cerr
+    << "\nUSAGE: " << s << "  [options]  -p <prefix>  <bank path>\n\n";
+  return;
+}
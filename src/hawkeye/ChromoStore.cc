@@ -1,3 +1,7 @@
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <sys/types.h>
 #include <sys/time.h>
 #include <dirent.h>
@@ -23,6 +27,8 @@ ChromoStore::ChromoStore()
   m_tracepaths.push_back("/local/chromo3/Chromatograms/%TRACEDB%/ABISSed/%EID3%/%EID4%/%EID5%/");
 
   m_tracepaths.push_back("/fs/szasmg/Chromatograms/%TRACEDB%/");
+  m_tracepaths.push_back("chromat.trc");
+  m_tracepaths.push_back("../chromat.trc");
   m_tracepaths.push_back("chromat_dir");
   m_tracepaths.push_back("../chromat_dir");
 
@@ -31,10 +37,39 @@ ChromoStore::ChromoStore()
   m_tracecmd          = "curl \"http://www.ncbi.nlm.nih.gov/Traces/trace.fcgi?cmd=java&val=%EID%\" -s -o %TRACECACHE%/%EID%";
   m_tracecmdpath      = "%TRACECACHE%/%EID%";
   m_tracecmdenabled   = 0;
+  m_tracecachelimit   = 64 * 1024 * 1024;
+
+  m_cachebytes = 0;
+  m_threadstarted = false;
+  m_stopping = false;
+  m_settings = currentSettings();
+  pthread_mutex_init(&m_lock, NULL);
+  pthread_cond_init(&m_wakeup, NULL);
+  pthread_cond_init(&m_loaded, NULL);
 }
 
 ChromoStore::~ChromoStore()
 {
+  if (m_threadstarted)
+  {
+    pthread_mutex_lock(&m_lock);
+    m_stopping = true;
+    m_prefetch.clear();
+    pthread_cond_signal(&m_wakeup);
+    pthread_mutex_unlock(&m_lock);
+    pthread_join(m_thread, NULL);
+  }
+
+  map<string, AMOS::TraceArchive_t *>::iterator ai;
+  for (ai = m_archives.begin(); ai != m_archives.end(); ai++)
+  {
+    delete ai->second;
+  }
+
+  pthread_cond_destroy(&m_loaded);
+  pthread_cond_destroy(&m_wakeup);
+  pthread_mutex_destroy(&m_lock);
+
   if (m_tracecachecreated)
   {
     cerr << "Cleaning tracecache directory: " << m_tracecache << endl;
@@ -82,14 +117,15 @@ static void replaceAll(string & str,
   }
 }
 
-string ChromoStore::replaceTraceTokens(const string & str,
-                                const string & eid,
-                                const string & iid)
+string ChromoStore::replaceTraceTokens(const Settings_t & settings,
+                                       const string & str,
+                                       const string & eid,
+                                       const string & iid)
 {
   string result(str);
 
-  replaceAll(result, "TRACECACHE", m_tracecache);
-  replaceAll(result, "TRACEDB",    m_tracedb);
+  replaceAll(result, "TRACECACHE", settings.tracecache);
+  replaceAll(result, "TRACEDB",    settings.tracedb);
   replaceAll(result, "EID",  eid);
   replaceAll(result, "IID",  iid);
 
@@ -101,48 +137,142 @@ string ChromoStore::replaceTraceTokens(const string & str,
 extern "C"
 {
   #include "Read.h"
+  #include "open_trace_file.h"
 }
 
-char * ChromoStore::fetchTrace(const AMOS::Read_t & read, 
-                             std::vector<int16_t> & positions )
+
+bool ChromoStore::Settings_t::operator!= (const Settings_t & o) const
 {
-  string eid = read.getEID();
+  return tracepaths != o.tracepaths ||
+         tracecache != o.tracecache ||
+         tracecmd != o.tracecmd ||
+         tracecmdpath != o.tracecmdpath ||
+         tracedb != o.tracedb ||
+         tracecmdenabled != o.tracecmdenabled;
+}
 
-  char iidarr[16];
-  sprintf(iidarr, "%d", read.getIID());
-  string iid(iidarr);
 
-  Read * trace = NULL;
+ChromoStore::Settings_t ChromoStore::currentSettings() const
+{
+  Settings_t settings;
+  settings.tracepaths      = m_tracepaths;
+  settings.tracecache      = m_tracecache;
+  settings.tracecmd        = m_tracecmd;
+  settings.tracecmdpath    = m_tracecmdpath;
+  settings.tracedb         = m_tracedb;
+  settings.tracecmdenabled = m_tracecmdenabled;
+
+  return settings;
+}
+
+
+// Called with m_lock held. The public settings belong to the gui thread, so
+// the prefetch thread only sees the copies made here. Traces that were not
+// found may turn up with other settings.
+void ChromoStore::updateSettings(const Settings_t & settings)
+{
+  if (settings != m_settings)
+  {
+    m_settings = settings;
+    m_missing.clear();
+  }
+}
+
+
+// Opens and keeps the trace archive at path, or returns NULL if path is not
+// a trace archive
+AMOS::TraceArchive_t * ChromoStore::getArchive(const string & path)
+{
+  AMOS::TraceArchive_t * archive = NULL;
 
+  pthread_mutex_lock(&m_lock);
+
+  map<string, AMOS::TraceArchive_t *>::iterator ai = m_archives.find(path);
+  if (ai != m_archives.end())
+  {
+    archive = ai->second;
+  }
+  else
+  {
+    if (AMOS::TraceArchive_t::isArchive(path))
+    {
+      try
+      {
+        archive = new AMOS::TraceArchive_t();
+        archive->open(path);
+        cerr << "Opened trace archive " << path << " with "
+             << archive->getSize() << " traces" << endl;
+      }
+      catch (AMOS::Exception_t & e)
+      {
+        cerr << "Can't open trace archive " << path << ": " << e.what() << endl;
+        delete archive;
+        archive = NULL;
+      }
+    }
+
+    m_archives[path] = archive;
+  }
+
+  pthread_mutex_unlock(&m_lock);
+
+  return archive;
+}
+
+
+// Finds the trace file of a read in the trace archives and directories, or
+// with the fetch command, and reads it into data. Called without m_lock, by
+// the gui or the prefetch thread.
+bool ChromoStore::loadTraceData(const Settings_t & settings,
+                                const string & eid,
+                                const string & iid,
+                                string & data)
+{
+  FILE * fp = NULL;
   string path;
 
-  vector <string>::iterator ci;
-  for (ci =  m_tracepaths.begin();
-       ci != m_tracepaths.end() && !trace;
+  vector <string>::const_iterator ci;
+  for (ci =  settings.tracepaths.begin();
+       ci != settings.tracepaths.end() && !fp;
        ci++)
   {
-    path = replaceTraceTokens(*ci, eid, iid);
+    path = replaceTraceTokens(settings, *ci, eid, iid);
 
-    DIR * dir = opendir(path.c_str());
-    if (dir)
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) { continue; }
+
+    if (S_ISREG(st.st_mode))
+    {
+      AMOS::TraceArchive_t * archive = getArchive(path);
+      AMOS::Size_t size;
+      const char * trace = archive ? archive->find(eid, size) : NULL;
+
+      if (trace)
+      {
+        data.assign(trace, size);
+        return true;
+      }
+    }
+    else if (S_ISDIR(st.st_mode))
     {
-      closedir(dir);
       path += "/" + eid;
-      trace = read_reading((char *)path.c_str(), TT_ANY);
+      fp = open_trace_file((char *)path.c_str(), NULL);
     }
   }
 
-  if (!trace && m_tracecmdenabled)
+  if (!fp && settings.tracecmdenabled)
   {
+    pthread_mutex_lock(&m_lock);
     if (!m_tracecachecreated)
     {
-      int retval = mkdir(m_tracecache.c_str(), 
+      int retval = mkdir(settings.tracecache.c_str(), 
                          S_IRUSR | S_IWUSR | S_IXUSR | S_IRGRP | S_IWGRP | S_IXGRP | S_IROTH | S_IXOTH );
       m_tracecachecreated = !retval;
     }
+    pthread_mutex_unlock(&m_lock);
 
-    string cmd = replaceTraceTokens(m_tracecmd, eid, iid);
-    path = replaceTraceTokens(m_tracecmdpath, eid, iid);
+    string cmd = replaceTraceTokens(settings, settings.tracecmd, eid, iid);
+    path = replaceTraceTokens(settings, settings.tracecmdpath, eid, iid);
 
     cerr << "**** Executing: \"" << cmd << "\"" << endl;
 
@@ -150,8 +280,202 @@ char * ChromoStore::fetchTrace(const AMOS::Read_t & read,
 
     if (!retval)
     {
-      trace = read_reading((char *)path.c_str(), TT_ANY);
+      fp = open_trace_file((char *)path.c_str(), NULL);
+    }
+  }
+
+  if (!fp) { return false; }
+
+  char buffer[65536];
+  size_t n;
+
+  data.clear();
+  while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+  {
+    data.append(buffer, n);
+  }
+  fclose(fp);
+
+  return true;
+}
+
+
+// Called with m_lock held
+void ChromoStore::cacheTrace(const string & eid, bool found, const string & data)
+{
+  if (!found)
+  {
+    m_missing.insert(eid);
+    return;
+  }
+
+  if (m_cacheindex.find(eid) != m_cacheindex.end()) { return; }
+
+  m_cache.push_front(make_pair(eid, data));
+  m_cacheindex[eid] = m_cache.begin();
+  m_cachebytes += data.size();
+
+  // evict the least recently used traces, but always keep the newest
+  while (m_cachebytes > m_tracecachelimit && m_cache.size() > 1)
+  {
+    m_cachebytes -= m_cache.back().second.size();
+    m_cacheindex.erase(m_cache.back().first);
+    m_cache.pop_back();
+  }
+}
+
+
+void * ChromoStore::prefetchMain(void * store)
+{
+  ((ChromoStore *) store)->prefetchLoop();
+  return NULL;
+}
+
+
+void ChromoStore::prefetchLoop()
+{
+  pthread_mutex_lock(&m_lock);
+
+  while (!m_stopping)
+  {
+    if (m_prefetch.empty())
+    {
+      pthread_cond_wait(&m_wakeup, &m_lock);
+      continue;
+    }
+
+    pair<string, string> next = m_prefetch.front();
+    m_prefetch.pop_front();
+
+    if (m_cacheindex.find(next.first) != m_cacheindex.end() ||
+        m_missing.find(next.first) != m_missing.end())
+    {
+      continue;
+    }
+
+    Settings_t settings = m_settings;
+    m_inflight = next.first;
+    pthread_mutex_unlock(&m_lock);
+
+    string data;
+    bool found = loadTraceData(settings, next.first, next.second, data);
+
+    pthread_mutex_lock(&m_lock);
+    cacheTrace(next.first, found, data);
+    m_inflight.clear();
+    pthread_cond_broadcast(&m_loaded);
+  }
+
+  pthread_mutex_unlock(&m_lock);
+}
+
+
+void ChromoStore::prefetchTrace(const string & eid, AMOS::ID_t iid)
+{
+  char iidarr[16];
+  sprintf(iidarr, "%d", iid);
+
+  pthread_mutex_lock(&m_lock);
+  updateSettings(currentSettings());
+
+  if (m_cacheindex.find(eid) == m_cacheindex.end() &&
+      m_missing.find(eid) == m_missing.end())
+  {
+    m_prefetch.push_back(make_pair(eid, string(iidarr)));
+
+    if (!m_threadstarted)
+    {
+      m_threadstarted = !pthread_create(&m_thread, NULL, prefetchMain, this);
     }
+    pthread_cond_signal(&m_wakeup);
+  }
+
+  pthread_mutex_unlock(&m_lock);
+}
+
+
+void ChromoStore::clearPrefetch()
+{
+  pthread_mutex_lock(&m_lock);
+  m_prefetch.clear();
+  pthread_mutex_unlock(&m_lock);
+}
+
+
+// Decodes a trace file held in memory
+static Read * decodeTrace(const string & eid, string & data)
+{
+  FILE * fp = NULL;
+
+#ifdef HAVE_FMEMOPEN
+  fp = fmemopen(&data[0], data.size(), "r");
+#endif
+
+  if (!fp)
+  {
+    fp = tmpfile();
+    if (!fp) { return NULL; }
+    fwrite(data.data(), 1, data.size(), fp);
+    rewind(fp);
+  }
+
+  Read * trace = fread_reading(fp, (char *)eid.c_str(), TT_ANY);
+  fclose(fp);
+
+  return trace;
+}
+
+
+char * ChromoStore::fetchTrace(const AMOS::Read_t & read, 
+                             std::vector<int16_t> & positions )
+{
+  string eid = read.getEID();
+
+  char iidarr[16];
+  sprintf(iidarr, "%d", read.getIID());
+  string iid(iidarr);
+
+  Read * trace = NULL;
+  string data;
+  bool found = false;
+  bool missing = false;
+  Settings_t settings = currentSettings();
+
+  // take the trace from the cache, waiting if the prefetch thread is
+  // loading it right now
+  pthread_mutex_lock(&m_lock);
+  updateSettings(settings);
+
+  while (m_inflight == eid)
+  {
+    pthread_cond_wait(&m_loaded, &m_lock);
+  }
+
+  map<string, TraceList_t::iterator>::iterator ci = m_cacheindex.find(eid);
+  if (ci != m_cacheindex.end())
+  {
+    m_cache.splice(m_cache.begin(), m_cache, ci->second);
+    data = ci->second->second;
+    found = true;
+  }
+  else
+  {
+    missing = m_missing.find(eid) != m_missing.end();
+  }
+  pthread_mutex_unlock(&m_lock);
+
+  if (!found && !missing)
+  {
+    found = loadTraceData(settings, eid, iid, data);
+
+    pthread_mutex_lock(&m_lock);
+    cacheTrace(eid, found, data);
+    pthread_mutex_unlock(&m_lock);
+  }
+
+  if (found)
+  {
+    trace = decodeTrace(eid, data);
   }
 
   // Load positions out of trace
@@ -165,5 +489,3 @@ char * ChromoStore::fetchTrace(const AMOS::Read_t & read,
 
   return (char *) trace;
 }
-
-
@@ -4,10 +4,14 @@
 #include "foundation_AMOS.hh"
 #include <string>
 #include <map>
+#include <set>
+#include <list>
+#include <deque>
 #include <vector>
+#include <pthread.h>
 
 
-class ChromoStore 
+class ChromoStore
 {
 public:
   static ChromoStore * Instance();
@@ -15,6 +19,12 @@ public:
 
   char * fetchTrace(const AMOS::Read_t & read, std::vector<int16_t> & positions);
 
+  // Queue a trace to be loaded into the cache in the background
+  void prefetchTrace(const std::string & eid, AMOS::ID_t iid);
+
+  // Forget the traces queued for prefetch, e.g. when the view moved on
+  void clearPrefetch();
+
 
   std::vector <std::string> m_tracepaths;
   std::string m_tracecache;
@@ -22,6 +32,7 @@ public:
   std::string m_tracecmdpath;
   std::string m_tracedb;
   bool m_tracecmdenabled;
+  size_t m_tracecachelimit;   // bytes of trace files kept in memory
 
 
 
@@ -33,13 +44,60 @@ protected:
 
 
 private:
-  std::string replaceTraceTokens(const std::string & str,
+  // The trace settings, copied for the prefetch thread
+  struct Settings_t
+  {
+    std::vector <std::string> tracepaths;
+    std::string tracecache;
+    std::string tracecmd;
+    std::string tracecmdpath;
+    std::string tracedb;
+    bool tracecmdenabled;
+
+    bool operator!= (const Settings_t & o) const;
+  };
+
+  typedef std::list<std::pair<std::string, std::string> > TraceList_t;
+
+  std::string replaceTraceTokens(const Settings_t & settings,
+                                 const std::string & str,
                                  const std::string & eid,
                                  const std::string & iid);
 
+  Settings_t currentSettings() const;
+  void updateSettings(const Settings_t & settings);
+
+  bool loadTraceData(const Settings_t & settings,
+                     const std::string & eid,
+                     const std::string & iid,
+                     std::string & data);
+  AMOS::TraceArchive_t * getArchive(const std::string & path);
+  void cacheTrace(const std::string & eid, bool found, const std::string & data);
+
+  static void * prefetchMain(void * store);
+  void prefetchLoop();
+
   bool m_tracecachecreated;
 
-  
+  // LRU cache of trace files by eid, most recently used first
+  TraceList_t m_cache;
+  std::map<std::string, TraceList_t::iterator> m_cacheindex;
+  size_t m_cachebytes;
+  std::set<std::string> m_missing;
+
+  std::map<std::string, AMOS::TraceArchive_t *> m_archives;
+
+  // Prefetch queue of (eid, iid) and its thread
+  std::deque<std::pair<std::string, std::string> > m_prefetch;
+  std::string m_inflight;
+  Settings_t m_settings;
+  pthread_t m_thread;
+  bool m_threadstarted;
+  bool m_stopping;
+  pthread_mutex_t m_lock;
+  pthread_cond_t m_wakeup;
+  pthread_cond_t m_loaded;
+
 };
 
 #endif
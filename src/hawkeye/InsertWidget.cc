@@ -698,16 +698,43 @@ void InsertWidget::initializeTiling()
     if (m_datastore->feat_bank.isOpen())
     {
       Feature_t feat;
-      m_datastore->feat_bank.seekg(1);
-      
-      while (m_datastore->feat_bank >> feat)
+      vector<ContigRangeIndex_t::Entry_t> feats;
+      vector<ContigRangeIndex_t::Entry_t>::const_iterator fi;
+      bool indexed = m_datastore->m_rangeindex.isOpen();
+
+      // The contig range index names the features of the contig, unless
+      // some of them have no IID to fetch them by
+      if (indexed)
       {
-        if (feat.getSource().second == Contig_t::NCODE &&
-            feat.getSource().first == m_datastore->m_contig.getIID())
+        m_datastore->m_rangeindex.getFeatures(m_datastore->m_contig.getIID(),
+                                              Range_t(-MAX_POS, MAX_POS), feats);
+        for (fi = feats.begin(); indexed && fi != feats.end(); fi++)
         {
+          indexed = (fi->iid != AMOS::NULL_ID);
+        }
+      }
+
+      if (indexed)
+      {
+        for (fi = feats.begin(); fi != feats.end(); fi++)
+        {
+          m_datastore->feat_bank.fetch(fi->iid, feat);
           m_features.push_back(feat);
         }
       }
+      else
+      {
+        m_datastore->feat_bank.seekg(1);
+
+        while (m_datastore->feat_bank >> feat)
+        {
+          if (feat.getSource().second == Contig_t::NCODE &&
+              feat.getSource().first == m_datastore->m_contig.getIID())
+          {
+            m_features.push_back(feat);
+          }
+        }
+      }
     }
   }
 
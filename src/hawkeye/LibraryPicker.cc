@@ -105,15 +105,7 @@ void LaunchPad::loadLibraries()
         AMOS::Distribution_t dist = lib.getDistribution();
 
         ID_t libid = lib.getIID();
-        int frag = 0;
-
-        for (int i = 0; i < m_datastore->m_fragliblookup.size(); i++)
-        {
-          if (m_datastore->m_fragliblookup[i] == libid)
-          {
-            frag++;
-          }
-        }
+        int frag = m_datastore->countFragments(libid);
 
         new LibListItem(libraryList,
                         QString::number(libid),
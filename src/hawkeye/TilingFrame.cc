@@ -13,6 +13,7 @@
 #include <Q3VBoxLayout>
 #include "ConsensusField.hh"
 #include "RenderSeq.hh"
+#include "ChromoStore.hh"
 #include "UIElements.hh"
 #include "DataStore.hh"
 #include "AlignmentInfo.hh"
@@ -418,6 +419,44 @@ void TilingFrame::loadContigRange(int gindex)
     }
     //cerr << "Loaded [" << m_loadedStart << "," << m_loadedEnd << "]:" << m_renderedSeqs.size() << " kept:" << orig << " erased: " << erase << endl;
 
+    // Queue the traces of the reads just outside the loaded range, so they
+    // are in memory before the user scrolls to them
+    if (m_displayAllChromo)
+    {
+      ChromoStore * chromostore = ChromoStore::Instance();
+      chromostore->clearPrefetch();
+
+      int leftStart  = max(0, m_loadedStart - m_loadedWidth);
+      int rightEnd   = min(clen, m_loadedEnd + m_loadedWidth);
+
+      for (vi = m_tiling.begin(); vi != viend; vi++)
+      {
+        int glen = vi->getGappedLength();
+
+        // reads in the loaded range already have their traces
+        if (RenderSeq_t::hasOverlap(m_loadedStart, m_loadedEnd, vi->offset, glen, clen))
+        {
+          continue;
+        }
+
+        if ((m_loadedStart > leftStart && 
+             RenderSeq_t::hasOverlap(leftStart, m_loadedStart-1, vi->offset, glen, clen)) ||
+            (rightEnd > m_loadedEnd &&
+             RenderSeq_t::hasOverlap(m_loadedEnd+1, rightEnd, vi->offset, glen, clen)))
+        {
+          try
+          {
+            string eid = m_datastore->read_bank.lookupEID(vi->source);
+            chromostore->prefetchTrace(eid, vi->source);
+          }
+          catch (Exception_t & e)
+          {
+            cerr << "Can't prefetch trace of read " << vi->source << ": " << e.what() << endl;
+          }
+        }
+      }
+    }
+
     QApplication::restoreOverrideCursor();
   }
 }
@@ -2,4 +2,4 @@
 
 
 cd test_cases
-rm -rf *.bnk *.log *.fasta *.contig
+rm -rf *.bnk *.log *.fasta *.contig *.out